@@ -54,6 +54,19 @@ sss_status_t nxScp03_HostLocal_CalculateHostCryptogram(
 */
 sss_status_t nxSCP03_Encrypt_CommandAPDU(
     NXSCP03_DynCtx_t *pdySCP03SessCtx, uint8_t *cmdBuf, size_t *cmdBufLen);
+
+/**
+* To pad and encrypt ``cmdBuf`` straight into ``encBuf``.
+*
+* ``encBuf`` is either ``cmdBuf`` itself (in place) or does not overlap it.
+* On input ``*pEncBufLen`` is the room in ``encBuf``, which must be at least
+* SCP_PADDED_LEN(cmdBufLen). On output it is SCP_PADDED_LEN(cmdBufLen).
+*/
+sss_status_t nxSCP03_Encrypt_CommandAPDU_To(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    const uint8_t *cmdBuf,
+    size_t cmdBufLen,
+    uint8_t *encBuf,
+    size_t *pEncBufLen);
 /**
 *  To provide additional Security with MAC as CRC
 */
@@ -61,7 +74,7 @@ sss_status_t nxpSCP03_CalculateMac_CommandAPDU(
     NXSCP03_DynCtx_t *pdySCP03SessCtx, uint8_t *pCmdBuf, size_t pCmdBufLen, uint8_t *mac, size_t *macLen);
 
 /**
-*   To get Plain Response APDU
+*   To get Plain Response APDU, decrypted in place in ``rspBuf``
 */
 uint16_t nxpSCP03_Decrypt_ResponseAPDU(
     NXSCP03_DynCtx_t *pdySCP03SessCtx, size_t cmdBufLen, uint8_t *rspBuf, size_t *pRspBufLen, uint8_t hasle);
@@ -83,6 +96,16 @@ sss_status_t nxScp03_Generate_SessionKey(
 */
 void nxpSCP03_Inc_CommandCounter(NXSCP03_DynCtx_t *pdySCP03SessCtx);
 
+/**
+* To expand the session keys once, after they are (re)set in ``pdySCP03SessCtx``
+*/
+sss_status_t nxScp03_DynCtx_KeyedInit(NXSCP03_DynCtx_t *pdySCP03SessCtx);
+
+/**
+* To wipe the expanded session keys, at session close
+*/
+void nxScp03_DynCtx_KeyedFree(NXSCP03_DynCtx_t *pdySCP03SessCtx);
+
 #ifdef __cplusplus
 } /* extern "c"*/
 #endif
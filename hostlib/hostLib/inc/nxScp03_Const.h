@@ -56,6 +56,9 @@
 #define SCP_IV_SIZE (16)         // length of the Inital Vector
 #define SCP_COMMAND_MAC_SIZE (8) // length of the MAC appended in the APDU payload (8 'MSB's)
 
+/** Length of a command payload once padded (0x80 and zeroes) for encryption, 0 stays 0 */
+#define SCP_PADDED_LEN(LEN) (((LEN) == 0) ? 0 : ((((LEN) / SCP_KEY_SIZE) + 1) * SCP_KEY_SIZE))
+
 #define DATA_CARD_CRYPTOGRAM (0x00)       //!< Data card cryptogram
 #define DATA_HOST_CRYPTOGRAM (0x01)       //!< Data host cryptogram
 #define DATA_DERIVATION_SENC (0x04)       //!< Data Derivation to generate Sess ENC Key
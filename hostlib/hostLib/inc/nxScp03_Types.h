@@ -83,6 +83,42 @@ typedef enum
  *
  * @{ */
 
+/** Keep the session ENC/MAC/RMAC keys expanded in host crypto contexts
+ * for the lifetime of the session, instead of re-keying on every APDU.
+ *
+ * Only the OpenSSL and mbedTLS host crypto are supported, other host
+ * crypto falls back to the generic ``sss_host_*`` APIs. */
+#ifndef NX_SCP03_KEYED_CTX_CACHE
+#if SSS_HAVE_HOSTCRYPTO_OPENSSL || SSS_HAVE_HOSTCRYPTO_MBEDTLS
+#define NX_SCP03_KEYED_CTX_CACHE 1
+#else
+#define NX_SCP03_KEYED_CTX_CACHE 0
+#endif
+#endif
+
+/** NXSCP03_KeyedCtx_t::ready: all contexts are keyed and owned */
+#define NX_SCP03_KEYED_READY 0x4B594452u
+/** NXSCP03_KeyedCtx_t::ready: keying failed, the generic host crypto is used */
+#define NX_SCP03_KEYED_FAILED 0x4B594446u
+
+/**
+ * Pre-keyed host crypto contexts of a SCP03 session.
+ *
+ * Owned by ``NXSCP03_DynCtx_t``. Created from the session keys by
+ * nxScp03_DynCtx_KeyedInit() and wiped by nxScp03_DynCtx_KeyedFree().
+ *
+ * The pointers are owned only while ``ready`` is NX_SCP03_KEYED_READY.
+ * Any other value, e.g. left over on the stack, means nothing to free.
+ */
+typedef struct
+{
+    void *pEncCtx;  //!< AES-CBC encrypt, session ENC key
+    void *pDecCtx;  //!< AES-CBC decrypt, session ENC key
+    void *pMacCtx;  //!< AES-CMAC, session MAC key
+    void *pRmacCtx; //!< AES-CMAC, session RMAC key
+    uint32_t ready; //!< NX_SCP03_KEYED_READY, NX_SCP03_KEYED_FAILED or not keyed yet
+} NXSCP03_KeyedCtx_t;
+
 /**
  * Dynamic SCP03 Context.
  *
@@ -100,6 +136,9 @@ typedef struct
 
     /** Handle differnt types of auth.. PlatformSCP / AppletSCP */
     SE_AuthType_t authType;
+
+    /** Session keys, already expanded */
+    NXSCP03_KeyedCtx_t keyed;
 } NXSCP03_DynCtx_t;
 
 /**
@@ -0,0 +1,112 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Host side emulation of the SE05x applet, for tests and benchmarks
+ * without hardware.
+ *
+ * se05x_emul_process() takes a C-APDU as built by se05x_APDU_impl.h and
+ * returns the R-APDU the applet would return, plus the time the real SE
+ * would have needed for it. It is reached either through the smCom layer
+ * (smComEmul.c, build with SMCOM_EMUL) or through the T=1 over I2C stack
+ * with platform/generic/i2c_a7_emul.c in place of the I2C driver.
+ *
+ * Emulated:
+ * - Applet select, GetVersion, GetRandom, GetFreeMemory
+ * - Platform SCP03 (INITIALIZE UPDATE / EXTERNAL AUTHENTICATE, C-MAC,
+ *   C-DEC, R-MAC, R-ENC), with the static keys of SE05X_EMUL_KEY_*
+ * - UserID sessions (CreateSession, VerifySessionUserID, CloseSession)
+ * - EC keys on the NIST, Brainpool and Koblitz curves: generate, import,
+ *   ECDSA sign / verify, ECDH
+ * - AES, HMAC and binary objects, counters, UserIDs, ReadIDList / ReadType /
+ *   ReadSize / CheckObjectExists / DeleteSecureObject / DeleteAll
+ * - Cipher (ECB, CBC, CTR), MAC (HMAC, CMAC) and digest, one shot and
+ *   multi step through crypto objects
+ *
+ * Not emulated: AESKey / ECKey applet sessions, RSA, DES crypto,
+ * policies, attestation, TLS / HKDF and PCRs. These return
+ * 6D00 or 6985.
+ *
+ * The emulator is one SE per process and not thread safe; callers
+ * serialize through smCom like they would for the real SE.
+ */
+
+#ifndef SE05X_EMUL_H_INC
+#define SE05X_EMUL_H_INC
+
+#if defined(SSS_USE_FTR_FILE)
+#include "fsl_sss_ftr.h"
+#else
+#include "fsl_sss_ftr_default.h"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "se05x_tlv.h"
+
+/* se05x_emul.c implements the applet with OpenSSL host crypto. The
+ * interface is declared in any case, so that a test can link the smCom
+ * and I2C targets against a scripted se05x_emul_process() of its own. */
+
+/** Number of secure objects the emulated SE can hold */
+#ifndef SE05X_EMUL_MAX_OBJECTS
+#define SE05X_EMUL_MAX_OBJECTS 64
+#endif
+
+/** Number of entries of the latency table, defaults included */
+#ifndef SE05X_EMUL_MAX_LATENCY
+#define SE05X_EMUL_MAX_LATENCY 48
+#endif
+
+/** Wildcard for se05x_emul_set_latency() */
+#define SE05X_EMUL_ANY 0xFF
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Process one C-APDU.
+ *
+ * @param[in] cmd         C-APDU, short or extended length
+ * @param[in] cmdLen      Length of cmd
+ * @param[out] rsp        R-APDU, data followed by SW1 SW2
+ * @param[in,out] rspLen  IN: size of rsp, OUT: length of the R-APDU
+ * @param[out] pLatencyUs Optional, time the SE would have been busy
+ *
+ * @return The status word also stored at the end of rsp, or SM_NOT_OK
+ *         if rsp is too small.
+ */
+smStatus_t se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs);
+
+/** Power cycle: transient objects, sessions and Platform SCP are lost */
+void se05x_emul_reset(void);
+
+/** Back to an empty SE, as delivered */
+void se05x_emul_factory_reset(void);
+
+/**
+ * Set the modelled processing time of a command.
+ *
+ * The time is baseUs + perByteNs * (command data + response data) / 1000.
+ * ins is the instruction without the transient / auth / attest bits.
+ * SE05X_EMUL_ANY matches any ins, p1 or p2; the most specific entry wins.
+ */
+void se05x_emul_set_latency(uint8_t ins, uint8_t p1, uint8_t p2, uint32_t baseUs, uint32_t perByteNs);
+
+/** Scale all modelled times, in percent. 100 is the default, 0 turns the model off. */
+void se05x_emul_set_latency_scale(uint32_t percent);
+
+/** Replace the Platform SCP03 static keys, 16 bytes each */
+void se05x_emul_set_scp03_keys(const uint8_t *enc, const uint8_t *mac, const uint8_t *dek);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* SE05X_EMUL_H_INC */
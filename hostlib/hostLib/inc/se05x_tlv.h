@@ -164,8 +164,26 @@ typedef struct Se05xSession
 
     /**Connection data context */
     void *conn_ctx;
+
+    /** EC curves known to be created on the SE, see SE05X_EC_CURVE_BIT() */
+    uint32_t ecCurveBitmap;
+
+    /** Incremented when all objects are deleted, so that host side copies
+     * of object attributes taken before can be recognised as stale */
+    uint32_t objEpoch;
 } Se05xSession_t;
 
+/** Se05xSession_t.ecCurveBitmap was filled from Se05x_API_ReadECCurveList */
+#define SE05X_EC_CURVE_BITMAP_VALID (1u << 0)
+
+/** Bit of ``CURVE`` in Se05xSession_t.ecCurveBitmap.
+ *
+ * Weierstrass curves use bits 1 to 27, Edwards / Montgomery curves bits
+ * 28 to 31. 0 for anything else. */
+#define SE05X_EC_CURVE_BIT(CURVE)                       \
+    (((CURVE) >= 1 && (CURVE) < 28) ? (1u << (CURVE)) : \
+                                      (((CURVE) >= 0x40 && (CURVE) <= 0x43) ? (1u << ((CURVE)-0x40 + 28)) : 0u))
+
 
 typedef struct
 {
@@ -341,6 +359,19 @@ smStatus_t se05x_DeCrypt(struct Se05xSession *pSessionCtx,
     size_t *rspLength,
     uint8_t hasle);
 
+/** Longest header of se05x_FrameApdu(): CLA INS P1 P2 and an extended Lc */
+#define SE05X_APDU_FRAME_HDR_MAX (4 + 3)
+
+/** Raw C-APDU of a session less command: header, Lc, data and, with
+ * ``hasle``, an extended Le. ``cmdBuf`` may lie in ``txBuf`` itself, at
+ * offset SE05X_APDU_FRAME_HDR_MAX. */
+smStatus_t se05x_FrameApdu(const tlvHeader_t *hdr,
+    const uint8_t *cmdBuf,
+    size_t cmdBufLen,
+    uint8_t hasle,
+    uint8_t *txBuf,
+    size_t *ptxBufLen);
+
 smStatus_t DoAPDUTxRx_s_Case2(Se05xSession_t *pSessionCtx,
     const tlvHeader_t *hdr,
     uint8_t *cmdBuf,
@@ -373,6 +404,54 @@ smStatus_t DoAPDUTxRx(Se05xSession_t *pSessionCtx,
     uint8_t *rspBuf,
     size_t *pRspBufLen);
 
+/** One command of a batch, see DoAPDUTxRx_Batch() */
+typedef struct
+{
+    /** IN: Command header */
+    tlvHeader_t hdr;
+    /** IN: Command data (TLVs), NULL if none */
+    uint8_t *cmdBuf;
+    /** IN: Length of cmdBuf */
+    size_t cmdBufLen;
+    /** IN: Set to 1 for extended length, as DoAPDUTxRx_s_Case4_ext */
+    uint8_t hasle;
+    /** IN: Response buffer (data and SW), NULL if only the status is needed */
+    uint8_t *rspBuf;
+    /** IN: Size of rspBuf, OUT: Length of the response */
+    size_t rspBufLen;
+    /** OUT: Status of the command, SM_NOT_OK if it was not sent */
+    smStatus_t status;
+} Se05xBatchApdu_t;
+
+/** Called by DoAPDUTxRx_Batch() as soon as ``pApdu`` completed */
+typedef void (*fp_Se05xBatchApduDone_t)(void *pDoneCtx, size_t index, Se05xBatchApdu_t *pApdu);
+
+/** Send ``apduCount`` prepared commands back to back over ``pSessionCtx``.
+ *
+ * Each command is wrapped by the session, so Platform SCP03 / applet
+ * session wrapping applies. The status and the response of each command
+ * are written back into ``pApdus``, and ``fpDone`` (optional) is called
+ * for each completed command.
+ *
+ * Over a plain or user ID session, when smCom has an asynchronous
+ * transport (smCom_InitAsync()), command N+1 is wrapped while the SE
+ * processes command N. With SCP03 the wrapping of a command depends on the
+ * response of the previous one, each command then goes through fp_TXn.
+ *
+ * The commands run in order. With ``stopOnError`` the batch stops at the
+ * first command that does not return SM_OK, the remaining ones keep
+ * status SM_NOT_OK.
+ *
+ * @return SM_OK if all commands returned SM_OK, else the status of the
+ *         first failing command.
+ */
+smStatus_t DoAPDUTxRx_Batch(Se05xSession_t *pSessionCtx,
+    Se05xBatchApdu_t *pApdus,
+    size_t apduCount,
+    uint8_t stopOnError,
+    fp_Se05xBatchApduDone_t fpDone,
+    void *pDoneCtx);
+
 #if SSS_HAVE_APPLET_SE05X_IOT
 smStatus_t Se05x_API_I2CM_Send(
     pSe05xSession_t sessionId, const uint8_t *buffer, size_t bufferLen, uint8_t *result, size_t *presultLen);
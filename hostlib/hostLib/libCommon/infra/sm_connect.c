@@ -81,6 +81,9 @@
 #if defined(SMCOM_RC663_VCOM)
 #include "smComNxpNfcRdLib.h"
 #endif
+#if defined(SMCOM_EMUL)
+#include "smComEmul.h"
+#endif
 
 #include "global_platf.h"
 
@@ -407,6 +410,8 @@ U16 SM_I2CConnect(void **conn_ctx, SmCommState_t *commState, U8 *atr, U16 *atrLe
     }
 #elif defined (SCI2C)
     status = smComSCI2C_Init(conn_ctx, pConnString);
+#elif defined(SMCOM_EMUL)
+    status = smComEmul_Init(conn_ctx, pConnString);
 #endif
     if (status != SMCOM_OK) {
         return status;
@@ -475,7 +480,13 @@ U16 SM_Connect(void *conn_ctx, SmCommState_t *commState, U8 *atr, U16 *atrLen)
 #elif defined(SPI)
     smComSCSPI_Init(ESTABLISH_SCI2C, 0x00, atr, atrLen);
 #elif defined(T1oI2C)
-    sw = smComT1oI2C_Open(conn_ctx, ESE_MODE_NORMAL, 0x00, atr, atrLen);
+    if (commState->sessionResume == 1) {
+        /* Session still open on the SE, only re-synchronise the link */
+        sw = smComT1oI2C_Open(conn_ctx, ESE_MODE_RESUME, 0x00, atr, atrLen);
+    }
+    else {
+        sw = smComT1oI2C_Open(conn_ctx, ESE_MODE_NORMAL, 0x00, atr, atrLen);
+    }
 #elif defined(SMCOM_JRCP_V1) || defined(SMCOM_JRCP_V2) || defined(PCSC) || defined(SMCOM_PCSC)
     if (atrLen != NULL) {
         *atrLen = 0;
@@ -485,6 +496,8 @@ U16 SM_Connect(void *conn_ctx, SmCommState_t *commState, U8 *atr, U16 *atrLen)
 #elif defined(RJCT_VCOM)
 #elif defined(SMCOM_THREAD)
     sw = smComThread_Open(atr, atrLen);
+#elif defined(SMCOM_EMUL)
+    sw = smComEmul_Open(conn_ctx, atr, atrLen);
 #endif // TDA8029_UART
 
 #if !defined(IPC)
@@ -627,6 +640,9 @@ U16 SM_Close(void *conn_ctx, U8 mode)
 #if defined(SMCOM_RC663_VCOM)
     AX_UNUSED_ARG(mode);
     smComNxpNfcRdLib_Close();
+#endif
+#if defined(SMCOM_EMUL)
+    sw = smComEmul_Close(conn_ctx, mode);
 #endif
     smCom_DeInit();
 
@@ -0,0 +1,476 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ *
+ * @par Description
+ * APDU metrics, see sm_metrics.h
+ *
+ *****************************************************************************/
+
+#include "sm_metrics.h"
+
+#if SM_METRICS
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__GNUC__)
+#define METRICS_ADD32(P, V) (void)__atomic_fetch_add((P), (uint32_t)(V), __ATOMIC_RELAXED)
+#define METRICS_ADD64(P, V) (void)__atomic_fetch_add((P), (uint64_t)(V), __ATOMIC_RELAXED)
+#define METRICS_LOAD32(P) __atomic_load_n((P), __ATOMIC_RELAXED)
+#define METRICS_CLAIM(P, NEW) metrics_claim((P), (NEW))
+static int metrics_claim(uint32_t *pKey, uint32_t newKey)
+{
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(pKey, &expected, newKey, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+#else
+/* No atomics, callers have to serialise APDUs */
+#define METRICS_ADD32(P, V) (*(P) += (uint32_t)(V))
+#define METRICS_ADD64(P, V) (*(P) += (uint64_t)(V))
+#define METRICS_LOAD32(P) (*(P))
+#define METRICS_CLAIM(P, NEW) ((*(P) == 0) ? (*(P) = (NEW), 1) : 0)
+#endif
+
+#define METRICS_KEY_USED 0x01000000u
+
+static smMetrics_t gMetrics;
+/* Command on the link, only touched with the smCom lock held */
+static uint32_t gLinkKey;
+
+static const char *const gPhaseNames[SM_METRICS_PHASE_COUNT] = {
+    "wrap",
+    "i2c_write",
+    "se_busy",
+    "i2c_read",
+    "t1_recovery",
+    "unwrap",
+    "total",
+};
+
+static const char *const gEventNames[SM_METRICS_EV_COUNT] = {
+    "t1_wtx",
+    "t1_resync",
+    "t1_intf_reset",
+    "t1_rnack_tx",
+    "t1_rnack_rx",
+    "t1_iframe_tx",
+    "t1_crc_error",
+    "t1_no_frame",
+    "t1_recovery",
+    "t1_recovery_failed",
+    "i2c_write_error",
+    "i2c_read_tail",
+};
+
+static uint32_t metrics_key(const uint8_t *pHdr)
+{
+    return METRICS_KEY_USED | ((uint32_t)pHdr[1] << 16) | ((uint32_t)pHdr[2] << 8) | pHdr[3];
+}
+
+/* Log-linear bucket: exact below SM_METRICS_SUB_BUCKETS, then
+ * SM_METRICS_SUB_BUCKETS buckets per power of two */
+static uint32_t metrics_bucket(uint32_t us)
+{
+    uint32_t exp    = 0;
+    uint32_t bucket = 0;
+
+    if (us < SM_METRICS_SUB_BUCKETS) {
+        return us;
+    }
+    for (exp = 2; (us >> (exp + 1)) != 0; exp++) {
+    }
+    bucket = (exp - 1) * SM_METRICS_SUB_BUCKETS + ((us >> (exp - 2)) & (SM_METRICS_SUB_BUCKETS - 1));
+    return (bucket < SM_METRICS_BUCKETS) ? bucket : (SM_METRICS_BUCKETS - 1);
+}
+
+uint32_t sm_metrics_bucket_low_us(uint32_t bucket)
+{
+    uint32_t exp;
+
+    if (bucket < SM_METRICS_SUB_BUCKETS) {
+        return bucket;
+    }
+    exp = bucket / SM_METRICS_SUB_BUCKETS + 1;
+    return (SM_METRICS_SUB_BUCKETS + (bucket % SM_METRICS_SUB_BUCKETS)) << (exp - 2);
+}
+
+static smMetricsCmd_t *metrics_cmd(uint32_t key)
+{
+    size_t i;
+    uint32_t slotKey;
+
+    for (i = 0; i < SM_METRICS_MAX_CMDS; i++) {
+        slotKey = METRICS_LOAD32(&gMetrics.cmd[i].key);
+        if (slotKey == key) {
+            return &gMetrics.cmd[i];
+        }
+        if (slotKey == 0) {
+            if (METRICS_CLAIM(&gMetrics.cmd[i].key, key)) {
+                return &gMetrics.cmd[i];
+            }
+            /* Taken by someone else in the mean time */
+            if (METRICS_LOAD32(&gMetrics.cmd[i].key) == key) {
+                return &gMetrics.cmd[i];
+            }
+        }
+    }
+    METRICS_ADD32(&gMetrics.cmdOverflow, 1);
+    return NULL;
+}
+
+static uint32_t metrics_elapsed_us(uint64_t startUs)
+{
+    uint64_t nowUs = sm_get_time_us();
+    uint64_t us    = (nowUs > startUs) ? (nowUs - startUs) : 0;
+    return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+void sm_metrics_phase(smMetricsPhase_t phase, const uint8_t *pHdr, uint64_t startUs)
+{
+    uint32_t us          = metrics_elapsed_us(startUs);
+    uint32_t key         = (pHdr != NULL) ? metrics_key(pHdr) : gLinkKey;
+    smMetricsCmd_t *pCmd = NULL;
+
+    if (phase >= SM_METRICS_PHASE_COUNT) {
+        return;
+    }
+    METRICS_ADD32(&gMetrics.phaseHist[phase][metrics_bucket(us)], 1);
+    METRICS_ADD64(&gMetrics.phaseSumUs[phase], us);
+    if (key != 0) {
+        pCmd = metrics_cmd(key);
+        if (pCmd != NULL) {
+            METRICS_ADD64(&pCmd->sumUs[phase], us);
+        }
+    }
+}
+
+void sm_metrics_apdu(const uint8_t *pHdr, uint64_t startUs, size_t txLen, const uint8_t *pRsp, size_t rspLen)
+{
+    uint32_t us          = metrics_elapsed_us(startUs);
+    smMetricsCmd_t *pCmd = metrics_cmd(metrics_key(pHdr));
+    uint32_t maxUs;
+
+    METRICS_ADD32(&gMetrics.phaseHist[SM_METRICS_PHASE_TOTAL][metrics_bucket(us)], 1);
+    METRICS_ADD64(&gMetrics.phaseSumUs[SM_METRICS_PHASE_TOTAL], us);
+    if (pCmd == NULL) {
+        return;
+    }
+    METRICS_ADD32(&pCmd->count, 1);
+    if ((pRsp == NULL) || (rspLen < 2) || (pRsp[rspLen - 2] != 0x90) || (pRsp[rspLen - 1] != 0x00)) {
+        METRICS_ADD32(&pCmd->errors, 1);
+    }
+    METRICS_ADD64(&pCmd->txBytes, txLen);
+    METRICS_ADD64(&pCmd->rxBytes, (pRsp != NULL) ? rspLen : 0);
+    METRICS_ADD64(&pCmd->sumUs[SM_METRICS_PHASE_TOTAL], us);
+    METRICS_ADD32(&pCmd->hist[metrics_bucket(us)], 1);
+    maxUs = METRICS_LOAD32(&pCmd->maxUs);
+#if defined(__GNUC__)
+    while ((us > maxUs) &&
+           !__atomic_compare_exchange_n(&pCmd->maxUs, &maxUs, us, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+#else
+    if (us > maxUs) {
+        pCmd->maxUs = us;
+    }
+#endif
+}
+
+void sm_metrics_event(smMetricsEvent_t event)
+{
+    if (event < SM_METRICS_EV_COUNT) {
+        METRICS_ADD32(&gMetrics.events[event], 1);
+    }
+}
+
+void sm_metrics_link_begin(const uint8_t *pHdr)
+{
+    gLinkKey = (pHdr != NULL) ? metrics_key(pHdr) : 0;
+}
+
+void sm_metrics_link_end(void)
+{
+    gLinkKey = 0;
+}
+
+void sm_metrics_snapshot(smMetrics_t *pMetrics)
+{
+    if (pMetrics != NULL) {
+        memcpy(pMetrics, &gMetrics, sizeof(*pMetrics));
+    }
+}
+
+void sm_metrics_reset(void)
+{
+    memset(&gMetrics, 0, sizeof(gMetrics));
+}
+
+/* Output buffer that keeps counting once full */
+typedef struct
+{
+    char *buf;
+    size_t size;
+    size_t len;
+} metrics_out_t;
+
+static void metrics_printf(metrics_out_t *pOut, const char *fmt, ...)
+{
+    va_list args;
+    int n;
+    size_t room = (pOut->len < pOut->size) ? (pOut->size - pOut->len) : 0;
+
+    va_start(args, fmt);
+    n = vsnprintf((room > 0) ? (pOut->buf + pOut->len) : NULL, room, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        pOut->len += (size_t)n;
+    }
+}
+
+static void metrics_prom_hist(metrics_out_t *pOut, const char *name, const char *labels, const uint32_t *hist)
+{
+    uint64_t cumulative = 0;
+    uint32_t last       = 0;
+    uint32_t i;
+    const char *sep = (labels[0] != '\0') ? "," : "";
+
+    for (i = 0; i < SM_METRICS_BUCKETS; i++) {
+        if (hist[i] != 0) {
+            last = i + 1;
+        }
+    }
+    for (i = 0; i < last && i < SM_METRICS_BUCKETS - 1; i++) {
+        cumulative += hist[i];
+        /* le is inclusive, the bucket ends just below the next lower bound */
+        metrics_printf(pOut,
+            "%s_bucket{%s%sle=\"%lu\"} %llu\n",
+            name,
+            labels,
+            sep,
+            (unsigned long)(sm_metrics_bucket_low_us(i + 1) - 1),
+            (unsigned long long)cumulative);
+    }
+    for (; i < SM_METRICS_BUCKETS; i++) {
+        cumulative += hist[i];
+    }
+    metrics_printf(pOut, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep, (unsigned long long)cumulative);
+    metrics_printf(pOut, "%s_count{%s} %llu\n", name, labels, (unsigned long long)cumulative);
+}
+
+static void metrics_json_hist(metrics_out_t *pOut, const uint32_t *hist)
+{
+    uint32_t i;
+    int first = 1;
+
+    metrics_printf(pOut, "[");
+    for (i = 0; i < SM_METRICS_BUCKETS; i++) {
+        if (hist[i] != 0) {
+            metrics_printf(pOut,
+                "%s[%lu,%lu]",
+                first ? "" : ",",
+                (unsigned long)sm_metrics_bucket_low_us(i),
+                (unsigned long)hist[i]);
+            first = 0;
+        }
+    }
+    metrics_printf(pOut, "]");
+}
+
+/* Families with one sample (set) per command, in the order they are exported */
+typedef enum
+{
+    METRICS_PROM_APDUS,
+    METRICS_PROM_ERRORS,
+    METRICS_PROM_TX_BYTES,
+    METRICS_PROM_RX_BYTES,
+    METRICS_PROM_PHASES,
+    METRICS_PROM_MAX,
+    METRICS_PROM_LATENCY,
+    METRICS_PROM_CMD_FAMILIES,
+} metrics_prom_family_t;
+
+static const char *const gCmdFamilies[METRICS_PROM_CMD_FAMILIES][3] = {
+    {"se05x_apdu_total", "counter", "APDUs sent, per command"},
+    {"se05x_apdu_errors_total", "counter", "APDUs without a 9000 response, per command"},
+    {"se05x_apdu_tx_bytes_total", "counter", "Bytes sent, per command"},
+    {"se05x_apdu_rx_bytes_total", "counter", "Bytes received, per command"},
+    {"se05x_apdu_phase_microseconds_total", "counter", "Time spent in each phase, per command"},
+    {"se05x_apdu_max_microseconds", "gauge", "Slowest APDU, per command"},
+    {"se05x_apdu_latency_microseconds", "histogram", "APDU latency, per command"},
+};
+
+/* Prometheus wants all samples of a family right after its HELP and TYPE */
+static void metrics_prom_family(metrics_out_t *pOut, const char *name, const char *type, const char *help)
+{
+    metrics_printf(pOut, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void metrics_prom_cmd(
+    metrics_out_t *pOut, metrics_prom_family_t family, const smMetricsCmd_t *pCmd, const char *labels)
+{
+    const char *name = gCmdFamilies[family][0];
+    int phase;
+
+    switch (family) {
+    case METRICS_PROM_APDUS:
+        metrics_printf(pOut, "%s{%s} %lu\n", name, labels, (unsigned long)pCmd->count);
+        break;
+    case METRICS_PROM_ERRORS:
+        metrics_printf(pOut, "%s{%s} %lu\n", name, labels, (unsigned long)pCmd->errors);
+        break;
+    case METRICS_PROM_TX_BYTES:
+        metrics_printf(pOut, "%s{%s} %llu\n", name, labels, (unsigned long long)pCmd->txBytes);
+        break;
+    case METRICS_PROM_RX_BYTES:
+        metrics_printf(pOut, "%s{%s} %llu\n", name, labels, (unsigned long long)pCmd->rxBytes);
+        break;
+    case METRICS_PROM_PHASES:
+        for (phase = 0; phase < SM_METRICS_PHASE_COUNT; phase++) {
+            metrics_printf(pOut,
+                "%s{%s,phase=\"%s\"} %llu\n",
+                name,
+                labels,
+                gPhaseNames[phase],
+                (unsigned long long)pCmd->sumUs[phase]);
+        }
+        break;
+    case METRICS_PROM_MAX:
+        metrics_printf(pOut, "%s{%s} %lu\n", name, labels, (unsigned long)pCmd->maxUs);
+        break;
+    default:
+        metrics_printf(
+            pOut, "%s_sum{%s} %llu\n", name, labels, (unsigned long long)pCmd->sumUs[SM_METRICS_PHASE_TOTAL]);
+        metrics_prom_hist(pOut, name, labels, pCmd->hist);
+        break;
+    }
+}
+
+static void metrics_export_prometheus(metrics_out_t *pOut, const smMetrics_t *pM)
+{
+    char labels[64];
+    size_t i;
+    int family;
+    int phase;
+
+    for (family = 0; family < METRICS_PROM_CMD_FAMILIES; family++) {
+        metrics_prom_family(pOut, gCmdFamilies[family][0], gCmdFamilies[family][1], gCmdFamilies[family][2]);
+        for (i = 0; i < SM_METRICS_MAX_CMDS; i++) {
+            const smMetricsCmd_t *pCmd = &pM->cmd[i];
+            if (pCmd->key == 0) {
+                continue;
+            }
+            snprintf(labels,
+                sizeof(labels),
+                "ins=\"0x%02X\",p1=\"0x%02X\",p2=\"0x%02X\"",
+                (unsigned int)((pCmd->key >> 16) & 0xFF),
+                (unsigned int)((pCmd->key >> 8) & 0xFF),
+                (unsigned int)(pCmd->key & 0xFF));
+            metrics_prom_cmd(pOut, (metrics_prom_family_t)family, pCmd, labels);
+        }
+    }
+
+    metrics_prom_family(
+        pOut, "se05x_apdu_untracked_total", "counter", "APDUs not counted per command, all slots were taken");
+    metrics_printf(pOut, "se05x_apdu_untracked_total %lu\n", (unsigned long)pM->cmdOverflow);
+
+    metrics_prom_family(pOut, "se05x_phase_latency_microseconds", "histogram", "Latency of each phase, all commands");
+    for (phase = 0; phase < SM_METRICS_PHASE_COUNT; phase++) {
+        snprintf(labels, sizeof(labels), "phase=\"%s\"", gPhaseNames[phase]);
+        metrics_printf(pOut,
+            "se05x_phase_latency_microseconds_sum{%s} %llu\n",
+            labels,
+            (unsigned long long)pM->phaseSumUs[phase]);
+        metrics_prom_hist(pOut, "se05x_phase_latency_microseconds", labels, pM->phaseHist[phase]);
+    }
+
+    metrics_prom_family(pOut, "se05x_link_events_total", "counter", "T=1oI2C link events");
+    for (i = 0; i < SM_METRICS_EV_COUNT; i++) {
+        metrics_printf(
+            pOut, "se05x_link_events_total{event=\"%s\"} %lu\n", gEventNames[i], (unsigned long)pM->events[i]);
+    }
+}
+
+static void metrics_export_json(metrics_out_t *pOut, const smMetrics_t *pM)
+{
+    size_t i;
+    int phase;
+    int first = 1;
+
+    metrics_printf(pOut, "{\"apdus\":[");
+    for (i = 0; i < SM_METRICS_MAX_CMDS; i++) {
+        const smMetricsCmd_t *pCmd = &pM->cmd[i];
+        if (pCmd->key == 0) {
+            continue;
+        }
+        metrics_printf(pOut,
+            "%s{\"ins\":%u,\"p1\":%u,\"p2\":%u,\"count\":%lu,\"errors\":%lu,"
+            "\"tx_bytes\":%llu,\"rx_bytes\":%llu,\"max_us\":%lu,\"sum_us\":{",
+            first ? "" : ",",
+            (unsigned int)((pCmd->key >> 16) & 0xFF),
+            (unsigned int)((pCmd->key >> 8) & 0xFF),
+            (unsigned int)(pCmd->key & 0xFF),
+            (unsigned long)pCmd->count,
+            (unsigned long)pCmd->errors,
+            (unsigned long long)pCmd->txBytes,
+            (unsigned long long)pCmd->rxBytes,
+            (unsigned long)pCmd->maxUs);
+        for (phase = 0; phase < SM_METRICS_PHASE_COUNT; phase++) {
+            metrics_printf(pOut,
+                "%s\"%s\":%llu",
+                (phase == 0) ? "" : ",",
+                gPhaseNames[phase],
+                (unsigned long long)pCmd->sumUs[phase]);
+        }
+        metrics_printf(pOut, "},\"hist\":");
+        metrics_json_hist(pOut, pCmd->hist);
+        metrics_printf(pOut, "}");
+        first = 0;
+    }
+    metrics_printf(pOut, "],\"untracked\":%lu,\"phases\":{", (unsigned long)pM->cmdOverflow);
+    for (phase = 0; phase < SM_METRICS_PHASE_COUNT; phase++) {
+        metrics_printf(pOut, "%s\"%s\":", (phase == 0) ? "" : ",", gPhaseNames[phase]);
+        metrics_json_hist(pOut, pM->phaseHist[phase]);
+    }
+    metrics_printf(pOut, "},\"events\":{");
+    for (i = 0; i < SM_METRICS_EV_COUNT; i++) {
+        metrics_printf(
+            pOut, "%s\"%s\":%lu", (i == 0) ? "" : ",", gEventNames[i], (unsigned long)pM->events[i]);
+    }
+    metrics_printf(pOut, "}}\n");
+}
+
+U16 sm_metrics_export(smMetricsFormat_t format, char *buf, size_t *pBufLen)
+{
+    static smMetrics_t snapshot;
+    metrics_out_t out;
+
+    if ((buf == NULL) || (pBufLen == NULL) || (*pBufLen == 0)) {
+        return ERR_API_ERROR;
+    }
+    out.buf  = buf;
+    out.size = *pBufLen;
+    out.len  = 0;
+
+    /* Static to keep the stack small. Exports are expected from one thread. */
+    sm_metrics_snapshot(&snapshot);
+    if (format == SM_METRICS_FORMAT_JSON) {
+        metrics_export_json(&out, &snapshot);
+    }
+    else {
+        metrics_export_prometheus(&out, &snapshot);
+    }
+
+    if (out.len >= out.size) {
+        *pBufLen = out.size - 1;
+        return ERR_BUF_TOO_SMALL;
+    }
+    *pBufLen = out.len;
+    return SW_OK;
+}
+
+#endif /* SM_METRICS */
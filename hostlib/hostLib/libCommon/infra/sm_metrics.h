@@ -0,0 +1,208 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ *
+ * @par Description
+ * APDU metrics: per command counters, latency histograms split in phases
+ * and T=1 protocol events.
+ *
+ * Compiled in with SM_METRICS=1. Updates are atomic adds on statically
+ * allocated counters, there is no lock and no allocation on the APDU
+ * path.
+ *
+ * Commands are keyed by INS, P1 and P2. The CLA is not part of the key,
+ * so that a command has one entry with and without secure messaging.
+ *
+ * The I2C write, SE busy and I2C read phases are recorded per T=1 frame,
+ * the other phases per APDU.
+ *
+ *****************************************************************************/
+
+#ifndef _SM_METRICS_H_
+#define _SM_METRICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sm_types.h"
+#include "sm_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SM_METRICS
+#define SM_METRICS 0
+#endif
+
+/** Distinct INS / P1 / P2 tracked. Further commands are only counted in cmdOverflow */
+#ifndef SM_METRICS_MAX_CMDS
+#define SM_METRICS_MAX_CMDS 32
+#endif
+
+/** Histogram sub buckets per power of two. Bucket width is at most 25% of its value */
+#define SM_METRICS_SUB_BUCKETS 4
+/** Histogram buckets, the last one holds everything from 7 * 2^23 us (~59 s) */
+#define SM_METRICS_BUCKETS 100
+
+typedef enum
+{
+    /** SCP03 / session wrap of the command */
+    SM_METRICS_PHASE_WRAP = 0,
+    /** Writing frames to the SE */
+    SM_METRICS_PHASE_I2C_WRITE,
+    /** Polling until the SE starts to answer */
+    SM_METRICS_PHASE_SE_BUSY,
+    /** Reading frames from the SE */
+    SM_METRICS_PHASE_I2C_READ,
+    /** Waiting before a T=1 retransmission */
+    SM_METRICS_PHASE_T1_RECOVERY,
+    /** SCP03 / session unwrap of the response */
+    SM_METRICS_PHASE_UNWRAP,
+    /** Whole APDU, as seen by the session layer */
+    SM_METRICS_PHASE_TOTAL,
+    SM_METRICS_PHASE_COUNT,
+} smMetricsPhase_t;
+
+typedef enum
+{
+    /** WTX request answered */
+    SM_METRICS_EV_T1_WTX = 0,
+    /** S(RESYNCH) sent */
+    SM_METRICS_EV_T1_RESYNC,
+    /** S(INTF RESET) sent */
+    SM_METRICS_EV_T1_INTF_RESET,
+    /** R(NACK) sent, a frame from the SE was rejected */
+    SM_METRICS_EV_T1_RNACK_TX,
+    /** R(NACK) received, a frame is sent again */
+    SM_METRICS_EV_T1_RNACK_RX,
+    /** I-frames sent */
+    SM_METRICS_EV_T1_IFRAME_TX,
+    /** Frames from the SE with a bad CRC / LRC */
+    SM_METRICS_EV_T1_CRC_ERROR,
+    /** No frame read from the SE */
+    SM_METRICS_EV_T1_NO_FRAME,
+    /** Frames sent again, or R(NACK)ed, by the error recovery */
+    SM_METRICS_EV_T1_RECOVERY,
+    /** Error recovery gave up, the exchange failed */
+    SM_METRICS_EV_T1_RECOVERY_FAILED,
+    /** Failed I2C writes */
+    SM_METRICS_EV_I2C_WRITE_ERROR,
+    /** Frames longer than the NAD probe, the rest needed another I2C read */
+    SM_METRICS_EV_I2C_READ_TAIL,
+    SM_METRICS_EV_COUNT,
+} smMetricsEvent_t;
+
+typedef enum
+{
+    /** Prometheus text exposition format */
+    SM_METRICS_FORMAT_PROMETHEUS = 0,
+    /** JSON */
+    SM_METRICS_FORMAT_JSON,
+} smMetricsFormat_t;
+
+typedef struct
+{
+    /** 0x01000000 | INS << 16 | P1 << 8 | P2, 0 if the entry is free */
+    uint32_t key;
+    /** APDUs */
+    uint32_t count;
+    /** APDUs that failed or did not end with 0x9000 */
+    uint32_t errors;
+    /** Command bytes sent, after wrap */
+    uint64_t txBytes;
+    /** Response bytes, after unwrap */
+    uint64_t rxBytes;
+    /** Time per phase */
+    uint64_t sumUs[SM_METRICS_PHASE_COUNT];
+    /** Slowest APDU */
+    uint32_t maxUs;
+    /** Histogram of SM_METRICS_PHASE_TOTAL */
+    uint32_t hist[SM_METRICS_BUCKETS];
+} smMetricsCmd_t;
+
+typedef struct
+{
+    smMetricsCmd_t cmd[SM_METRICS_MAX_CMDS];
+    /** APDUs not tracked because cmd[] was full */
+    uint32_t cmdOverflow;
+    /** Histogram per phase, over all commands */
+    uint32_t phaseHist[SM_METRICS_PHASE_COUNT][SM_METRICS_BUCKETS];
+    /** Time per phase, over all commands */
+    uint64_t phaseSumUs[SM_METRICS_PHASE_COUNT];
+    uint32_t events[SM_METRICS_EV_COUNT];
+} smMetrics_t;
+
+#if SM_METRICS
+
+/** Record ``phase`` as lasting from ``startUs`` until now.
+ *
+ * @param pHdr CLA INS P1 P2 of the command. NULL to use the command on
+ *             the link, see sm_metrics_link_begin().
+ */
+void sm_metrics_phase(smMetricsPhase_t phase, const uint8_t *pHdr, uint64_t startUs);
+
+/** Record a finished APDU, started at ``startUs``.
+ *
+ * @param pRsp Response including the status word, NULL if the APDU failed
+ */
+void sm_metrics_apdu(const uint8_t *pHdr, uint64_t startUs, size_t txLen, const uint8_t *pRsp, size_t rspLen);
+
+/** Count a protocol event */
+void sm_metrics_event(smMetricsEvent_t event);
+
+/** Set / clear the command being exchanged on the link.
+ *
+ * Called with the smCom lock held, so the T=1 and I2C layers can record
+ * their phases for that command.
+ */
+void sm_metrics_link_begin(const uint8_t *pHdr);
+void sm_metrics_link_end(void);
+
+/** Copy all counters. Taken without a lock, counters of an APDU in
+ * progress may be partly updated. */
+void sm_metrics_snapshot(smMetrics_t *pMetrics);
+
+/** Clear all counters */
+void sm_metrics_reset(void);
+
+/** Lower bound, in micro seconds, of histogram bucket ``bucket`` */
+uint32_t sm_metrics_bucket_low_us(uint32_t bucket);
+
+/** Write a snapshot as text.
+ *
+ * @param[out] buf         Output, nul terminated
+ * @param[in,out] pBufLen  IN: size of buf, OUT: length of the text
+ *
+ * @return SW_OK, or ERR_BUF_TOO_SMALL with the text truncated
+ */
+U16 sm_metrics_export(smMetricsFormat_t format, char *buf, size_t *pBufLen);
+
+/* Hooks for the APDU path, nothing is left of them with SM_METRICS=0 */
+#define SM_METRICS_START(T) uint64_t T = sm_get_time_us()
+#define SM_METRICS_RESTART(T) (T) = sm_get_time_us()
+#define SM_METRICS_PHASE(PHASE, HDR, T) sm_metrics_phase((PHASE), (HDR), (T))
+#define SM_METRICS_APDU(HDR, T, TXLEN, RSP, RSPLEN) sm_metrics_apdu((HDR), (T), (TXLEN), (RSP), (RSPLEN))
+#define SM_METRICS_EVENT(EV) sm_metrics_event(EV)
+#define SM_METRICS_LINK_BEGIN(HDR) sm_metrics_link_begin(HDR)
+#define SM_METRICS_LINK_END() sm_metrics_link_end()
+
+#else
+
+#define SM_METRICS_START(T)
+#define SM_METRICS_RESTART(T)
+#define SM_METRICS_PHASE(PHASE, HDR, T)
+#define SM_METRICS_APDU(HDR, T, TXLEN, RSP, RSPLEN)
+#define SM_METRICS_EVENT(EV)
+#define SM_METRICS_LINK_BEGIN(HDR)
+#define SM_METRICS_LINK_END()
+
+#endif /* SM_METRICS */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _SM_METRICS_H_ */
@@ -0,0 +1,254 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * sm_metrics_export() of a few APDUs, phases and T=1 events. The
+ * Prometheus text is parsed line by line:
+ * - every family starts with # HELP then # TYPE, and is not seen again
+ *   once the next family started
+ * - every sample belongs to the family it is in (_bucket, _sum and _count
+ *   for histograms), and every family has samples
+ * - histogram buckets are cumulative and _count is the +Inf bucket
+ * - the counters are the ones recorded
+ * and a buffer that is too small gives ERR_BUF_TOO_SMALL.
+ */
+
+#include <sm_metrics.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FAMILIES 10
+#define TEST_NAME_LEN 64
+#define TEST_LABELS_LEN 128
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return 1;                                       \
+    }
+
+static char gText[64 * 1024];
+
+/* Parser state */
+static char gFamilies[TEST_FAMILIES][TEST_NAME_LEN];
+static size_t gSamples[TEST_FAMILIES];
+static int gFamilyCount;
+static int gHistogram;
+static int gTypeSeen;
+/* Labels (without le) of the buckets being read, and the last bucket */
+static char gHistLabels[TEST_LABELS_LEN];
+static unsigned long long gHistLast;
+static int gHistInf;
+
+static const uint8_t gHdrA[] = {0x80, 0x01, 0x02, 0x03};
+static const uint8_t gHdrB[] = {0x80, 0x02, 0x00, 0x00};
+static const uint8_t gOk[]   = {0x01, 0x02, 0x90, 0x00};
+static const uint8_t gErr[]  = {0x6A, 0x80};
+
+/* An APDU of hdr that took about latencyUs */
+static void record_apdu(const uint8_t *hdr, uint32_t latencyUs, const uint8_t *pRsp, size_t rspLen)
+{
+    sm_metrics_apdu(hdr, sm_get_time_us() - latencyUs, 10, pRsp, rspLen);
+}
+
+static int parse_help(const char *line)
+{
+    char name[TEST_NAME_LEN];
+    int i;
+
+    CHECK(1 == sscanf(line, "# HELP %63s ", name));
+    CHECK(gFamilyCount < TEST_FAMILIES);
+    for (i = 0; i < gFamilyCount; i++) {
+        CHECK(0 != strcmp(gFamilies[i], name));
+    }
+    /* The last histogram of the previous family was complete */
+    CHECK(gHistLabels[0] == '\0');
+    strcpy(gFamilies[gFamilyCount++], name);
+    gTypeSeen = 0;
+    return 0;
+}
+
+static int parse_type(const char *line)
+{
+    char name[TEST_NAME_LEN];
+    char type[16];
+
+    CHECK(gFamilyCount > 0 && !gTypeSeen);
+    CHECK(2 == sscanf(line, "# TYPE %63s %15s", name, type));
+    CHECK(0 == strcmp(name, gFamilies[gFamilyCount - 1]));
+    CHECK(0 == strcmp(type, "counter") || 0 == strcmp(type, "gauge") || 0 == strcmp(type, "histogram"));
+    gHistogram = (0 == strcmp(type, "histogram"));
+    gTypeSeen  = 1;
+    return 0;
+}
+
+static int ends_with(const char *name, size_t nameLen, const char *suffix)
+{
+    size_t suffixLen = strlen(suffix);
+    return nameLen > suffixLen && 0 == memcmp(name + nameLen - suffixLen, suffix, suffixLen);
+}
+
+static int parse_histogram(const char *line, size_t nameLen, const char *family, unsigned long long value)
+{
+    const char *labels = line + nameLen + 1;
+    const char *le     = strstr(line, "le=\"");
+    const char *end    = strchr(line, '}');
+    size_t labelsLen;
+
+    CHECK(line[nameLen] == '{' && end != NULL);
+    if (0 == strncmp(line + strlen(family), "_bucket{", 8)) {
+        CHECK(le != NULL && le < end);
+        labelsLen = (size_t)(le - labels);
+        if (labelsLen > 0) {
+            labelsLen--; /* The comma before le */
+        }
+        CHECK(labelsLen < TEST_LABELS_LEN);
+        if (gHistLabels[0] == '\0') {
+            memcpy(gHistLabels, labels, labelsLen);
+            gHistLabels[labelsLen] = '\0';
+            gHistLast              = 0;
+            gHistInf               = 0;
+        }
+        CHECK(strlen(gHistLabels) == labelsLen && 0 == memcmp(gHistLabels, labels, labelsLen));
+        CHECK(!gHistInf);
+        CHECK(value >= gHistLast);
+        gHistLast = value;
+        gHistInf  = (0 == strncmp(le, "le=\"+Inf\"}", 10));
+    }
+    else if (0 == strncmp(line + strlen(family), "_count{", 7)) {
+        labelsLen = (size_t)(end - labels);
+        CHECK(gHistInf);
+        CHECK(strlen(gHistLabels) == labelsLen && 0 == memcmp(gHistLabels, labels, labelsLen));
+        CHECK(value == gHistLast);
+        gHistLabels[0] = '\0';
+    }
+    else {
+        /* _sum comes before the buckets of its labels */
+        CHECK(0 == strncmp(line + strlen(family), "_sum{", 5));
+        CHECK(gHistLabels[0] == '\0');
+    }
+    return 0;
+}
+
+static int parse_sample(const char *line)
+{
+    const char *family;
+    const char *space;
+    size_t nameLen = strcspn(line, "{ ");
+    unsigned long long value;
+
+    CHECK(gFamilyCount > 0 && gTypeSeen);
+    family = gFamilies[gFamilyCount - 1];
+    space  = strrchr(line, ' ');
+    CHECK(space != NULL && 1 == sscanf(space, " %llu", &value));
+    if (gHistogram) {
+        CHECK(ends_with(line, nameLen, "_bucket") || ends_with(line, nameLen, "_sum") ||
+              ends_with(line, nameLen, "_count"));
+        CHECK(0 == strncmp(line, family, strlen(family)) && line[strlen(family)] == '_');
+        CHECK(0 == parse_histogram(line, nameLen, family, value));
+    }
+    else {
+        CHECK(nameLen == strlen(family) && 0 == strncmp(line, family, nameLen));
+    }
+    gSamples[gFamilyCount - 1]++;
+    return 0;
+}
+
+static int parse_prometheus(char *text)
+{
+    char *line;
+    char *next;
+    int i;
+
+    memset(gSamples, 0, sizeof(gSamples));
+    gFamilyCount   = 0;
+    gTypeSeen      = 0;
+    gHistLabels[0] = '\0';
+    for (line = text; *line != '\0'; line = next) {
+        next = strchr(line, '\n');
+        CHECK(next != NULL);
+        *next++ = '\0';
+        if (0 == strncmp(line, "# HELP ", 7)) {
+            CHECK(0 == parse_help(line));
+        }
+        else if (0 == strncmp(line, "# TYPE ", 7)) {
+            CHECK(0 == parse_type(line));
+        }
+        else {
+            CHECK(line[0] != '#' && line[0] != '\0');
+            CHECK(0 == parse_sample(line));
+        }
+    }
+    CHECK(gHistLabels[0] == '\0');
+    CHECK(gFamilyCount == TEST_FAMILIES);
+    for (i = 0; i < gFamilyCount; i++) {
+        CHECK(gSamples[i] > 0);
+    }
+    return 0;
+}
+
+static int test_prometheus(void)
+{
+    char *copy;
+    size_t len = sizeof(gText);
+    int result;
+
+    CHECK(SW_OK == sm_metrics_export(SM_METRICS_FORMAT_PROMETHEUS, gText, &len));
+    CHECK(len == strlen(gText));
+
+    copy = (char *)malloc(len + 1);
+    CHECK(copy != NULL);
+    memcpy(copy, gText, len + 1);
+    result = parse_prometheus(copy);
+    free(copy);
+    if (result != 0) {
+        printf("%s", gText);
+    }
+    CHECK(result == 0);
+
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_total{ins=\"0x01\",p1=\"0x02\",p2=\"0x03\"} 4\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_total{ins=\"0x02\",p1=\"0x00\",p2=\"0x00\"} 2\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_errors_total{ins=\"0x01\",p1=\"0x02\",p2=\"0x03\"} 1\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_tx_bytes_total{ins=\"0x02\",p1=\"0x00\",p2=\"0x00\"} 20\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_latency_microseconds_count{ins=\"0x01\",p1=\"0x02\",p2=\"0x03\"} 4\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_phase_latency_microseconds_count{phase=\"total\"} 6\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_phase_latency_microseconds_count{phase=\"i2c_write\"} 1\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_link_events_total{event=\"t1_wtx\"} 2\n"));
+    CHECK(NULL != strstr(gText, "\nse05x_apdu_untracked_total 0\n"));
+    return 0;
+}
+
+static int test_buffer_too_small(void)
+{
+    char small[64];
+    size_t len = sizeof(small);
+
+    CHECK(ERR_BUF_TOO_SMALL == sm_metrics_export(SM_METRICS_FORMAT_PROMETHEUS, small, &len));
+    CHECK(len == sizeof(small) - 1 && len == strlen(small));
+    return 0;
+}
+
+int main(void)
+{
+    sm_metrics_reset();
+    record_apdu(gHdrA, 2, gOk, sizeof(gOk));
+    record_apdu(gHdrA, 300, gOk, sizeof(gOk));
+    record_apdu(gHdrA, 5000, gOk, sizeof(gOk));
+    record_apdu(gHdrA, 40, gErr, sizeof(gErr));
+    record_apdu(gHdrB, 70, gOk, sizeof(gOk));
+    record_apdu(gHdrB, 1000, gOk, sizeof(gOk));
+    sm_metrics_phase(SM_METRICS_PHASE_I2C_WRITE, gHdrA, sm_get_time_us() - 100);
+    sm_metrics_event(SM_METRICS_EV_T1_WTX);
+    sm_metrics_event(SM_METRICS_EV_T1_WTX);
+
+    if (test_prometheus() || test_buffer_too_small()) {
+        return 1;
+    }
+    printf("test_sm_metrics: OK\n");
+    return 0;
+}
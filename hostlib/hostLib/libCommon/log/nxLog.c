@@ -11,6 +11,7 @@ extern "C" {
 #include <nxLog.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include "sm_printf.h"
@@ -38,8 +39,19 @@ extern "C" {
 #define szCRLF "\r\n"
 #define szLF "\n"
 
+/* Buffer of one line of nLog, at most NLOG_LINE_SIZE - 2 characters are
+ * printed */
+#define NLOG_LINE_SIZE 256
+
 static void setColor(int level);
 static void reSetColor(void);
+static void nLog_PrintText(const char *comp, int level, const char *text);
+static void nLog_PrintArrayMessage(const char *comp,
+    int level,
+    const char *message,
+    const unsigned char *array,
+    size_t shown_len,
+    size_t array_len);
 
 #if defined(_MSC_VER)
 static HANDLE sStdOutConsoleHandle = INVALID_HANDLE_VALUE;
@@ -151,6 +163,767 @@ static void nLog_ReleaseLock()
 #endif
 }
 
+#if NX_LOG_RUNTIME_LEVEL
+uint8_t gnLogLevel[NX_LOG_COMP_MAX] = {
+    [NX_LOG_COMP_APP]     = NX_LEVEL_DEBUG,
+    [NX_LOG_COMP_HOSTLIB] = NX_LEVEL_DEBUG,
+    [NX_LOG_COMP_MBEDTLS] = NX_LEVEL_DEBUG,
+    [NX_LOG_COMP_SCP]     = NX_LEVEL_DEBUG,
+    [NX_LOG_COMP_SMCOM]   = NX_LEVEL_DEBUG,
+    [NX_LOG_COMP_SSS]     = NX_LEVEL_DEBUG,
+};
+#endif
+
+void nLog_SetLevel(nLog_Comp_t comp, int level)
+{
+#if NX_LOG_RUNTIME_LEVEL
+    int i;
+    if (level < 0) {
+        level = 0;
+    }
+    if (level > NX_LEVEL_DEBUG) {
+        level = NX_LEVEL_DEBUG;
+    }
+    for (i = 0; i < NX_LOG_COMP_MAX; i++) {
+        if (comp == NX_LOG_COMP_MAX || comp == (nLog_Comp_t)i) {
+            gnLogLevel[i] = (uint8_t)level;
+        }
+    }
+#else
+    (void)comp;
+    (void)level;
+#endif
+}
+
+#if NX_LOG_ASYNC
+
+#if !(__GNUC__ && !AX_EMBEDDED)
+#error "NX_LOG_ASYNC needs pthreads"
+#endif
+#if defined(SMCOM_JRCP_V2)
+#error "NX_LOG_ASYNC can not echo the logs over JRCP_V2"
+#endif
+
+#include <stdlib.h>
+#include <time.h>
+
+/* Bytes of the ring of each logging thread, a power of 2 */
+#ifndef NX_LOG_ASYNC_RING_SIZE
+#define NX_LOG_ASYNC_RING_SIZE (16 * 1024)
+#endif
+
+/* Longest array kept by nLog_au8, the rest is shown as " ..." */
+#ifndef NX_LOG_ASYNC_MAX_ARRAY
+#define NX_LOG_ASYNC_MAX_ARRAY (NX_LOG_ASYNC_RING_SIZE / 4)
+#endif
+
+/* Longest %s argument kept. By default as long as a whole line, so that
+ * nothing is cut that the synchronous nLog would print. */
+#ifndef NX_LOG_ASYNC_MAX_STR
+#define NX_LOG_ASYNC_MAX_STR (NLOG_LINE_SIZE - 2)
+#endif
+
+/* Sleep of the writer thread when all rings are empty */
+#ifndef NX_LOG_ASYNC_POLL_US
+#define NX_LOG_ASYNC_POLL_US 2000
+#endif
+
+/* Raw arguments of one nLog call */
+#define NX_LOG_ASYNC_ARGS_SIZE 512
+
+#define NLOG_RING_MASK (NX_LOG_ASYNC_RING_SIZE - 1)
+#define NLOG_ALIGN8(LEN) (((LEN) + 7u) & ~(size_t)7u)
+
+#if (NX_LOG_ASYNC_RING_SIZE & NLOG_RING_MASK) != 0
+#error "NX_LOG_ASYNC_RING_SIZE must be a power of 2"
+#endif
+
+enum
+{
+    NLOG_REC_PAD, /* Skip to the start of the ring */
+    NLOG_REC_LOG, /* nLog: raw arguments of format */
+    NLOG_REC_AU8, /* nLog_au8: the array */
+};
+
+typedef struct
+{
+    uint64_t timeNs;
+    const char *comp;
+    const char *format; /* or message of NLOG_REC_AU8 */
+    uint32_t size;      /* of the record, header included, multiple of 8 */
+    uint32_t dataLen;   /* bytes following the header */
+    uint32_t arrayLen;  /* NLOG_REC_AU8: length logged, can exceed dataLen */
+    uint8_t kind;
+    uint8_t level;
+} nLog_rec_t;
+
+/* Single producer (the owning thread) single consumer (the writer) */
+typedef struct nLog_ring
+{
+    struct nLog_ring *next;
+    uint32_t owned;   /* 1 while a thread logs to it */
+    uint32_t dropped; /* records lost since the last report */
+    uint64_t head;    /* written by the owner */
+    uint64_t tail;    /* written by the writer */
+    uint8_t buf[NX_LOG_ASYNC_RING_SIZE];
+} nLog_ring_t;
+
+static struct
+{
+    nLog_ring_t *rings; /* only grows, rings of exited threads are reused */
+    pthread_t thread;
+    pthread_key_t key;
+    uint8_t keyCreated;
+    uint8_t running;
+    uint8_t stop;
+} gnLogAsync;
+
+/* Serialises starting and stopping the writer */
+static pthread_mutex_t gnLogAsyncLock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread nLog_ring_t *tnLogRing;
+
+static void nLog_AsyncStop(void);
+
+static uint64_t nLog_TimeNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void nLog_SleepUs(uint32_t us)
+{
+    struct timespec ts;
+    ts.tv_sec  = us / 1000000u;
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+/* Reserve size contiguous bytes. NULL if the ring is full. */
+static nLog_rec_t *nLog_RingReserve(nLog_ring_t *ring, size_t size)
+{
+    uint64_t head   = ring->head;
+    uint64_t tail   = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t offset   = (size_t)(head & NLOG_RING_MASK);
+    size_t toEnd    = NX_LOG_ASYNC_RING_SIZE - offset;
+    size_t skip     = (toEnd < size) ? toEnd : 0;
+    nLog_rec_t *pad = (nLog_rec_t *)&ring->buf[offset];
+
+    if (NX_LOG_ASYNC_RING_SIZE - (head - tail) < skip + size) {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    if (skip > 0) {
+        /* Less than a header left is skipped without a pad record */
+        if (skip >= sizeof(nLog_rec_t)) {
+            pad->kind = NLOG_REC_PAD;
+            pad->size = (uint32_t)skip;
+        }
+        __atomic_store_n(&ring->head, head + skip, __ATOMIC_RELEASE);
+        offset = 0;
+    }
+    return (nLog_rec_t *)&ring->buf[offset];
+}
+
+static void nLog_RingCommit(nLog_ring_t *ring, const nLog_rec_t *rec)
+{
+    __atomic_store_n(&ring->head, ring->head + rec->size, __ATOMIC_RELEASE);
+}
+
+/* Oldest record of the ring, NULL if empty */
+static const nLog_rec_t *nLog_RingPeek(nLog_ring_t *ring)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (ring->tail != head) {
+        size_t offset         = (size_t)(ring->tail & NLOG_RING_MASK);
+        size_t toEnd          = NX_LOG_ASYNC_RING_SIZE - offset;
+        const nLog_rec_t *rec = (const nLog_rec_t *)&ring->buf[offset];
+        if (toEnd < sizeof(nLog_rec_t)) {
+            __atomic_store_n(&ring->tail, ring->tail + toEnd, __ATOMIC_RELEASE);
+        }
+        else if (rec->kind == NLOG_REC_PAD) {
+            __atomic_store_n(&ring->tail, ring->tail + rec->size, __ATOMIC_RELEASE);
+        }
+        else {
+            return rec;
+        }
+    }
+    return NULL;
+}
+
+static void nLog_AsyncReleaseRing(void *ring)
+{
+    __atomic_store_n(&((nLog_ring_t *)ring)->owned, 0, __ATOMIC_RELEASE);
+}
+
+static void *nLog_AsyncWriter(void *arg);
+
+static int nLog_AsyncStart(void)
+{
+    int running;
+    pthread_mutex_lock(&gnLogAsyncLock);
+    if (!gnLogAsync.keyCreated) {
+        if (pthread_key_create(&gnLogAsync.key, &nLog_AsyncReleaseRing) == 0) {
+            gnLogAsync.keyCreated = 1;
+            atexit(&nLog_AsyncStop);
+        }
+    }
+    if (gnLogAsync.keyCreated && !__atomic_load_n(&gnLogAsync.running, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&gnLogAsync.stop, 0, __ATOMIC_RELAXED);
+        if (pthread_create(&gnLogAsync.thread, NULL, &nLog_AsyncWriter, NULL) == 0) {
+            __atomic_store_n(&gnLogAsync.running, 1, __ATOMIC_RELEASE);
+        }
+    }
+    running = __atomic_load_n(&gnLogAsync.running, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&gnLogAsyncLock);
+    return running;
+}
+
+static void nLog_AsyncStop(void)
+{
+    pthread_mutex_lock(&gnLogAsyncLock);
+    if (__atomic_load_n(&gnLogAsync.running, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&gnLogAsync.stop, 1, __ATOMIC_RELEASE);
+        pthread_join(gnLogAsync.thread, NULL);
+        __atomic_store_n(&gnLogAsync.running, 0, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&gnLogAsyncLock);
+}
+
+/* Ring of the calling thread. NULL to log synchronously. */
+static nLog_ring_t *nLog_AsyncRing(void)
+{
+    nLog_ring_t *ring = tnLogRing;
+
+    if (!__atomic_load_n(&gnLogAsync.running, __ATOMIC_ACQUIRE) && !nLog_AsyncStart()) {
+        return NULL;
+    }
+    if (ring != NULL) {
+        return ring;
+    }
+    for (ring = __atomic_load_n(&gnLogAsync.rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&ring->owned, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (ring == NULL) {
+        ring = (nLog_ring_t *)calloc(1, sizeof(*ring));
+        if (ring == NULL) {
+            return NULL;
+        }
+        ring->owned = 1;
+        ring->next  = __atomic_load_n(&gnLogAsync.rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(
+            &gnLogAsync.rings, &ring->next, ring, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+    (void)pthread_setspecific(gnLogAsync.key, ring);
+    tnLogRing = ring;
+    return ring;
+}
+
+enum
+{
+    NLOG_LEN_NONE,
+    NLOG_LEN_HH,
+    NLOG_LEN_H,
+    NLOG_LEN_L,
+    NLOG_LEN_LL,
+    NLOG_LEN_J,
+    NLOG_LEN_Z,
+    NLOG_LEN_T,
+    NLOG_LEN_LD,
+};
+
+/* One printf conversion */
+typedef struct
+{
+    size_t len;     /* '%' up to the conversion, both included */
+    uint8_t stars;  /* width / precision taken from the arguments */
+    uint8_t lenMod; /* NLOG_LEN_ */
+    char conv;
+} nLog_spec_t;
+
+static void nLog_ParseSpec(const char *p, nLog_spec_t *spec)
+{
+    const char *start = p++;
+
+    spec->stars  = 0;
+    spec->lenMod = NLOG_LEN_NONE;
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) {
+        p++;
+    }
+    if (*p == '*') {
+        spec->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    switch (*p) {
+    case 'h':
+        p++;
+        spec->lenMod = (*p == 'h') ? NLOG_LEN_HH : NLOG_LEN_H;
+        p += (*p == 'h') ? 1 : 0;
+        break;
+    case 'l':
+        p++;
+        spec->lenMod = (*p == 'l') ? NLOG_LEN_LL : NLOG_LEN_L;
+        p += (*p == 'l') ? 1 : 0;
+        break;
+    case 'j':
+        spec->lenMod = NLOG_LEN_J;
+        p++;
+        break;
+    case 'z':
+        spec->lenMod = NLOG_LEN_Z;
+        p++;
+        break;
+    case 't':
+        spec->lenMod = NLOG_LEN_T;
+        p++;
+        break;
+    case 'L':
+        spec->lenMod = NLOG_LEN_LD;
+        p++;
+        break;
+    default:
+        break;
+    }
+    spec->conv = *p;
+    spec->len  = (size_t)(p - start) + ((*p != '\0') ? 1 : 0);
+}
+
+static uint64_t nLog_ArgSigned(va_list *pArgs, uint8_t lenMod)
+{
+    switch (lenMod) {
+    case NLOG_LEN_L:
+        return (uint64_t)va_arg(*pArgs, long);
+    case NLOG_LEN_LL:
+        return (uint64_t)va_arg(*pArgs, long long);
+    case NLOG_LEN_J:
+        return (uint64_t)va_arg(*pArgs, intmax_t);
+    case NLOG_LEN_Z:
+        return (uint64_t)va_arg(*pArgs, size_t);
+    case NLOG_LEN_T:
+        return (uint64_t)va_arg(*pArgs, ptrdiff_t);
+    default:
+        return (uint64_t)va_arg(*pArgs, int);
+    }
+}
+
+static uint64_t nLog_ArgUnsigned(va_list *pArgs, uint8_t lenMod)
+{
+    switch (lenMod) {
+    case NLOG_LEN_L:
+        return va_arg(*pArgs, unsigned long);
+    case NLOG_LEN_LL:
+        return va_arg(*pArgs, unsigned long long);
+    case NLOG_LEN_J:
+        return va_arg(*pArgs, uintmax_t);
+    case NLOG_LEN_Z:
+        return va_arg(*pArgs, size_t);
+    case NLOG_LEN_T:
+        return (uint64_t)va_arg(*pArgs, ptrdiff_t);
+    default:
+        return va_arg(*pArgs, unsigned int);
+    }
+}
+
+/*
+ * Keep the arguments of format in 8 byte slots, strings as their length
+ * followed by the bytes and a '\0'. Returns 1 for what can not be kept,
+ * which is then formatted by the caller.
+ */
+static int nLog_CaptureArgs(const char *format, va_list *pArgs, uint8_t *out, size_t outSize, size_t *pOutLen)
+{
+    size_t pos    = 0;
+    const char *p = format;
+    nLog_spec_t spec;
+    uint64_t slot;
+    double dbl;
+    uint8_t i;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        nLog_ParseSpec(p, &spec);
+        p += spec.len;
+        if (spec.conv == '%') {
+            continue;
+        }
+        if (pos + 8u * (spec.stars + 1u) > outSize) {
+            return 1;
+        }
+        if (spec.lenMod == NLOG_LEN_LD || (spec.lenMod == NLOG_LEN_L && (spec.conv == 's' || spec.conv == 'c'))) {
+            /* long double, wide characters and strings */
+            return 1;
+        }
+        for (i = 0; i < spec.stars; i++) {
+            slot = (uint64_t)va_arg(*pArgs, int);
+            memcpy(&out[pos], &slot, 8);
+            pos += 8;
+        }
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            slot = nLog_ArgSigned(pArgs, spec.lenMod);
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            slot = nLog_ArgUnsigned(pArgs, spec.lenMod);
+            break;
+        case 'c':
+            slot = (uint64_t)va_arg(*pArgs, int);
+            break;
+        case 'p':
+            slot = (uint64_t)(uintptr_t)va_arg(*pArgs, void *);
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            dbl = va_arg(*pArgs, double);
+            memcpy(&slot, &dbl, 8);
+            break;
+        case 's': {
+            const char *str = va_arg(*pArgs, const char *);
+            size_t len      = 0;
+            if (str == NULL) {
+                str = "(null)";
+            }
+            while (len < NX_LOG_ASYNC_MAX_STR && str[len] != '\0') {
+                len++;
+            }
+            if (pos + 8 + NLOG_ALIGN8(len + 1) > outSize) {
+                return 1;
+            }
+            slot = len;
+            memcpy(&out[pos], &slot, 8);
+            memcpy(&out[pos + 8], str, len);
+            out[pos + 8 + len] = '\0';
+            pos += 8 + NLOG_ALIGN8(len + 1);
+            continue;
+        }
+        default:
+            /* %n, or not a conversion */
+            return 1;
+        }
+        memcpy(&out[pos], &slot, 8);
+        pos += 8;
+    }
+    *pOutLen = pos;
+    return 0;
+}
+
+#define NLOG_SNPRINTF(VALUE)                                                                 \
+    ((spec.stars == 0) ? snprintf(&out[pos], outSize - pos, fmt, VALUE) :                    \
+        (spec.stars == 1) ? snprintf(&out[pos], outSize - pos, fmt, star[0], VALUE) :        \
+                            snprintf(&out[pos], outSize - pos, fmt, star[0], star[1], VALUE))
+
+/* Format what nLog_CaptureArgs() kept */
+static void nLog_FormatArgs(const char *format, const uint8_t *args, size_t argsLen, char *out, size_t outSize)
+{
+    size_t pos    = 0;
+    size_t argPos = 0;
+    const char *p = format;
+    nLog_spec_t spec;
+    char fmt[32];
+    int star[2] = {0, 0};
+    uint64_t slot;
+    double dbl;
+    int n;
+    uint8_t i;
+
+    while (*p != '\0' && pos + 1 < outSize) {
+        const char *next = strchr(p, '%');
+        size_t len       = (next == NULL) ? strlen(p) : (size_t)(next - p);
+        if (len > outSize - 1 - pos) {
+            len = outSize - 1 - pos;
+        }
+        memcpy(&out[pos], p, len);
+        pos += len;
+        if (next == NULL || pos + 1 >= outSize) {
+            break;
+        }
+        p = next;
+        nLog_ParseSpec(p, &spec);
+        if (spec.conv == '%') {
+            out[pos++] = '%';
+            p += spec.len;
+            continue;
+        }
+        if (spec.len >= sizeof(fmt) || argPos + 8u * (spec.stars + 1u) > argsLen) {
+            break;
+        }
+        memcpy(fmt, p, spec.len);
+        fmt[spec.len] = '\0';
+        p += spec.len;
+        for (i = 0; i < spec.stars; i++) {
+            memcpy(&slot, &args[argPos], 8);
+            star[i] = (int)slot;
+            argPos += 8;
+        }
+        memcpy(&slot, &args[argPos], 8);
+        argPos += 8;
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            switch (spec.lenMod) {
+            case NLOG_LEN_L:
+                n = NLOG_SNPRINTF((long)slot);
+                break;
+            case NLOG_LEN_LL:
+                n = NLOG_SNPRINTF((long long)slot);
+                break;
+            case NLOG_LEN_J:
+                n = NLOG_SNPRINTF((intmax_t)slot);
+                break;
+            case NLOG_LEN_Z:
+                n = NLOG_SNPRINTF((size_t)slot);
+                break;
+            case NLOG_LEN_T:
+                n = NLOG_SNPRINTF((ptrdiff_t)slot);
+                break;
+            default:
+                n = NLOG_SNPRINTF((int)slot);
+                break;
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch (spec.lenMod) {
+            case NLOG_LEN_L:
+                n = NLOG_SNPRINTF((unsigned long)slot);
+                break;
+            case NLOG_LEN_LL:
+                n = NLOG_SNPRINTF((unsigned long long)slot);
+                break;
+            case NLOG_LEN_J:
+                n = NLOG_SNPRINTF((uintmax_t)slot);
+                break;
+            case NLOG_LEN_Z:
+                n = NLOG_SNPRINTF((size_t)slot);
+                break;
+            case NLOG_LEN_T:
+                n = NLOG_SNPRINTF((ptrdiff_t)slot);
+                break;
+            default:
+                n = NLOG_SNPRINTF((unsigned int)slot);
+                break;
+            }
+            break;
+        case 'c':
+            n = NLOG_SNPRINTF((int)slot);
+            break;
+        case 'p':
+            n = NLOG_SNPRINTF((void *)(uintptr_t)slot);
+            break;
+        case 's':
+            if (argPos + NLOG_ALIGN8(slot + 1) > argsLen) {
+                n = -1;
+                break;
+            }
+            n = NLOG_SNPRINTF((const char *)&args[argPos]);
+            argPos += NLOG_ALIGN8(slot + 1);
+            break;
+        default:
+            memcpy(&dbl, &slot, 8);
+            n = NLOG_SNPRINTF(dbl);
+            break;
+        }
+        if (n < 0) {
+            break;
+        }
+        pos += ((size_t)n < outSize - 1 - pos) ? (size_t)n : outSize - 1 - pos;
+    }
+    out[pos] = '\0';
+}
+
+/* Queue a record of nLog. 0 if it has to be logged synchronously. */
+static int nLog_AsyncLog(const char *comp, int level, const char *format, va_list vArgs)
+{
+    uint8_t args[NX_LOG_ASYNC_ARGS_SIZE];
+    size_t argsLen    = 0;
+    nLog_ring_t *ring = nLog_AsyncRing();
+    nLog_rec_t *rec;
+    va_list vCopy;
+
+    if (ring == NULL) {
+        return 0;
+    }
+    if (format != NULL && format[0] != '\0') {
+        va_copy(vCopy, vArgs);
+        if (nLog_CaptureArgs(format, &vCopy, args, sizeof(args), &argsLen) != 0) {
+            /* Not kept raw, format it here */
+            uint64_t len = 0;
+            int n        = vsnprintf((char *)&args[8], NLOG_LINE_SIZE - 1, format, vArgs);
+            if (n > 0) {
+                len = ((size_t)n < NLOG_LINE_SIZE - 2) ? (uint64_t)n : NLOG_LINE_SIZE - 2;
+            }
+            args[8 + len] = '\0';
+            memcpy(&args[0], &len, 8);
+            argsLen = 8 + NLOG_ALIGN8(len + 1);
+            format  = "%s";
+        }
+        va_end(vCopy);
+    }
+    rec = nLog_RingReserve(ring, NLOG_ALIGN8(sizeof(*rec) + argsLen));
+    if (rec != NULL) {
+        rec->timeNs   = nLog_TimeNs();
+        rec->comp     = comp;
+        rec->format   = format;
+        rec->size     = (uint32_t)NLOG_ALIGN8(sizeof(*rec) + argsLen);
+        rec->dataLen  = (uint32_t)argsLen;
+        rec->arrayLen = 0;
+        rec->kind     = NLOG_REC_LOG;
+        rec->level    = (uint8_t)level;
+        memcpy(rec + 1, args, argsLen);
+        nLog_RingCommit(ring, rec);
+    }
+    return 1;
+}
+
+/* Queue a record of nLog_au8. 0 if it has to be logged synchronously. */
+static int nLog_AsyncLogArray(
+    const char *comp, int level, const char *message, const unsigned char *array, size_t array_len)
+{
+    size_t kept       = (array == NULL) ? 0 : array_len;
+    nLog_ring_t *ring = nLog_AsyncRing();
+    nLog_rec_t *rec;
+
+    if (ring == NULL) {
+        return 0;
+    }
+    if (kept > NX_LOG_ASYNC_MAX_ARRAY) {
+        kept = NX_LOG_ASYNC_MAX_ARRAY;
+    }
+    rec = nLog_RingReserve(ring, NLOG_ALIGN8(sizeof(*rec) + kept));
+    if (rec != NULL) {
+        rec->timeNs   = nLog_TimeNs();
+        rec->comp     = comp;
+        rec->format   = message;
+        rec->size     = (uint32_t)NLOG_ALIGN8(sizeof(*rec) + kept);
+        rec->dataLen  = (uint32_t)kept;
+        rec->arrayLen = (array_len > UINT32_MAX) ? UINT32_MAX : (uint32_t)array_len;
+        rec->kind     = NLOG_REC_AU8;
+        rec->level    = (uint8_t)level;
+        if (kept > 0) {
+            memcpy(rec + 1, array, kept);
+        }
+        nLog_RingCommit(ring, rec);
+    }
+    return 1;
+}
+
+static void nLog_AsyncPrint(const nLog_rec_t *rec)
+{
+    const uint8_t *data = (const uint8_t *)(rec + 1);
+    char buffer[NLOG_LINE_SIZE];
+
+    nLog_AcquireLock();
+    if (rec->kind == NLOG_REC_AU8) {
+        nLog_PrintArrayMessage(rec->comp, rec->level, rec->format, data, rec->dataLen, rec->arrayLen);
+    }
+    else {
+        buffer[0] = '\0';
+        if (rec->format != NULL) {
+            nLog_FormatArgs(rec->format, data, rec->dataLen, buffer, sizeof(buffer) - 1);
+        }
+        nLog_PrintText(rec->comp, rec->level, buffer);
+    }
+    nLog_ReleaseLock();
+}
+
+/* Print all queued records, oldest first. Returns how many. */
+static size_t nLog_AsyncDrain(void)
+{
+    size_t count = 0;
+    for (;;) {
+        const nLog_rec_t *oldest = NULL;
+        nLog_ring_t *oldestRing  = NULL;
+        nLog_ring_t *ring;
+        for (ring = __atomic_load_n(&gnLogAsync.rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+            const nLog_rec_t *rec = nLog_RingPeek(ring);
+            uint32_t dropped      = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+            if (dropped > 0) {
+                char buffer[48];
+                snprintf(buffer, sizeof(buffer), "%u log records dropped", (unsigned int)dropped);
+                nLog_AcquireLock();
+                nLog_PrintText("nxLog", NX_LEVEL_WARN, buffer);
+                nLog_ReleaseLock();
+            }
+            if (rec != NULL && (oldest == NULL || rec->timeNs < oldest->timeNs)) {
+                oldest     = rec;
+                oldestRing = ring;
+            }
+        }
+        if (oldest == NULL) {
+            break;
+        }
+        nLog_AsyncPrint(oldest);
+        __atomic_store_n(&oldestRing->tail, oldestRing->tail + oldest->size, __ATOMIC_RELEASE);
+        count++;
+    }
+    return count;
+}
+
+static void *nLog_AsyncWriter(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        int stop = __atomic_load_n(&gnLogAsync.stop, __ATOMIC_ACQUIRE);
+        if (nLog_AsyncDrain() > 0) {
+            fflush(stdout);
+        }
+        else if (stop) {
+            break;
+        }
+        else {
+            nLog_SleepUs(NX_LOG_ASYNC_POLL_US);
+        }
+    }
+    return NULL;
+}
+
+#endif /* NX_LOG_ASYNC */
+
+void nLog_Flush(void)
+{
+#if NX_LOG_ASYNC
+    nLog_ring_t *ring;
+    while (__atomic_load_n(&gnLogAsync.running, __ATOMIC_ACQUIRE)) {
+        for (ring = __atomic_load_n(&gnLogAsync.rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+            if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+        }
+        if (ring == NULL) {
+            break;
+        }
+        nLog_SleepUs(NX_LOG_ASYNC_POLL_US / 4);
+    }
+#endif
+}
+
 uint8_t nLog_Init()
 {
 #if USE_LOCK
@@ -173,6 +946,9 @@ uint8_t nLog_Init()
 
 void nLog_DeInit()
 {
+#if NX_LOG_ASYNC
+    nLog_AsyncStop();
+#endif
 #if USE_LOCK
 #if defined(USE_RTOS) && (USE_RTOS == 1)
     if (gLogginglock != NULL) {
@@ -189,77 +965,121 @@ void nLog_DeInit()
 /* Used for scenarios other than LPC55S_NS */
 void nLog(const char *comp, int level, const char *format, ...)
 {
-    nLog_AcquireLock();
     if (level > (int)(sizeof(szLevel) / sizeof(char*))) {
         return;
     }
-    setColor(level);
-    if (level >= 1) {
-        PRINTF("%-6s:%s:", comp, szLevel[level-1]);
-    }
-    if (format == NULL) {
-        /* Nothing */
-#ifdef SMCOM_JRCP_V2
-        smCom_Echo(NULL, comp, szLevel[level-1], "");
-#endif // SMCOM_JRCP_V2
+#if NX_LOG_ASYNC
+    {
+        int queued;
+        va_list vArgs;
+        va_start(vArgs, format);
+        queued = nLog_AsyncLog(comp, level, format, vArgs);
+        va_end(vArgs);
+        if (queued) {
+            return;
+        }
     }
-    else if (format[0] == '\0') {
-        /* Nothing */
+#endif
+    nLog_AcquireLock();
+    if (format == NULL || format[0] == '\0') {
+        nLog_PrintText(comp, level, "");
 #ifdef SMCOM_JRCP_V2
         smCom_Echo(NULL, comp, szLevel[level-1], "");
 #endif // SMCOM_JRCP_V2
     }
     else {
-        char buffer[256];
+        char buffer[NLOG_LINE_SIZE];
         size_t size_buff = sizeof(buffer) / sizeof(buffer[0]) - 1;
         va_list vArgs;
         va_start(vArgs, format);
         vsnprintf(buffer, size_buff, format, vArgs);
         va_end(vArgs);
-        PRINTF("%s", buffer);
+        nLog_PrintText(comp, level, buffer);
 #ifdef SMCOM_JRCP_V2
         smCom_Echo(NULL, comp, szLevel[level-1], buffer);
 #endif // SMCOM_JRCP_V2
     }
-    reSetColor();
-    PRINTF(szEOL);
     nLog_ReleaseLock();
 }
 
 void nLog_au8(const char *comp, int level, const char *message, const unsigned char *array, size_t array_len)
 {
-    size_t i;
-    nLog_AcquireLock();
     if (level > (int)(sizeof(szLevel) / sizeof(char*))) {
         return;
     }
+#if NX_LOG_ASYNC
+    if (nLog_AsyncLogArray(comp, level, message, array, array_len)) {
+        return;
+    }
+#endif
+    nLog_AcquireLock();
+    nLog_PrintArrayMessage(comp, level, message, array, array_len, array_len);
+    nLog_ReleaseLock();
+}
+
+/* One line, with the lock held */
+static void nLog_PrintText(const char *comp, int level, const char *text)
+{
+    setColor(level);
+    if (level >= 1) {
+        PRINTF("%-6s:%s:", comp, szLevel[level-1]);
+    }
+    PRINTF("%s", text);
+    reSetColor();
+    PRINTF(szEOL);
+}
+
+#define NLOG_APPEND(LINE, POS, SZ) (memcpy(&(LINE)[POS], SZ, sizeof(SZ) - 1), (POS) + sizeof(SZ) - 1)
+
+/* Header and hex dump of nLog_au8, one PRINTF per line, with the lock held */
+static void nLog_PrintArrayMessage(const char *comp,
+    int level,
+    const char *message,
+    const unsigned char *array,
+    size_t shown_len,
+    size_t array_len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char line[sizeof(szEOL) + sizeof("=>") + 5 * sizeof(TAB_SEPRATOR) + 16 * 3];
+    size_t pos = 0;
+    size_t i;
+
     setColor(level);
     if (level >= 1) {
         PRINTF("%-6s:%s:%s (Len=%" PRId32 ")", comp, szLevel[level-1], message, (int32_t)array_len);
     }
-    for (i = 0; i < array_len; i++) {
+    for (i = 0; i < shown_len; i++) {
         if (0 == (i % 16)) {
-            PRINTF(szEOL);
-            if (0 == i) {
-#if COMPRESSED_LOGGING_STYLE
-                PRINTF("=>");
-#endif
-                PRINTF(TAB_SEPRATOR);
+            if (pos > 0) {
+                line[pos] = '\0';
+                PRINTF("%s", line);
             }
-            else {
-                PRINTF(TAB_SEPRATOR);
+            pos = NLOG_APPEND(line, 0, szEOL);
+#if COMPRESSED_LOGGING_STYLE
+            if (0 == i) {
+                pos = NLOG_APPEND(line, pos, "=>");
             }
+#endif
+            pos = NLOG_APPEND(line, pos, TAB_SEPRATOR);
         }
 #if !COMPRESSED_LOGGING_STYLE
         if (0 == (i % 4)) {
-            PRINTF(TAB_SEPRATOR);
+            pos = NLOG_APPEND(line, pos, TAB_SEPRATOR);
         }
 #endif
-        PRINTF("%02X ", array[i]);
+        line[pos++] = hex[array[i] >> 4];
+        line[pos++] = hex[array[i] & 0x0F];
+        line[pos++] = ' ';
+    }
+    if (pos > 0) {
+        line[pos] = '\0';
+        PRINTF("%s", line);
+    }
+    if (shown_len < array_len) {
+        PRINTF(" ...");
     }
     reSetColor();
     PRINTF(szEOL);
-    nLog_ReleaseLock();
 }
 
 static void setColor(int level)
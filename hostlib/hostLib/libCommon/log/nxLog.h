@@ -72,6 +72,32 @@ extern "C" {
  *  Do not take loging level information at run time, but at compile time.
  *  This enables to reduce the code size.
  *
+ *  On top of that, what is compiled in can be lowered at run time per
+ *  component with nLog_SetLevel(), at the cost of one compare per log
+ *  call. Set NX_LOG_RUNTIME_LEVEL to 0 to drop that.
+ *
+ *
+ *  Asynchronous logging
+ *  ===========================================================================
+ *
+ *  With NX_LOG_ASYNC set to 1 (Linux / pthreads only), nLog and nLog_au8
+ *  do not format nor print. Each logging thread appends a binary record
+ *  (time, component, level, format pointer and raw arguments, or the raw
+ *  array) to its own lock free ring, and a writer thread formats and
+ *  prints them in time order. Each line is the same as the synchronous
+ *  one, it is only printed later than it would have been. %s arguments
+ *  are copied. Arguments that can not be kept raw (long double, wide
+ *  characters, more than fit a record) are formatted by the logging
+ *  thread.
+ *
+ *  Except:
+ *      - nLog_au8 keeps at most NX_LOG_ASYNC_MAX_ARRAY bytes of the
+ *        array, the rest is shown as " ...".
+ *      - A full ring drops records, and the writer reports how many.
+ *
+ *  Component names, formats and messages have to be string literals, as
+ *  only their pointers are kept. Records still queued are printed by
+ *  nLog_Flush(), nLog_DeInit() and at exit, but not on a crash.
  *
  **/
 
@@ -88,6 +114,34 @@ extern "C" {
 #define NX_LOG_W
 #define NX_LOG_E
 
+#ifndef NX_LOG_RUNTIME_LEVEL
+#define NX_LOG_RUNTIME_LEVEL 1
+#endif
+
+#ifndef NX_LOG_ASYNC
+#define NX_LOG_ASYNC 0
+#endif
+
+/* Components of the run time level filter */
+typedef enum
+{
+    NX_LOG_COMP_APP,
+    NX_LOG_COMP_HOSTLIB,
+    NX_LOG_COMP_MBEDTLS,
+    NX_LOG_COMP_SCP,
+    NX_LOG_COMP_SMCOM,
+    NX_LOG_COMP_SSS,
+    NX_LOG_COMP_MAX,
+} nLog_Comp_t;
+
+#if NX_LOG_RUNTIME_LEVEL
+/* Highest level printed per component, see nLog_SetLevel() */
+extern uint8_t gnLogLevel[NX_LOG_COMP_MAX];
+#define NX_LOG_IF(COMP, LEVEL, CALL) ((gnLogLevel[NX_LOG_COMP_##COMP] >= (LEVEL)) ? (CALL) : (void)0)
+#else
+#define NX_LOG_IF(COMP, LEVEL, CALL) (CALL)
+#endif
+
 /*
  * Initialised the multithreading locks if running on Native or FreeRtos.
  * If running on system where mutex or semaphore is not available, return
@@ -100,6 +154,19 @@ void nLog(const char *comp, int level, const char *format, ...);
 
 void nLog_au8(const char *comp, int level, const char *message, const unsigned char *array, size_t array_len);
 
+/*
+ * Only print up to level for the component, NX_LEVEL_ERROR .. NX_LEVEL_DEBUG,
+ * or 0 for nothing. NX_LOG_COMP_MAX sets all components. What is not
+ * compiled in can not be enabled here.
+ */
+void nLog_SetLevel(nLog_Comp_t comp, int level);
+
+/*
+ * Wait until the asynchronous writer has printed all records logged so
+ * far. Does nothing without NX_LOG_ASYNC.
+ */
+void nLog_Flush(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,23 +49,23 @@
 #if NX_LOG_ENABLE_MBEDTLS_DEBUG
 #   define LOG_DEBUG_ENABLED 1
 #   define LOG_D(format, ...) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, format, ##__VA_ARGS__)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, format, ##__VA_ARGS__))
 #   define LOG_X8_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%02X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%02X",#VALUE, VALUE))
 #   define LOG_U8_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE))
 #   define LOG_X16_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%04X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%04X",#VALUE, VALUE))
 #   define LOG_U16_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE))
 #   define LOG_X32_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%08X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=0x%08X",#VALUE, VALUE))
 #   define LOG_U32_D(VALUE) \
-        nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog("mbedtls", NX_LEVEL_DEBUG, "%s=%u",#VALUE, VALUE))
 #   define LOG_AU8_D(ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_DEBUG, #ARRAY, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog_au8("mbedtls", NX_LEVEL_DEBUG, #ARRAY, ARRAY, LEN))
 #   define LOG_MAU8_D(MESSAGE, ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_DEBUG, MESSAGE, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_DEBUG, nLog_au8("mbedtls", NX_LEVEL_DEBUG, MESSAGE, ARRAY, LEN))
 #else
 #   define LOG_DEBUG_ENABLED 0
 #   define LOG_D(...)
@@ -82,23 +82,23 @@
 #if NX_LOG_ENABLE_MBEDTLS_INFO
 #   define LOG_INFO_ENABLED 1
 #   define LOG_I(format, ...) \
-        nLog("mbedtls", NX_LEVEL_INFO, format, ##__VA_ARGS__)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, format, ##__VA_ARGS__))
 #   define LOG_X8_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%02X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%02X",#VALUE, VALUE))
 #   define LOG_U8_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE))
 #   define LOG_X16_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%04X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%04X",#VALUE, VALUE))
 #   define LOG_U16_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE))
 #   define LOG_X32_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%08X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=0x%08X",#VALUE, VALUE))
 #   define LOG_U32_I(VALUE) \
-        nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog("mbedtls", NX_LEVEL_INFO, "%s=%u",#VALUE, VALUE))
 #   define LOG_AU8_I(ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_INFO, #ARRAY, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog_au8("mbedtls", NX_LEVEL_INFO, #ARRAY, ARRAY, LEN))
 #   define LOG_MAU8_I(MESSAGE, ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_INFO, MESSAGE, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_INFO, nLog_au8("mbedtls", NX_LEVEL_INFO, MESSAGE, ARRAY, LEN))
 #else
 #   define LOG_INFO_ENABLED 0
 #   define LOG_I(...)
@@ -115,23 +115,23 @@
 #if NX_LOG_ENABLE_MBEDTLS_WARN
 #   define LOG_WARN_ENABLED 1
 #   define LOG_W(format, ...) \
-        nLog("mbedtls", NX_LEVEL_WARN, format, ##__VA_ARGS__)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, format, ##__VA_ARGS__))
 #   define LOG_X8_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%02X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%02X",#VALUE, VALUE))
 #   define LOG_U8_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE))
 #   define LOG_X16_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%04X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%04X",#VALUE, VALUE))
 #   define LOG_U16_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE))
 #   define LOG_X32_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%08X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=0x%08X",#VALUE, VALUE))
 #   define LOG_U32_W(VALUE) \
-        nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog("mbedtls", NX_LEVEL_WARN, "%s=%u",#VALUE, VALUE))
 #   define LOG_AU8_W(ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_WARN, #ARRAY, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog_au8("mbedtls", NX_LEVEL_WARN, #ARRAY, ARRAY, LEN))
 #   define LOG_MAU8_W(MESSAGE, ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_WARN, MESSAGE, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_WARN, nLog_au8("mbedtls", NX_LEVEL_WARN, MESSAGE, ARRAY, LEN))
 #else
 #   define LOG_WARN_ENABLED 0
 #   define LOG_W(...)
@@ -148,23 +148,23 @@
 #if NX_LOG_ENABLE_MBEDTLS_ERROR
 #   define LOG_ERROR_ENABLED 1
 #   define LOG_E(format, ...) \
-        nLog("mbedtls", NX_LEVEL_ERROR, format, ##__VA_ARGS__)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, format, ##__VA_ARGS__))
 #   define LOG_X8_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%02X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%02X",#VALUE, VALUE))
 #   define LOG_U8_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE))
 #   define LOG_X16_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%04X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%04X",#VALUE, VALUE))
 #   define LOG_U16_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE))
 #   define LOG_X32_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%08X",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=0x%08X",#VALUE, VALUE))
 #   define LOG_U32_E(VALUE) \
-        nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog("mbedtls", NX_LEVEL_ERROR, "%s=%u",#VALUE, VALUE))
 #   define LOG_AU8_E(ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_ERROR, #ARRAY, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog_au8("mbedtls", NX_LEVEL_ERROR, #ARRAY, ARRAY, LEN))
 #   define LOG_MAU8_E(MESSAGE, ARRAY,LEN) \
-        nLog_au8("mbedtls", NX_LEVEL_ERROR, MESSAGE, ARRAY, LEN)
+        NX_LOG_IF(MBEDTLS, NX_LEVEL_ERROR, nLog_au8("mbedtls", NX_LEVEL_ERROR, MESSAGE, ARRAY, LEN))
 #else
 #   define LOG_ERROR_ENABLED 0
 #   define LOG_E(...)
@@ -0,0 +1,23 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * nxLog.c once more, without NX_LOG_ASYNC and with its public names
+ * renamed, as the reference of test_nxLog_async.c.
+ */
+
+#undef NX_LOG_ASYNC
+#define NX_LOG_ASYNC 0
+
+#define gnLogLevel gnLogLevelSync
+#define nLog_SetLevel nLog_SetLevelSync
+#define nLog_Flush nLog_FlushSync
+#define nLog_Init nLog_InitSync
+#define nLog_DeInit nLog_DeInitSync
+#define nLog nLogSync
+#define nLog_au8 nLog_au8Sync
+
+#include "../nxLog.c"
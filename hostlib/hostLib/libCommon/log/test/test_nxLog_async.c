@@ -0,0 +1,308 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * nLog and nLog_au8 with NX_LOG_ASYNC=1, against the synchronous logger
+ * (nxLog_sync.c) for the same calls, with stdout sent to a file:
+ * - byte identical output for %s (also longer than a line), %*d, %ld,
+ *   %p, %Lf, other conversions, arguments that do not fit a record, and
+ *   nLog_au8 of 0 to 100 bytes
+ * - lines of another thread in time order
+ * - arrays longer than NX_LOG_ASYNC_MAX_ARRAY are cut with " ..."
+ * - with the writer blocked, a full ring drops records and the writer
+ *   reports how many: printed + reported == logged
+ * - nLog_DeInit() and exit() print everything that is queued
+ */
+
+#include <nxLog.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <wchar.h>
+
+/* nxLog.c built synchronously, see nxLog_sync.c */
+void nLogSync(const char *comp, int level, const char *format, ...);
+void nLog_au8Sync(const char *comp, int level, const char *message, const unsigned char *array, size_t array_len);
+
+typedef void (*test_log_t)(const char *comp, int level, const char *format, ...);
+typedef void (*test_log_au8_t)(
+    const char *comp, int level, const char *message, const unsigned char *array, size_t array_len);
+
+#define TEST_DROP_RECORDS 4000
+#define TEST_EXIT_RECORDS 200
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return 1;                                       \
+    }
+
+static char gOutPath[] = "/tmp/nxlog_async_XXXXXX";
+static int gStdout     = -1;
+static char gLongStr[400];
+static unsigned char gArray[5000];
+
+/* Send stdout to gOutPath, emptied */
+static int capture_start(void)
+{
+    int fd;
+    fflush(stdout);
+    fd = open(gOutPath, O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        return 1;
+    }
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+    return 0;
+}
+
+/* Back to the real stdout, returns what was captured */
+static char *capture_end(size_t *pLen)
+{
+    FILE *fp;
+    char *text;
+    long len;
+
+    fflush(stdout);
+    dup2(gStdout, STDOUT_FILENO);
+    fp = fopen(gOutPath, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    text = (char *)calloc(1, (size_t)len + 1);
+    if (text != NULL && len > 0 && 1 != fread(text, (size_t)len, 1, fp)) {
+        free(text);
+        text = NULL;
+    }
+    fclose(fp);
+    *pLen = (size_t)len;
+    return text;
+}
+
+static void log_formats(test_log_t log)
+{
+    int local = 0;
+
+    log("sss", NX_LEVEL_INFO, "plain text");
+    log("smCom", NX_LEVEL_DEBUG, "%s and %s", "first", "second");
+    log("sss", NX_LEVEL_WARN, "long %s", gLongStr);
+    log("sss", NX_LEVEL_WARN, "%.*s|%-*s|", 5, gLongStr, 12, "left");
+    log("App", NX_LEVEL_ERROR, "%*d|%-*d|%0*d", 8, -42, 6, 7, 5, 123);
+    log("hostLib", NX_LEVEL_DEBUG, "%ld %ld %lu", LONG_MIN, LONG_MAX, ULONG_MAX);
+    log("scp", NX_LEVEL_INFO, "%p %p", (void *)&local, (void *)NULL);
+    log("sss", NX_LEVEL_INFO, "%lld %llx %zu %hhd %hu %c %%", LLONG_MIN, 0x123456789ABCDEFull, (size_t)-1, 300, 70000, 'x');
+    log("sss", NX_LEVEL_INFO, "%x %X %o %#x %+d % d", 0xCAFEu, 0xBEEFu, 8u, 255u, 5, 6);
+    log("sss", NX_LEVEL_INFO, "%f %.3e %g %Lf", 3.14159, -1e-10, 1e100, (long double)2.5L);
+    log("sss", NX_LEVEL_INFO, "%s", (const char *)NULL);
+    log("sss", NX_LEVEL_INFO, "%ls|%lc", L"wide", (wint_t)L'w');
+    /* More than a record keeps raw */
+    log("sss", NX_LEVEL_DEBUG, "%s %s %s", gLongStr, gLongStr + 100, gLongStr + 200);
+    log("sss", NX_LEVEL_INFO, "");
+    log("sss", NX_LEVEL_INFO, NULL);
+}
+
+static void log_arrays(test_log_au8_t log_au8)
+{
+    static const size_t lens[] = {0, 1, 3, 4, 15, 16, 17, 31, 32, 33, 100};
+    size_t i;
+    log_au8("smCom", NX_LEVEL_DEBUG, "Null", NULL, 0);
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        log_au8((i & 1) ? "smCom" : "scp", (int)(1 + i % 4), "Tx>", gArray + i, lens[i]);
+    }
+}
+
+static void *thread_log(void *arg)
+{
+    int i;
+    test_log_t log = (test_log_t)arg;
+    for (i = 0; i < 5; i++) {
+        log("thread", NX_LEVEL_INFO, "line %d of the thread", i);
+    }
+    return NULL;
+}
+
+static void log_all(test_log_t log, test_log_au8_t log_au8)
+{
+    pthread_t thread;
+    log_formats(log);
+    log_arrays(log_au8);
+    if (0 == pthread_create(&thread, NULL, &thread_log, (void *)log)) {
+        pthread_join(thread, NULL);
+    }
+    log("main", NX_LEVEL_INFO, "after the thread");
+}
+
+static int test_same_output(void)
+{
+    char *expected;
+    char *got;
+    size_t expectedLen = 0;
+    size_t gotLen      = 0;
+    int same;
+
+    CHECK(0 == capture_start());
+    log_all(&nLogSync, &nLog_au8Sync);
+    expected = capture_end(&expectedLen);
+    CHECK(expected != NULL && expectedLen > 0);
+
+    CHECK(0 == capture_start());
+    log_all(&nLog, &nLog_au8);
+    nLog_Flush();
+    got = capture_end(&gotLen);
+    CHECK(got != NULL);
+
+    same = (gotLen == expectedLen && 0 == memcmp(got, expected, gotLen));
+    if (!same) {
+        printf("--- synchronous:\n%s--- asynchronous:\n%s---\n", expected, got);
+    }
+    free(expected);
+    free(got);
+    CHECK(same);
+    return 0;
+}
+
+static int test_long_array(void)
+{
+    char *got;
+    size_t gotLen = 0;
+
+    CHECK(0 == capture_start());
+    nLog_au8("smCom", NX_LEVEL_DEBUG, "Rx<", gArray, sizeof(gArray));
+    nLog_Flush();
+    got = capture_end(&gotLen);
+    CHECK(got != NULL);
+    CHECK(NULL != strstr(got, "smCom :DEBUG:Rx< (Len=5000)"));
+    CHECK(gotLen > 5 && 0 == memcmp(got + gotLen - 5, " ...\n", 5));
+    free(got);
+    return 0;
+}
+
+static int test_drops(void)
+{
+    char *got;
+    char *p;
+    size_t gotLen  = 0;
+    size_t printed = 0;
+    size_t dropped = 0;
+    int i;
+
+    CHECK(0 == capture_start());
+    /* The writer blocks on stdout, nothing is taken off the ring */
+    flockfile(stdout);
+    for (i = 0; i < TEST_DROP_RECORDS; i++) {
+        nLog("drop", NX_LEVEL_INFO, "record %d", i);
+    }
+    funlockfile(stdout);
+    nLog_Flush();
+    got = capture_end(&gotLen);
+    CHECK(got != NULL);
+    for (p = got; (p = strstr(p, "drop  :INFO :record ")) != NULL; p++) {
+        printed++;
+    }
+    for (p = got; (p = strstr(p, "nxLog :WARN :")) != NULL; p++) {
+        unsigned int n = 0;
+        CHECK(1 == sscanf(p, "nxLog :WARN :%u log records dropped", &n));
+        dropped += n;
+    }
+    free(got);
+    CHECK(printed > 0 && dropped > 0);
+    CHECK(printed + dropped == TEST_DROP_RECORDS);
+    return 0;
+}
+
+static int count_lines(const char *text, const char *prefix)
+{
+    int count = 0;
+    const char *p;
+    for (p = text; (p = strstr(p, prefix)) != NULL; p++) {
+        count++;
+    }
+    return count;
+}
+
+static int test_deinit(void)
+{
+    char *got;
+    size_t gotLen = 0;
+    int i;
+
+    CHECK(0 == capture_start());
+    for (i = 0; i < 100; i++) {
+        nLog("deinit", NX_LEVEL_INFO, "record %d", i);
+    }
+    nLog_DeInit();
+    got = capture_end(&gotLen);
+    CHECK(got != NULL);
+    i = count_lines(got, "deinit:INFO :record ");
+    free(got);
+    CHECK(i == 100);
+    return 0;
+}
+
+/* In a child, before the writer is started in this process */
+static int test_exit(void)
+{
+    char *got;
+    size_t gotLen = 0;
+    int status    = -1;
+    pid_t pid;
+    int i;
+
+    CHECK(0 == capture_start());
+    pid = fork();
+    if (pid == 0) {
+        for (i = 0; i < TEST_EXIT_RECORDS; i++) {
+            nLog("exit", NX_LEVEL_INFO, "record %d", i);
+        }
+        exit(0);
+    }
+    CHECK(pid > 0);
+    CHECK(pid == waitpid(pid, &status, 0));
+    got = capture_end(&gotLen);
+    CHECK(got != NULL);
+    i = count_lines(got, "exit  :INFO :record ");
+    free(got);
+    CHECK(WIFEXITED(status) && 0 == WEXITSTATUS(status));
+    CHECK(i == TEST_EXIT_RECORDS);
+    return 0;
+}
+
+int main(void)
+{
+    int fd;
+    size_t i;
+
+    for (i = 0; i < sizeof(gLongStr) - 1; i++) {
+        gLongStr[i] = (char)('a' + i % 26);
+    }
+    for (i = 0; i < sizeof(gArray); i++) {
+        gArray[i] = (unsigned char)(i * 37);
+    }
+    fd = mkstemp(gOutPath);
+    gStdout = dup(STDOUT_FILENO);
+    if (fd < 0 || gStdout < 0) {
+        printf("FAIL: mkstemp / dup\n");
+        return 1;
+    }
+    close(fd);
+
+    if (test_exit() || test_same_output() || test_long_array() || test_drops() || test_deinit()) {
+        unlink(gOutPath);
+        return 1;
+    }
+    unlink(gOutPath);
+    printf("test_nxLog_async: OK\n");
+    return 0;
+}
@@ -15,6 +15,8 @@
 #endif
 
 #include <string.h>
+#include <limits.h>
+#include <stdint.h>
 #include <assert.h>
 #include <nxLog_scp.h>
 #include "nxScp03_Apis.h"
@@ -31,26 +33,21 @@
 #error "No hostcrypto"
 #endif // SSS_HAVE_HOSTCRYPTO_MBEDTLS
 
-#if SSS_HAVE_SE05X_VER_GTE_06_00
-#if defined(SE05X_MAX_BUF_SIZE_CMD) && (SE05X_MAX_BUF_SIZE_CMD != 1024)
-#   error "Expect hard coded for SE05X_MAX_BUF_SIZE_CMD = 1024"
-#endif
-#define NX_SCP03_MAX_BUFFER_SIZE 0x400 /* 0x400 = 1024 */
-#else
-#if defined(SE05X_MAX_BUF_SIZE_CMD) && (SE05X_MAX_BUF_SIZE_CMD != 892)
-#   error "Expect hard coded for SE05X_MAX_BUF_SIZE_CMD = 892"
+#if NX_SCP03_KEYED_CTX_CACHE
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+#include <mbedtls/aes.h>
+#include <mbedtls/cmac.h>
+#elif SSS_HAVE_HOSTCRYPTO_OPENSSL
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000)
+#include <openssl/core_names.h>
 #endif
-#define NX_SCP03_MAX_BUFFER_SIZE 0x380 /* 0x380 = 896 */
 #endif
+#endif // NX_SCP03_KEYED_CTX_CACHE
+
 /* ************************************************************************** */
 /* Functions : Private function declaration                                   */
 /* ************************************************************************** */
 /**
-* To Apply Encryption on Plain Data
-*/
-
-static void nxSCP03_PadCommandAPDU(uint8_t *cmdBuf, size_t *pCmdBufLen);
-/**
 * To Maintain chaining of Sent commands
 */
 static sss_status_t nxSCP03_Calculate_CommandICV(NXSCP03_DynCtx_t *pdySCP03SessCtx, uint8_t *pIcv);
@@ -63,55 +60,602 @@ static sss_status_t nxpSCP03_Get_ResponseICV(NXSCP03_DynCtx_t *pdySCP03SessCtx,
 /**
 * To check plain data
 */
-static uint16_t nxpSCP03_RestoreSw_RAPDU(
-    uint8_t *rspBuf, size_t *pRspBufLen, uint8_t *plaintextResponse, size_t plaintextRespLen, uint8_t *sw);
+static uint16_t nxpSCP03_RestoreSw_RAPDU(uint8_t *rspBuf, size_t *pRspBufLen, size_t plaintextRespLen, uint8_t *sw);
 
 /**
 * Decrement counter block for ICV calculation
 */
 static void nxpSCP03_Dec_CommandCounter(uint8_t *pCtrblock);
 
+/**
+* AES-CBC with the session ENC key
+*/
+static sss_status_t nxScp03_AesCbc(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    sss_mode_t mode,
+    uint8_t *pIv,
+    const uint8_t *srcData,
+    uint8_t *destData,
+    size_t dataLen);
+
+/**
+* AES-CMAC over MCV || data || tail with the session MAC or RMAC key
+*/
+static sss_status_t nxScp03_Cmac(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    bool isRmac,
+    const uint8_t *data,
+    size_t dataLen,
+    const uint8_t *tail,
+    size_t tailLen,
+    uint8_t *mac,
+    size_t *macLen);
+
+/* ************************************************************************** */
+/* Functions : Pre-keyed session contexts                                     */
+/* ************************************************************************** */
+
+#if NX_SCP03_KEYED_CTX_CACHE
+
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+typedef sss_mbedtls_object_t nxScp03_HostObject_t;
+#else
+typedef sss_openssl_object_t nxScp03_HostObject_t;
+#endif
+
+static sss_status_t nxScp03_Keyed_GetKey(sss_object_t *keyObj, const uint8_t **ppKey, size_t *pKeyLen)
+{
+    sss_status_t status            = kStatus_SSS_Fail;
+    nxScp03_HostObject_t *pHostObj = (nxScp03_HostObject_t *)keyObj;
+
+    ENSURE_OR_GO_EXIT(keyObj != NULL);
+    ENSURE_OR_GO_EXIT(pHostObj->contents != NULL);
+    ENSURE_OR_GO_EXIT(pHostObj->contents_size == 16 || pHostObj->contents_size == 24 || pHostObj->contents_size == 32);
+    *ppKey   = (const uint8_t *)pHostObj->contents;
+    *pKeyLen = pHostObj->contents_size;
+    status   = kStatus_SSS_Success;
+exit:
+    return status;
+}
+
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+
+static void *nxScp03_Keyed_NewCipher(sss_object_t *keyObj, sss_mode_t mode)
+{
+    mbedtls_aes_context *pAes = NULL;
+    const uint8_t *pKey       = NULL;
+    size_t keyLen             = 0;
+    int ret                   = -1;
+
+    ENSURE_OR_GO_EXIT(nxScp03_Keyed_GetKey(keyObj, &pKey, &keyLen) == kStatus_SSS_Success);
+    pAes = (mbedtls_aes_context *)SSS_MALLOC(sizeof(*pAes));
+    ENSURE_OR_GO_EXIT(pAes != NULL);
+    mbedtls_aes_init(pAes);
+    if (mode == kMode_SSS_Encrypt) {
+        ret = mbedtls_aes_setkey_enc(pAes, pKey, (unsigned int)(keyLen * 8));
+    }
+    else {
+        ret = mbedtls_aes_setkey_dec(pAes, pKey, (unsigned int)(keyLen * 8));
+    }
+    if (ret != 0) {
+        mbedtls_aes_free(pAes);
+        SSS_FREE(pAes);
+        pAes = NULL;
+    }
+exit:
+    return pAes;
+}
+
+static void *nxScp03_Keyed_NewMac(sss_object_t *keyObj)
+{
+    mbedtls_cipher_context_t *pCipher        = NULL;
+    const mbedtls_cipher_info_t *cipher_info = NULL;
+    const uint8_t *pKey                      = NULL;
+    size_t keyLen                            = 0;
+    int ret                                  = -1;
+
+    ENSURE_OR_GO_EXIT(nxScp03_Keyed_GetKey(keyObj, &pKey, &keyLen) == kStatus_SSS_Success);
+    cipher_info = mbedtls_cipher_info_from_values(MBEDTLS_CIPHER_ID_AES, (int)(keyLen * 8), MBEDTLS_MODE_ECB);
+    ENSURE_OR_GO_EXIT(cipher_info != NULL);
+    pCipher = (mbedtls_cipher_context_t *)SSS_MALLOC(sizeof(*pCipher));
+    ENSURE_OR_GO_EXIT(pCipher != NULL);
+    mbedtls_cipher_init(pCipher);
+    ret = mbedtls_cipher_setup(pCipher, cipher_info);
+    if (ret == 0) {
+        ret = mbedtls_cipher_cmac_starts(pCipher, pKey, keyLen * 8);
+    }
+    if (ret != 0) {
+        mbedtls_cipher_free(pCipher);
+        SSS_FREE(pCipher);
+        pCipher = NULL;
+    }
+exit:
+    return pCipher;
+}
+
+static void nxScp03_Keyed_FreeCipher(void *pCtx)
+{
+    if (pCtx != NULL) {
+        /* mbedtls_aes_free() zeroizes the key schedule */
+        mbedtls_aes_free((mbedtls_aes_context *)pCtx);
+        SSS_FREE(pCtx);
+    }
+}
+
+static void nxScp03_Keyed_FreeMac(void *pCtx)
+{
+    if (pCtx != NULL) {
+        mbedtls_cipher_free((mbedtls_cipher_context_t *)pCtx);
+        SSS_FREE(pCtx);
+    }
+}
+
+static sss_status_t nxScp03_Keyed_Cipher(
+    void *pCtx, sss_mode_t mode, const uint8_t *pIv, const uint8_t *srcData, uint8_t *destData, size_t dataLen)
+{
+    uint8_t iv[SCP_IV_SIZE];
+    int ret;
+
+    /* mbedtls_aes_crypt_cbc updates the IV, keep the one of the caller */
+    memcpy(iv, pIv, SCP_IV_SIZE);
+    ret = mbedtls_aes_crypt_cbc((mbedtls_aes_context *)pCtx,
+        (mode == kMode_SSS_Encrypt) ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
+        dataLen,
+        iv,
+        srcData,
+        destData);
+    return (ret == 0) ? kStatus_SSS_Success : kStatus_SSS_Fail;
+}
+
+static sss_status_t nxScp03_Keyed_Mac(void *pCtx,
+    const uint8_t *mcv,
+    const uint8_t *data,
+    size_t dataLen,
+    const uint8_t *tail,
+    size_t tailLen,
+    uint8_t *mac,
+    size_t *macLen)
+{
+    mbedtls_cipher_context_t *pCipher = (mbedtls_cipher_context_t *)pCtx;
+    int ret;
+
+    ret = mbedtls_cipher_cmac_reset(pCipher);
+    if (ret == 0) {
+        ret = mbedtls_cipher_cmac_update(pCipher, mcv, SCP_MCV_LEN);
+    }
+    if (ret == 0 && dataLen > 0) {
+        ret = mbedtls_cipher_cmac_update(pCipher, data, dataLen);
+    }
+    if (ret == 0 && tailLen > 0) {
+        ret = mbedtls_cipher_cmac_update(pCipher, tail, tailLen);
+    }
+    if (ret == 0) {
+        ret = mbedtls_cipher_cmac_finish(pCipher, mac);
+    }
+    if (ret != 0) {
+        return kStatus_SSS_Fail;
+    }
+    *macLen = SCP_CMAC_SIZE;
+    return kStatus_SSS_Success;
+}
+
+#else /* SSS_HAVE_HOSTCRYPTO_OPENSSL */
+
+static void *nxScp03_Keyed_NewCipher(sss_object_t *keyObj, sss_mode_t mode)
+{
+    EVP_CIPHER_CTX *pCipher       = NULL;
+    const EVP_CIPHER *cipher_info = NULL;
+    const uint8_t *pKey           = NULL;
+    size_t keyLen                 = 0;
+
+    ENSURE_OR_GO_EXIT(nxScp03_Keyed_GetKey(keyObj, &pKey, &keyLen) == kStatus_SSS_Success);
+    switch (keyLen) {
+    case 16:
+        cipher_info = EVP_aes_128_cbc();
+        break;
+    case 24:
+        cipher_info = EVP_aes_192_cbc();
+        break;
+    default:
+        cipher_info = EVP_aes_256_cbc();
+        break;
+    }
+    pCipher = EVP_CIPHER_CTX_new();
+    ENSURE_OR_GO_EXIT(pCipher != NULL);
+    if (1 != EVP_CipherInit_ex(pCipher, cipher_info, NULL, pKey, NULL, (mode == kMode_SSS_Encrypt) ? 1 : 0)) {
+        EVP_CIPHER_CTX_free(pCipher);
+        pCipher = NULL;
+        goto exit;
+    }
+    EVP_CIPHER_CTX_set_padding(pCipher, 0);
+exit:
+    return pCipher;
+}
+
+static void nxScp03_Keyed_FreeCipher(void *pCtx)
+{
+    if (pCtx != NULL) {
+        /* EVP_CIPHER_CTX_free() cleanses the key schedule */
+        EVP_CIPHER_CTX_free((EVP_CIPHER_CTX *)pCtx);
+    }
+}
+
+static sss_status_t nxScp03_Keyed_Cipher(
+    void *pCtx, sss_mode_t mode, const uint8_t *pIv, const uint8_t *srcData, uint8_t *destData, size_t dataLen)
+{
+    EVP_CIPHER_CTX *pCipher = (EVP_CIPHER_CTX *)pCtx;
+    int outLen              = 0;
+    int finLen              = 0;
+
+    AX_UNUSED_ARG(mode);
+    ENSURE_OR_GO_EXIT(dataLen <= INT_MAX);
+    /* Only reload the IV, the key schedule is kept */
+    ENSURE_OR_GO_EXIT(1 == EVP_CipherInit_ex(pCipher, NULL, NULL, NULL, pIv, -1));
+    ENSURE_OR_GO_EXIT(1 == EVP_CipherUpdate(pCipher, destData, &outLen, srcData, (int)dataLen));
+    ENSURE_OR_GO_EXIT(1 == EVP_CipherFinal_ex(pCipher, destData + outLen, &finLen));
+    ENSURE_OR_GO_EXIT((size_t)(outLen + finLen) == dataLen);
+    return kStatus_SSS_Success;
+exit:
+    return kStatus_SSS_Fail;
+}
+
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000)
+
+static void *nxScp03_Keyed_NewMac(sss_object_t *keyObj)
+{
+    EVP_MAC *pCmac        = NULL;
+    EVP_MAC_CTX *pMacCtx  = NULL;
+    const uint8_t *pKey   = NULL;
+    size_t keyLen         = 0;
+    const char *cipherStr = NULL;
+    OSSL_PARAM params[2];
+
+    ENSURE_OR_GO_EXIT(nxScp03_Keyed_GetKey(keyObj, &pKey, &keyLen) == kStatus_SSS_Success);
+    switch (keyLen) {
+    case 16:
+        cipherStr = "AES-128-CBC";
+        break;
+    case 24:
+        cipherStr = "AES-192-CBC";
+        break;
+    default:
+        cipherStr = "AES-256-CBC";
+        break;
+    }
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_CIPHER, (char *)cipherStr, 0);
+    params[1] = OSSL_PARAM_construct_end();
+
+    pCmac = EVP_MAC_fetch(NULL, "CMAC", NULL);
+    ENSURE_OR_GO_EXIT(pCmac != NULL);
+    pMacCtx = EVP_MAC_CTX_new(pCmac);
+    /* The context keeps its own reference */
+    EVP_MAC_free(pCmac);
+    ENSURE_OR_GO_EXIT(pMacCtx != NULL);
+    if (1 != EVP_MAC_init(pMacCtx, pKey, keyLen, params)) {
+        EVP_MAC_CTX_free(pMacCtx);
+        pMacCtx = NULL;
+    }
+exit:
+    return pMacCtx;
+}
+
+static void nxScp03_Keyed_FreeMac(void *pCtx)
+{
+    if (pCtx != NULL) {
+        EVP_MAC_CTX_free((EVP_MAC_CTX *)pCtx);
+    }
+}
+
+static sss_status_t nxScp03_Keyed_Mac(void *pCtx,
+    const uint8_t *mcv,
+    const uint8_t *data,
+    size_t dataLen,
+    const uint8_t *tail,
+    size_t tailLen,
+    uint8_t *mac,
+    size_t *macLen)
+{
+    EVP_MAC_CTX *pMacCtx = (EVP_MAC_CTX *)pCtx;
+
+    /* A NULL key restarts CMAC with the key already set */
+    ENSURE_OR_GO_EXIT(1 == EVP_MAC_init(pMacCtx, NULL, 0, NULL));
+    ENSURE_OR_GO_EXIT(1 == EVP_MAC_update(pMacCtx, mcv, SCP_MCV_LEN));
+    if (dataLen > 0) {
+        ENSURE_OR_GO_EXIT(1 == EVP_MAC_update(pMacCtx, data, dataLen));
+    }
+    if (tailLen > 0) {
+        ENSURE_OR_GO_EXIT(1 == EVP_MAC_update(pMacCtx, tail, tailLen));
+    }
+    ENSURE_OR_GO_EXIT(1 == EVP_MAC_final(pMacCtx, mac, macLen, *macLen));
+    return kStatus_SSS_Success;
+exit:
+    return kStatus_SSS_Fail;
+}
+
+#else /* OPENSSL_VERSION_NUMBER */
+
+static void *nxScp03_Keyed_NewMac(sss_object_t *keyObj)
+{
+    CMAC_CTX *pCmacCtx            = NULL;
+    const EVP_CIPHER *cipher_info = NULL;
+    const uint8_t *pKey           = NULL;
+    size_t keyLen                 = 0;
+
+    ENSURE_OR_GO_EXIT(nxScp03_Keyed_GetKey(keyObj, &pKey, &keyLen) == kStatus_SSS_Success);
+    switch (keyLen) {
+    case 16:
+        cipher_info = EVP_aes_128_cbc();
+        break;
+    case 24:
+        cipher_info = EVP_aes_192_cbc();
+        break;
+    default:
+        cipher_info = EVP_aes_256_cbc();
+        break;
+    }
+    pCmacCtx = CMAC_CTX_new();
+    ENSURE_OR_GO_EXIT(pCmacCtx != NULL);
+    if (1 != CMAC_Init(pCmacCtx, pKey, keyLen, cipher_info, NULL)) {
+        CMAC_CTX_free(pCmacCtx);
+        pCmacCtx = NULL;
+    }
+exit:
+    return pCmacCtx;
+}
+
+static void nxScp03_Keyed_FreeMac(void *pCtx)
+{
+    if (pCtx != NULL) {
+        CMAC_CTX_free((CMAC_CTX *)pCtx);
+    }
+}
+
+static sss_status_t nxScp03_Keyed_Mac(void *pCtx,
+    const uint8_t *mcv,
+    const uint8_t *data,
+    size_t dataLen,
+    const uint8_t *tail,
+    size_t tailLen,
+    uint8_t *mac,
+    size_t *macLen)
+{
+    CMAC_CTX *pCmacCtx = (CMAC_CTX *)pCtx;
+
+    /* All NULL restarts CMAC with the key already set */
+    ENSURE_OR_GO_EXIT(1 == CMAC_Init(pCmacCtx, NULL, 0, NULL, NULL));
+    ENSURE_OR_GO_EXIT(1 == CMAC_Update(pCmacCtx, mcv, SCP_MCV_LEN));
+    if (dataLen > 0) {
+        ENSURE_OR_GO_EXIT(1 == CMAC_Update(pCmacCtx, data, dataLen));
+    }
+    if (tailLen > 0) {
+        ENSURE_OR_GO_EXIT(1 == CMAC_Update(pCmacCtx, tail, tailLen));
+    }
+    ENSURE_OR_GO_EXIT(1 == CMAC_Final(pCmacCtx, mac, macLen));
+    return kStatus_SSS_Success;
+exit:
+    return kStatus_SSS_Fail;
+}
+
+#endif /* OPENSSL_VERSION_NUMBER */
+#endif /* SSS_HAVE_HOSTCRYPTO_MBEDTLS */
+
+#endif /* NX_SCP03_KEYED_CTX_CACHE */
+
+sss_status_t nxScp03_DynCtx_KeyedInit(NXSCP03_DynCtx_t *pdySCP03SessCtx)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+#if NX_SCP03_KEYED_CTX_CACHE
+    NXSCP03_KeyedCtx_t keyed;
+#endif
+
+    ENSURE_OR_GO_EXIT(pdySCP03SessCtx != NULL);
+    /* Session keys may have been rotated, drop the old ones first */
+    nxScp03_DynCtx_KeyedFree(pdySCP03SessCtx);
+#if NX_SCP03_KEYED_CTX_CACHE
+    keyed.pEncCtx  = nxScp03_Keyed_NewCipher(&pdySCP03SessCtx->Enc, kMode_SSS_Encrypt);
+    keyed.pDecCtx  = nxScp03_Keyed_NewCipher(&pdySCP03SessCtx->Enc, kMode_SSS_Decrypt);
+    keyed.pMacCtx  = nxScp03_Keyed_NewMac(&pdySCP03SessCtx->Mac);
+    keyed.pRmacCtx = nxScp03_Keyed_NewMac(&pdySCP03SessCtx->Rmac);
+    if ((keyed.pEncCtx == NULL) || (keyed.pDecCtx == NULL) || (keyed.pMacCtx == NULL) ||
+        (keyed.pRmacCtx == NULL)) {
+        LOG_W("Could not expand session keys, re-keying per APDU");
+        nxScp03_Keyed_FreeCipher(keyed.pEncCtx);
+        nxScp03_Keyed_FreeCipher(keyed.pDecCtx);
+        nxScp03_Keyed_FreeMac(keyed.pMacCtx);
+        nxScp03_Keyed_FreeMac(keyed.pRmacCtx);
+        /* Not retried per APDU, see nxScp03_DynCtx_KeyedGet */
+        pdySCP03SessCtx->keyed.ready = NX_SCP03_KEYED_FAILED;
+        goto exit;
+    }
+    keyed.ready            = NX_SCP03_KEYED_READY;
+    pdySCP03SessCtx->keyed = keyed;
+#endif
+    status = kStatus_SSS_Success;
+exit:
+    return status;
+}
+
+void nxScp03_DynCtx_KeyedFree(NXSCP03_DynCtx_t *pdySCP03SessCtx)
+{
+    ENSURE_OR_GO_EXIT(pdySCP03SessCtx != NULL);
+#if NX_SCP03_KEYED_CTX_CACHE
+    if (pdySCP03SessCtx->keyed.ready == NX_SCP03_KEYED_READY) {
+        nxScp03_Keyed_FreeCipher(pdySCP03SessCtx->keyed.pEncCtx);
+        nxScp03_Keyed_FreeCipher(pdySCP03SessCtx->keyed.pDecCtx);
+        nxScp03_Keyed_FreeMac(pdySCP03SessCtx->keyed.pMacCtx);
+        nxScp03_Keyed_FreeMac(pdySCP03SessCtx->keyed.pRmacCtx);
+    }
+#endif
+    memset(&pdySCP03SessCtx->keyed, 0, sizeof(pdySCP03SessCtx->keyed));
+exit:
+    return;
+}
+
+#if NX_SCP03_KEYED_CTX_CACHE
+/* Keyed contexts of the session, expanded on first use, e.g. for a resumed
+ * session whose keys were set without nxScp03_DynCtx_KeyedInit. A failed
+ * expansion is returned again without a retry, the caller then uses the
+ * generic host crypto. */
+static sss_status_t nxScp03_DynCtx_KeyedGet(NXSCP03_DynCtx_t *pdySCP03SessCtx)
+{
+    if (pdySCP03SessCtx->keyed.ready == NX_SCP03_KEYED_READY) {
+        return kStatus_SSS_Success;
+    }
+    if (pdySCP03SessCtx->keyed.ready == NX_SCP03_KEYED_FAILED) {
+        return kStatus_SSS_Fail;
+    }
+    return nxScp03_DynCtx_KeyedInit(pdySCP03SessCtx);
+}
+#endif
+
+static sss_status_t nxScp03_AesCbc(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    sss_mode_t mode,
+    uint8_t *pIv,
+    const uint8_t *srcData,
+    uint8_t *destData,
+    size_t dataLen)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+    sss_symmetric_t symm;
+
+#if NX_SCP03_KEYED_CTX_CACHE
+    if (nxScp03_DynCtx_KeyedGet(pdySCP03SessCtx) == kStatus_SSS_Success) {
+        return nxScp03_Keyed_Cipher((mode == kMode_SSS_Encrypt) ? pdySCP03SessCtx->keyed.pEncCtx :
+                                                                  pdySCP03SessCtx->keyed.pDecCtx,
+            mode,
+            pIv,
+            srcData,
+            destData,
+            dataLen);
+    }
+#endif
+
+    status = sss_host_symmetric_context_init(
+        &symm, pdySCP03SessCtx->Enc.keyStore->session, &pdySCP03SessCtx->Enc, kAlgorithm_SSS_AES_CBC, mode);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+    status = sss_host_cipher_one_go(&symm, pIv, SCP_KEY_SIZE, srcData, destData, dataLen);
+    sss_host_symmetric_context_free(&symm);
+exit:
+    return status;
+}
+
+static sss_status_t nxScp03_Cmac(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    bool isRmac,
+    const uint8_t *data,
+    size_t dataLen,
+    const uint8_t *tail,
+    size_t tailLen,
+    uint8_t *mac,
+    size_t *macLen)
+{
+    sss_status_t status  = kStatus_SSS_Fail;
+    sss_object_t *keyObj = isRmac ? &pdySCP03SessCtx->Rmac : &pdySCP03SessCtx->Mac;
+    sss_mac_t macCtx;
+
+#if NX_SCP03_KEYED_CTX_CACHE
+    if (nxScp03_DynCtx_KeyedGet(pdySCP03SessCtx) == kStatus_SSS_Success) {
+        return nxScp03_Keyed_Mac(isRmac ? pdySCP03SessCtx->keyed.pRmacCtx : pdySCP03SessCtx->keyed.pMacCtx,
+            pdySCP03SessCtx->MCV,
+            data,
+            dataLen,
+            tail,
+            tailLen,
+            mac,
+            macLen);
+    }
+#endif
+
+    status = sss_host_mac_context_init(&macCtx, keyObj->keyStore->session, keyObj, kAlgorithm_SSS_CMAC_AES, kMode_SSS_Mac);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+
+    status = sss_host_mac_init(&macCtx);
+    ENSURE_OR_GO_CLEANUP(status == kStatus_SSS_Success);
+
+    status = sss_host_mac_update(&macCtx, pdySCP03SessCtx->MCV, SCP_MCV_LEN);
+    ENSURE_OR_GO_CLEANUP(status == kStatus_SSS_Success);
+
+    if (dataLen > 0) {
+        status = sss_host_mac_update(&macCtx, data, dataLen);
+        ENSURE_OR_GO_CLEANUP(status == kStatus_SSS_Success);
+    }
+    if (tailLen > 0) {
+        status = sss_host_mac_update(&macCtx, tail, tailLen);
+        ENSURE_OR_GO_CLEANUP(status == kStatus_SSS_Success);
+    }
+
+    status = sss_host_mac_finish(&macCtx, mac, macLen);
+cleanup:
+    sss_host_mac_context_free(&macCtx);
+exit:
+    return status;
+}
+
 sss_status_t nxSCP03_Encrypt_CommandAPDU(NXSCP03_DynCtx_t *pdySCP03SessCtx, uint8_t *cmdBuf, size_t *pCmdBufLen)
 {
     sss_status_t sss_status = kStatus_SSS_Fail;
-    size_t dataLen = 0;
+    size_t encLen           = 0;
 
     ENSURE_OR_GO_CLEANUP(pCmdBufLen != NULL);
+    /* Callers of this API reserve room for the padding after the command */
+    encLen     = SCP_PADDED_LEN(*pCmdBufLen);
+    sss_status = nxSCP03_Encrypt_CommandAPDU_To(pdySCP03SessCtx, cmdBuf, *pCmdBufLen, cmdBuf, &encLen);
+    ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
+    *pCmdBufLen = encLen;
+
+cleanup:
+    return sss_status;
+}
+
+sss_status_t nxSCP03_Encrypt_CommandAPDU_To(NXSCP03_DynCtx_t *pdySCP03SessCtx,
+    const uint8_t *cmdBuf,
+    size_t cmdBufLen,
+    uint8_t *encBuf,
+    size_t *pEncBufLen)
+{
+    sss_status_t sss_status         = kStatus_SSS_Fail;
+    uint8_t iv[SCP_IV_SIZE]         = {0};
+    uint8_t lastBlock[SCP_KEY_SIZE] = {0};
+    size_t fullLen                  = 0;
+    size_t tailLen                  = 0;
+
+    ENSURE_OR_GO_CLEANUP(pdySCP03SessCtx != NULL);
+    ENSURE_OR_GO_CLEANUP(pEncBufLen != NULL);
     LOG_D("FN: %s", __FUNCTION__);
-    LOG_MAU8_D(" Input:cmdBuf", cmdBuf, *pCmdBufLen);
-
-    if (*pCmdBufLen != 0) {
-        sss_symmetric_t symm;
-        uint8_t iv[16] = {0};
-        uint8_t *pIv = (uint8_t *)iv;
-        uint8_t apduPayloadToEncrypt[NX_SCP03_MAX_BUFFER_SIZE] = {0};
-
-        /* Prior to encrypting the data, the data shall be padded as defined in section 4.1.4.
-        This padding becomes part of the data field.*/
-        nxSCP03_PadCommandAPDU(cmdBuf, pCmdBufLen);
-        sss_status = nxSCP03_Calculate_CommandICV(pdySCP03SessCtx, pIv);
-        ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
-        memcpy(apduPayloadToEncrypt, cmdBuf, *pCmdBufLen);
 
-        sss_status = sss_host_symmetric_context_init(&symm,
-            pdySCP03SessCtx->Enc.keyStore->session,
-            &pdySCP03SessCtx->Enc,
-            kAlgorithm_SSS_AES_CBC,
-            kMode_SSS_Encrypt);
-        ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
-        dataLen = *pCmdBufLen;
-        LOG_D("Encrypt CommandAPDU");
-        sss_status = sss_host_cipher_one_go(&symm, pIv, SCP_KEY_SIZE, apduPayloadToEncrypt, cmdBuf, dataLen);
-        ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
-        LOG_AU8_D(cmdBuf, dataLen);
-        LOG_MAU8_D("Output: EncryptedcmdBuf", cmdBuf, dataLen);
-        sss_host_symmetric_context_free(&symm);
-    }
-    else {
+    if (cmdBufLen == 0) {
         /* Nothing to encrypt */
-        sss_status = kStatus_SSS_Success;
+        *pEncBufLen = 0;
+        sss_status  = kStatus_SSS_Success;
+        goto cleanup;
+    }
+    ENSURE_OR_GO_CLEANUP(cmdBuf != NULL);
+    ENSURE_OR_GO_CLEANUP(encBuf != NULL);
+    ENSURE_OR_GO_CLEANUP(cmdBufLen < (SIZE_MAX - SCP_KEY_SIZE));
+    ENSURE_OR_GO_CLEANUP(*pEncBufLen >= SCP_PADDED_LEN(cmdBufLen));
+    LOG_MAU8_D(" Input:cmdBuf", cmdBuf, cmdBufLen);
+
+    /* Prior to encrypting the data, the data shall be padded as defined in section 4.1.4.
+    This padding becomes part of the data field.
+    Only the last block carries padding, build it aside so that the
+    full blocks are encrypted straight from cmdBuf into encBuf. */
+    tailLen = cmdBufLen % SCP_KEY_SIZE;
+    fullLen = cmdBufLen - tailLen;
+    memcpy(lastBlock, &cmdBuf[fullLen], tailLen);
+    lastBlock[tailLen] = SCP_DATA_PAD_BYTE;
+
+    sss_status = nxSCP03_Calculate_CommandICV(pdySCP03SessCtx, iv);
+    ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
+
+    LOG_D("Encrypt CommandAPDU");
+    if (fullLen > 0) {
+        sss_status = nxScp03_AesCbc(pdySCP03SessCtx, kMode_SSS_Encrypt, iv, cmdBuf, encBuf, fullLen);
+        ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
+        /* CBC chaining into the last block */
+        memcpy(iv, &encBuf[fullLen - SCP_KEY_SIZE], SCP_IV_SIZE);
     }
+    sss_status = nxScp03_AesCbc(pdySCP03SessCtx, kMode_SSS_Encrypt, iv, lastBlock, &encBuf[fullLen], SCP_KEY_SIZE);
+    ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
 
+    *pEncBufLen = fullLen + SCP_KEY_SIZE;
+    LOG_MAU8_D("Output: EncryptedcmdBuf", encBuf, *pEncBufLen);
 
 cleanup:
     return sss_status;
@@ -123,22 +667,12 @@ uint16_t nxpSCP03_Decrypt_ResponseAPDU(
     AX_UNUSED_ARG(hasle);
     sss_status_t sss_status = kStatus_SSS_Fail;
     uint16_t status = SCP_FAIL;
-    sss_algorithm_t algorithm = kAlgorithm_SSS_CMAC_AES;
-    sss_mode_t mode = kMode_SSS_Mac;
-    sss_mac_t macCtx;
     uint8_t sw[SCP_GP_SW_LEN];
     uint8_t respMac[SCP_CMAC_SIZE] = {0};
     size_t signatureLen = sizeof(respMac);
-    size_t compareoffset = 0;
-    size_t macSize = SCP_CMAC_SIZE;
+    size_t dataLen = 0;
     uint8_t iv[SCP_IV_SIZE] = {0};
     uint8_t *pIv = (uint8_t *)iv;
-    uint8_t response[NX_SCP03_MAX_BUFFER_SIZE];
-    uint8_t plaintextResponse[NX_SCP03_MAX_BUFFER_SIZE]={0};
-    sss_algorithm_t algorithm_aes = kAlgorithm_SSS_AES_CBC;
-    sss_mode_t mode_aes = kMode_SSS_Decrypt;
-    sss_symmetric_t symm;
-    size_t actualRespLen = 0;
 
     ENSURE_OR_GO_EXIT(pRspBufLen != NULL);
     ENSURE_OR_GO_EXIT(pdySCP03SessCtx != NULL);
@@ -149,34 +683,16 @@ uint16_t nxpSCP03_Decrypt_ResponseAPDU(
 
 
     if (*pRspBufLen >= (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN)) {
+        // rspBuf = Encrypted data || RMAC || SW
+        dataLen = *pRspBufLen - SCP_COMMAND_MAC_SIZE - SCP_GP_SW_LEN;
         memcpy(sw, &(rspBuf[*pRspBufLen - SCP_GP_SW_LEN]), SCP_GP_SW_LEN);
 
-        sss_status = sss_host_mac_context_init(
-            &macCtx, pdySCP03SessCtx->Rmac.keyStore->session, &pdySCP03SessCtx->Rmac, algorithm, mode);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        sss_status = sss_host_mac_init(&macCtx);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        sss_status = sss_host_mac_update(&macCtx, pdySCP03SessCtx->MCV, macSize);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        sss_status = sss_host_mac_update(&macCtx, rspBuf, *pRspBufLen - SCP_COMMAND_MAC_SIZE - SCP_GP_SW_LEN);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        sss_status = sss_host_mac_update(&macCtx, sw, SCP_GP_SW_LEN);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        sss_status = sss_host_mac_finish(&macCtx, respMac, &signatureLen);
-
+        sss_status = nxScp03_Cmac(pdySCP03SessCtx, TRUE, rspBuf, dataLen, sw, SCP_GP_SW_LEN, respMac, &signatureLen);
         ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
         LOG_MAU8_D(" Calculated RMAC :", respMac, signatureLen);
-        sss_host_mac_context_free(&macCtx);
         LOG_D("Verify MAC");
         // Do a comparison of the received and the calculated mac
-        compareoffset = *pRspBufLen - SCP_COMMAND_MAC_SIZE - SCP_GP_SW_LEN;
-
-        if (memcmp(respMac, &rspBuf[compareoffset], SCP_COMMAND_MAC_SIZE) != 0) {
+        if (memcmp(respMac, &rspBuf[dataLen], SCP_COMMAND_MAC_SIZE) != 0) {
             LOG_E(" RESPONSE MAC DID NOT VERIFY %04X", status);
             return status;
         }
@@ -186,34 +702,21 @@ uint16_t nxpSCP03_Decrypt_ResponseAPDU(
     // Decrypt Response Data Field in case Reponse Mac verified OK
     if (*pRspBufLen > (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN)) {
         // There is data payload in response
-        size_t dataLen = 0;
-        if (*pRspBufLen > (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN)) {
-            memcpy(response, rspBuf, (*pRspBufLen) - (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN));
-            //LOG_MAU8_D(" EncResponse", response, (*pRspBufLen) - 10);
-        }
-        memcpy(sw, &(rspBuf[*pRspBufLen - SCP_GP_SW_LEN]), SCP_GP_SW_LEN);
         LOG_MAU8_D("Status Word: ", sw, 2);
 
         // Calculate ICV to decrypt the response
         sss_status = nxpSCP03_Get_ResponseICV(pdySCP03SessCtx, pIv, cmdBufLen == 0 ? FALSE : TRUE);
         ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
 
-        sss_status = sss_host_symmetric_context_init(
-            &symm, pdySCP03SessCtx->Enc.keyStore->session, &pdySCP03SessCtx->Enc, algorithm_aes, mode_aes);
-        ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-        dataLen = (*pRspBufLen) - (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN);
         LOG_D("Decrypt the response");
-        // Decrypt the response
-        sss_status = sss_host_cipher_one_go(&symm, pIv, SCP_KEY_SIZE, response, plaintextResponse, dataLen);
+        // Decrypt the response, in place
+        sss_status = nxScp03_AesCbc(pdySCP03SessCtx, kMode_SSS_Decrypt, pIv, rspBuf, rspBuf, dataLen);
         ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
 
-        LOG_MAU8_D("PlainText", plaintextResponse, (*pRspBufLen) - (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN));
-        sss_host_symmetric_context_free(&symm);
-        actualRespLen = (*pRspBufLen) - (SCP_COMMAND_MAC_SIZE + SCP_GP_SW_LEN);
-        /*Remove the padding from the plaintextResponse*/
+        LOG_MAU8_D("PlainText", rspBuf, dataLen);
+        /*Remove the padding from the plaintext response*/
         sss_status = kStatus_SSS_Fail;
-        status = nxpSCP03_RestoreSw_RAPDU(rspBuf, pRspBufLen, plaintextResponse, actualRespLen, sw);
+        status = nxpSCP03_RestoreSw_RAPDU(rspBuf, pRspBufLen, dataLen, sw);
         if (status == SCP_OK) {
             sss_status = kStatus_SSS_Success;
         }
@@ -239,8 +742,7 @@ exit:
     return status;
 }
 
-static uint16_t nxpSCP03_RestoreSw_RAPDU(
-    uint8_t *rspBuf, size_t *pRspBufLen, uint8_t *plaintextResponse, size_t plaintextRespLen, uint8_t *sw)
+static uint16_t nxpSCP03_RestoreSw_RAPDU(uint8_t *rspBuf, size_t *pRspBufLen, size_t plaintextRespLen, uint8_t *sw)
 {
     uint16_t status = SCP_DECODE_FAIL;
     size_t i;
@@ -249,7 +751,6 @@ static uint16_t nxpSCP03_RestoreSw_RAPDU(
     i = plaintextRespLen;
 
     ENSURE_OR_GO_EXIT(pRspBufLen != NULL);
-    ENSURE_OR_GO_EXIT(plaintextResponse != NULL);
     ENSURE_OR_GO_EXIT(rspBuf != NULL);
     ENSURE_OR_GO_EXIT(sw != NULL);
     ENSURE_OR_GO_EXIT(plaintextRespLen >= SCP_KEY_SIZE);
@@ -257,13 +758,12 @@ static uint16_t nxpSCP03_RestoreSw_RAPDU(
     LOG_D("FN: %s", __FUNCTION__);
 
     while ((i > 1) && (i > (plaintextRespLen - SCP_KEY_SIZE))) {
-        if (plaintextResponse[i - 1] == 0x00) {
+        if (rspBuf[i - 1] == 0x00) {
             i--;
         }
-        else if (plaintextResponse[i - 1] == SCP_DATA_PAD_BYTE) {
-            // We have found padding delimitor
-            memcpy(&plaintextResponse[i - 1], sw, SCP_GP_SW_LEN);
-            memcpy(rspBuf, plaintextResponse, i + 1);
+        else if (rspBuf[i - 1] == SCP_DATA_PAD_BYTE) {
+            // We have found padding delimitor, the SW replaces it
+            memcpy(&rspBuf[i - 1], sw, SCP_GP_SW_LEN);
             *pRspBufLen = (i + 1);
             removePaddingOk = 1;
             LOG_MAU8_D("PlainText+SW", rspBuf, *pRspBufLen);
@@ -290,7 +790,6 @@ static sss_status_t nxpSCP03_Get_ResponseICV(NXSCP03_DynCtx_t *pdySCP03SessCtx,
     uint8_t ivZero[SCP_IV_SIZE] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
     sss_status_t status = kStatus_SSS_Fail;
-    sss_symmetric_t symm;
     size_t dataLen = 0;
     uint8_t paddedCounterBlock[SCP_IV_SIZE] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
@@ -306,15 +805,8 @@ static sss_status_t nxpSCP03_Get_ResponseICV(NXSCP03_DynCtx_t *pdySCP03SessCtx,
 
     LOG_MAU8_D(" Input:Data", paddedCounterBlock, SCP_KEY_SIZE);
 
-    status = sss_host_symmetric_context_init(&symm,
-        pdySCP03SessCtx->Enc.keyStore->session,
-        &pdySCP03SessCtx->Enc,
-        kAlgorithm_SSS_AES_CBC,
-        kMode_SSS_Encrypt);
-    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
     dataLen = SCP_KEY_SIZE;
-    status = sss_host_cipher_one_go(&symm, ivZero, SCP_KEY_SIZE, paddedCounterBlock, pIcv, dataLen);
-    sss_host_symmetric_context_free(&symm);
+    status = nxScp03_AesCbc(pdySCP03SessCtx, kMode_SSS_Encrypt, ivZero, paddedCounterBlock, pIcv, dataLen);
     ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
     LOG_MAU8_D(" Output:RespICV", pIcv, dataLen);
 exit:
@@ -363,32 +855,15 @@ sss_status_t nxpSCP03_CalculateMac_CommandAPDU(
     NXSCP03_DynCtx_t *pdySCP03SessCtx, uint8_t *pCmdBuf, size_t cmdBufLen, uint8_t *mac, size_t *macLen)
 {
     sss_status_t sss_status = kStatus_SSS_Fail;
-    sss_mac_t macCtx;
-    sss_algorithm_t algorithm = kAlgorithm_SSS_CMAC_AES;
-    sss_mode_t mode = kMode_SSS_Mac;
 
     ENSURE_OR_GO_EXIT(pdySCP03SessCtx != NULL);
     ENSURE_OR_GO_EXIT(mac != NULL);
     LOG_D("FN: %s", __FUNCTION__);
     LOG_MAU8_D("Input: cmdBuf", pCmdBuf, cmdBufLen);
 
-    sss_status =
-        sss_host_mac_context_init(&macCtx, pdySCP03SessCtx->Mac.keyStore->session, &pdySCP03SessCtx->Mac, algorithm, mode);
-    ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-    sss_status = sss_host_mac_init(&macCtx);
-    ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-    sss_status = sss_host_mac_update(&macCtx, pdySCP03SessCtx->MCV, SCP_KEY_SIZE);
-    ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-    sss_status = sss_host_mac_update(&macCtx, pCmdBuf, cmdBufLen);
-    ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
-
-    sss_status = sss_host_mac_finish(&macCtx, mac, macLen);
+    sss_status = nxScp03_Cmac(pdySCP03SessCtx, FALSE, pCmdBuf, cmdBufLen, NULL, 0, mac, macLen);
     ENSURE_OR_GO_EXIT(sss_status == kStatus_SSS_Success);
     LOG_MAU8_D("Output: mac", mac, SCP_COMMAND_MAC_SIZE);
-    sss_host_mac_context_free(&macCtx);
     // Store updated mcv!
     memcpy(pdySCP03SessCtx->MCV, mac, SCP_MCV_LEN);
 
@@ -401,48 +876,14 @@ static sss_status_t nxSCP03_Calculate_CommandICV(NXSCP03_DynCtx_t *pdySCP03SessC
     uint8_t ivZero[SCP_KEY_SIZE] = {
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
     sss_status_t status = kStatus_SSS_Fail;
-    sss_symmetric_t symm;
     size_t dataLen = 0;
 
     ENSURE_OR_GO_EXIT(pdySCP03SessCtx != NULL);
     LOG_D("FN: %s", __FUNCTION__);
 
-
-    status = sss_host_symmetric_context_init(&symm,
-        pdySCP03SessCtx->Enc.keyStore->session,
-        &pdySCP03SessCtx->Enc,
-        kAlgorithm_SSS_AES_CBC,
-        kMode_SSS_Encrypt);
-    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
-
     dataLen = SCP_KEY_SIZE;
-    status = sss_host_cipher_one_go(&symm, ivZero, SCP_KEY_SIZE, pdySCP03SessCtx->cCounter, pIcv, dataLen);
-    sss_host_symmetric_context_free(&symm);
+    status = nxScp03_AesCbc(pdySCP03SessCtx, kMode_SSS_Encrypt, ivZero, pdySCP03SessCtx->cCounter, pIcv, dataLen);
     LOG_MAU8_D(" Output:", pIcv, SCP_COMMAND_MAC_SIZE);
 exit:
     return status;
 }
-
-static void nxSCP03_PadCommandAPDU(uint8_t *cmdBuf, size_t *pCmdBufLen)
-{
-    uint16_t zeroBytesToPad = 0;
-
-    ENSURE_OR_GO_EXIT(pCmdBufLen != NULL);
-    ENSURE_OR_GO_EXIT(cmdBuf != NULL);
-    LOG_D("FN: %s", __FUNCTION__);
-    LOG_MAU8_D("Input: cmdBuf", cmdBuf, *pCmdBufLen);
-    // pad the payload and adjust the length of the APDU
-    cmdBuf[(*pCmdBufLen)] = SCP_DATA_PAD_BYTE;
-    *pCmdBufLen += 1;
-    zeroBytesToPad = (SCP_KEY_SIZE - ((*pCmdBufLen) % SCP_KEY_SIZE)) % SCP_KEY_SIZE;
-
-    while ((zeroBytesToPad > 0) && ((size_t)(*pCmdBufLen) < (size_t)(1 << ((sizeof(size_t) * 4) - 1)))) {
-        cmdBuf[(*pCmdBufLen)] = 0x00;
-        *pCmdBufLen += 1;
-        zeroBytesToPad--;
-    }
-    LOG_MAU8_D("Ouput: cmdBuf", cmdBuf, *pCmdBufLen);
-
-exit:
-    return;
-}
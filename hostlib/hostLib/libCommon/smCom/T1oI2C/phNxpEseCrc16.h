@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \addtogroup ISO7816-3_protocol_lib
+ * \brief CRC-16/X.25 of the T=1 epilogue field
+ *
+ * The CRC can be computed in one go with phNxpEseCrc16_Compute, or folded in
+ * while a frame is built with phNxpEseCrc16_Init / phNxpEseCrc16_Update /
+ * phNxpEseCrc16_Final.
+ *
+ * @{ */
+#ifndef _PHNXPESECRC16_H_
+#define _PHNXPESECRC16_H_
+
+#include <phEseTypes.h>
+#include "sm_types.h"
+
+/*!
+ * \brief Process 4 bytes per step with 4 lookup tables (2 KB instead of 512 bytes).
+ * Roughly 3 times faster than the single table on a PC. Embedded targets keep
+ * the smaller table by default.
+ */
+#ifndef PH_ESE_CRC16_SLICE_BY_4
+#if AX_EMBEDDED
+#define PH_ESE_CRC16_SLICE_BY_4 0
+#else
+#define PH_ESE_CRC16_SLICE_BY_4 1
+#endif
+#endif
+
+/*!
+ * \brief Initial value of a running CRC
+ */
+#define PH_ESE_CRC16_INIT 0xFFFF
+
+/*!
+ * \brief Start a running CRC
+ */
+#define phNxpEseCrc16_Init() ((uint16_t)PH_ESE_CRC16_INIT)
+
+uint16_t phNxpEseCrc16_Update(uint16_t crc, const uint8_t *p_buff, uint32_t length);
+uint16_t phNxpEseCrc16_UpdateCopy(uint16_t crc, uint8_t *p_dest, const uint8_t *p_src, uint32_t length);
+uint16_t phNxpEseCrc16_Final(uint16_t crc);
+uint16_t phNxpEseCrc16_Compute(const uint8_t *p_buff, uint32_t length);
+
+/** @} */
+#endif /* _PHNXPESECRC16_H_ */
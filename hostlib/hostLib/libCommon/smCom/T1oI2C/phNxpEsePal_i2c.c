@@ -46,6 +46,17 @@
 
 #define MAX_RETRY_CNT 10
 
+/* Optional platform hook for the data ready line of the SE */
+static phPalEse_DataReadyWait_t gfpDataReadyWait = NULL;
+
+/* Time stamp of the end of the last read or write, for ESE_WRITE_GUARD_US */
+static uint64_t gLastAccessTimeUs = 0;
+
+/* PH_PAL_ESE_LINK_* seen since the last phPalEse_i2c_take_link_events */
+static uint8_t gLinkEvents = 0;
+
+static void phPalEse_i2c_guard(void);
+
 /*******************************************************************************
 **
 ** Function         phPalEse_i2c_close
@@ -137,6 +148,7 @@ int phPalEse_i2c_read(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToRead)
     //sm_sleep(ESE_POLL_DELAY_MS);
     while (numRead != nNbBytesToRead) {
         ret = axI2CRead(pDevHandle, I2C_BUS_0, SMCOM_I2C_ADDRESS, pBuffer, nNbBytesToRead);
+        gLastAccessTimeUs = sm_get_time_us();
         if (ret != I2C_OK) {
             LOG_D("_i2c_read() error : %d ", ret);
             if ((ret == I2C_NACK_ON_ADDRESS) && (retryCount < MAX_RETRY_COUNT)) {
@@ -151,6 +163,7 @@ int phPalEse_i2c_read(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToRead)
         }
         else {
             numRead = nNbBytesToRead;
+            gLinkEvents |= PH_PAL_ESE_LINK_RX;
             break;
         }
     }
@@ -177,9 +190,10 @@ int phPalEse_i2c_write(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToWrite)
     int numWrote = 0;
     pBuffer[0] = 0x5A; //Recovery if stack forgot to add NAD byte.
     do {
-        /* 1ms delay to give ESE polling delay */
-        sm_sleep(ESE_POLL_DELAY_MS);
+        /* Guard time to give ESE polling delay */
+        phPalEse_i2c_guard();
         ret = axI2CWrite(pDevHandle, I2C_BUS_0, SMCOM_I2C_ADDRESS, pBuffer, nNbBytesToWrite);
+        gLastAccessTimeUs = sm_get_time_us();
         if (ret != I2C_OK) {
             LOG_D("_i2c_write() error : %d ", ret);
             if ((ret == I2C_NACK_ON_ADDRESS) && (retryCount < MAX_RETRY_COUNT)) {
@@ -190,6 +204,9 @@ int phPalEse_i2c_write(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToWrite)
                 LOG_D("_i2c_write() failed. Going to retry, counter:%d  !", retryCount);
                 continue;
             }
+            if (ret != I2C_NACK_ON_ADDRESS) {
+                gLinkEvents |= PH_PAL_ESE_LINK_FAULT;
+            }
             return -1;
         }
         else {
@@ -200,3 +217,106 @@ int phPalEse_i2c_write(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToWrite)
     } while (ret != I2C_OK);
     return numWrote;
 }
+
+/*******************************************************************************
+**
+** Function         phPalEse_i2c_take_link_events
+**
+** Description      Returns the PH_PAL_ESE_LINK_* seen since the last call and
+**                  clears them. Tells an SE that does not answer at all, e.g.
+**                  still booting, from one that answers wrongly.
+**
+** Returns          PH_PAL_ESE_LINK_* bits
+**
+*******************************************************************************/
+uint8_t phPalEse_i2c_take_link_events(void)
+{
+    uint8_t events = gLinkEvents;
+
+    gLinkEvents = 0;
+    return events;
+}
+
+/*******************************************************************************
+**
+** Function         phPalEse_i2c_guard_left_us
+**
+** Description      Time until ESE_WRITE_GUARD_US have passed since the last
+**                  access to the ESE. A write before then waits for it.
+**
+** Returns          Micro seconds, 0 if a write can go out at once
+**
+*******************************************************************************/
+uint32_t phPalEse_i2c_guard_left_us(void)
+{
+    uint64_t idleUs = sm_get_time_us() - gLastAccessTimeUs;
+
+    if (idleUs >= ESE_WRITE_GUARD_US) {
+        return 0;
+    }
+    return (uint32_t)(ESE_WRITE_GUARD_US - idleUs);
+}
+
+/*******************************************************************************
+**
+** Function         phPalEse_i2c_guard
+**
+** Description      Waits until ESE_WRITE_GUARD_US have passed since the last
+**                  access to the ESE
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phPalEse_i2c_guard(void)
+{
+    uint32_t leftUs = phPalEse_i2c_guard_left_us();
+
+    if (leftUs == 0) {
+        return;
+    }
+#if defined(__gnu_linux__)
+    sm_usleep(leftUs);
+#else
+    /* Without sub milli second sleep, wait as before */
+    sm_sleep(ESE_POLL_DELAY_MS);
+#endif
+}
+
+/*******************************************************************************
+**
+** Function         phPalEse_i2c_set_data_ready_hook
+**
+** Description      Installs the platform specific wait on the SE data ready
+**                  (IRQ) line. Pass NULL to remove the hook.
+**
+** param[in]       fpWait           - platform wait function
+**
+** Returns          None
+**
+*******************************************************************************/
+void phPalEse_i2c_set_data_ready_hook(phPalEse_DataReadyWait_t fpWait)
+{
+    gfpDataReadyWait = fpWait;
+}
+
+/*******************************************************************************
+**
+** Function         phPalEse_i2c_wait_data_ready
+**
+** Description      Waits until the SE signals a response on the data ready line
+**
+** param[in]       pDevHandle       - valid device handle
+** param[in]       timeout_us       - max time to wait in micro seconds
+**
+** Returns          1         - SE has data ready
+**                  0         - timeout
+**                  -1        - no data ready line available on this platform
+**
+*******************************************************************************/
+int phPalEse_i2c_wait_data_ready(void *pDevHandle, uint32_t timeout_us)
+{
+    if (gfpDataReadyWait == NULL) {
+        return -1;
+    }
+    return gfpDataReadyWait(pDevHandle, timeout_us);
+}
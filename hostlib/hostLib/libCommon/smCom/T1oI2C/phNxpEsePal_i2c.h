@@ -29,6 +29,28 @@
  * \brief ESE Poll timeout (min 1 miliseconds)
  */
 #define ESE_POLL_DELAY_MS (1)
+/*!
+ * \brief Min. time (micro seconds) between the end of the last access to the
+ * ESE and the start of a write. Only waited for when the bus was used more
+ * recently than that.
+ */
+#ifndef ESE_WRITE_GUARD_US
+#define ESE_WRITE_GUARD_US (ESE_POLL_DELAY_MS * 1000u)
+#endif
+/*!
+ * \brief Fine grained poll delay (micro seconds) used by the adaptive wait
+ * once the expected processing time of a command has (nearly) elapsed.
+ */
+#ifndef ESE_POLL_FINE_DELAY_US
+#define ESE_POLL_FINE_DELAY_US (200)
+#endif
+/*!
+ * \brief Max time (milli seconds) to wait on the data ready line
+ * before falling back to NAD polling. Matches the max WTX timeout.
+ */
+#ifndef ESE_DATA_READY_TIMEOUT_MS
+#define ESE_DATA_READY_TIMEOUT_MS (1000)
+#endif
 /*!
  * \brief ESE Poll timeout.
  * As Max WTX timeout is 1sec, select ESE_NAD_POLLING_MAX count in such a way that WTX request frm SE is not skiped
@@ -73,6 +95,34 @@
 // #define I2C_MASTER_SLAVE_ADDR_7BIT (0x90U >> 1)  //slve bit address is 20U but driver do right shift so set to 40U
 #define SMCOM_I2C_ADDRESS           (0x90)
 
+/*!
+ * \ingroup eSe_PAL_I2C
+ *
+ * \brief Platform hook to wait on the "data ready" (IRQ) line of the SE.
+ *
+ * \param pDevHandle   device handle as returned by phPalEse_i2c_open_and_configure
+ * \param timeout_us   max time to wait in micro seconds
+ *
+ * \return 1 when the SE signals a response is available, 0 on timeout.
+ */
+typedef int (*phPalEse_DataReadyWait_t)(void *pDevHandle, uint32_t timeout_us);
+
+/*!
+ * \ingroup eSe_PAL_I2C
+ *
+ * \brief phPalEse_i2c_take_link_events: a read returned data from the SE
+ */
+#define PH_PAL_ESE_LINK_RX 0x01
+
+/*!
+ * \ingroup eSe_PAL_I2C
+ *
+ * \brief phPalEse_i2c_take_link_events: a write failed other than by a NACK
+ * on the address. Failed reads are not counted, the SE NACKs reads while it
+ * has nothing to send.
+ */
+#define PH_PAL_ESE_LINK_FAULT 0x02
+
 /*!
  * \ingroup eSe_PAL_I2C
  *
@@ -106,5 +156,9 @@ void phPalEse_i2c_close(void *pDevHandle);
 ESESTATUS phPalEse_i2c_open_and_configure(pphPalEse_Config_t pConfig);
 int phPalEse_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead);
 int phPalEse_i2c_write(void *pDevHandle,uint8_t * pBuffer, int nNbBytesToWrite);
+void phPalEse_i2c_set_data_ready_hook(phPalEse_DataReadyWait_t fpWait);
+uint8_t phPalEse_i2c_take_link_events(void);
+uint32_t phPalEse_i2c_guard_left_us(void);
+int phPalEse_i2c_wait_data_ready(void *pDevHandle, uint32_t timeout_us);
 /** @} */
 #endif  /*  _PHNXPESE_PAL_I2C_H    */
@@ -15,9 +15,11 @@
  */
 #include <phNxpEseProto7816_3.h>
 #include <phNxpEsePal_i2c.h>
+#include <phNxpEseCrc16.h>
 #include <phEseTypes.h>
 #include "sm_types.h"
 #include "sm_timer.h"
+#include "sm_metrics.h"
 #include "se05x_const.h"
 #include <limits.h>
 
@@ -35,6 +37,32 @@
 
 phNxpEseProto7816_t phNxpEseProto7816_3_Var;
 
+#if PH_PROTO_7816_IFRAME_PREBUILD
+/* Next chained I-frame, framed while the ESE processes the current one */
+static struct
+{
+    uint8_t frame[MAX_DATA_LEN];
+    uint32_t frameLen; /* 0 if no frame is prebuilt */
+    uint8_t *p_data;
+    uint32_t dataOffset;
+    uint32_t sendDataLen;
+    uint8_t seqNo;
+    bool_t isChained;
+} phNxpEseProto7816_NextIframe;
+#endif
+
+/* Response of the exchange driven by phNxpEseProto7816_TransceiveStep, and its buffer size */
+static phNxpEse_data *phNxpEseProto7816_AsyncRsp;
+static uint32_t phNxpEseProto7816_AsyncRspLen;
+
+/* Delay before the next frame may be sent (recovery back-off, WTX) */
+static struct
+{
+    uint32_t delayUs;
+    uint64_t setAtUs;
+    bool_t recovery; /* Spent as SM_METRICS_PHASE_T1_RECOVERY */
+} phNxpEseProto7816_TxDelay;
+
 /******************************************************************************
 \section Introduction Introduction
 
@@ -51,12 +79,32 @@ static bool_t phNxpEseProto7816_SendIframe(void* conn_ctx, iFrameInfo_t iFrameDa
 static bool_t phNxpEseProto7816_sendRframe(void* conn_ctx, rFrameTypes_t rFrameType);
 static bool_t phNxpEseProto7816_SetFirstIframeContxt(void);
 static bool_t phNxpEseProto7816_SetNextIframeContxt(void);
+static bool_t phNxpEseProto7816_GetNextIframe(const iFrameInfo_t *pLastIframe, iFrameInfo_t *pNextIframe);
+static uint32_t phNxpEseProto7816_BuildIframe(const iFrameInfo_t *pIframe, uint8_t *p_framebuff);
+#if PH_PROTO_7816_IFRAME_PREBUILD
+static void phNxpEseProto7816_PrebuildNextIframe(void);
+#endif
+static uint16_t phNxpEseProto7816_DecodeIfs(uint8_t *p_data, uint32_t data_len);
+static void phNxpEseProto7816_UpdateIfsc(uint16_t ifsc);
+#if PH_PROTO_7816_IFS_NEGOTIATE
+static uint16_t phNxpEseProto7816_GetIfscFromAtr(phNxpEse_data *pAtr);
+static bool_t phNxpEseProto7816_NegotiateIfs(void* conn_ctx, phNxpEse_data *pAtr);
+#endif
 static bool_t phNxpEseProro7816_SaveRxframeData(uint8_t *p_data, uint32_t data_len);
 static bool_t phNxpEseProto7816_ResetRecovery(void);
 static bool_t phNxpEseProto7816_RecoverySteps(void);
+static void phNxpEseProto7816_RecoveryBackoff(uint32_t retries);
+static void phNxpEseProto7816_SetTxDelay(uint32_t delayUs, bool_t recovery);
+static uint32_t phNxpEseProto7816_TxDelayLeftUs(void);
+static void phNxpEseProto7816_WaitTxDelay(void);
 static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len);
+static bool_t phNxpEseProto7816_ProcessRawFrame(void* conn_ctx, bool_t rxStatus, uint32_t data_len, uint8_t *p_data);
 static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx);
+static bool_t phNxpEseProto7816_SendNextFrame(void* conn_ctx);
 static bool_t TransceiveProcess(void* conn_ctx);
+static bool_t phNxpEseProto7816_TransceiveBegin(phNxpEse_data *pCmd, phNxpEse_data *pRsp);
+static bool_t phNxpEseProto7816_TransceiveEnd(bool_t status, phNxpEse_data *pRsp, uint32_t reqDataLen);
+static bool_t phNxpEseProto7816_AsyncSendNext(void* conn_ctx, bool_t status, bool_t *pComplete, uint32_t *pDelayUs);
 static bool_t phNxpEseProto7816_RSync(void* conn_ctx);
 
 /******************************************************************************
@@ -125,32 +173,11 @@ static bool_t phNxpEseProto7816_GetRawFrame(void* conn_ctx, uint32_t *data_len,
 static uint16_t phNxpEseProto7816_ComputeCRC(unsigned char *p_buff, uint32_t offset,
         uint32_t length)
 {
-    uint16_t CAL_CRC = 0xFFFF, CRC = 0x0000;
-    uint32_t i = 0;
+    uint16_t CRC = 0x0000;
 
     ENSURE_OR_GO_EXIT(p_buff != NULL);
-    for (i = offset; i < length; i++)
-    {
-        CAL_CRC ^= p_buff[i];
-        for (int bit = 8; bit > 0; --bit)
-        {
-            if ((CAL_CRC & 0x0001) == 0x0001)
-            {
-                CAL_CRC = (unsigned short)((CAL_CRC >> 1) ^ 0x8408);
-            }
-            else
-            {
-                CAL_CRC >>= 1;
-            }
-        }
-
-    }
-    CAL_CRC ^=0xFFFF;
-#if defined(T1oI2C_UM11225)
-    CRC = ((CAL_CRC & 0xFF) << 8) | ((CAL_CRC >> 8) & 0xFF);
-#elif defined(T1oI2C_GP1_0)
-    CRC = CAL_CRC;
-#endif
+    ENSURE_OR_GO_EXIT(offset <= length);
+    CRC = phNxpEseCrc16_Compute(&p_buff[offset], (length - offset));
 exit:
     return (uint16_t) CRC;
 }
@@ -226,8 +253,9 @@ static bool_t phNxpEseProto7816_SendSFrame(void* conn_ctx, sFrameInfo_t sFrameDa
 {
     bool_t status = ESESTATUS_FAILED;
     uint32_t frame_len = 0;
-    uint8_t p_framebuff[7] = {0};
+    uint8_t p_framebuff[8] = {0};
     uint8_t pcb_byte = 0;
+    uint8_t inf_len = 0;
     sFrameInfo_t sframeData = sFrameData;
     uint16_t calc_crc=0;
     /* This update is helpful in-case a R-NACK is transmitted from the MW */
@@ -235,6 +263,7 @@ static bool_t phNxpEseProto7816_SendSFrame(void* conn_ctx, sFrameInfo_t sFrameDa
     switch(sframeData.sFrameType)
     {
         case RESYNCH_REQ:
+            SM_METRICS_EVENT(SM_METRICS_EV_T1_RESYNC);
             frame_len = (PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN);
             p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] = 0;
 #if defined(T1oI2C_GP1_0)
@@ -248,6 +277,7 @@ static bool_t phNxpEseProto7816_SendSFrame(void* conn_ctx, sFrameInfo_t sFrameDa
             break;
 #if defined(T1oI2C_UM11225)
         case INTF_RESET_REQ:
+            SM_METRICS_EVENT(SM_METRICS_EV_T1_INTF_RESET);
             frame_len = (PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN);
             p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] = 0;
             p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET] = 0x00;
@@ -273,6 +303,7 @@ static bool_t phNxpEseProto7816_SendSFrame(void* conn_ctx, sFrameInfo_t sFrameDa
             break;
 #endif
         case WTX_RSP:
+            SM_METRICS_EVENT(SM_METRICS_EV_T1_WTX);
             frame_len = (PH_PROTO_7816_HEADER_LEN + 1 + PH_PROTO_7816_CRC_LEN);
 #if defined(T1oI2C_UM11225)
             /* T =1 UM11225 SE050 block format LEN field is of 2 byte*/
@@ -287,6 +318,28 @@ static bool_t phNxpEseProto7816_SendSFrame(void* conn_ctx, sFrameInfo_t sFrameDa
             pcb_byte |= PH_PROTO_7816_S_BLOCK_RSP;
             pcb_byte |= PH_PROTO_7816_S_WTX;
             break;
+        case IFSC_REQ:
+        case IFSC_RES:
+            /* IFS is coded on 2 bytes only if it does not fit in 1 byte */
+            inf_len = (sframeData.ifs > 0xFE) ? 2 : 1;
+            frame_len = (PH_PROTO_7816_HEADER_LEN + inf_len + PH_PROTO_7816_CRC_LEN);
+#if defined(T1oI2C_UM11225)
+            p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] = inf_len;
+#elif defined(T1oI2C_GP1_0)
+            p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] = 0x00;
+            p_framebuff[PH_PROPTO_7816_LEN_LOWER_OFFSET] = inf_len;
+#endif
+            if (inf_len == 2) {
+                p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET] = (sframeData.ifs >> 8) & 0xFF;
+                p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET + 1] = sframeData.ifs & 0xFF;
+            }
+            else {
+                p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET] = sframeData.ifs & 0xFF;
+            }
+
+            pcb_byte |= (sframeData.sFrameType == IFSC_REQ) ? PH_PROTO_7816_S_BLOCK_REQ : PH_PROTO_7816_S_BLOCK_RSP;
+            pcb_byte |= PH_PROTO_7816_S_IFS;
+            break;
 #if defined(T1oI2C_UM11225)
         case CHIP_RESET_REQ:
             frame_len = (PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN);
@@ -376,6 +429,7 @@ static  bool_t phNxpEseProto7816_sendRframe(void* conn_ctx, rFrameTypes_t rFrame
     rFrameInfo_t *pNextTx_RframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.RframeInfo;
     if(RNACK == rFrameType) /* R-NACK */
     {
+        SM_METRICS_EVENT(SM_METRICS_EV_T1_RNACK_TX);
         switch(pNextTx_RframeInfo->errCode)
         {
         case PARITY_ERROR:
@@ -412,65 +466,145 @@ static  bool_t phNxpEseProto7816_sendRframe(void* conn_ctx, rFrameTypes_t rFrame
 }
 
 /******************************************************************************
- * Function         phNxpEseProto7816_SendIframe
+ * Function         phNxpEseProto7816_BuildIframe
  *
- * Description      This internal function is called to send I-frame with all
- *                   updated 7816-3 headers
+ * Description      This internal function is called to frame an I-frame with all
+ *                   updated 7816-3 headers and the CRC
  *
- * param[in]        sFrameInfo_t: Info about I frame
+ * param[in]        iFrameInfo_t: Info about I frame
+ * param[out]       uint8_t: frame buffer of MAX_DATA_LEN bytes
  *
- * Returns          On success return TRUE or else FALSE.
+ * Returns          Length of the frame.
  *
  ******************************************************************************/
-static bool_t phNxpEseProto7816_SendIframe(void* conn_ctx, iFrameInfo_t iFrameData)
+static uint32_t phNxpEseProto7816_BuildIframe(const iFrameInfo_t *pIframe, uint8_t *p_framebuff)
 {
-    bool_t status = FALSE;
     uint32_t frame_len = 0;
-    uint8_t p_framebuff[MAX_DATA_LEN];
     uint8_t pcb_byte = 0;
     uint16_t calc_crc = 0;
-    iFrameInfo_t *pNextTx_IframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo;
 
-    if (0 == iFrameData.sendDataLen)
-    {
-        LOG_E("%s Line: [%d] I frame Len is 0, INVALID ",__FUNCTION__,__LINE__);
-        return FALSE;
-    }
-    /* This update is helpful in-case a R-NACK is transmitted from the MW */
-    phNxpEseProto7816_3_Var.lastSentNonErrorframeType = IFRAME;
-    frame_len = (iFrameData.sendDataLen+ PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN);
+    frame_len = (pIframe->sendDataLen+ PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN);
 
     /* frame the packet */
     p_framebuff[PH_PROPTO_7816_NAD_OFFSET] = SEND_PACKET_SOF; /* NAD Byte */
 
-    if (iFrameData.isChained)
+    if (pIframe->isChained)
     {
         /* make B6 (M) bit high */
         pcb_byte |= PH_PROTO_7816_CHAINING;
     }
 
     /* Update the send seq no */
-    pcb_byte |= (pNextTx_IframeInfo->seqNo << 6);
+    pcb_byte |= (pIframe->seqNo << 6);
 
     /* store the pcb byte */
     p_framebuff[PH_PROPTO_7816_PCB_OFFSET] = pcb_byte;
 #if defined(T1oI2C_UM11225)
     /* store I frame length */
     /* for T1oI2C_UM11225 LEN field is of 1 byte*/
-    p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] =iFrameData.sendDataLen;
+    p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] =pIframe->sendDataLen;
 #elif defined(T1oI2C_GP1_0)
     /* store I frame length */
     /* for T1oI2C_GP1_0 LEN field is of 2 byte*/
-    p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] =(((uint16_t)iFrameData.sendDataLen) >> 8 & 0xff);
-    p_framebuff[PH_PROPTO_7816_LEN_LOWER_OFFSET] =(((uint16_t)iFrameData.sendDataLen) & 0xff);
+    p_framebuff[PH_PROPTO_7816_LEN_UPPER_OFFSET] =(((uint16_t)pIframe->sendDataLen) >> 8 & 0xff);
+    p_framebuff[PH_PROPTO_7816_LEN_LOWER_OFFSET] =(((uint16_t)pIframe->sendDataLen) & 0xff);
 #endif
-    /* store I frame */
-    phNxpEse_memcpy(&(p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET]), iFrameData.p_data + iFrameData.dataOffset, iFrameData.sendDataLen);
-    calc_crc = phNxpEseProto7816_ComputeCRC(p_framebuff, 0, (frame_len - 2));
+    /* store I frame, the CRC is computed while copying the INF field */
+    calc_crc = phNxpEseCrc16_Update(phNxpEseCrc16_Init(), p_framebuff, PH_PROPTO_7816_INF_BYTE_OFFSET);
+    calc_crc = phNxpEseCrc16_UpdateCopy(calc_crc,
+        &(p_framebuff[PH_PROPTO_7816_INF_BYTE_OFFSET]),
+        pIframe->p_data + pIframe->dataOffset,
+        pIframe->sendDataLen);
+    calc_crc = phNxpEseCrc16_Final(calc_crc);
 
     p_framebuff[frame_len - 2] = (calc_crc >> 8) & 0xff;
     p_framebuff[frame_len - 1] = calc_crc & 0xff;
-    status = phNxpEseProto7816_SendRawFrame(conn_ctx, frame_len, p_framebuff);
+    return frame_len;
+}
+
+#if PH_PROTO_7816_IFRAME_PREBUILD
+/******************************************************************************
+ * Function         phNxpEseProto7816_PrebuildNextIframe
+ *
+ * Description      This internal function is called after a chained I-frame is
+ *                  sent, to frame the next one while the ESE processes it.
+ *                  phNxpEseProto7816_SendIframe() sends the prebuilt frame if
+ *                  the R-ACK leads to the same next I-frame.
+ *
+ * param[in]        void
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEseProto7816_PrebuildNextIframe(void)
+{
+    iFrameInfo_t nextIframe = phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.IframeInfo;
+    iFrameInfo_t *pLastTx_IframeInfo = &phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.IframeInfo;
+
+    if ((FALSE == pLastTx_IframeInfo->isChained) ||
+        (FALSE == phNxpEseProto7816_GetNextIframe(pLastTx_IframeInfo, &nextIframe)))
+    {
+        return;
+    }
+    if ((phNxpEseProto7816_NextIframe.frameLen != 0) &&
+        (phNxpEseProto7816_NextIframe.dataOffset == nextIframe.dataOffset) &&
+        (phNxpEseProto7816_NextIframe.seqNo == nextIframe.seqNo))
+    {
+        /* Re-transmission of the current frame, the next one is ready */
+        return;
+    }
+    phNxpEseProto7816_NextIframe.frameLen = phNxpEseProto7816_BuildIframe(&nextIframe, phNxpEseProto7816_NextIframe.frame);
+    phNxpEseProto7816_NextIframe.p_data = nextIframe.p_data;
+    phNxpEseProto7816_NextIframe.dataOffset = nextIframe.dataOffset;
+    phNxpEseProto7816_NextIframe.sendDataLen = nextIframe.sendDataLen;
+    phNxpEseProto7816_NextIframe.seqNo = nextIframe.seqNo;
+    phNxpEseProto7816_NextIframe.isChained = nextIframe.isChained;
+}
+#endif
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_SendIframe
+ *
+ * Description      This internal function is called to send I-frame with all
+ *                   updated 7816-3 headers
+ *
+ * param[in]        sFrameInfo_t: Info about I frame
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_SendIframe(void* conn_ctx, iFrameInfo_t iFrameData)
+{
+    bool_t status = FALSE;
+    uint32_t frame_len = 0;
+    uint8_t p_framebuff[MAX_DATA_LEN];
+    uint8_t *p_frame = p_framebuff;
+
+    if (0 == iFrameData.sendDataLen)
+    {
+        LOG_E("%s Line: [%d] I frame Len is 0, INVALID ",__FUNCTION__,__LINE__);
+        return FALSE;
+    }
+    /* This update is helpful in-case a R-NACK is transmitted from the MW */
+    phNxpEseProto7816_3_Var.lastSentNonErrorframeType = IFRAME;
+    SM_METRICS_EVENT(SM_METRICS_EV_T1_IFRAME_TX);
+#if PH_PROTO_7816_IFRAME_PREBUILD
+    if ((phNxpEseProto7816_NextIframe.frameLen != 0) &&
+        (phNxpEseProto7816_NextIframe.p_data == iFrameData.p_data) &&
+        (phNxpEseProto7816_NextIframe.dataOffset == iFrameData.dataOffset) &&
+        (phNxpEseProto7816_NextIframe.sendDataLen == iFrameData.sendDataLen) &&
+        (phNxpEseProto7816_NextIframe.seqNo == iFrameData.seqNo) &&
+        (phNxpEseProto7816_NextIframe.isChained == iFrameData.isChained))
+    {
+        p_frame = phNxpEseProto7816_NextIframe.frame;
+        frame_len = phNxpEseProto7816_NextIframe.frameLen;
+    }
+    else
+#endif
+    {
+        frame_len = phNxpEseProto7816_BuildIframe(&iFrameData, p_framebuff);
+    }
+    status = phNxpEseProto7816_SendRawFrame(conn_ctx, frame_len, p_frame);
 
     return status;
 }
@@ -497,6 +631,10 @@ static bool_t phNxpEseProto7816_SetFirstIframeContxt(void)
     pNextTx_IframeInfo->seqNo = pLastTx_IframeInfo->seqNo ^ 1;
     phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_IFRAME;
     pRx_EseCntx->pRsp->len = 0;
+#if PH_PROTO_7816_IFRAME_PREBUILD
+    /* A new command, a frame prebuilt for the previous one is stale */
+    phNxpEseProto7816_NextIframe.frameLen = 0;
+#endif
     if (pNextTx_IframeInfo->totalDataLen > pNextTx_IframeInfo->maxDataLen) {
         pNextTx_IframeInfo->isChained = TRUE;
         pNextTx_IframeInfo->sendDataLen = pNextTx_IframeInfo->maxDataLen;
@@ -531,28 +669,46 @@ static bool_t phNxpEseProto7816_SetNextIframeContxt(void)
     phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType = IFRAME;
     phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_IFRAME;
 
-    pNextTx_IframeInfo->seqNo = pLastTx_IframeInfo->seqNo ^ 1;
-    if((UINT_MAX - pLastTx_IframeInfo->dataOffset) < pLastTx_IframeInfo->maxDataLen)
+    return phNxpEseProto7816_GetNextIframe(pLastTx_IframeInfo, pNextTx_IframeInfo);
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_GetNextIframe
+ *
+ * Description      This internal function is called to get the I-frame that
+ *                  follows a chained I-frame.
+ *
+ * param[in]        iFrameInfo_t: last sent I-frame
+ * param[out]       iFrameInfo_t: next I-frame
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_GetNextIframe(const iFrameInfo_t *pLastIframe, iFrameInfo_t *pNextIframe)
+{
+    pNextIframe->seqNo = pLastIframe->seqNo ^ 1;
+    if((UINT_MAX - pLastIframe->dataOffset) < pLastIframe->sendDataLen)
     {
         return FALSE;
     }
-    pNextTx_IframeInfo->dataOffset = pLastTx_IframeInfo->dataOffset + pLastTx_IframeInfo->maxDataLen;
-    pNextTx_IframeInfo->p_data = pLastTx_IframeInfo->p_data;
-    pNextTx_IframeInfo->maxDataLen = pLastTx_IframeInfo->maxDataLen;
+    /* The IFSC may have changed since the last I-frame was sent, so continue after its data */
+    pNextIframe->dataOffset = pLastIframe->dataOffset + pLastIframe->sendDataLen;
+    pNextIframe->p_data = pLastIframe->p_data;
+    pNextIframe->maxDataLen = pLastIframe->maxDataLen;
 
     //if  chained
-    if (pLastTx_IframeInfo->totalDataLen > pLastTx_IframeInfo->maxDataLen) {
+    if (pLastIframe->totalDataLen > pLastIframe->maxDataLen) {
         LOG_D("%s Process Chained Frame ",__FUNCTION__);
-        pNextTx_IframeInfo->isChained = TRUE;
-        pNextTx_IframeInfo->sendDataLen = pLastTx_IframeInfo->maxDataLen;
-        pNextTx_IframeInfo->totalDataLen = pLastTx_IframeInfo->totalDataLen - pLastTx_IframeInfo->maxDataLen;
+        pNextIframe->isChained = TRUE;
+        pNextIframe->sendDataLen = pLastIframe->maxDataLen;
+        pNextIframe->totalDataLen = pLastIframe->totalDataLen - pLastIframe->maxDataLen;
     }
     else
     {
-        pNextTx_IframeInfo->isChained = FALSE;
-        pNextTx_IframeInfo->sendDataLen = pLastTx_IframeInfo->totalDataLen;
+        pNextIframe->isChained = FALSE;
+        pNextIframe->sendDataLen = pLastIframe->totalDataLen;
     }
-    LOG_D("I-Frame Data Len: %ld ", pNextTx_IframeInfo->sendDataLen);
+    LOG_D("I-Frame Data Len: %ld ", pNextIframe->sendDataLen);
     return TRUE;
 }
 
@@ -591,6 +747,114 @@ static bool_t phNxpEseProro7816_SaveRxframeData(uint8_t *p_data, uint32_t data_l
     }
 }
 
+/******************************************************************************
+ * Function         phNxpEseProto7816_RecoveryBackoff
+ *
+ * Description      This internal function delays a retry of the error
+ *                  recovery. Only called when a retry is sent, not when the
+ *                  recovery escalates. The first retry goes out at once, the next ones
+ *                  wait PH_PROTO_7816_RECOVERY_BASE_US doubled per retry, at
+ *                  most DELAY_ERROR_RECOVERY. The delay is spent before the
+ *                  retry is sent, see phNxpEseProto7816_SetTxDelay.
+ *
+ * param[in]        uint32_t: retries already done in this recovery
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEseProto7816_RecoveryBackoff(uint32_t retries)
+{
+    uint32_t delayUs = DELAY_ERROR_RECOVERY;
+
+    SM_METRICS_EVENT(SM_METRICS_EV_T1_RECOVERY);
+    if (retries == 0) {
+        return;
+    }
+    if (retries <= 16) {
+        delayUs = (uint32_t)PH_PROTO_7816_RECOVERY_BASE_US << (retries - 1);
+    }
+    if (delayUs > DELAY_ERROR_RECOVERY) {
+        delayUs = DELAY_ERROR_RECOVERY;
+    }
+    LOG_D("%s Retry %d after %d us ", __FUNCTION__, retries, delayUs);
+    phNxpEseProto7816_SetTxDelay(delayUs, TRUE);
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_SetTxDelay
+ *
+ * Description      This internal function holds back the next frame until
+ *                  delayUs have passed. The blocking transceive sleeps in
+ *                  phNxpEseProto7816_WaitTxDelay, the non blocking one
+ *                  returns the delay to its caller.
+ *
+ * param[in]        uint32_t: delay in micro seconds
+ * param[in]        bool_t: TRUE if it is a back-off of the error recovery
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEseProto7816_SetTxDelay(uint32_t delayUs, bool_t recovery)
+{
+    phNxpEseProto7816_TxDelay.delayUs = delayUs;
+    phNxpEseProto7816_TxDelay.setAtUs = sm_get_time_us();
+    phNxpEseProto7816_TxDelay.recovery = recovery;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_TxDelayLeftUs
+ *
+ * Description      This internal function returns the time left before the
+ *                  next frame may be sent.
+ *
+ * Returns          Micro seconds, 0 if the frame can be sent at once
+ *
+ ******************************************************************************/
+static uint32_t phNxpEseProto7816_TxDelayLeftUs(void)
+{
+    uint64_t elapsedUs = 0;
+
+    if (phNxpEseProto7816_TxDelay.delayUs == 0) {
+        return 0;
+    }
+    elapsedUs = sm_get_time_us() - phNxpEseProto7816_TxDelay.setAtUs;
+    if (elapsedUs >= phNxpEseProto7816_TxDelay.delayUs) {
+        return 0;
+    }
+    return (uint32_t)(phNxpEseProto7816_TxDelay.delayUs - elapsedUs);
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_WaitTxDelay
+ *
+ * Description      This internal function sleeps what is left of the delay
+ *                  set by phNxpEseProto7816_SetTxDelay and clears it. Rounded
+ *                  up to milli seconds where sm_usleep is not available.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEseProto7816_WaitTxDelay(void)
+{
+    uint32_t leftUs = phNxpEseProto7816_TxDelayLeftUs();
+
+    if (phNxpEseProto7816_TxDelay.delayUs == 0) {
+        return;
+    }
+    if (leftUs > 0) {
+#if defined(__gnu_linux__)
+        sm_usleep(leftUs);
+#else
+        /* Without sub milli second sleep, round up to whole milli seconds */
+        sm_sleep((leftUs + 999) / 1000);
+#endif
+    }
+    if (phNxpEseProto7816_TxDelay.recovery) {
+        SM_METRICS_PHASE(SM_METRICS_PHASE_T1_RECOVERY, NULL, phNxpEseProto7816_TxDelay.setAtUs);
+    }
+    phNxpEseProto7816_TxDelay.delayUs = 0;
+}
+
 /******************************************************************************
  * Function         phNxpEseProto7816_ResetRecovery
  *
@@ -640,6 +904,7 @@ static bool_t phNxpEseProto7816_RecoverySteps(void)
     }
     else
     { /* If recovery fails */
+        SM_METRICS_EVENT(SM_METRICS_EV_T1_RECOVERY_FAILED);
         phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
     }
     return TRUE;
@@ -750,9 +1015,9 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
         }
         else
         {
-            sm_sleep(DELAY_ERROR_RECOVERY/1000);
             if(phNxpEseProto7816_3_Var.recoveryCounter < PH_PROTO_7816_FRAME_RETRY_COUNT)
             {
+                phNxpEseProto7816_RecoveryBackoff(phNxpEseProto7816_3_Var.recoveryCounter);
                 phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType = RFRAME;
                 pNextTx_RframeInfo->errCode = OTHER_ERROR;
                 phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_R_NACK ;
@@ -787,7 +1052,7 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
             /* Error handling 2: Other indicated error */
             ((pcb_bits.lsb == 0x00) && (pcb_bits.bit2 == 0x01)))
         {
-            sm_sleep(DELAY_ERROR_RECOVERY/1000);
+            SM_METRICS_EVENT(SM_METRICS_EV_T1_RNACK_RX);
             if((pcb_bits.lsb == 0x00) && (pcb_bits.bit2 == 0x01)) {
                 pRx_lastRcvdRframeInfo->errCode = OTHER_ERROR;
             }
@@ -796,6 +1061,7 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
             }
             if(phNxpEseProto7816_3_Var.recoveryCounter < PH_PROTO_7816_FRAME_RETRY_COUNT)
             {
+                phNxpEseProto7816_RecoveryBackoff(phNxpEseProto7816_3_Var.recoveryCounter);
                 if(phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.FrameType == IFRAME)
                 {
                     phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx = phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx;
@@ -849,9 +1115,9 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
         /* Error handling 3 */
         else if ((pcb_bits.lsb == 0x01) && (pcb_bits.bit2 == 0x01))
         {
-            sm_sleep(DELAY_ERROR_RECOVERY/1000);
             if(phNxpEseProto7816_3_Var.recoveryCounter < PH_PROTO_7816_FRAME_RETRY_COUNT)
             {
+                phNxpEseProto7816_RecoveryBackoff(phNxpEseProto7816_3_Var.recoveryCounter);
                 pRx_lastRcvdRframeInfo->errCode = SOF_MISSED_ERROR;
                 phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx = phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx;
                 phNxpEseProto7816_3_Var.recoveryCounter++;
@@ -881,9 +1147,28 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
                 break;
             case IFSC_RES:
                 pRx_lastRcvdSframeInfo->sFrameType = IFSC_RES;
+                pRx_lastRcvdSframeInfo->ifs = phNxpEseProto7816_DecodeIfs(p_data, data_len);
                 phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType= UNKNOWN;
                 phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE ;
                 break;
+            case IFSC_REQ:
+                /* ESE changes its IFSC, for the rest of the chain and the next commands */
+                pRx_lastRcvdSframeInfo->sFrameType = IFSC_REQ;
+                pRx_lastRcvdSframeInfo->ifs = phNxpEseProto7816_DecodeIfs(p_data, data_len);
+                if (pRx_lastRcvdSframeInfo->ifs == 0) {
+                    LOG_E("%s Invalid IFS request ", __FUNCTION__);
+                    phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType = RFRAME;
+                    pNextTx_RframeInfo->errCode = OTHER_ERROR;
+                    phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_R_NACK;
+                    break;
+                }
+                phNxpEseProto7816_UpdateIfsc(pRx_lastRcvdSframeInfo->ifs);
+                LOG_D("%s IFSC changed to %d ", __FUNCTION__, phNxpEseProto7816_3_Var.ifsc);
+                phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType= SFRAME;
+                pNextTx_SframeInfo->sFrameType = IFSC_RES;
+                pNextTx_SframeInfo->ifs = pRx_lastRcvdSframeInfo->ifs;
+                phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_S_IFS_RSP;
+                break;
             case ABORT_RES:
                 pRx_lastRcvdSframeInfo->sFrameType = ABORT_RES;
                 phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType= UNKNOWN;
@@ -930,7 +1215,7 @@ static bool_t phNxpEseProto7816_DecodeFrame(uint8_t *p_data, uint32_t data_len)
                     }
                     else
                     {
-                        sm_sleep(DELAY_ERROR_RECOVERY/1000);
+                        phNxpEseProto7816_SetTxDelay(PH_PROTO_7816_WTX_DELAY_US, FALSE);
                         pRx_lastRcvdSframeInfo->sFrameType = WTX_REQ;
                         phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType= SFRAME;
                         pNextTx_SframeInfo->sFrameType = WTX_RSP;
@@ -1045,28 +1330,30 @@ exit:
 }
 
 /******************************************************************************
- * Function         phNxpEseProto7816_ProcessResponse
+ * Function         phNxpEseProto7816_ProcessRawFrame
  *
  * Description      This internal function is used to
  *                  1. Check the CRC
  *                  2. Initiate decoding of received frame of data.
+ *                  3. Start the recovery if no frame was received.
  *
- * param[in]        void
+ * param[in]        void*: connection context
+ * param[in]        bool_t: TRUE if a frame was received
+ * param[in]        uint32_t: length of the received frame
+ * param[in]        uint8_t: received frame
  *
  * Returns          On success return TRUE or else FALSE.
  *
  ******************************************************************************/
-static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
+static bool_t phNxpEseProto7816_ProcessRawFrame(void* conn_ctx, bool_t rxStatus, uint32_t data_len, uint8_t *p_data)
 {
-    uint32_t data_len = 0;
-    uint8_t *p_data = NULL;
     bool_t status = FALSE;
     bool_t checkCrcPass = TRUE;
     iFrameInfo_t *pRx_lastRcvdIframeInfo = &phNxpEseProto7816_3_Var.phNxpEseRx_Cntx.lastRcvdIframeInfo;
     rFrameInfo_t *pNextTx_RframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.RframeInfo;
     sFrameInfo_t *pLastTx_SframeInfo = &phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.SframeInfo;
 
-    status = phNxpEseProto7816_GetRawFrame(conn_ctx, &data_len, &p_data);
+    status = rxStatus;
     LOG_D("%s p_data ----> %p len ----> 0x%lx ", __FUNCTION__,p_data, data_len);
     if(TRUE == status)
     {
@@ -1083,6 +1370,7 @@ static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
         else
         {
             LOG_E("%s CRC Check failed ", __FUNCTION__);
+            SM_METRICS_EVENT(SM_METRICS_EV_T1_CRC_ERROR);
             if(phNxpEseProto7816_3_Var.rnack_retry_counter < phNxpEseProto7816_3_Var.rnack_retry_limit)
             {
                 phNxpEseProto7816_3_Var.phNxpEseRx_Cntx.lastRcvdFrameType = INVALID ;
@@ -1105,6 +1393,7 @@ static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
     else
     {
         LOG_E("%s phNxpEseProto7816_GetRawFrame failed starting recovery", __FUNCTION__);
+        SM_METRICS_EVENT(SM_METRICS_EV_T1_NO_FRAME);
         if ((SFRAME == phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.FrameType) &&
             ((WTX_RSP == pLastTx_SframeInfo->sFrameType) || (RESYNCH_RSP == pLastTx_SframeInfo->sFrameType))) {
             if(phNxpEseProto7816_3_Var.rnack_retry_counter < phNxpEseProto7816_3_Var.rnack_retry_limit)
@@ -1122,6 +1411,7 @@ static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
                 LOG_E("%s Recovery failed completely, Going to exit ", __FUNCTION__);
                 phNxpEseProto7816_3_Var.rnack_retry_counter = PH_PROTO_7816_VALUE_ZERO;
                 /* Recovery failed completely, Going to exit */
+                SM_METRICS_EVENT(SM_METRICS_EV_T1_RECOVERY_FAILED);
                 phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
                 phNxpEseProto7816_3_Var.timeoutCounter = PH_PROTO_7816_VALUE_ZERO;
             }
@@ -1144,16 +1434,17 @@ static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
                 LOG_E("%s Recovery failed completely, Going to exit ", __FUNCTION__);
                 phNxpEseProto7816_3_Var.rnack_retry_counter = PH_PROTO_7816_VALUE_ZERO;
                 /* Recovery failed completely, Going to exit */
+                SM_METRICS_EVENT(SM_METRICS_EV_T1_RECOVERY_FAILED);
                 phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
                 phNxpEseProto7816_3_Var.timeoutCounter = PH_PROTO_7816_VALUE_ZERO;
             }
         }
         else
         {
-            sm_sleep(DELAY_ERROR_RECOVERY/1000);
             /* re transmit the frame */
             if(phNxpEseProto7816_3_Var.timeoutCounter < PH_PROTO_7816_TIMEOUT_RETRY_COUNT)
             {
+                phNxpEseProto7816_RecoveryBackoff(phNxpEseProto7816_3_Var.timeoutCounter);
                 phNxpEseProto7816_3_Var.timeoutCounter++;
                 LOG_E("%s re-transmitting the previous frame ", __FUNCTION__);
                 phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx = phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx ;
@@ -1171,92 +1462,154 @@ static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
 }
 
 /******************************************************************************
- * Function         TransceiveProcess
+ * Function         phNxpEseProto7816_ProcessResponse
  *
  * Description      This internal function is used to
- *                  1. Send the raw data received from application after computing CRC
- *                  2. Receive the the response data from ESE, decode, process and
- *                     store the data.
+ *                  1. Read the response frame from ESE
+ *                  2. Check the CRC and decode it, or start the recovery.
  *
- * param[in]        void
+ * param[in]        void*: connection context
  *
  * Returns          On success return TRUE or else FALSE.
  *
  ******************************************************************************/
-static bool_t TransceiveProcess(void* conn_ctx)
+static bool_t phNxpEseProto7816_ProcessResponse(void* conn_ctx)
+{
+    uint32_t data_len = 0;
+    uint8_t *p_data = NULL;
+    bool_t status = FALSE;
+
+    status = phNxpEseProto7816_GetRawFrame(conn_ctx, &data_len, &p_data);
+    return phNxpEseProto7816_ProcessRawFrame(conn_ctx, status, data_len, p_data);
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_SendNextFrame
+ *
+ * Description      This internal function sends the frame selected by
+ *                  nextTransceiveState, after the pending delay if any, and
+ *                  on success makes it the last transmitted frame.
+ *
+ * param[in]        void*: connection context
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_SendNextFrame(void* conn_ctx)
 {
     bool_t status = FALSE;
     sFrameInfo_t sFrameInfo;
-    sFrameInfo.sFrameType = INVALID_REQ_RES;
 
     sFrameInfo.sFrameType = INVALID_REQ_RES;
+    sFrameInfo.ifs = 0;
 
-    while(phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState != IDLE_STATE)
+    LOG_D("%s nextTransceiveState %x ", __FUNCTION__, phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState);
+    phNxpEseProto7816_WaitTxDelay();
+    switch(phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState)
     {
-        LOG_D("%s nextTransceiveState %x ", __FUNCTION__, phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState);
-        switch(phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState)
-        {
-            case SEND_IFRAME:
-                status = phNxpEseProto7816_SendIframe(conn_ctx, phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo);
-                break;
-            case SEND_R_ACK:
-                status = phNxpEseProto7816_sendRframe(conn_ctx, RACK);
-                break;
-            case SEND_R_NACK:
-                status = phNxpEseProto7816_sendRframe(conn_ctx, RNACK);
-                break;
-            case SEND_S_RSYNC:
-                sFrameInfo.sFrameType = RESYNCH_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_WTX_RSP:
-                sFrameInfo.sFrameType = WTX_RSP;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
+        case SEND_IFRAME:
+            status = phNxpEseProto7816_SendIframe(conn_ctx, phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo);
+            break;
+        case SEND_R_ACK:
+            status = phNxpEseProto7816_sendRframe(conn_ctx, RACK);
+            break;
+        case SEND_R_NACK:
+            status = phNxpEseProto7816_sendRframe(conn_ctx, RNACK);
+            break;
+        case SEND_S_RSYNC:
+            sFrameInfo.sFrameType = RESYNCH_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_WTX_RSP:
+            sFrameInfo.sFrameType = WTX_RSP;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_IFS_REQ:
+            sFrameInfo.sFrameType = IFSC_REQ;
+            sFrameInfo.ifs = phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.SframeInfo.ifs;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_IFS_RSP:
+            sFrameInfo.sFrameType = IFSC_RES;
+            sFrameInfo.ifs = phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.SframeInfo.ifs;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
 #if defined(T1oI2C_UM11225)
-            case SEND_S_CHIP_RST:
-                sFrameInfo.sFrameType = CHIP_RESET_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_INTF_RST:
-                sFrameInfo.sFrameType = INTF_RESET_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_EOS:
-                sFrameInfo.sFrameType = PROP_END_APDU_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_ATR:
-                sFrameInfo.sFrameType = ATR_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
+        case SEND_S_CHIP_RST:
+            sFrameInfo.sFrameType = CHIP_RESET_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_INTF_RST:
+            sFrameInfo.sFrameType = INTF_RESET_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_EOS:
+            sFrameInfo.sFrameType = PROP_END_APDU_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_ATR:
+            sFrameInfo.sFrameType = ATR_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
 #elif defined(T1oI2C_GP1_0)
-            case SEND_S_CIP:
-                sFrameInfo.sFrameType = CIP_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_SWR:
-                sFrameInfo.sFrameType = SWR_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_RELEASE:
-                sFrameInfo.sFrameType = RELEASE_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
-            case SEND_S_COLD_RST:
-                sFrameInfo.sFrameType = COLD_RESET_REQ;
-                status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
-                break;
+        case SEND_S_CIP:
+            sFrameInfo.sFrameType = CIP_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_SWR:
+            sFrameInfo.sFrameType = SWR_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_RELEASE:
+            sFrameInfo.sFrameType = RELEASE_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
+        case SEND_S_COLD_RST:
+            sFrameInfo.sFrameType = COLD_RESET_REQ;
+            status = phNxpEseProto7816_SendSFrame(conn_ctx, sFrameInfo);
+            break;
 #else
 #error Either T1oI2C_UM11225 or T1oI2C_GP1_0 must be defined.
 #endif
-            default:
-                phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
-                break;
+        default:
+            phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
+            break;
+    }
+    if(TRUE == status)
+    {
+        phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx = phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx;
+#if PH_PROTO_7816_IFRAME_PREBUILD
+        if (IFRAME == phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.FrameType) {
+            /* ESE is busy with this I-frame, meanwhile frame the next one of the chain */
+            phNxpEseProto7816_PrebuildNextIframe();
         }
+#endif
+    }
+    return status;
+}
+
+/******************************************************************************
+ * Function         TransceiveProcess
+ *
+ * Description      This internal function is used to
+ *                  1. Send the raw data received from application after computing CRC
+ *                  2. Receive the the response data from ESE, decode, process and
+ *                     store the data.
+ *
+ * param[in]        void
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t TransceiveProcess(void* conn_ctx)
+{
+    bool_t status = FALSE;
+
+    while(phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState != IDLE_STATE)
+    {
+        status = phNxpEseProto7816_SendNextFrame(conn_ctx);
         if(TRUE == status)
         {
-            phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx = phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx;
             status = phNxpEseProto7816_ProcessResponse(conn_ctx);
         }
         else
@@ -1287,22 +1640,63 @@ bool_t phNxpEseProto7816_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEs
 {
     bool_t status = FALSE;
     uint32_t reqDataLen = 0;
+
+    LOG_D("Enter %s  ", __FUNCTION__);
+    if (NULL == pRsp)
+        return status;
+    reqDataLen = pRsp->len;
+    if (FALSE == phNxpEseProto7816_TransceiveBegin(pCmd, pRsp))
+        return status;
+    status = TransceiveProcess(conn_ctx);
+    return phNxpEseProto7816_TransceiveEnd(status, pRsp, reqDataLen);
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_TransceiveBegin
+ *
+ * Description      This internal function checks the protocol stack is idle
+ *                  and sets up the context of the first I-frame of pCmd.
+ *
+ * param[in]        phNxpEse_data: Command to ESE C-APDU
+ * param[out]       phNxpEse_data: Response from ESE R-APDU
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_TransceiveBegin(phNxpEse_data *pCmd, phNxpEse_data *pRsp)
+{
     phNxpEseRx_Cntx_t *pRx_EseCntx = &phNxpEseProto7816_3_Var.phNxpEseRx_Cntx;
     iFrameInfo_t *pNextTx_IframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo;
 
-    LOG_D("Enter %s  ", __FUNCTION__);
     if((NULL == pCmd) || (NULL == pRsp) ||
             (phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState != PH_NXP_ESE_PROTO_7816_IDLE))
-        return status;
-    reqDataLen = pRsp->len;
+        return FALSE;
     /* Updating the transceive information to the protocol stack */
     phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState = PH_NXP_ESE_PROTO_7816_TRANSCEIVE;
     pNextTx_IframeInfo->p_data = pCmd->p_data;
     pNextTx_IframeInfo->totalDataLen = pCmd->len;
     pRx_EseCntx->pRsp = pRsp;
+    phNxpEseProto7816_TxDelay.delayUs = 0;
     LOG_D("Transceive data ptr 0x%p len:%ld ", pCmd->p_data, pCmd->len);
     phNxpEseProto7816_SetFirstIframeContxt();
-    status = TransceiveProcess(conn_ctx);
+    return TRUE;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_TransceiveEnd
+ *
+ * Description      This internal function checks the collected response
+ *                  fits and puts the protocol stack back to idle.
+ *
+ * param[in]        bool_t: status of the exchange
+ * param[in,out]    phNxpEse_data: Response from ESE R-APDU
+ * param[in]        uint32_t: size of the response buffer
+ *
+ * Returns          On success return TRUE or else FALSE.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_TransceiveEnd(bool_t status, phNxpEse_data *pRsp, uint32_t reqDataLen)
+{
     if(FALSE == status)
     {
         /* ESE hard reset to be done */
@@ -1318,6 +1712,175 @@ bool_t phNxpEseProto7816_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEs
     return status;
 }
 
+/******************************************************************************
+ * Function         phNxpEseProto7816_TransceiveStart
+ *
+ * Description      Non blocking variant of phNxpEseProto7816_Transceive.
+ *                  Sends the first frame of pCmd and returns. Each frame
+ *                  received from ESE is then passed to
+ *                  phNxpEseProto7816_TransceiveStep until it reports the
+ *                  exchange is complete. pRsp must stay valid until then.
+ *                  None of them sleeps: a frame that must not be sent yet
+ *                  (I2C write guard, recovery back-off, WTX) is held back,
+ *                  the delay is returned in pDelayUs and the frame is sent
+ *                  by phNxpEseProto7816_TransceiveResume once it elapsed.
+ *
+ * param[in]        void*: connection context
+ * param[in]        phNxpEse_data: Command to ESE C-APDU
+ * param[out]       phNxpEse_data: Response from ESE R-APDU
+ * param[out]       uint32_t: 0 if the first frame was sent, else the delay
+ *                  in micro seconds before phNxpEseProto7816_TransceiveResume
+ *
+ * Returns          TRUE if the first frame was sent or held back, else FALSE.
+ *
+ ******************************************************************************/
+bool_t phNxpEseProto7816_TransceiveStart(
+    void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp, uint32_t *pDelayUs)
+{
+    bool_t status = FALSE;
+    bool_t bComplete = FALSE;
+
+    LOG_D("Enter %s  ", __FUNCTION__);
+    if ((NULL == pRsp) || (NULL == pDelayUs))
+        return status;
+    phNxpEseProto7816_AsyncRspLen = pRsp->len;
+    if (FALSE == phNxpEseProto7816_TransceiveBegin(pCmd, pRsp))
+        return status;
+    phNxpEseProto7816_AsyncRsp = pRsp;
+    status = phNxpEseProto7816_AsyncSendNext(conn_ctx, TRUE, &bComplete, pDelayUs);
+    if (TRUE == bComplete)
+    {
+        /* Only the failed send of the first frame ends the exchange here */
+        LOG_E("%s Transceive send failed ", __FUNCTION__);
+        status = FALSE;
+    }
+    return status;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_TransceiveStep
+ *
+ * Description      Processes the result of one read of the exchange started
+ *                  by phNxpEseProto7816_TransceiveStart and sends the next
+ *                  frame (R-ACK, next I-frame of the chain, WTX response,
+ *                  recovery frame, ...) if any.
+ *
+ * param[in]        void*: connection context
+ * param[in]        bool_t: TRUE if a frame was received, FALSE on read
+ *                  failure / timeout. The recovery then starts.
+ * param[in]        uint32_t: length of the received frame
+ * param[in]        uint8_t: received frame
+ * param[out]       bool_t: TRUE once the exchange is complete
+ * param[out]       uint32_t: 0 unless the next frame is held back, then the
+ *                  delay in micro seconds before phNxpEseProto7816_TransceiveResume
+ *
+ * Returns          Status of the exchange when complete, else TRUE as long
+ *                  as it continues.
+ *
+ ******************************************************************************/
+bool_t phNxpEseProto7816_TransceiveStep(void* conn_ctx,
+    bool_t rxStatus, uint32_t data_len, uint8_t *p_data, bool_t *pComplete, uint32_t *pDelayUs)
+{
+    bool_t status = FALSE;
+
+    ENSURE_OR_GO_EXIT(pComplete != NULL);
+    *pComplete = TRUE;
+    ENSURE_OR_GO_EXIT(pDelayUs != NULL);
+    *pDelayUs = 0;
+    if ((phNxpEseProto7816_AsyncRsp == NULL) ||
+        (phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState != PH_NXP_ESE_PROTO_7816_TRANSCEIVE)) {
+        LOG_E("%s No transceive in progress ", __FUNCTION__);
+        goto exit;
+    }
+    status = phNxpEseProto7816_ProcessRawFrame(conn_ctx, rxStatus, data_len, p_data);
+    status = phNxpEseProto7816_AsyncSendNext(conn_ctx, status, pComplete, pDelayUs);
+exit:
+    return status;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_TransceiveResume
+ *
+ * Description      Sends the frame held back by phNxpEseProto7816_TransceiveStart
+ *                  or phNxpEseProto7816_TransceiveStep once the delay they
+ *                  returned has elapsed.
+ *
+ * param[in]        void*: connection context
+ * param[out]       bool_t: TRUE once the exchange is complete
+ * param[out]       uint32_t: 0 if the frame was sent, else the delay left
+ *
+ * Returns          Status of the exchange when complete, else TRUE as long
+ *                  as it continues.
+ *
+ ******************************************************************************/
+bool_t phNxpEseProto7816_TransceiveResume(void* conn_ctx, bool_t *pComplete, uint32_t *pDelayUs)
+{
+    bool_t status = FALSE;
+
+    ENSURE_OR_GO_EXIT(pComplete != NULL);
+    *pComplete = TRUE;
+    ENSURE_OR_GO_EXIT(pDelayUs != NULL);
+    *pDelayUs = 0;
+    if ((phNxpEseProto7816_AsyncRsp == NULL) ||
+        (phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState != PH_NXP_ESE_PROTO_7816_TRANSCEIVE)) {
+        LOG_E("%s No transceive in progress ", __FUNCTION__);
+        goto exit;
+    }
+    status = phNxpEseProto7816_AsyncSendNext(conn_ctx, TRUE, pComplete, pDelayUs);
+exit:
+    return status;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_AsyncSendNext
+ *
+ * Description      This internal function sends the next frame of the non
+ *                  blocking exchange, unless the I2C write guard or the
+ *                  pending delay holds it back, and ends the exchange once
+ *                  there is nothing left to send.
+ *
+ * param[in]        void*: connection context
+ * param[in]        bool_t: status of the exchange so far
+ * param[out]       bool_t: TRUE once the exchange is complete
+ * param[out]       uint32_t: 0 if nothing is held back, else the delay left
+ *
+ * Returns          Status of the exchange when complete, else TRUE as long
+ *                  as it continues.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_AsyncSendNext(void* conn_ctx, bool_t status, bool_t *pComplete, uint32_t *pDelayUs)
+{
+    phNxpEse_data *pRsp = phNxpEseProto7816_AsyncRsp;
+    uint32_t delayUs = 0;
+
+    *pComplete = FALSE;
+    *pDelayUs = 0;
+    if (phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState != IDLE_STATE)
+    {
+        delayUs = phNxpEseProto7816_TxDelayLeftUs();
+        if (delayUs < phPalEse_i2c_guard_left_us()) {
+            delayUs = phPalEse_i2c_guard_left_us();
+        }
+        if (delayUs > 0) {
+            *pDelayUs = delayUs;
+            return TRUE;
+        }
+        status = phNxpEseProto7816_SendNextFrame(conn_ctx);
+        if (FALSE == status)
+        {
+            LOG_E("%s Transceive send failed, going to recovery! ", __FUNCTION__);
+            phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
+        }
+    }
+    if (phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState == IDLE_STATE)
+    {
+        *pComplete = TRUE;
+        phNxpEseProto7816_AsyncRsp = NULL;
+        status = phNxpEseProto7816_TransceiveEnd(status, pRsp, phNxpEseProto7816_AsyncRspLen);
+    }
+    return status;
+}
+
 /******************************************************************************
  * Function         phNxpEseProto7816_RSync
  *
@@ -1357,23 +1920,29 @@ bool_t phNxpEseProto7816_ResetProtoParams(void)
 {
     unsigned long int tmpWTXCountlimit = PH_PROTO_7816_VALUE_ZERO;
     unsigned long int tmpRNACKCountlimit = PH_PROTO_7816_VALUE_ZERO;
+    uint16_t tmpIfsc = PH_PROTO_7816_VALUE_ZERO;
     phNxpEseRx_Cntx_t *pRx_EseCntx = &phNxpEseProto7816_3_Var.phNxpEseRx_Cntx;
     iFrameInfo_t *pNextTx_IframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo;
     iFrameInfo_t *pLastTx_IframeInfo = &phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.IframeInfo;
 
     tmpWTXCountlimit = phNxpEseProto7816_3_Var.wtx_counter_limit;
     tmpRNACKCountlimit = phNxpEseProto7816_3_Var.rnack_retry_limit;
+    tmpIfsc = phNxpEseProto7816_3_Var.ifsc;
     phNxpEse_memset(&phNxpEseProto7816_3_Var, PH_PROTO_7816_VALUE_ZERO, sizeof(phNxpEseProto7816_t));
     phNxpEseProto7816_3_Var.wtx_counter_limit = tmpWTXCountlimit;
     phNxpEseProto7816_3_Var.rnack_retry_limit = tmpRNACKCountlimit;
+    phNxpEseProto7816_3_Var.ifsc = tmpIfsc;
+#if PH_PROTO_7816_IFRAME_PREBUILD
+    phNxpEseProto7816_NextIframe.frameLen = 0;
+#endif
     phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState = PH_NXP_ESE_PROTO_7816_IDLE;
     phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = IDLE_STATE;
     pRx_EseCntx->lastRcvdFrameType = INVALID;
     phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType = INVALID;
-    pNextTx_IframeInfo->maxDataLen = IFSC_SIZE_SEND;
+    pNextTx_IframeInfo->maxDataLen = (tmpIfsc != 0) ? tmpIfsc : IFSC_SIZE_SEND;
     pNextTx_IframeInfo->p_data = NULL;
     phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.FrameType = INVALID;
-    pLastTx_IframeInfo->maxDataLen = IFSC_SIZE_SEND;
+    pLastTx_IframeInfo->maxDataLen = pNextTx_IframeInfo->maxDataLen;
     pLastTx_IframeInfo->p_data = NULL;
     /* Initialized with sequence number of the last I-frame sent */
     pNextTx_IframeInfo->seqNo = PH_PROTO_7816_VALUE_ONE;
@@ -1449,6 +2018,12 @@ bool_t phNxpEseProto7816_Open(void* conn_ctx, phNxpEseProto7816InitParam_t initP
         {
             status = phNxpEseProto7816_GetAtr(conn_ctx, AtrRsp);
         }
+#if PH_PROTO_7816_IFS_NEGOTIATE
+        if(status == TRUE)
+        {
+            phNxpEseProto7816_NegotiateIfs(conn_ctx, AtrRsp);
+        }
+#endif
 
 #elif defined(T1oI2C_GP1_0)
         /* For GP soft reset does not respond with CIP so master should send CIP req. seperatly  */
@@ -1457,6 +2032,12 @@ bool_t phNxpEseProto7816_Open(void* conn_ctx, phNxpEseProto7816InitParam_t initP
         {
             status = phNxpEseProto7816_GetCip(conn_ctx, AtrRsp);
         }
+#if PH_PROTO_7816_IFS_NEGOTIATE
+        if(status == TRUE)
+        {
+            phNxpEseProto7816_NegotiateIfs(conn_ctx, AtrRsp);
+        }
+#endif
 #endif
     }
     else /* Do R-Sync */
@@ -1657,6 +2238,143 @@ bool_t phNxpEseProto7816_SetIfscSize(uint16_t IFSC_Size)
     return TRUE;
 }
 
+/******************************************************************************
+ * Function         phNxpEseProto7816_DecodeIfs
+ *
+ * Description      This internal function is used to get the IFS of an
+ *                  S(IFS) request/response
+ *
+ * param[in]        uint8_t : data buffer
+ * param[in]        uint32_t : buffer length
+ *
+ * Returns          IFS, or 0 if the INF field is not 1 or 2 bytes.
+ *
+ ******************************************************************************/
+static uint16_t phNxpEseProto7816_DecodeIfs(uint8_t *p_data, uint32_t data_len)
+{
+    uint16_t ifs = 0;
+
+    if (data_len == (PH_PROTO_7816_INF_FILED + 1)) {
+        ifs = p_data[PH_PROPTO_7816_INF_BYTE_OFFSET];
+    }
+    else if (data_len == (PH_PROTO_7816_INF_FILED + 2)) {
+        ifs = (uint16_t)((p_data[PH_PROPTO_7816_INF_BYTE_OFFSET] << 8) | p_data[PH_PROPTO_7816_INF_BYTE_OFFSET + 1]);
+    }
+    return ifs;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_UpdateIfsc
+ *
+ * Description      This internal function is used to set the IFSC of the ESE,
+ *                  up to what this host can send. It also applies to the
+ *                  remaining I-frames of an ongoing chain.
+ *
+ * param[in]        uint16_t : IFSC
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEseProto7816_UpdateIfsc(uint16_t ifsc)
+{
+    if (ifsc > PH_PROTO_7816_IFS_MAX) {
+        ifsc = PH_PROTO_7816_IFS_MAX;
+    }
+    phNxpEseProto7816_3_Var.ifsc = ifsc;
+    phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo.maxDataLen = ifsc;
+    phNxpEseProto7816_3_Var.phNxpEseLastTx_Cntx.IframeInfo.maxDataLen = ifsc;
+}
+
+#if PH_PROTO_7816_IFS_NEGOTIATE
+/******************************************************************************
+ * Function         phNxpEseProto7816_GetIfscFromAtr
+ *
+ * Description      This internal function is used to get the IFSC from the
+ *                  data link layer parameters (DLLP) of the ATR/CIP
+ *
+ * param[in]        phNxpEse_data : ATR/CIP response from ESE
+ *
+ * Returns          IFSC, or 0 if it could not be found.
+ *
+ ******************************************************************************/
+static uint16_t phNxpEseProto7816_GetIfscFromAtr(phNxpEse_data *pAtr)
+{
+    uint16_t ifsc = 0;
+    uint32_t offset = 0;
+    uint8_t *p_data = NULL;
+
+    ENSURE_OR_GO_EXIT(pAtr != NULL);
+    ENSURE_OR_GO_EXIT(pAtr->p_data != NULL);
+    p_data = pAtr->p_data;
+#if defined(T1oI2C_UM11225)
+    /* PVER(1) VID(5) DLLP length(1) DLLP: BWT(2) IFSC(2) PLID(1) ... */
+    offset = 1 + 5;
+#elif defined(T1oI2C_GP1_0)
+    /* PVER(1) IIN length(1) IIN PLID(1) PLP length(1) PLP DLLP length(1) DLLP: BWT(2) IFSC(2) ... */
+    offset = 1;
+    ENSURE_OR_GO_EXIT(offset < pAtr->len);
+    offset += 1 + p_data[offset]; /* IIN */
+    offset += 1;                  /* PLID */
+    ENSURE_OR_GO_EXIT(offset < pAtr->len);
+    offset += 1 + p_data[offset]; /* PLP */
+#endif
+    ENSURE_OR_GO_EXIT(offset < pAtr->len);
+    ENSURE_OR_GO_EXIT(p_data[offset] >= 4);
+    ENSURE_OR_GO_EXIT((offset + 1 + 4) <= pAtr->len);
+    ifsc = (uint16_t)((p_data[offset + 3] << 8) | p_data[offset + 4]);
+exit:
+    return ifsc;
+}
+
+/******************************************************************************
+ * Function         phNxpEseProto7816_NegotiateIfs
+ *
+ * Description      This internal function is used to
+ *                  1. Send up to the IFSC of the ESE given in the ATR/CIP
+ *                  2. Announce with an S(IFS) request that this host receives
+ *                     up to PH_PROTO_7816_IFS_MAX, if more than the default.
+ *                     Never the case with T1oI2C_UM11225.
+ *
+ * param[in]        phNxpEse_data : ATR/CIP response from ESE
+ *
+ * Returns          Always return TRUE, the default IFS is kept on failure.
+ *
+ ******************************************************************************/
+static bool_t phNxpEseProto7816_NegotiateIfs(void* conn_ctx, phNxpEse_data *pAtr)
+{
+    uint16_t ifsc = 0;
+#if (PH_PROTO_7816_IFS_MAX > IFSC_SIZE_SEND)
+    sFrameInfo_t *pNextTx_SframeInfo = &phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.SframeInfo;
+    sFrameInfo_t *pRx_lastRcvdSframeInfo = &phNxpEseProto7816_3_Var.phNxpEseRx_Cntx.lastRcvdSframeInfo;
+#endif
+
+    ifsc = phNxpEseProto7816_GetIfscFromAtr(pAtr);
+    if (ifsc == 0) {
+        LOG_W("%s No IFSC in ATR, keeping %d ", __FUNCTION__, phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.IframeInfo.maxDataLen);
+    }
+    else {
+        phNxpEseProto7816_UpdateIfsc(ifsc);
+        LOG_D("%s IFSC %d ", __FUNCTION__, phNxpEseProto7816_3_Var.ifsc);
+    }
+#if (PH_PROTO_7816_IFS_MAX > IFSC_SIZE_SEND)
+    phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState = PH_NXP_ESE_PROTO_7816_TRANSCEIVE;
+    phNxpEseProto7816_3_Var.phNxpEseNextTx_Cntx.FrameType= SFRAME;
+    pNextTx_SframeInfo->sFrameType = IFSC_REQ;
+    pNextTx_SframeInfo->ifs = PH_PROTO_7816_IFS_MAX;
+    pRx_lastRcvdSframeInfo->sFrameType = INVALID_REQ_RES;
+    phNxpEseProto7816_3_Var.phNxpEseProto7816_nextTransceiveState = SEND_S_IFS_REQ;
+    if ((TRUE != TransceiveProcess(conn_ctx)) || (pRx_lastRcvdSframeInfo->sFrameType != IFSC_RES) ||
+        (pRx_lastRcvdSframeInfo->ifs != PH_PROTO_7816_IFS_MAX)) {
+        LOG_W("%s IFSD %d not accepted ", __FUNCTION__, PH_PROTO_7816_IFS_MAX);
+    }
+    phNxpEseProto7816_3_Var.phNxpEseProto7816_CurrentState = PH_NXP_ESE_PROTO_7816_IDLE;
+#else
+    AX_UNUSED_ARG(conn_ctx);
+#endif
+    return TRUE;
+}
+#endif
+
 
 #if defined(T1oI2C_UM11225)
 /******************************************************************************
@@ -125,6 +125,8 @@ typedef enum phNxpEseProto7816_TransceiveStates
 #endif
   SEND_S_WTX_REQ, /*!< 7816-3 protocol transceive state: S-frame WTX command to be sent */
   SEND_S_WTX_RSP, /*!< 7816-3 protocol transceive state: S-frame WTX response to be sent */
+  SEND_S_IFS_REQ, /*!< 7816-3 protocol transceive state: S-frame IFS request to be sent */
+  SEND_S_IFS_RSP, /*!< 7816-3 protocol transceive state: S-frame IFS response to be sent */
 
 }phNxpEseProto7816_TransceiveStates_t;
 
@@ -156,6 +158,7 @@ typedef struct iFrameInfo
 typedef struct sFrameInfo
 {
   sFrameTypes_t sFrameType;/*!< S-frame: Type of S-frame cmd/rsp */
+  uint16_t ifs; /*!< S-frame: INF of an IFS request/response, the information field size */
 }sFrameInfo_t;
 
 /*!
@@ -238,6 +241,8 @@ typedef struct phNxpEseProto7816
   phNxpEseProto7816_FrameTypes_t lastSentNonErrorframeType; /*!< Copy of the last sent non-error frame type: R-ACK, S-frame, I-frame */
   unsigned long int rnack_retry_limit;
   unsigned long int rnack_retry_counter;
+  uint16_t ifsc; /*!< IFSC of the ESE as read from the ATR/CIP or set by an S(IFS) request, 0 if not known.
+                      Kept across protocol resets */
 }phNxpEseProto7816_t;
 
 /*!
@@ -281,9 +286,51 @@ typedef struct phNxpEseProto7816_PCB_bits {
  */
 #define IFSC_SIZE_SEND  254
 /*!
- * \brief Delay to be used before sending the next frame, after error reported by ESE
+ * \brief Max. size of the INF field this host can send and receive, bounded by MAX_DATA_LEN
+ */
+#if defined(T1oI2C_UM11225)
+  #define PH_PROTO_7816_IFS_MAX 254 // LEN field is 1 byte
+#elif defined(T1oI2C_GP1_0)
+  #define PH_PROTO_7816_IFS_MAX (MAX_DATA_LEN - PH_PROTO_7816_INF_FILED)
+#endif
+/*!
+ * \brief Take the IFSC from the ATR/CIP at open, and announce PH_PROTO_7816_IFS_MAX as
+ * IFSD with an S(IFS) request if it is more than the default IFSC_SIZE_SEND
+ *
+ * With T1oI2C_UM11225 (SE05x) the LEN field is one byte, PH_PROTO_7816_IFS_MAX
+ * equals IFSC_SIZE_SEND and no S(IFS) request is sent. An SE05x announces an
+ * IFSC of 254 as well, so there frames keep their size. What remains is that
+ * an S(IFS) request of the SE is applied, also within a chain.
+ */
+#ifndef PH_PROTO_7816_IFS_NEGOTIATE
+#define PH_PROTO_7816_IFS_NEGOTIATE 1
+#endif
+/*!
+ * \brief Frame the next chained I-frame (header, INF and CRC) while the ESE
+ * is busy with the current one, instead of after its R-ACK is received
+ */
+#ifndef PH_PROTO_7816_IFRAME_PREBUILD
+#define PH_PROTO_7816_IFRAME_PREBUILD 1
+#endif
+/*!
+ * \brief Longest delay, in us, before sending the next frame after an error
+ * reported by ESE
  */
 #define DELAY_ERROR_RECOVERY 3500
+/*!
+ * \brief Delay, in us, before the second retry of an error recovery. The first
+ * retry is sent at once, each further one waits twice as long as the previous,
+ * up to DELAY_ERROR_RECOVERY
+ */
+#ifndef PH_PROTO_7816_RECOVERY_BASE_US
+#define PH_PROTO_7816_RECOVERY_BASE_US 250
+#endif
+/*!
+ * \brief Delay, in us, before answering a WTX request of ESE
+ */
+#ifndef PH_PROTO_7816_WTX_DELAY_US
+#define PH_PROTO_7816_WTX_DELAY_US 3000
+#endif
 /*!
  * \brief 7816-3 protocol frame header length
  */
@@ -329,9 +376,16 @@ typedef struct phNxpEseProto7816_PCB_bits {
  */
 #define PH_PROTO_7816_S_RESYNCH      0x00
 /*!
- * \brief 7816-3 protocol max. error retry counter
+ * \brief 7816-3 S-block IFS mask
  */
+#define PH_PROTO_7816_S_IFS          0x01
+/*!
+ * \brief 7816-3 protocol max. error retry counter, after which the interface
+ * is reset
+ */
+#ifndef PH_PROTO_7816_FRAME_RETRY_COUNT
 #define PH_PROTO_7816_FRAME_RETRY_COUNT 10
+#endif
 /*!
  * \brief 7816-3 protocol max. WTX default count
  */
@@ -430,6 +484,11 @@ bool_t phNxpEseProto7816_ChipReset(void* conn_ctx);
 bool_t phNxpEseProto7816_Close(void* conn_ctx);
 bool_t phNxpEseProto7816_Open(void* conn_ctx, phNxpEseProto7816InitParam_t initParam , phNxpEse_data *AtrRsp);
 bool_t phNxpEseProto7816_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp);
+bool_t phNxpEseProto7816_TransceiveStart(
+    void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp, uint32_t *pDelayUs);
+bool_t phNxpEseProto7816_TransceiveStep(void* conn_ctx,
+    bool_t rxStatus, uint32_t data_len, uint8_t *p_data, bool_t *pComplete, uint32_t *pDelayUs);
+bool_t phNxpEseProto7816_TransceiveResume(void* conn_ctx, bool_t *pComplete, uint32_t *pDelayUs);
 bool_t phNxpEseProto7816_Reset(void);
 bool_t phNxpEseProto7816_SetIfscSize(uint16_t IFSC_Size);
 bool_t phNxpEseProto7816_ResetProtoParams(void);
@@ -18,6 +18,7 @@
 #include <phNxpEsePal_i2c.h>
 #include "sm_types.h"
 #include "sm_timer.h"
+#include "sm_metrics.h"
 #include <fsl_sss_types.h>
 
 #ifdef FLOW_VERBOSE
@@ -35,7 +36,32 @@
 #define RECIEVE_PACKET_SOF      0xA5
 #define CHAINED_PACKET_WITHSEQN      0x60
 #define CHAINED_PACKET_WITHOUTSEQN      0x20
+/* Marks a used slot of the wait model, INS/P1/P2 are in the lower 24 bits */
+#define ESE_WAIT_KEY_VALID      0x01000000u
+#define ESE_POLL_DELAY_US       (ESE_POLL_DELAY_MS * 1000u)
+#if defined(__gnu_linux__)
+#define ESE_WAIT_MODE_DEFAULT   ESE_WAIT_ADAPTIVE
+#else
+/* Without sub milli second sleep the fine polling would busy loop */
+#define ESE_WAIT_MODE_DEFAULT   ESE_WAIT_POLL
+#endif
 static int phNxpEse_readPacket(void* conn_ctx, void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead);
+static int phNxpEse_probeLen(phNxpEse_Context_t *nxpese_ctxt, int bufferLen);
+static bool_t phNxpEse_findSof(uint8_t *pBuffer, int probeLen, int *pNumRead);
+static int phNxpEse_readTail(void *pDevHandle, uint8_t *pBuffer, int bufferLen, int numRead);
+static int phNxpEse_readFrame(phNxpEse_Context_t *nxpese_ctxt, void *pDevHandle, uint8_t *pBuffer, int bufferLen,
+    int numRead, uint64_t sofTimeUs);
+static int phNxpEse_pollPacket(phNxpEse_Context_t *nxpese_ctxt, uint8_t *pBuffer, int bufferLen);
+static void phNxpEse_waitForResponse(phNxpEse_Context_t *nxpese_ctxt, void *pDevHandle);
+static uint32_t phNxpEse_adaptiveSleepUs(phNxpEse_Context_t *nxpese_ctxt);
+static uint32_t phNxpEse_pollDelayUs(phNxpEse_Context_t *nxpese_ctxt);
+static uint32_t phNxpEse_asyncPollDelayUs(phNxpEse_Context_t *nxpese_ctxt);
+static ESESTATUS phNxpEse_checkTransceive(phNxpEse_Context_t *nxpese_ctxt, phNxpEse_data *pCmd, phNxpEse_data *pRsp);
+static void phNxpEse_setWaitKey(phNxpEse_Context_t *nxpese_ctxt, const phNxpEse_data *pCmd);
+static void phNxpEse_recordLatency(phNxpEse_Context_t *nxpese_ctxt, uint64_t rxTimeUs);
+static void phNxpEse_trackTxFrame(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame);
+static void phNxpEse_expectRxLen(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame);
+static void phNxpEse_learnRxLen(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame, int frameLen);
 static int poll_sof_chained_delay = 0;
 
 /*********************** Global Variables *************************************/
@@ -54,7 +80,9 @@ phNxpEse_Context_t gnxpese_ctxt;
  * param[out]       phNxpEse_data: ATR Response from ESE
  *
  * Returns          This function return ESESTATUS_SUCCES (0) in case of success
- *                  In case of failure returns other failure value.
+ *                  ESESTATUS_RESPONSE_TIMEOUT if the SE did not answer at all:
+ *                  writes not acknowledged, no frame read, e.g. still booting.
+ *                  In case of other failure returns other failure value.
  *
  ******************************************************************************/
 ESESTATUS phNxpEse_init(void *conn_ctx, phNxpEse_initParams initParams, phNxpEse_data *AtrRsp)
@@ -83,10 +111,14 @@ ESESTATUS phNxpEse_init(void *conn_ctx, phNxpEse_initParams initParams, phNxpEse
     }
 
     /* T=1 Protocol layer open */
+    (void)phPalEse_i2c_take_link_events();
     status = phNxpEseProto7816_Open((void*)nxpese_ctxt, protoInitParam , AtrRsp);
     if(FALSE == status)
     {
         wConfigStatus = ESESTATUS_FAILED;
+        if (phPalEse_i2c_take_link_events() == 0) {
+            wConfigStatus = ESESTATUS_RESPONSE_TIMEOUT;
+        }
         LOG_E("phNxpEseProto7816_Open failed ");
     }
     return wConfigStatus;
@@ -148,6 +180,7 @@ ESESTATUS phNxpEse_open(void **conn_ctx, phNxpEse_initParams initParams, const c
     pnxpese_ctxt->pDevHandle = tPalConfig.pDevHandle;
     /* STATUS_OPEN */
     pnxpese_ctxt->EseLibStatus = ESE_STATUS_OPEN;
+    pnxpese_ctxt->waitMode = ESE_WAIT_MODE_DEFAULT;
     phNxpEse_memcpy(&pnxpese_ctxt->initParams, &initParams, sizeof(phNxpEse_initParams));
     return wConfigStatus;
 
@@ -180,28 +213,15 @@ ESESTATUS phNxpEse_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data
     bool_t bStatus = FALSE;
     phNxpEse_Context_t* nxpese_ctxt = (conn_ctx == NULL) ? &gnxpese_ctxt : (phNxpEse_Context_t*)conn_ctx;
 
-    if((NULL == pCmd) || (NULL == pRsp)) {
-        return ESESTATUS_INVALID_PARAMETER;
-    }
-
-    if ((pCmd->len == 0) || pCmd->p_data == NULL )
+    status = phNxpEse_checkTransceive(nxpese_ctxt, pCmd, pRsp);
+    if (ESESTATUS_SUCCESS != status)
     {
-        LOG_E(" phNxpEse_Transceive - Invalid Parameter no data");
-        return ESESTATUS_INVALID_PARAMETER;
-    }
-    else if ((ESE_STATUS_CLOSE == nxpese_ctxt->EseLibStatus))
-    {
-        LOG_E(" %s ESE Not Initialized ", __FUNCTION__);
-        return ESESTATUS_NOT_INITIALISED;
-    }
-    else if ((ESE_STATUS_BUSY == nxpese_ctxt->EseLibStatus))
-    {
-        LOG_E(" %s ESE - BUSY ", __FUNCTION__);
-        return ESESTATUS_BUSY;
+        return status;
     }
     else
     {
         nxpese_ctxt->EseLibStatus = ESE_STATUS_BUSY;
+        phNxpEse_setWaitKey(nxpese_ctxt, pCmd);
         bStatus = phNxpEseProto7816_Transceive((void*)nxpese_ctxt, pCmd, pRsp);
         if(TRUE == bStatus)
         {
@@ -225,6 +245,222 @@ ESESTATUS phNxpEse_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data
     }
 }
 
+/******************************************************************************
+ * Function         phNxpEse_checkTransceive
+ *
+ * Description      This function validate ESE state & C-APDU data of a
+ *                  transceive request.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        phNxpEse_data: Command to ESE C-APDU
+ * param[in]        phNxpEse_data: Response from ESE R-APDU
+ *
+ * Returns          ESESTATUS_SUCCESS if the request can be processed else
+ *                  proper error code
+ *
+ ******************************************************************************/
+static ESESTATUS phNxpEse_checkTransceive(phNxpEse_Context_t *nxpese_ctxt, phNxpEse_data *pCmd, phNxpEse_data *pRsp)
+{
+    if((NULL == pCmd) || (NULL == pRsp)) {
+        return ESESTATUS_INVALID_PARAMETER;
+    }
+
+    if ((pCmd->len == 0) || pCmd->p_data == NULL )
+    {
+        LOG_E(" phNxpEse_Transceive - Invalid Parameter no data");
+        return ESESTATUS_INVALID_PARAMETER;
+    }
+    else if ((ESE_STATUS_CLOSE == nxpese_ctxt->EseLibStatus))
+    {
+        LOG_E(" %s ESE Not Initialized ", __FUNCTION__);
+        return ESESTATUS_NOT_INITIALISED;
+    }
+    else if ((ESE_STATUS_BUSY == nxpese_ctxt->EseLibStatus))
+    {
+        LOG_E(" %s ESE - BUSY ", __FUNCTION__);
+        return ESESTATUS_BUSY;
+    }
+    return ESESTATUS_SUCCESS;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_setWaitKey
+ *
+ * Description      Selects the command class the response latency of pCmd
+ *                  is learned for.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        phNxpEse_data: Command to ESE C-APDU
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_setWaitKey(phNxpEse_Context_t *nxpese_ctxt, const phNxpEse_data *pCmd)
+{
+    /* Response latency is learned per command class: CLA INS P1 P2 */
+    if (pCmd->len >= 4) {
+        nxpese_ctxt->waitKey = ESE_WAIT_KEY_VALID | ((uint32_t)pCmd->p_data[1] << 16) |
+                               ((uint32_t)pCmd->p_data[2] << 8) | pCmd->p_data[3];
+    }
+    else {
+        nxpese_ctxt->waitKey = 0;
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpEse_TransceiveStart
+ *
+ * Description      Non blocking variant of phNxpEse_Transceive. Sends the
+ *                  first frame of the C-APDU and returns. The exchange is
+ *                  then driven by calling phNxpEse_TransceivePoll once the
+ *                  delay it returns has elapsed. pRsp must stay valid until
+ *                  the exchange is complete. Synchronous transceive requests
+ *                  fail with ESESTATUS_BUSY meanwhile. Neither sleeps, a
+ *                  frame held back by the I2C write guard, a recovery
+ *                  back-off or a WTX is sent by a later poll.
+ *
+ * param[in]        connection context
+ * param[in]        phNxpEse_data: Command to ESE C-APDU
+ * param[out]      phNxpEse_data: Response from ESE R-APDU
+ *
+ * Returns          ESESTATUS_SUCCESS if the exchange was started else proper
+ *                  error code
+ *
+ ******************************************************************************/
+ESESTATUS phNxpEse_TransceiveStart(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp)
+{
+    ESESTATUS status = ESESTATUS_FAILED;
+    uint32_t delayUs = 0;
+    phNxpEse_Context_t* nxpese_ctxt = (conn_ctx == NULL) ? &gnxpese_ctxt : (phNxpEse_Context_t*)conn_ctx;
+
+    status = phNxpEse_checkTransceive(nxpese_ctxt, pCmd, pRsp);
+    if (ESESTATUS_SUCCESS != status)
+    {
+        return status;
+    }
+    nxpese_ctxt->EseLibStatus = ESE_STATUS_BUSY;
+    phNxpEse_setWaitKey(nxpese_ctxt, pCmd);
+    nxpese_ctxt->asyncRsp = *pRsp;
+    nxpese_ctxt->asyncPolls = 0;
+    nxpese_ctxt->finePollUntilUs = 0;
+    if (TRUE != phNxpEseProto7816_TransceiveStart((void*)nxpese_ctxt, pCmd, &nxpese_ctxt->asyncRsp, &delayUs))
+    {
+        LOG_E(" %s phNxpEseProto7816_TransceiveStart- Failed ", __FUNCTION__);
+        if (nxpese_ctxt->EseLibStatus != ESE_STATUS_CLOSE) {
+            nxpese_ctxt->EseLibStatus = ESE_STATUS_IDLE;
+        }
+        return ESESTATUS_FAILED;
+    }
+    nxpese_ctxt->asyncPending = 1;
+    nxpese_ctxt->asyncSendPending = (delayUs > 0) ? 1 : 0;
+    if (delayUs == 0) {
+        delayUs = phNxpEse_asyncPollDelayUs(nxpese_ctxt);
+    }
+    nxpese_ctxt->asyncPollTimeUs = sm_get_time_us() + delayUs;
+    return ESESTATUS_SUCCESS;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_TransceivePoll
+ *
+ * Description      Drives the exchange started by phNxpEse_TransceiveStart.
+ *                  Probes once for the NAD of a response frame, without
+ *                  sleeping. A received frame is processed and the next
+ *                  frame of the exchange is sent, or held back until the
+ *                  returned delay has elapsed and sent by the next poll.
+ *
+ * param[in]        connection context
+ * param[out]       uint32_t: length of the R-APDU when complete
+ * param[out]       uint32_t: delay in micro seconds until the next call is
+ *                  useful, while ESESTATUS_PENDING
+ *
+ * Returns          ESESTATUS_PENDING while the exchange continues,
+ *                  ESESTATUS_SUCCESS / ESESTATUS_FAILED when complete.
+ *
+ ******************************************************************************/
+ESESTATUS phNxpEse_TransceivePoll(void* conn_ctx, uint32_t *pRspLen, uint32_t *pNextPollUs)
+{
+    ESESTATUS status = ESESTATUS_FAILED;
+    bool_t bStatus = FALSE;
+    bool_t bComplete = FALSE;
+    uint32_t delayUs = 0;
+    int ret = 0;
+    uint64_t nowUs = 0;
+    phNxpEse_Context_t* nxpese_ctxt = (conn_ctx == NULL) ? &gnxpese_ctxt : (phNxpEse_Context_t*)conn_ctx;
+
+    ENSURE_OR_GO_EXIT(pRspLen != NULL);
+    ENSURE_OR_GO_EXIT(pNextPollUs != NULL);
+    *pNextPollUs = 0;
+    if (!nxpese_ctxt->asyncPending) {
+        LOG_E(" %s No transceive in progress ", __FUNCTION__);
+        status = ESESTATUS_INVALID_STATE;
+        goto exit;
+    }
+
+    nowUs = sm_get_time_us();
+    if (nowUs < nxpese_ctxt->asyncPollTimeUs) {
+        *pNextPollUs = (uint32_t)(nxpese_ctxt->asyncPollTimeUs - nowUs);
+        return ESESTATUS_PENDING;
+    }
+
+    if (nxpese_ctxt->asyncSendPending) {
+        /* Held back frame is due */
+        bStatus = phNxpEseProto7816_TransceiveResume((void*)nxpese_ctxt, &bComplete, &delayUs);
+        goto step_done;
+    }
+
+    ret = phNxpEse_pollPacket(nxpese_ctxt, nxpese_ctxt->p_read_buff, MAX_DATA_LEN);
+    if ((ret == 0) && (nxpese_ctxt->asyncPolls < ESE_NAD_POLLING_MAX) &&
+        (nxpese_ctxt->EseLibStatus != ESE_STATUS_CLOSE)) {
+        /* SE still busy */
+        *pNextPollUs = phNxpEse_asyncPollDelayUs(nxpese_ctxt);
+        nxpese_ctxt->asyncPollTimeUs = nowUs + *pNextPollUs;
+        return ESESTATUS_PENDING;
+    }
+    if (ret > 0) {
+        LOG_MAU8_D("RAW Rx<", nxpese_ctxt->p_read_buff, ret);
+    }
+    else if (ret == 0) {
+        LOG_E("%s No response from ESE ", __FUNCTION__);
+    }
+    else {
+        LOG_E("PAL Read status error status = %x", ret);
+    }
+
+    /* Frame received, or timeout / read failure which starts the recovery */
+    bStatus = phNxpEseProto7816_TransceiveStep((void*)nxpese_ctxt,
+        (ret > 0) ? TRUE : FALSE,
+        (ret > 0) ? (uint32_t)ret : 0,
+        nxpese_ctxt->p_read_buff,
+        &bComplete,
+        &delayUs);
+step_done:
+    if (FALSE == bComplete) {
+        nxpese_ctxt->asyncPolls = 0;
+        nxpese_ctxt->asyncSendPending = (delayUs > 0) ? 1 : 0;
+        *pNextPollUs = (delayUs > 0) ? delayUs : phNxpEse_asyncPollDelayUs(nxpese_ctxt);
+        nxpese_ctxt->asyncPollTimeUs = sm_get_time_us() + *pNextPollUs;
+        return ESESTATUS_PENDING;
+    }
+
+    nxpese_ctxt->asyncSendPending = 0;
+    nxpese_ctxt->asyncPending = 0;
+    if (nxpese_ctxt->EseLibStatus != ESE_STATUS_CLOSE) {
+        nxpese_ctxt->EseLibStatus = ESE_STATUS_IDLE;
+    }
+    if (TRUE == bStatus) {
+        *pRspLen = nxpese_ctxt->asyncRsp.len;
+        status = ESESTATUS_SUCCESS;
+    }
+    else {
+        LOG_E(" %s phNxpEseProto7816_TransceiveStep- Failed ", __FUNCTION__);
+        status = ESESTATUS_FAILED;
+    }
+    LOG_D(" %s Exit status 0x%x ", __FUNCTION__, status);
+exit:
+    return status;
+}
+
 /******************************************************************************
  * Function         phNxpEse_reset
  *
@@ -440,6 +676,382 @@ exit:
     return status;
 }
 
+/******************************************************************************
+ * Function         phNxpEse_sleepUs
+ *
+ * Description      Sleeps for the given number of micro seconds. Whole milli
+ *                  seconds use sm_sleep, the remainder uses sm_usleep.
+ *
+ * param[in]        uint32_t: time to sleep in micro seconds
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_sleepUs(uint32_t sleepUs)
+{
+    if (sleepUs >= 1000) {
+        sm_sleep(sleepUs / 1000);
+    }
+    if ((sleepUs % 1000) != 0) {
+        sm_usleep(sleepUs % 1000);
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpEse_getWaitSlot
+ *
+ * Description      Returns the latency history of a command class. The model
+ *                  is direct mapped, a colliding command class replaces the
+ *                  previous one when bCreate is TRUE.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint32_t: command class key
+ * param[in]        bool_t: create the slot if not present
+ *
+ * Returns          Pointer to the slot or NULL
+ *
+ ******************************************************************************/
+static phNxpEse_waitSlot_t *phNxpEse_getWaitSlot(phNxpEse_Context_t *nxpese_ctxt, uint32_t key, bool_t bCreate)
+{
+    phNxpEse_waitSlot_t *pSlot = NULL;
+    uint32_t index = ((key * 2654435761u) >> 16) % ESE_WAIT_MODEL_SLOTS;
+
+    if ((key & ESE_WAIT_KEY_VALID) == 0) {
+        return NULL;
+    }
+    pSlot = &nxpese_ctxt->waitModel[index];
+    if (pSlot->key != key) {
+        if (!bCreate) {
+            return NULL;
+        }
+        phNxpEse_memset(pSlot, 0x00, sizeof(*pSlot));
+        pSlot->key = key;
+    }
+    return pSlot;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_expectedLatencyUs
+ *
+ * Description      Expected processing time of a command class. The minimum
+ *                  of the recent samples is used so that the host does not
+ *                  over sleep when the SE is faster than usual.
+ *
+ * param[in]        phNxpEse_waitSlot_t: latency history
+ *
+ * Returns          Expected latency in micro seconds, 0 if unknown
+ *
+ ******************************************************************************/
+static uint32_t phNxpEse_expectedLatencyUs(const phNxpEse_waitSlot_t *pSlot)
+{
+    uint32_t expected = UINT32_MAX;
+    uint8_t i = 0;
+
+    if ((pSlot == NULL) || (pSlot->count == 0)) {
+        return 0;
+    }
+    for (i = 0; i < pSlot->count; i++) {
+        if (pSlot->samples_us[i] < expected) {
+            expected = pSlot->samples_us[i];
+        }
+    }
+    return expected;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_recordLatency
+ *
+ * Description      Adds the latency of the APDU in progress to the rolling
+ *                  history of its command class.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint64_t: time stamp when the response was detected
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_recordLatency(phNxpEse_Context_t *nxpese_ctxt, uint64_t rxTimeUs)
+{
+    phNxpEse_waitSlot_t *pSlot = NULL;
+    uint64_t latencyUs = 0;
+
+    if (!nxpese_ctxt->latencyPending) {
+        return;
+    }
+    nxpese_ctxt->latencyPending = 0;
+    if (rxTimeUs < nxpese_ctxt->txDoneTimeUs) {
+        return;
+    }
+    pSlot = phNxpEse_getWaitSlot(nxpese_ctxt, nxpese_ctxt->waitKey, TRUE);
+    if (pSlot == NULL) {
+        return;
+    }
+    latencyUs = rxTimeUs - nxpese_ctxt->txDoneTimeUs;
+    pSlot->samples_us[pSlot->next] = (latencyUs > UINT32_MAX) ? UINT32_MAX : (uint32_t)latencyUs;
+    pSlot->next = (pSlot->next + 1) % ESE_WAIT_MODEL_HISTORY;
+    if (pSlot->count < ESE_WAIT_MODEL_HISTORY) {
+        pSlot->count++;
+    }
+    LOG_D("%s key 0x%06X latency %lu us", __FUNCTION__, nxpese_ctxt->waitKey & 0xFFFFFF, (unsigned long)latencyUs);
+}
+
+/******************************************************************************
+ * Function         phNxpEse_trackTxFrame
+ *
+ * Description      Tracks the frames written to the SE. Writing the last
+ *                  I-frame of an APDU starts the latency measurement and
+ *                  arms the wait for the next read.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint8_t: T=1 frame written to the SE
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_trackTxFrame(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame)
+{
+    uint8_t pcb = p_frame[PH_PROPTO_7816_PCB_OFFSET];
+
+    nxpese_ctxt->waitArmed = 0;
+    if (nxpese_ctxt->waitMode == ESE_WAIT_POLL) {
+        nxpese_ctxt->latencyPending = 0;
+        return;
+    }
+    if ((pcb & 0x80) == 0x00) {
+        /* I-frame, the SE starts processing after the last one */
+        if ((pcb & PH_PROTO_7816_CHAINING) == 0x00) {
+            nxpese_ctxt->txDoneTimeUs = sm_get_time_us();
+            nxpese_ctxt->waitArmed = 1;
+            nxpese_ctxt->latencyPending = 1;
+        }
+        else {
+            nxpese_ctxt->latencyPending = 0;
+        }
+    }
+    else if ((pcb & 0xC0) == 0x80) {
+        /* R-frame, an ACK/NACK does not measure the command */
+        nxpese_ctxt->latencyPending = 0;
+    }
+    else {
+        /* S-frame, e.g. WTX response: the command is still being processed */
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpEse_expectRxLen
+ *
+ * Description      Sets the INF length the NAD probe reads along, from the
+ *                  frame written to the SE. After the last I-frame of an
+ *                  APDU it is the shorter of the last two lengths learned for
+ *                  the command class, at most ESE_SPECULATIVE_READ_MAX_INF.
+ *                  After a chained one the SE answers with an R-frame.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint8_t: T=1 frame written to the SE
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_expectRxLen(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame)
+{
+    uint8_t pcb = p_frame[PH_PROPTO_7816_PCB_OFFSET];
+    phNxpEse_waitSlot_t *pSlot = NULL;
+
+    if ((pcb & 0x80) != 0x00) {
+        /* R- and S-frames do not change what the SE answers with next */
+        return;
+    }
+    nxpese_ctxt->rxExpectLen = 0;
+    nxpese_ctxt->rspLenPending = 0;
+    if ((pcb & PH_PROTO_7816_CHAINING) == 0x00) {
+        pSlot = phNxpEse_getWaitSlot(nxpese_ctxt, nxpese_ctxt->waitKey, FALSE);
+        if ((pSlot != NULL) && (pSlot->rspCount > 0)) {
+            nxpese_ctxt->rxExpectLen = pSlot->rspLen[0];
+            if ((pSlot->rspCount > 1) && (pSlot->rspLen[1] < nxpese_ctxt->rxExpectLen)) {
+                nxpese_ctxt->rxExpectLen = pSlot->rspLen[1];
+            }
+            if (nxpese_ctxt->rxExpectLen > ESE_SPECULATIVE_READ_MAX_INF) {
+                nxpese_ctxt->rxExpectLen = ESE_SPECULATIVE_READ_MAX_INF;
+            }
+        }
+        nxpese_ctxt->rspLenPending = 1;
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpEse_learnRxLen
+ *
+ * Description      Learns from a frame read from the SE. The INF lengths of
+ *                  the first I-frame of the last two responses are kept for
+ *                  the command class. A chained I-frame is expected to be followed by one
+ *                  of the same length, anything else by a frame without INF.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint8_t: T=1 frame read from the SE
+ * param[in]        int: length of the frame
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_learnRxLen(phNxpEse_Context_t *nxpese_ctxt, const uint8_t *p_frame, int frameLen)
+{
+    uint8_t pcb = p_frame[PH_PROPTO_7816_PCB_OFFSET];
+    int infLen = frameLen - PH_PROTO_7816_HEADER_LEN - PH_PROTO_7816_CRC_LEN;
+    phNxpEse_waitSlot_t *pSlot = NULL;
+
+    if ((pcb & 0x80) != 0x00) {
+        /* R-frame, or S-frame such as a WTX request: the response is still to come */
+        return;
+    }
+    if (nxpese_ctxt->rspLenPending) {
+        nxpese_ctxt->rspLenPending = 0;
+        pSlot = phNxpEse_getWaitSlot(nxpese_ctxt, nxpese_ctxt->waitKey, TRUE);
+        if (pSlot != NULL) {
+            pSlot->rspLen[1] = pSlot->rspLen[0];
+            pSlot->rspLen[0] = (uint16_t)infLen;
+            if (pSlot->rspCount < 2) {
+                pSlot->rspCount++;
+            }
+        }
+    }
+    nxpese_ctxt->rxExpectLen = ((pcb & PH_PROTO_7816_CHAINING) != 0x00) ? (uint16_t)infLen : 0;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_waitForResponse
+ *
+ * Description      Called before polling for a response. For the first read
+ *                  after the last I-frame of an APDU this either waits on the
+ *                  data ready line or sleeps most of the learned processing
+ *                  time in one go. Sub milli second polling follows.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        void: device handle
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void phNxpEse_waitForResponse(phNxpEse_Context_t *nxpese_ctxt, void *pDevHandle)
+{
+    uint32_t sleepUs = 0;
+    int ready = -1;
+
+    if (!nxpese_ctxt->waitArmed) {
+        return;
+    }
+    nxpese_ctxt->waitArmed = 0;
+    nxpese_ctxt->finePollUntilUs = 0;
+
+    if (nxpese_ctxt->waitMode == ESE_WAIT_DATA_READY) {
+        ready = phPalEse_i2c_wait_data_ready(pDevHandle, ESE_DATA_READY_TIMEOUT_MS * 1000u);
+        if (ready > 0) {
+            nxpese_ctxt->finePollUntilUs = sm_get_time_us() + ESE_WAIT_FINE_WINDOW_US;
+            return;
+        }
+        if (ready == 0) {
+            /* Timeout, continue with normal polling */
+            return;
+        }
+        /* No data ready line, fall back to the adaptive wait */
+    }
+
+    sleepUs = phNxpEse_adaptiveSleepUs(nxpese_ctxt);
+    if (sleepUs != 0) {
+        phNxpEse_sleepUs(sleepUs);
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpEse_adaptiveSleepUs
+ *
+ * Description      Time left of the share of the learned processing time
+ *                  that is slept in one go. Also sets up the fine polling
+ *                  window around the expected completion.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ *
+ * Returns          Time to sleep in micro seconds, 0 if nothing is learned
+ *                  yet for this command
+ *
+ ******************************************************************************/
+static uint32_t phNxpEse_adaptiveSleepUs(phNxpEse_Context_t *nxpese_ctxt)
+{
+    uint32_t expectedUs = 0;
+    uint32_t sleepUs = 0;
+    uint64_t nowUs = 0;
+    uint64_t elapsedUs = 0;
+
+    expectedUs = phNxpEse_expectedLatencyUs(
+        phNxpEse_getWaitSlot(nxpese_ctxt, nxpese_ctxt->waitKey, FALSE));
+    if (expectedUs == 0) {
+        /* Nothing learned yet for this command */
+        return 0;
+    }
+
+    nowUs = sm_get_time_us();
+    elapsedUs = (nowUs > nxpese_ctxt->txDoneTimeUs) ? (nowUs - nxpese_ctxt->txDoneTimeUs) : 0;
+    sleepUs = (uint32_t)(((uint64_t)expectedUs * ESE_WAIT_SLEEP_PERCENT) / 100);
+    nxpese_ctxt->finePollUntilUs = nxpese_ctxt->txDoneTimeUs + expectedUs + ESE_WAIT_FINE_WINDOW_US;
+    return (sleepUs > elapsedUs) ? (uint32_t)(sleepUs - elapsedUs) : 0;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_pollDelayUs
+ *
+ * Description      Delay before the next NAD probe. Fine grained around the
+ *                  expected completion time, ESE_POLL_DELAY_MS otherwise.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ *
+ * Returns          Poll delay in micro seconds
+ *
+ ******************************************************************************/
+static uint32_t phNxpEse_pollDelayUs(phNxpEse_Context_t *nxpese_ctxt)
+{
+    if ((nxpese_ctxt->finePollUntilUs != 0) && (sm_get_time_us() < nxpese_ctxt->finePollUntilUs)) {
+        return ESE_POLL_FINE_DELAY_US;
+    }
+    nxpese_ctxt->finePollUntilUs = 0;
+    return ESE_POLL_DELAY_US;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_asyncPollDelayUs
+ *
+ * Description      Delay before the next NAD probe of phNxpEse_TransceivePoll.
+ *                  Same pacing as phNxpEse_readPacket, but returned instead
+ *                  of slept. The data ready line is not waited on, the
+ *                  learned processing time is used instead.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ *
+ * Returns          Poll delay in micro seconds
+ *
+ ******************************************************************************/
+static uint32_t phNxpEse_asyncPollDelayUs(phNxpEse_Context_t *nxpese_ctxt)
+{
+    uint32_t delayUs = 0;
+
+    if (nxpese_ctxt->waitArmed) {
+        /* First read after the last I-frame of the APDU */
+        nxpese_ctxt->waitArmed = 0;
+        nxpese_ctxt->finePollUntilUs = 0;
+        if (nxpese_ctxt->waitMode != ESE_WAIT_POLL) {
+            delayUs = phNxpEse_adaptiveSleepUs(nxpese_ctxt);
+            if (delayUs != 0) {
+                return delayUs;
+            }
+        }
+    }
+    delayUs = phNxpEse_pollDelayUs(nxpese_ctxt);
+    if (delayUs >= ESE_POLL_DELAY_US) {
+        /* Only the 1ms polls count for the timeout, each one backs off ESE_POLL_DELAY_MS more */
+        nxpese_ctxt->asyncPolls++;
+        delayUs += ESE_POLL_DELAY_MS * 1000u;
+    }
+    return delayUs;
+}
+
 /******************************************************************************
  * Function         phNxpEse_readPacket
  *
@@ -459,46 +1071,37 @@ static int phNxpEse_readPacket(void* conn_ctx, void *pDevHandle, uint8_t * pBuff
 {
     int ret = -1;
     int sof_counter = 0;/* one read may take 1 ms*/
-    int total_count = 0 ,numBytesToRead=0, headerIndex=0;
+    int numRead = 0, probeLen = 0;
+    int bufferLen = nNbBytesToRead;
+    uint32_t pollDelayUs = ESE_POLL_DELAY_US;
+    uint64_t sofTimeUs = 0;
     phNxpEse_Context_t* nxpese_ctxt = (conn_ctx == NULL) ? &gnxpese_ctxt : (phNxpEse_Context_t*)conn_ctx;
 
+    SM_METRICS_START(phaseStartUs);
+
     ENSURE_OR_GO_EXIT(pBuffer != NULL);
     memset(pBuffer,0,nNbBytesToRead);
+    phNxpEse_waitForResponse(nxpese_ctxt, pDevHandle);
     do
     {
-        sof_counter++;
+        pollDelayUs = phNxpEse_pollDelayUs(nxpese_ctxt);
+        if (pollDelayUs >= ESE_POLL_DELAY_US) {
+            /* Fine polling is bounded in time, only the 1ms polls count for the timeout */
+            sof_counter++;
+        }
         ret = -1;
-        sm_sleep(ESE_POLL_DELAY_MS); /* 1ms delay to give ESE polling delay */
-        ret = phPalEse_i2c_read(pDevHandle, pBuffer, 2); /*read NAD PCB byte first*/
+        phNxpEse_sleepUs(pollDelayUs); /* delay to give ESE polling delay */
+        probeLen = phNxpEse_probeLen(nxpese_ctxt, bufferLen);
+        ret = phPalEse_i2c_read(pDevHandle, pBuffer, probeLen); /*read NAD PCB byte first*/
         if (ret < 0)
         {
             /*Polling for read on i2c, hence Debug log*/
             LOG_D("_i2c_read() [HDR]errno : %x ret : %X", errno, ret);
         }
-        if(pBuffer[0] == RECIEVE_PACKET_SOF)
-        {
-            /* Read the HEADR of Two bytes*/
-            LOG_D("%s Read HDR", __FUNCTION__);
-            pBuffer[0] = RECIEVE_PACKET_SOF;
-#if defined(T1oI2C_UM11225)
-            numBytesToRead = 1;
-#elif defined(T1oI2C_GP1_0)
-            numBytesToRead = 2;
-#endif
-            headerIndex = 1;
-            break;
-        }
-        if(pBuffer[1] == RECIEVE_PACKET_SOF)
+        if(phNxpEse_findSof(pBuffer, probeLen, &numRead))
         {
             /* Read the HEADR of Two bytes*/
             LOG_D("%s Read HDR", __FUNCTION__);
-            pBuffer[0] = RECIEVE_PACKET_SOF;
-#if defined(T1oI2C_UM11225)
-            numBytesToRead = 2;
-#elif defined(T1oI2C_GP1_0)
-            numBytesToRead = 3;
-#endif
-            headerIndex = 0;
             break;
         }
         /*if host writes invalid frame and host and SE are out of sync*/
@@ -507,35 +1110,15 @@ static int phNxpEse_readPacket(void* conn_ctx, void *pDevHandle, uint8_t * pBuff
             LOG_W("%s Recieved NAD byte 0x%x ",__FUNCTION__,pBuffer[0]);
             LOG_W("%s NAD error, clearing the read buffer ", __FUNCTION__);
             /*retry to get all data*/
-#if defined(T1oI2C_UM11225)
-            numBytesToRead = 1;
-#elif defined(T1oI2C_GP1_0)
-            numBytesToRead = 2;
-#endif
-            headerIndex = 1;
-            ret = phPalEse_i2c_read(pDevHandle, &pBuffer[1+headerIndex], numBytesToRead);
-#if defined(T1oI2C_UM11225)
-            total_count = 3;
-            nNbBytesToRead = pBuffer[2];
-#elif defined(T1oI2C_GP1_0)
-            total_count = 4;
-            nNbBytesToRead = (pBuffer[2] << 8 & 0xFF) | (pBuffer[3] & 0xFF) ;
-#endif
-            /* Read the Complete data + two byte CRC*/
-            ret = phPalEse_i2c_read(pDevHandle, &pBuffer[PH_PROTO_7816_HEADER_LEN], (nNbBytesToRead+PH_PROTO_7816_CRC_LEN));
-            if (ret < 0)
-            {
-                LOG_D("_i2c_read() [HDR]errno : %x ret : %X", errno, ret);
-                ret = -1;
-            }
-            else
-            {
-                ret = (total_count + (nNbBytesToRead + PH_PROTO_7816_CRC_LEN));
-            }
+            ret = phNxpEse_readTail(pDevHandle, pBuffer, bufferLen, probeLen);
             break;
         }
+        if (pollDelayUs < ESE_POLL_DELAY_US)
+        {
+            /* Fine polling, no additional back off */
+        }
         /*If it is Chained packet wait for 1 ms*/
-        if(poll_sof_chained_delay == 1)
+        else if(poll_sof_chained_delay == 1)
         {
             LOG_D("%s Chained Pkt, delay read %dms",__FUNCTION__,ESE_POLL_DELAY_MS * CHAINED_PKT_SCALER);
             sm_sleep(ESE_POLL_DELAY_MS);
@@ -549,48 +1132,214 @@ static int phNxpEse_readPacket(void* conn_ctx, void *pDevHandle, uint8_t * pBuff
     if((pBuffer[0] == RECIEVE_PACKET_SOF) && (ret > 0))
     {
         LOG_D("%s SOF FOUND", __FUNCTION__);
-        /* Read the HEADR of one/Two bytes based on how two bytes read A5 PCB or 00 A5*/
-        ret = phPalEse_i2c_read(pDevHandle, &pBuffer[1+headerIndex], numBytesToRead);
+        sofTimeUs = sm_get_time_us();
+        SM_METRICS_PHASE(SM_METRICS_PHASE_SE_BUSY, NULL, phaseStartUs);
+        ret = phNxpEse_readFrame(nxpese_ctxt, pDevHandle, pBuffer, bufferLen, numRead, sofTimeUs);
+   }
+   else
+   {
+       ret=-1;
+   }
+exit:
+    return ret;
+}
+/******************************************************************************
+ * Function         phNxpEse_probeLen
+ *
+ * Description      Number of bytes read by a NAD probe. With
+ *                  ESE_SPECULATIVE_READ the header, the expected INF and the
+ *                  CRC are read along, so that a frame of the expected length
+ *                  takes one I2C read. Bytes beyond the end of a shorter frame
+ *                  are dropped.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        int: size of the read buffer
+ *
+ * Returns          Number of bytes to read
+ *
+ ******************************************************************************/
+static int phNxpEse_probeLen(phNxpEse_Context_t *nxpese_ctxt, int bufferLen)
+{
+#if ESE_SPECULATIVE_READ
+    int probeLen = PH_PROTO_7816_HEADER_LEN + nxpese_ctxt->rxExpectLen + PH_PROTO_7816_CRC_LEN;
+    return (probeLen > bufferLen) ? bufferLen : probeLen;
+#else
+    (void)nxpese_ctxt;
+    (void)bufferLen;
+    return 2; /*read NAD PCB byte first*/
+#endif
+}
+
+/******************************************************************************
+ * Function         phNxpEse_findSof
+ *
+ * Description      Checks the start of a NAD probe for the start of a
+ *                  frame, either "A5 PCB" or "xx A5". In the latter case the
+ *                  probed bytes are moved so that the frame starts at
+ *                  pBuffer[0].
+ *
+ * param[in,out]    uint8_t: probed bytes
+ * param[in]        int: number of probed bytes
+ * param[out]       int: number of bytes of the frame in pBuffer
+ *
+ * Returns          TRUE if the SOF was found
+ *
+ ******************************************************************************/
+static bool_t phNxpEse_findSof(uint8_t *pBuffer, int probeLen, int *pNumRead)
+{
+    if(pBuffer[0] == RECIEVE_PACKET_SOF)
+    {
+        *pNumRead = probeLen;
+        return TRUE;
+    }
+    if(pBuffer[1] == RECIEVE_PACKET_SOF)
+    {
+        memmove(pBuffer, &pBuffer[1], probeLen - 1);
+        pBuffer[probeLen - 1] = 0;
+        *pNumRead = probeLen - 1;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_readTail
+ *
+ * Description      Completes a frame of which the first bytes are already
+ *                  read: the rest of the header, then the rest of the data
+ *                  and the CRC.
+ *
+ * param[in]        void: device handle
+ * param[in,out]    uint8_t: frame buffer
+ * param[in]        int: size of pBuffer
+ * param[in]        int: number of bytes of the frame already in pBuffer
+ *
+ * Returns          ret - length of the frame
+ *                  -1  - read operation failure
+ *
+ ******************************************************************************/
+static int phNxpEse_readTail(void *pDevHandle, uint8_t *pBuffer, int bufferLen, int numRead)
+{
+    int ret = -1;
+    int frameLen = 0;
+
+    if (numRead < PH_PROTO_7816_HEADER_LEN)
+    {
+        ret = phPalEse_i2c_read(pDevHandle, &pBuffer[numRead], PH_PROTO_7816_HEADER_LEN - numRead);
         if (ret < 0)
         {
             LOG_D("_i2c_read() [HDR]errno : %x ret : %X", errno, ret);
         }
-        if((pBuffer[1] == CHAINED_PACKET_WITHOUTSEQN) || (pBuffer[1] == CHAINED_PACKET_WITHSEQN))
-        {
-            poll_sof_chained_delay = 1;
-            LOG_D("poll_sof_chained_delay value is %d ", poll_sof_chained_delay);
-        }
-        else
-        {
-            poll_sof_chained_delay = 0;
-            LOG_D("poll_sof_chained_delay value is %d ", poll_sof_chained_delay);
-        }
+        numRead = PH_PROTO_7816_HEADER_LEN;
+    }
 #if defined(T1oI2C_UM11225)
-        total_count = 3;
-        nNbBytesToRead = pBuffer[2];
+    frameLen = pBuffer[2];
 #elif defined(T1oI2C_GP1_0)
-        total_count = 4;
-        nNbBytesToRead = (pBuffer[2] << 8 & 0xFF) | (pBuffer[3] & 0xFF) ;
+    frameLen = ((pBuffer[2] << 8) & 0xFF00) | (pBuffer[3] & 0xFF) ;
 #endif
+    frameLen += PH_PROTO_7816_HEADER_LEN + PH_PROTO_7816_CRC_LEN;
+    if (frameLen > bufferLen) {
+        LOG_E("%s Frame of %d bytes does not fit ", __FUNCTION__, frameLen);
+        return -1;
+    }
+    if (numRead < frameLen)
+    {
         /* Read the Complete data + two byte CRC*/
-        ret = phPalEse_i2c_read(pDevHandle, &pBuffer[PH_PROTO_7816_HEADER_LEN], (nNbBytesToRead+PH_PROTO_7816_CRC_LEN));
+        SM_METRICS_EVENT(SM_METRICS_EV_I2C_READ_TAIL);
+        ret = phPalEse_i2c_read(pDevHandle, &pBuffer[numRead], frameLen - numRead);
         if (ret < 0)
         {
-            LOG_D("_i2c_read() [HDR]errno : %x ret : %X", errno, ret);
-            ret = -1;
+            LOG_D("_i2c_read() [DATA]errno : %x ret : %X", errno, ret);
+            return -1;
         }
-        else
-        {
-            ret = (total_count + (nNbBytesToRead+PH_PROTO_7816_CRC_LEN));
+    }
+    return frameLen;
+}
+
+/******************************************************************************
+ * Function         phNxpEse_readFrame
+ *
+ * Description      Reads the rest of a frame once its SOF was found: what
+ *                  the NAD probe did not read of the header, the data and
+ *                  the CRC.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        void: device handle
+ * param[in,out]    uint8_t: frame buffer, the SOF already in pBuffer[0]
+ * param[in]        int: size of pBuffer
+ * param[in]        int: number of bytes of the frame already in pBuffer
+ * param[in]        uint64_t: time stamp the SOF was found
+ *
+ * Returns          ret - length of the frame
+ *                  -1  - read operation failure
+ *
+ ******************************************************************************/
+static int phNxpEse_readFrame(phNxpEse_Context_t *nxpese_ctxt, void *pDevHandle, uint8_t *pBuffer, int bufferLen,
+    int numRead, uint64_t sofTimeUs)
+{
+    int ret = -1;
+
+    SM_METRICS_START(phaseStartUs);
+
+    ret = phNxpEse_readTail(pDevHandle, pBuffer, bufferLen, numRead);
+    if((pBuffer[1] == CHAINED_PACKET_WITHOUTSEQN) || (pBuffer[1] == CHAINED_PACKET_WITHSEQN))
+    {
+        poll_sof_chained_delay = 1;
+        LOG_D("poll_sof_chained_delay value is %d ", poll_sof_chained_delay);
+    }
+    else
+    {
+        poll_sof_chained_delay = 0;
+        LOG_D("poll_sof_chained_delay value is %d ", poll_sof_chained_delay);
+    }
+    if (ret > 0)
+    {
+        SM_METRICS_PHASE(SM_METRICS_PHASE_I2C_READ, NULL, phaseStartUs);
+        phNxpEse_learnRxLen(nxpese_ctxt, pBuffer, ret);
+        if ((pBuffer[PH_PROPTO_7816_PCB_OFFSET] & 0x80) == 0x00) {
+            /* I-frame: the SE completed processing of the command */
+            phNxpEse_recordLatency(nxpese_ctxt, sofTimeUs);
         }
-   }
-   else
-   {
-       ret=-1;
-   }
-exit:
+    }
     return ret;
 }
+
+/******************************************************************************
+ * Function         phNxpEse_pollPacket
+ *
+ * Description      Non blocking variant of phNxpEse_readPacket: probes once
+ *                  for the NAD, and reads the frame if it is there.
+ *
+ * param[in]        phNxpEse_Context_t: ESE context
+ * param[in]        uint8_t: pointer to read buffer
+ * param[in]        int : MAX bytes to read
+ *
+ * Returns          ret - number of successfully read bytes
+ *                  0   - SE still busy, no frame yet
+ *                  -1  - read operation failure
+ *
+ ******************************************************************************/
+static int phNxpEse_pollPacket(phNxpEse_Context_t *nxpese_ctxt, uint8_t *pBuffer, int bufferLen)
+{
+    int ret = -1;
+    int numRead = 0, probeLen = 0;
+
+    memset(pBuffer, 0, bufferLen);
+    probeLen = phNxpEse_probeLen(nxpese_ctxt, bufferLen);
+    ret = phPalEse_i2c_read(nxpese_ctxt->pDevHandle, pBuffer, probeLen); /*read NAD PCB byte first*/
+    if (ret < 0)
+    {
+        /*Polling for read on i2c, hence Debug log*/
+        LOG_D("_i2c_read() [HDR]errno : %x ret : %X", errno, ret);
+    }
+    if (!phNxpEse_findSof(pBuffer, probeLen, &numRead))
+    {
+        return 0;
+    }
+    LOG_D("%s SOF FOUND", __FUNCTION__);
+    return phNxpEse_readFrame(
+        nxpese_ctxt, nxpese_ctxt->pDevHandle, pBuffer, bufferLen, numRead, sm_get_time_us());
+}
 /******************************************************************************
  * Function         phNxpEse_WriteFrame
  *
@@ -618,12 +1367,15 @@ ESESTATUS phNxpEse_WriteFrame(void* conn_ctx, uint32_t data_len, const uint8_t *
     nxpese_ctxt->cmd_len = data_len;
     if(nxpese_ctxt->EseLibStatus != ESE_STATUS_CLOSE)
     {
+        SM_METRICS_START(writeStartUs);
         dwNoBytesWrRd = phPalEse_i2c_write(nxpese_ctxt->pDevHandle,
                             nxpese_ctxt->p_cmd_data,
                             nxpese_ctxt->cmd_len
                             );
+        SM_METRICS_PHASE(SM_METRICS_PHASE_I2C_WRITE, NULL, writeStartUs);
         if (-1 == dwNoBytesWrRd)
         {
+            SM_METRICS_EVENT(SM_METRICS_EV_I2C_WRITE_ERROR);
             LOG_E(" - Error in I2C Write.....");
             status = ESESTATUS_FAILED;
         }
@@ -634,6 +1386,8 @@ ESESTATUS phNxpEse_WriteFrame(void* conn_ctx, uint32_t data_len, const uint8_t *
         else
         {
             status = ESESTATUS_SUCCESS;
+            phNxpEse_trackTxFrame(nxpese_ctxt, nxpese_ctxt->p_cmd_data);
+            phNxpEse_expectRxLen(nxpese_ctxt, nxpese_ctxt->p_cmd_data);
             LOG_MAU8_D("RAW Tx>",nxpese_ctxt->p_cmd_data, nxpese_ctxt->cmd_len );
         }
     }
@@ -659,6 +1413,35 @@ ESESTATUS phNxpEse_setIfsc(uint16_t IFSC_Size)
     return ESESTATUS_SUCCESS;
 }
 
+/******************************************************************************
+ * Function         phNxpEse_setWaitMode
+ *
+ * Description      This function selects how the host waits for the response
+ *                  of the SE. Call it after the connection is opened.
+ *
+ * param[in]        void*: connection context
+ * param[in]        phNxpEse_waitMode: wait mode
+ *
+ * Returns          On Success ESESTATUS_SUCCESS else proper error code.
+ *
+ ******************************************************************************/
+ESESTATUS phNxpEse_setWaitMode(void* conn_ctx, phNxpEse_waitMode waitMode)
+{
+    phNxpEse_Context_t* nxpese_ctxt = (conn_ctx == NULL) ? &gnxpese_ctxt : (phNxpEse_Context_t*)conn_ctx;
+
+    if ((waitMode != ESE_WAIT_POLL) && (waitMode != ESE_WAIT_ADAPTIVE) && (waitMode != ESE_WAIT_DATA_READY)) {
+        return ESESTATUS_INVALID_PARAMETER;
+    }
+    if (ESE_STATUS_CLOSE == nxpese_ctxt->EseLibStatus) {
+        return ESESTATUS_NOT_INITIALISED;
+    }
+    nxpese_ctxt->waitMode = waitMode;
+    nxpese_ctxt->waitArmed = 0;
+    nxpese_ctxt->latencyPending = 0;
+    nxpese_ctxt->finePollUntilUs = 0;
+    return ESESTATUS_SUCCESS;
+}
+
 /******************************************************************************
  * Function         phNxpEse_memset
  *
@@ -50,10 +50,23 @@ typedef struct phNxpEse_initParams
     phNxpEse_initMode initMode; /*!< Ese communication mode */
 } phNxpEse_initParams;
 
+/**
+ *
+ * \brief How the host waits for the response of the SE
+ *
+ */
+typedef enum
+{
+    ESE_WAIT_POLL = 0, /*!< Poll for the NAD every ESE_POLL_DELAY_MS (legacy behaviour) */
+    ESE_WAIT_ADAPTIVE, /*!< Sleep the learned processing time of the command, then poll at ESE_POLL_FINE_DELAY_US */
+    ESE_WAIT_DATA_READY, /*!< Wait on the data ready line (see phPalEse_i2c_set_data_ready_hook), then poll */
+} phNxpEse_waitMode;
 
 ESESTATUS phNxpEse_init(void *conn_ctx, phNxpEse_initParams initParams, phNxpEse_data *AtrRsp);
 ESESTATUS phNxpEse_open(void **conn_ctx, phNxpEse_initParams initParams, const char *pConnString);
 ESESTATUS phNxpEse_Transceive(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp);
+ESESTATUS phNxpEse_TransceiveStart(void* conn_ctx, phNxpEse_data *pCmd, phNxpEse_data *pRsp);
+ESESTATUS phNxpEse_TransceivePoll(void* conn_ctx, uint32_t *pRspLen, uint32_t *pNextPollUs);
 ESESTATUS phNxpEse_deInit(void* conn_ctx);
 ESESTATUS phNxpEse_close(void* conn_ctx);
 ESESTATUS phNxpEse_reset(void* conn_ctx);
@@ -66,5 +79,6 @@ void *phNxpEse_memalloc(uint32_t size);
 void phNxpEse_free(void* ptr);
 ESESTATUS phNxpEse_getAtr(void* conn_ctx, phNxpEse_data *pRsp);
 ESESTATUS phNxpEse_getCip(void* conn_ctx, phNxpEse_data *pRsp);
+ESESTATUS phNxpEse_setWaitMode(void* conn_ctx, phNxpEse_waitMode waitMode);
 /** @} */
 #endif /* _PHNXPESE_API_H_ */
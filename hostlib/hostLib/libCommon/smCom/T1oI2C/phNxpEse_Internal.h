@@ -34,6 +34,52 @@ typedef enum
    ESE_STATUS_OPEN,
 } phNxpEse_LibStatus;
 
+/* Number of command classes (INS/P1/P2) for which response latency is learned */
+#ifndef ESE_WAIT_MODEL_SLOTS
+#define ESE_WAIT_MODEL_SLOTS 16
+#endif
+
+/* Number of recent latency samples kept per command class */
+#ifndef ESE_WAIT_MODEL_HISTORY
+#define ESE_WAIT_MODEL_HISTORY 8
+#endif
+
+/* Share (in percent) of the expected latency slept in one go before polling */
+#ifndef ESE_WAIT_SLEEP_PERCENT
+#define ESE_WAIT_SLEEP_PERCENT 80
+#endif
+
+/* Extra time (micro seconds) fine polling continues beyond the expected latency */
+#ifndef ESE_WAIT_FINE_WINDOW_US
+#define ESE_WAIT_FINE_WINDOW_US 2000
+#endif
+
+/* Read the header, the expected INF and the CRC of a frame with the NAD
+ * probe, in one I2C read. The expected INF length is learned per command
+ * class. 0 probes the NAD and PCB only and reads the rest separately */
+#ifndef ESE_SPECULATIVE_READ
+#define ESE_SPECULATIVE_READ 1
+#endif
+
+/* Largest INF length a NAD probe reads along for the first response frame.
+ * Bytes read beyond a shorter frame cost bus time, one more I2C read for a
+ * longer frame costs little, so the probe uses the shorter of the last two
+ * responses of the command class, at most this much */
+#ifndef ESE_SPECULATIVE_READ_MAX_INF
+#define ESE_SPECULATIVE_READ_MAX_INF 32
+#endif
+
+/* Rolling latency history of one command class */
+typedef struct phNxpEse_waitSlot
+{
+    uint32_t key;          /* ESE_WAIT_KEY_VALID | INS/P1/P2, 0 when unused */
+    uint8_t count;         /* Number of valid samples */
+    uint8_t next;          /* Index of the sample to be overwritten next */
+    uint32_t samples_us[ESE_WAIT_MODEL_HISTORY];
+    uint16_t rspLen[2];    /* INF length of the first I-frame of the last two responses */
+    uint8_t rspCount;      /* Number of valid entries of rspLen */
+} phNxpEse_waitSlot_t;
+
 /* I2C Control structure */
 typedef struct phNxpEse_Context
 {
@@ -44,6 +90,22 @@ typedef struct phNxpEse_Context
     uint16_t cmd_len;
     uint8_t p_cmd_data[MAX_DATA_LEN];
     phNxpEse_initParams initParams;
+
+    phNxpEse_waitMode waitMode;     /* How to wait for the response of the SE */
+    uint32_t waitKey;               /* Command class (INS/P1/P2) of the APDU in progress */
+    uint8_t waitArmed;              /* Next read is the first one after the last I-frame of the APDU */
+    uint8_t latencyPending;         /* Latency of the APDU in progress is not yet recorded */
+    uint64_t txDoneTimeUs;          /* Time stamp when the last I-frame of the APDU was written */
+    uint64_t finePollUntilUs;       /* Poll at ESE_POLL_FINE_DELAY_US until this time stamp */
+    phNxpEse_waitSlot_t waitModel[ESE_WAIT_MODEL_SLOTS];
+    uint16_t rxExpectLen;           /* INF length the next NAD probe reads along */
+    uint8_t rspLenPending;          /* INF length of the first response I-frame is not yet learned */
+
+    uint8_t asyncPending;           /* An exchange started by phNxpEse_TransceiveStart is in progress */
+    int asyncPolls;                 /* NAD polls at ESE_POLL_DELAY_US for the awaited frame */
+    uint8_t asyncSendPending;       /* The next frame is held back until asyncPollTimeUs */
+    uint64_t asyncPollTimeUs;       /* Time stamp of the next NAD poll */
+    phNxpEse_data asyncRsp;         /* Response buffer of the exchange in progress */
 } phNxpEse_Context_t;
 
 
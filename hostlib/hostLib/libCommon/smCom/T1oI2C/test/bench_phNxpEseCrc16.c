@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Micro-benchmark of the T=1 CRC: the bitwise reference against
+ * phNxpEseCrc16_Compute and phNxpEseCrc16_UpdateCopy (I-frame transmit
+ * path), for frame sizes seen on the wire. Build with and
+ * without PH_ESE_CRC16_SLICE_BY_4 to compare the table variants.
+ *
+ * Not run by ctest, timings depend on the host.
+ */
+
+#include <stdio.h>
+
+#include "phNxpEseCrc16.h"
+#include "phNxpEseCrc16_ref.h"
+#include "sm_timer.h"
+
+#define BENCH_BYTES (32u * 1024u * 1024u)
+
+/* Keeps the compiler from dropping the loops */
+static volatile uint16_t gSink;
+
+int main(void)
+{
+    static const uint32_t lengths[] = {5, 16, 64, 256};
+    uint8_t buff[256];
+    uint8_t frame[256];
+    size_t n;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(buff); i++) {
+        buff[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    printf("PH_ESE_CRC16_SLICE_BY_4=%d\n", PH_ESE_CRC16_SLICE_BY_4);
+    printf("%6s %14s %14s %8s %14s\n", "bytes", "bitwise MB/s", "table MB/s", "speedup", "copy MB/s");
+    for (n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+        uint32_t len   = lengths[n];
+        uint32_t loops = BENCH_BYTES / len;
+        uint64_t start;
+        uint64_t refUs;
+        uint64_t tableUs;
+        uint64_t copyUs;
+
+        start = sm_get_time_us();
+        for (i = 0; i < loops; i++) {
+            buff[0] = (uint8_t)i;
+            gSink   = phNxpEseCrc16_Reference(buff, len);
+        }
+        refUs = sm_get_time_us() - start;
+
+        start = sm_get_time_us();
+        for (i = 0; i < loops; i++) {
+            buff[0] = (uint8_t)i;
+            gSink   = phNxpEseCrc16_Compute(buff, len);
+        }
+        tableUs = sm_get_time_us() - start;
+
+        start = sm_get_time_us();
+        for (i = 0; i < loops; i++) {
+            buff[0] = (uint8_t)i;
+            gSink   = phNxpEseCrc16_UpdateCopy(phNxpEseCrc16_Init(), frame, buff, len);
+        }
+        copyUs = sm_get_time_us() - start;
+
+        if (refUs == 0) {
+            refUs = 1;
+        }
+        if (tableUs == 0) {
+            tableUs = 1;
+        }
+        if (copyUs == 0) {
+            copyUs = 1;
+        }
+        printf("%6u %14.1f %14.1f %7.1fx %14.1f\n",
+            (unsigned)len,
+            (double)BENCH_BYTES / (double)refUs,
+            (double)BENCH_BYTES / (double)tableUs,
+            (double)refUs / (double)tableUs,
+            (double)BENCH_BYTES / (double)copyUs);
+    }
+    return 0;
+}
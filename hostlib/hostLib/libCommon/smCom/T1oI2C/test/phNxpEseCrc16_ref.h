@@ -0,0 +1,48 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Bitwise CRC of the T=1 epilogue field, as computed by
+ * phNxpEseProto7816_ComputeCRC before the table driven phNxpEseCrc16.
+ * Reference for the CRC test and benchmark, keep it unchanged.
+ */
+
+#ifndef PHNXPESECRC16_REF_H
+#define PHNXPESECRC16_REF_H
+
+#include <stdint.h>
+
+static uint16_t phNxpEseCrc16_Reference(const uint8_t *p_buff, uint32_t length)
+{
+    uint16_t CAL_CRC = 0xFFFF, CRC = 0x0000;
+    uint32_t i = 0;
+
+    for (i = 0; i < length; i++)
+    {
+        CAL_CRC ^= p_buff[i];
+        for (int bit = 8; bit > 0; --bit)
+        {
+            if ((CAL_CRC & 0x0001) == 0x0001)
+            {
+                CAL_CRC = (unsigned short)((CAL_CRC >> 1) ^ 0x8408);
+            }
+            else
+            {
+                CAL_CRC >>= 1;
+            }
+        }
+    }
+    CAL_CRC ^= 0xFFFF;
+#if defined(T1oI2C_UM11225)
+    CRC = ((CAL_CRC & 0xFF) << 8) | ((CAL_CRC >> 8) & 0xFF);
+#elif defined(T1oI2C_GP1_0)
+    CRC = CAL_CRC;
+#endif
+    return (uint16_t)CRC;
+}
+
+#endif /* PHNXPESECRC16_REF_H */
@@ -0,0 +1,118 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * phNxpEseCrc16 must be bit exact with the bitwise CRC it replaced.
+ *
+ * Built once per byte order (T1oI2C_UM11225, T1oI2C_GP1_0) and per
+ * PH_ESE_CRC16_SLICE_BY_4 setting. Checked on random buffers of 0 to
+ * TEST_MAX_LEN bytes, at every alignment of the 4 byte steps:
+ * - phNxpEseCrc16_Compute
+ * - phNxpEseCrc16_Update over the buffer split at random points
+ * - phNxpEseCrc16_UpdateCopy, also for the copied bytes
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "phNxpEseCrc16.h"
+#include "phNxpEseCrc16_ref.h"
+
+/* Largest T=1 frame: prologue, 254 bytes INF, epilogue, with some margin */
+#define TEST_MAX_LEN 260
+#define TEST_ROUNDS 2000
+
+static uint32_t gRandState = 0x2545F491;
+
+/* xorshift32, fixed seed so that a failure can be reproduced */
+static uint32_t test_rand(void)
+{
+    gRandState ^= gRandState << 13;
+    gRandState ^= gRandState >> 17;
+    gRandState ^= gRandState << 5;
+    return gRandState;
+}
+
+static int check(const char *what, uint32_t len, uint16_t got, uint16_t expected)
+{
+    if (got != expected) {
+        printf("FAIL: %s, len %u: 0x%04X instead of 0x%04X\n", what, (unsigned)len, got, expected);
+        return 1;
+    }
+    return 0;
+}
+
+/* CRC of the buffer fed in pieces of random size */
+static uint16_t crc_split(const uint8_t *p_buff, uint32_t length)
+{
+    uint16_t crc  = phNxpEseCrc16_Init();
+    uint32_t done = 0;
+
+    while (done < length) {
+        uint32_t chunk = test_rand() % (length - done + 1);
+        crc            = phNxpEseCrc16_Update(crc, &p_buff[done], chunk);
+        done += chunk;
+    }
+    return phNxpEseCrc16_Final(crc);
+}
+
+/* CRC of the buffer copied in pieces of random size, the way a frame is built */
+static uint16_t crc_copy(uint8_t *p_dest, const uint8_t *p_src, uint32_t length)
+{
+    uint16_t crc  = phNxpEseCrc16_Init();
+    uint32_t done = 0;
+
+    while (done < length) {
+        uint32_t chunk = test_rand() % (length - done + 1);
+        crc            = phNxpEseCrc16_UpdateCopy(crc, &p_dest[done], &p_src[done], chunk);
+        done += chunk;
+    }
+    return phNxpEseCrc16_Final(crc);
+}
+
+int main(void)
+{
+    uint8_t buff[TEST_MAX_LEN + 4];
+    uint8_t copy[TEST_MAX_LEN + 4];
+    uint32_t round;
+    uint32_t len;
+    uint32_t i;
+    int failed = 0;
+
+    /* Known value: CRC-16/X.25 of "123456789" is 0x906E */
+#if defined(T1oI2C_UM11225)
+    failed |= check("check value", 9, phNxpEseCrc16_Compute((const uint8_t *)"123456789", 9), 0x6E90);
+#else
+    failed |= check("check value", 9, phNxpEseCrc16_Compute((const uint8_t *)"123456789", 9), 0x906E);
+#endif
+    failed |= check("empty", 0, phNxpEseCrc16_Compute(buff, 0), phNxpEseCrc16_Reference(buff, 0));
+
+    for (round = 0; round < TEST_ROUNDS && !failed; round++) {
+        /* Every length once, then random ones */
+        uint32_t offset  = round % 4;
+        uint8_t *p_buff  = &buff[offset];
+        uint16_t expected;
+
+        len = (round <= TEST_MAX_LEN) ? round : (test_rand() % (TEST_MAX_LEN + 1));
+        for (i = 0; i < len; i++) {
+            p_buff[i] = (uint8_t)test_rand();
+        }
+        expected = phNxpEseCrc16_Reference(p_buff, len);
+
+        failed |= check("compute", len, phNxpEseCrc16_Compute(p_buff, len), expected);
+        failed |= check("split update", len, crc_split(p_buff, len), expected);
+        memset(copy, 0, sizeof(copy));
+        failed |= check("update copy", len, crc_copy(&copy[offset], p_buff, len), expected);
+        if (memcmp(&copy[offset], p_buff, len) != 0) {
+            printf("FAIL: update copy, len %u: bytes differ\n", (unsigned)len);
+            failed = 1;
+        }
+    }
+
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
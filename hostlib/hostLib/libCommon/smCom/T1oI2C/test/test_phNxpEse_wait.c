@@ -0,0 +1,839 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Response wait of phNxpEse_readPacket against a scripted SE.
+ *
+ * The T=1 stack runs over platform/generic/i2c_a7_emul.c. Instead of the
+ * applet emulator, se05x_emul_process() below answers every C-APDU with
+ * 9000 after the time set in gScriptLatencyUs. axI2CWrite and
+ * phPalEse_i2c_read are wrapped (-Wl,--wrap) to time stamp the NAD polls
+ * that found the SE busy, relative to the write of the last I-frame of
+ * the command.
+ *
+ * Checked:
+ * - ESE_WAIT_POLL polls from the start, every ESE_POLL_DELAY_MS or more
+ * - ESE_WAIT_ADAPTIVE, once the command is learned, does not poll before
+ *   most of the learned time has passed (learned sleep), and polls at less
+ *   than ESE_POLL_DELAY_MS when the SE is a bit late (fine poll)
+ * - a command slower than learned is still received once the fine poll
+ *   window has passed
+ *
+ * Error recovery, with faults injected on the link: axI2CWrite corrupts
+ * the CRC of I-frames from the host, so that the SE answers R(NACK), and
+ * axI2CRead corrupts the CRC of frames from the SE. Checked:
+ * - a frame from the SE with a bad CRC is R(NACK)ed without a back off
+ * - the retransmissions after an R(NACK) from the SE wait
+ *   PH_PROTO_7816_RECOVERY_BASE_US, doubled per retry, at most
+ *   DELAY_ERROR_RECOVERY; the first one goes out at once
+ * - after PH_PROTO_7816_FRAME_RETRY_COUNT retries the recovery escalates
+ *   to an interface reset, without a back off. The command fails, the
+ *   next one goes through
+ * - SM_METRICS_EV_T1_RECOVERY counts the retries only
+ *
+ * Chaining, with S-blocks of the SE injected on the link:
+ * - an S(IFS) request of the SE in the middle of a chain is answered, and
+ *   the rest of the chain is sent in frames of the new size
+ * - when a chained I-frame is R(NACK)ed, it is sent again and the next
+ *   one, prebuilt meanwhile, is still sent without being built again
+ *
+ * Reading frames, with the NAD probe reading along the expected length:
+ * - a frame behind one byte of garbage ("xx A5") is shifted into place
+ *   and completed with a tail read
+ * - a response longer than learned is completed with a tail read
+ * - the probe reads along the shorter of the last two responses, at most
+ *   ESE_SPECULATIVE_READ_MAX_INF
+ * - a frame with NAD 0x00 (host and SE out of sync) is read completely,
+ *   dropped, and the response is received after the R(NACK)
+ *
+ * Non blocking exchanges, phNxpEse_TransceiveStart / phNxpEse_TransceivePoll,
+ * with sm_sleep and sm_usleep wrapped to catch any sleep inside them:
+ * - a plain and a chained exchange, R(NACK) retries with their back off, and
+ *   a WTX request of the SE all complete without a sleep. The delays before
+ *   the retries and the WTX response are returned as the next poll time and
+ *   still kept
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "i2c_a7.h"
+#include "phNxpEseCrc16.h"
+#include "phNxpEseProto7816_3.h"
+#include "phNxpEse_Api.h"
+#include "phNxpEsePal_i2c.h"
+#include "se05x_const.h"
+#include "se05x_emul.h"
+#include "sm_metrics.h"
+#include "sm_timer.h"
+
+#define TEST_LATENCY_US 20000u
+#define TEST_LATE_LATENCY_US 23000u
+#define TEST_SLOW_LATENCY_US 40000u
+#define TEST_MAX_POLLS 256
+#define TEST_MAX_FRAMES 64
+#define TEST_CHAIN_LEN 600
+#define TEST_IFS_SMALL 64
+#define TEST_ASYNC_MAX_POLLS 100000
+
+/* Processing time of the scripted SE */
+static uint32_t gScriptLatencyUs = TEST_LATENCY_US;
+
+/* Data bytes of the scripted response, before 9000 */
+static uint32_t gScriptRspLen;
+
+/* Last C-APDU received by the scripted SE */
+static uint8_t gScriptCmd[TEST_CHAIN_LEN];
+static size_t gScriptCmdLen;
+
+/* NAD polls of the command in progress that found the SE busy */
+static struct
+{
+    uint64_t lastIframeUs;
+    uint32_t count;
+    uint32_t atUs[TEST_MAX_POLLS];
+} gPolls;
+
+/* Injected faults, and the I-frames written to the SE since the last reset */
+static struct
+{
+    /* Next I-frames from the host to corrupt */
+    uint32_t txCorrupt;
+    /* I-frame, counted from 1, corrupted once. 0 for none */
+    uint32_t txCorruptAt;
+    /* IFS of the S(IFS) response of the host */
+    uint8_t ifsRsp;
+    /* Frame of the SE read before the one of the emulator, after the
+     * I-frame injectAt (counted from 1) is written */
+    uint32_t injectAt;
+    uint8_t inject[16];
+    uint32_t injectLen;
+    uint32_t injectPos;
+    /* Read one garbage byte before the next frame of the emulator */
+    int rxShift;
+    /* Bytes of the first successful read after the last I-frame */
+    uint32_t probeLen;
+    /* Next frames from the SE to corrupt */
+    uint32_t rxCorrupt;
+    /* Position in, and length of, the frame being read from the SE */
+    uint32_t rxPos;
+    uint32_t rxFrameLen;
+    int rxCorrupting;
+    uint64_t lastRxUs;
+    /* Time from the last frame read to each I-frame / S-frame written */
+    uint32_t iframes;
+    uint32_t iframeGapUs[TEST_MAX_FRAMES];
+    uint8_t iframeInfLen[TEST_MAX_FRAMES];
+    uint32_t sframes;
+    uint32_t sframeGapUs;
+    /* I-frames built (CRC computed while copying the INF) */
+    uint32_t iframeBuilds;
+} gFaults;
+
+/* Sleeps inside phNxpEse_TransceiveStart / phNxpEse_TransceivePoll */
+static struct
+{
+    int inCall;
+    uint32_t sleeps;
+    uint32_t polls;
+} gAsync;
+
+void __real_sm_sleep(uint32_t msec);
+void __real_sm_usleep(uint32_t microsec);
+void __wrap_sm_sleep(uint32_t msec);
+void __wrap_sm_usleep(uint32_t microsec);
+
+void __wrap_sm_sleep(uint32_t msec)
+{
+    if (gAsync.inCall) {
+        gAsync.sleeps++;
+    }
+    __real_sm_sleep(msec);
+}
+
+void __wrap_sm_usleep(uint32_t microsec)
+{
+    if (gAsync.inCall) {
+        gAsync.sleeps++;
+    }
+    __real_sm_usleep(microsec);
+}
+
+i2c_error_t __real_axI2CWrite(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pTx, unsigned short txLen);
+int __real_phPalEse_i2c_read(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToRead);
+i2c_error_t __real_axI2CRead(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pRx, unsigned short rxLen);
+i2c_error_t __wrap_axI2CWrite(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pTx, unsigned short txLen);
+int __wrap_phPalEse_i2c_read(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToRead);
+i2c_error_t __wrap_axI2CRead(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pRx, unsigned short rxLen);
+uint16_t __real_phNxpEseCrc16_UpdateCopy(uint16_t crc, uint8_t *pDst, const uint8_t *pSrc, uint32_t len);
+uint16_t __wrap_phNxpEseCrc16_UpdateCopy(uint16_t crc, uint8_t *pDst, const uint8_t *pSrc, uint32_t len);
+
+uint16_t __wrap_phNxpEseCrc16_UpdateCopy(uint16_t crc, uint8_t *pDst, const uint8_t *pSrc, uint32_t len)
+{
+    gFaults.iframeBuilds++;
+    return __real_phNxpEseCrc16_UpdateCopy(crc, pDst, pSrc, len);
+}
+
+/* Frame of the SE, read after I-frame ``at`` before the pending frame of the emulator */
+static void inject_frame(uint32_t at, uint8_t nad, uint8_t pcb, const uint8_t *inf, uint8_t infLen)
+{
+    uint16_t crc;
+
+    gFaults.inject[0] = nad;
+    gFaults.inject[1] = pcb;
+    gFaults.inject[2] = infLen;
+    memcpy(&gFaults.inject[3], inf, infLen);
+    crc                            = phNxpEseCrc16_Compute(gFaults.inject, 3u + infLen);
+    gFaults.inject[3 + infLen]     = (uint8_t)(crc >> 8);
+    gFaults.inject[3 + infLen + 1] = (uint8_t)crc;
+    gFaults.injectAt               = at;
+    gFaults.injectLen              = 0;
+    gFaults.injectPos              = 3u + infLen + 2u;
+}
+
+i2c_error_t __wrap_axI2CWrite(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pTx, unsigned short txLen)
+{
+    uint8_t frame[300];
+    uint32_t gapUs = (uint32_t)(sm_get_time_us() - gFaults.lastRxUs);
+    i2c_error_t ret;
+
+    if (txLen > 1 && (pTx[1] & 0x80) == 0) {
+        if (gFaults.iframes < TEST_MAX_FRAMES) {
+            gFaults.iframeGapUs[gFaults.iframes]  = gapUs;
+            gFaults.iframeInfLen[gFaults.iframes] = pTx[2];
+        }
+        gFaults.iframes++;
+        gFaults.probeLen = 0;
+        if ((gFaults.txCorrupt > 0 || gFaults.txCorruptAt == gFaults.iframes) && txLen <= sizeof(frame)) {
+            if (gFaults.txCorrupt > 0) {
+                gFaults.txCorrupt--;
+            }
+            memcpy(frame, pTx, txLen);
+            frame[txLen - 1] ^= 0x01;
+            pTx = frame;
+        }
+    }
+    else if (txLen > 1 && (pTx[1] & 0xC0) == 0xC0) {
+        gFaults.sframes++;
+        gFaults.sframeGapUs = gapUs;
+        if (pTx[1] == 0xE1 && pTx[2] == 1) {
+            gFaults.ifsRsp = pTx[3];
+        }
+    }
+    ret = __real_axI2CWrite(conn_ctx, bus, addr, pTx, txLen);
+    if (txLen > 1 && (pTx[1] & 0x80) == 0 && gFaults.injectAt == gFaults.iframes) {
+        /* The frame of the emulator stays pending, it is sent again after
+         * the answer of the host */
+        gFaults.injectLen = gFaults.injectPos;
+        gFaults.injectPos = 0;
+    }
+
+    if (txLen > 1 && (pTx[1] & 0x80) == 0) {
+        gPolls.lastIframeUs = sm_get_time_us();
+        gPolls.count        = 0;
+    }
+    return ret;
+}
+
+/* Corrupts the last CRC byte of the next gFaults.rxCorrupt frames. A frame
+ * may be read in several pieces, NAD probe and tail. */
+i2c_error_t __wrap_axI2CRead(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pRx, unsigned short rxLen)
+{
+    i2c_error_t ret = I2C_OK;
+    uint32_t i;
+
+    if (gFaults.injectPos < gFaults.injectLen) {
+        for (i = 0; i < rxLen; i++) {
+            pRx[i] = (gFaults.injectPos < gFaults.injectLen) ? gFaults.inject[gFaults.injectPos++] : 0xFF;
+        }
+    }
+    else if (gFaults.rxShift && rxLen > 1) {
+        ret = __real_axI2CRead(conn_ctx, bus, addr, &pRx[1], rxLen - 1);
+        if (ret == I2C_OK) {
+            pRx[0]         = 0x00;
+            gFaults.rxShift = 0;
+        }
+    }
+    else {
+        ret = __real_axI2CRead(conn_ctx, bus, addr, pRx, rxLen);
+    }
+    if (ret != I2C_OK) {
+        return ret;
+    }
+    if (gFaults.probeLen == 0) {
+        gFaults.probeLen = rxLen;
+    }
+    if (gFaults.rxPos >= gFaults.rxFrameLen && rxLen >= 3 && pRx[0] == 0xA5) {
+        gFaults.rxPos        = 0;
+        gFaults.rxFrameLen   = 3u + pRx[2] + 2u;
+        gFaults.rxCorrupting = (gFaults.rxCorrupt > 0);
+        if (gFaults.rxCorrupting) {
+            gFaults.rxCorrupt--;
+        }
+    }
+    for (i = 0; i < rxLen && gFaults.rxPos < gFaults.rxFrameLen; i++, gFaults.rxPos++) {
+        if (gFaults.rxCorrupting && gFaults.rxPos == gFaults.rxFrameLen - 1) {
+            pRx[i] ^= 0x01;
+        }
+    }
+    gFaults.lastRxUs = sm_get_time_us();
+    return ret;
+}
+
+int __wrap_phPalEse_i2c_read(void *pDevHandle, uint8_t *pBuffer, int nNbBytesToRead)
+{
+    int ret = __real_phPalEse_i2c_read(pDevHandle, pBuffer, nNbBytesToRead);
+
+    if (ret < 0 && gPolls.count < TEST_MAX_POLLS) {
+        gPolls.atUs[gPolls.count++] = (uint32_t)(sm_get_time_us() - gPolls.lastIframeUs);
+    }
+    return ret;
+}
+
+smStatus_t se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs)
+{
+    uint32_t i;
+
+    gScriptCmdLen = (cmdLen < sizeof(gScriptCmd)) ? cmdLen : sizeof(gScriptCmd);
+    memcpy(gScriptCmd, cmd, gScriptCmdLen);
+    for (i = 0; i < gScriptRspLen; i++) {
+        rsp[i] = (uint8_t)(i * 3);
+    }
+    rsp[i++] = 0x90;
+    rsp[i++] = 0x00;
+    *rspLen  = i;
+    if (pLatencyUs != NULL) {
+        *pLatencyUs = gScriptLatencyUs;
+    }
+    return SM_OK;
+}
+
+void se05x_emul_reset(void)
+{
+}
+
+/* Busy polls before minUs after the command was written */
+static uint32_t polls_before(uint32_t minUs)
+{
+    uint32_t i;
+    uint32_t n = 0;
+
+    for (i = 0; i < gPolls.count; i++) {
+        if (gPolls.atUs[i] < minUs) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* Shortest time between two busy polls, UINT32_MAX for less than two */
+static uint32_t min_poll_gap(void)
+{
+    uint32_t i;
+    uint32_t gap = UINT32_MAX;
+
+    for (i = 1; i < gPolls.count; i++) {
+        if (gPolls.atUs[i] - gPolls.atUs[i - 1] < gap) {
+            gap = gPolls.atUs[i] - gPolls.atUs[i - 1];
+        }
+    }
+    return gap;
+}
+
+/* Response of the scripted SE, and the C-APDU it received */
+static int check_response(const uint8_t *apdu, uint32_t apduLen, const phNxpEse_data *pRsp)
+{
+    uint32_t i;
+
+    for (i = 0; i < gScriptRspLen && i < pRsp->len; i++) {
+        if (pRsp->p_data[i] != (uint8_t)(i * 3)) {
+            break;
+        }
+    }
+    if (pRsp->len != gScriptRspLen + 2 || i != gScriptRspLen || pRsp->p_data[i] != 0x90 ||
+        pRsp->p_data[i + 1] != 0x00) {
+        printf("FAIL: response\n");
+        return 1;
+    }
+    if (gScriptCmdLen != apduLen || memcmp(gScriptCmd, apdu, apduLen) != 0) {
+        printf("FAIL: C-APDU received by the SE\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int transceive_apdu(void *conn_ctx, uint8_t *apdu, uint32_t apduLen, ESESTATUS expected)
+{
+    /* The T=1 layer may save up to SE05X_MAX_BUF_SIZE_RSP, e.g. the ATR of an interface reset */
+    static uint8_t rx[SE05X_MAX_BUF_SIZE_RSP];
+    phNxpEse_data cmd;
+    phNxpEse_data rsp;
+
+    cmd.len    = apduLen;
+    cmd.p_data = apdu;
+    rsp.len    = sizeof(rx);
+    rsp.p_data = rx;
+    if (phNxpEse_Transceive(conn_ctx, &cmd, &rsp) != expected) {
+        printf("FAIL: transceive\n");
+        return 1;
+    }
+    if (expected != ESESTATUS_SUCCESS) {
+        return 0;
+    }
+    return check_response(apdu, apduLen, &rsp);
+}
+
+/* Same with phNxpEse_TransceiveStart / phNxpEse_TransceivePoll. The test
+ * waits the returned delay between the polls */
+static int transceive_apdu_async(void *conn_ctx, uint8_t *apdu, uint32_t apduLen)
+{
+    static uint8_t rx[SE05X_MAX_BUF_SIZE_RSP];
+    phNxpEse_data cmd;
+    phNxpEse_data rsp;
+    uint32_t rspLen     = 0;
+    uint32_t nextPollUs = 0;
+    ESESTATUS status;
+
+    memset(&gAsync, 0, sizeof(gAsync));
+    cmd.len    = apduLen;
+    cmd.p_data = apdu;
+    rsp.len    = sizeof(rx);
+    rsp.p_data = rx;
+    gAsync.inCall = 1;
+    status        = phNxpEse_TransceiveStart(conn_ctx, &cmd, &rsp);
+    gAsync.inCall = 0;
+    if (status != ESESTATUS_SUCCESS) {
+        printf("FAIL: transceive start\n");
+        return 1;
+    }
+    do {
+        if (nextPollUs > 0) {
+            sm_usleep(nextPollUs);
+        }
+        gAsync.polls++;
+        gAsync.inCall = 1;
+        status        = phNxpEse_TransceivePoll(conn_ctx, &rspLen, &nextPollUs);
+        gAsync.inCall = 0;
+    } while (status == ESESTATUS_PENDING && gAsync.polls < TEST_ASYNC_MAX_POLLS);
+    if (status != ESESTATUS_SUCCESS) {
+        printf("FAIL: transceive poll 0x%x\n", (unsigned)status);
+        return 1;
+    }
+    rsp.len = rspLen;
+    if (gAsync.sleeps != 0) {
+        printf("FAIL: %u sleeps in the non blocking exchange\n", (unsigned)gAsync.sleeps);
+        return 1;
+    }
+    return check_response(apdu, apduLen, &rsp);
+}
+
+static int transceive_status(void *conn_ctx, ESESTATUS expected)
+{
+    uint8_t apdu[] = {0x80, 0x04, 0x00, 0x00};
+
+    return transceive_apdu(conn_ctx, apdu, sizeof(apdu), expected);
+}
+
+static int transceive(void *conn_ctx)
+{
+    return transceive_status(conn_ctx, ESESTATUS_SUCCESS);
+}
+
+/* Chained C-APDU, TEST_CHAIN_LEN bytes */
+static uint8_t *chained_apdu(void)
+{
+    static uint8_t apdu[TEST_CHAIN_LEN];
+    uint32_t i;
+
+    apdu[0] = 0x80;
+    apdu[1] = 0x01;
+    apdu[2] = 0x00;
+    apdu[3] = 0x00;
+    for (i = 4; i < sizeof(apdu); i++) {
+        apdu[i] = (uint8_t)(i * 7);
+    }
+    return apdu;
+}
+
+static int transceive_chained(void *conn_ctx)
+{
+    return transceive_apdu(conn_ctx, chained_apdu(), TEST_CHAIN_LEN, ESESTATUS_SUCCESS);
+}
+
+/* Back off before retry ``retries`` of the error recovery */
+static uint32_t backoff_us(uint32_t retries)
+{
+    uint32_t delayUs = DELAY_ERROR_RECOVERY;
+
+    if (retries == 0) {
+        return 0;
+    }
+    if (retries <= 16) {
+        delayUs = (uint32_t)PH_PROTO_7816_RECOVERY_BASE_US << (retries - 1);
+    }
+    return (delayUs > DELAY_ERROR_RECOVERY) ? DELAY_ERROR_RECOVERY : delayUs;
+}
+
+static void reset_faults(void)
+{
+    memset(&gFaults, 0, sizeof(gFaults));
+    sm_metrics_reset();
+}
+
+static int test_recovery(void *conn_ctx)
+{
+    smMetrics_t m;
+    uint32_t i;
+    int failed = 0;
+
+    /* Bad CRC from the SE: R(NACK) at once */
+    reset_faults();
+    gFaults.rxCorrupt = 1;
+    failed |= transceive(conn_ctx);
+    sm_metrics_snapshot(&m);
+    printf("recovery, bad CRC: %u CRC errors, %u R(NACK) sent, %u retries\n",
+        (unsigned)m.events[SM_METRICS_EV_T1_CRC_ERROR],
+        (unsigned)m.events[SM_METRICS_EV_T1_RNACK_TX],
+        (unsigned)m.events[SM_METRICS_EV_T1_RECOVERY]);
+    if (m.events[SM_METRICS_EV_T1_CRC_ERROR] != 1 || m.events[SM_METRICS_EV_T1_RNACK_TX] != 1 ||
+        m.events[SM_METRICS_EV_T1_RECOVERY] != 0 || m.phaseSumUs[SM_METRICS_PHASE_T1_RECOVERY] != 0) {
+        printf("FAIL: bad CRC recovery\n");
+        failed = 1;
+    }
+
+    /* R(NACK) from the SE, PH_PROTO_7816_FRAME_RETRY_COUNT times: each
+     * retransmission backs off a bit longer */
+    reset_faults();
+    gFaults.txCorrupt = PH_PROTO_7816_FRAME_RETRY_COUNT;
+    failed |= transceive(conn_ctx);
+    sm_metrics_snapshot(&m);
+    for (i = 1; i < gFaults.iframes && i <= PH_PROTO_7816_FRAME_RETRY_COUNT; i++) {
+        printf("recovery, retry %u after %u us (min %u us)\n",
+            (unsigned)i,
+            (unsigned)gFaults.iframeGapUs[i],
+            (unsigned)backoff_us(i - 1));
+        if (gFaults.iframeGapUs[i] < backoff_us(i - 1)) {
+            printf("FAIL: retry %u too early\n", (unsigned)i);
+            failed = 1;
+        }
+    }
+    if (gFaults.iframes != PH_PROTO_7816_FRAME_RETRY_COUNT + 1 ||
+        m.events[SM_METRICS_EV_T1_RNACK_RX] != PH_PROTO_7816_FRAME_RETRY_COUNT ||
+        m.events[SM_METRICS_EV_T1_RECOVERY] != PH_PROTO_7816_FRAME_RETRY_COUNT ||
+        m.events[SM_METRICS_EV_T1_INTF_RESET] != 0) {
+        printf("FAIL: %u I-frames, %u retries\n",
+            (unsigned)gFaults.iframes,
+            (unsigned)m.events[SM_METRICS_EV_T1_RECOVERY]);
+        failed = 1;
+    }
+
+    /* One R(NACK) more: the recovery escalates at once, and is not
+     * counted as a retry */
+    reset_faults();
+    gFaults.txCorrupt = PH_PROTO_7816_FRAME_RETRY_COUNT + 1;
+    failed |= transceive_status(conn_ctx, ESESTATUS_FAILED);
+    sm_metrics_snapshot(&m);
+    printf("recovery, escalation: %u retries, %u interface resets, reset sent %u us after the last R(NACK)\n",
+        (unsigned)m.events[SM_METRICS_EV_T1_RECOVERY],
+        (unsigned)m.events[SM_METRICS_EV_T1_INTF_RESET],
+        (unsigned)gFaults.sframeGapUs);
+    if (m.events[SM_METRICS_EV_T1_RECOVERY] != PH_PROTO_7816_FRAME_RETRY_COUNT ||
+        m.events[SM_METRICS_EV_T1_INTF_RESET] != 1 || gFaults.sframes == 0) {
+        printf("FAIL: escalation\n");
+        failed = 1;
+    }
+    failed |= transceive(conn_ctx);
+    return failed;
+}
+
+/* Largest INF of the I-frames from ``first`` on */
+static uint32_t max_inf_len(uint32_t first)
+{
+    uint32_t i;
+    uint32_t maxLen = 0;
+
+    for (i = first; i < gFaults.iframes && i < TEST_MAX_FRAMES; i++) {
+        if (gFaults.iframeInfLen[i] > maxLen) {
+            maxLen = gFaults.iframeInfLen[i];
+        }
+    }
+    return maxLen;
+}
+
+static int test_chaining(void *conn_ctx)
+{
+    uint32_t plainFrames;
+    uint8_t ifs;
+    int failed = 0;
+
+    /* Reference: frames of a chain without faults */
+    reset_faults();
+    failed |= transceive_chained(conn_ctx);
+    plainFrames = gFaults.iframes;
+    printf("chaining: %u I-frames, %u built, INF up to %u\n",
+        (unsigned)gFaults.iframes,
+        (unsigned)gFaults.iframeBuilds,
+        (unsigned)max_inf_len(0));
+    if (gFaults.iframeBuilds != gFaults.iframes) {
+        printf("FAIL: I-frames built more than once\n");
+        failed = 1;
+    }
+
+    /* R(NACK) of the second I-frame: sent again, the prebuilt third one
+     * is still used */
+    reset_faults();
+    gFaults.txCorruptAt = 2;
+    failed |= transceive_chained(conn_ctx);
+    printf("chaining, R(NACK): %u I-frames, %u built\n", (unsigned)gFaults.iframes, (unsigned)gFaults.iframeBuilds);
+    if (gFaults.iframes != plainFrames + 1 || gFaults.iframeBuilds != gFaults.iframes) {
+        printf("FAIL: prebuilt I-frame after an R(NACK)\n");
+        failed = 1;
+    }
+
+    /* S(IFS) request of the SE after the first I-frame. It changes its
+     * IFSC before it acknowledges the I-frame. */
+    reset_faults();
+    ifs = TEST_IFS_SMALL;
+    inject_frame(1, 0xA5, 0xC1, &ifs, 1);
+    failed |= transceive_chained(conn_ctx);
+    printf("chaining, S(IFS %u): S(IFS %u) answered, %u I-frames, then INF up to %u\n",
+        (unsigned)TEST_IFS_SMALL,
+        (unsigned)gFaults.ifsRsp,
+        (unsigned)gFaults.iframes,
+        (unsigned)max_inf_len(1));
+    if (gFaults.ifsRsp != TEST_IFS_SMALL || max_inf_len(1) != TEST_IFS_SMALL || gFaults.iframes <= plainFrames) {
+        printf("FAIL: S(IFS) within a chain\n");
+        failed = 1;
+    }
+
+    /* And back to the default */
+    reset_faults();
+    ifs = IFSC_SIZE_SEND;
+    inject_frame(1, 0xA5, 0xC1, &ifs, 1);
+    failed |= transceive_chained(conn_ctx);
+    if (gFaults.ifsRsp != IFSC_SIZE_SEND || max_inf_len(1) != IFSC_SIZE_SEND) {
+        printf("FAIL: S(IFS) back to %u\n", (unsigned)IFSC_SIZE_SEND);
+        failed = 1;
+    }
+    return failed;
+}
+
+/* Largest NAD probe, header, INF and CRC */
+#define TEST_PROBE_MAX (3u + ESE_SPECULATIVE_READ_MAX_INF + 2u)
+
+static int test_reads(void *conn_ctx)
+{
+    uint8_t apdu[]  = {0x80, 0x02, 0x00, 0x00};
+    uint8_t drain[] = {0x00, 0x00, 0x00, 0x00};
+    smMetrics_t m;
+    int failed = 0;
+
+    /* Learn a 2 byte response */
+    reset_faults();
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+
+    /* One byte of garbage before the frame */
+    reset_faults();
+    gFaults.rxShift = 1;
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    sm_metrics_snapshot(&m);
+    printf("reads, xx A5: probe of %u bytes, %u tail reads, %u CRC errors\n",
+        (unsigned)gFaults.probeLen,
+        (unsigned)m.events[SM_METRICS_EV_I2C_READ_TAIL],
+        (unsigned)m.events[SM_METRICS_EV_T1_CRC_ERROR]);
+    if (gFaults.probeLen != 7 || m.events[SM_METRICS_EV_I2C_READ_TAIL] != 1 ||
+        m.events[SM_METRICS_EV_T1_CRC_ERROR] != 0) {
+        printf("FAIL: SOF behind a garbage byte\n");
+        failed = 1;
+    }
+
+    /* Longer than learned: probe, then the rest */
+    reset_faults();
+    gScriptRspLen = 100;
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    sm_metrics_snapshot(&m);
+    printf("reads, longer: probe of %u bytes, %u tail reads\n",
+        (unsigned)gFaults.probeLen,
+        (unsigned)m.events[SM_METRICS_EV_I2C_READ_TAIL]);
+    if (gFaults.probeLen != 7 || m.events[SM_METRICS_EV_I2C_READ_TAIL] != 1) {
+        printf("FAIL: tail read after a short probe\n");
+        failed = 1;
+    }
+
+    /* Still the shorter of the last two responses */
+    reset_faults();
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    if (gFaults.probeLen != 7) {
+        printf("FAIL: probe of %u bytes after one long response\n", (unsigned)gFaults.probeLen);
+        failed = 1;
+    }
+
+    /* Two long responses: read along, at most ESE_SPECULATIVE_READ_MAX_INF */
+    reset_faults();
+    gScriptRspLen = 2;
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    printf("reads, after long ones: probe of %u bytes, at most %u\n", (unsigned)gFaults.probeLen, TEST_PROBE_MAX);
+    if (gFaults.probeLen != TEST_PROBE_MAX) {
+        printf("FAIL: probe not bounded\n");
+        failed = 1;
+    }
+    reset_faults();
+    gScriptRspLen = 0;
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    printf("reads, short again: probe of %u bytes\n", (unsigned)gFaults.probeLen);
+    if (gFaults.probeLen != 3 + 4 + 2) {
+        printf("FAIL: probe did not shrink\n");
+        failed = 1;
+    }
+
+    /* Frame with NAD 0x00, longer than the probe: read completely and
+     * dropped, the response follows the R(NACK) */
+    reset_faults();
+    inject_frame(1, 0x00, 0x82, drain, sizeof(drain));
+    failed |= transceive_apdu(conn_ctx, apdu, sizeof(apdu), ESESTATUS_SUCCESS);
+    sm_metrics_snapshot(&m);
+    printf("reads, NAD error: %u of %u bytes drained, %u tail reads, %u missing frames\n",
+        (unsigned)gFaults.injectPos,
+        (unsigned)gFaults.injectLen,
+        (unsigned)m.events[SM_METRICS_EV_I2C_READ_TAIL],
+        (unsigned)m.events[SM_METRICS_EV_T1_NO_FRAME]);
+    if (gFaults.injectPos != gFaults.injectLen || m.events[SM_METRICS_EV_I2C_READ_TAIL] != 1 ||
+        m.events[SM_METRICS_EV_T1_NO_FRAME] != 1) {
+        printf("FAIL: NAD error drain\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+static int test_async(void *conn_ctx)
+{
+    uint8_t apdu[]  = {0x80, 0x04, 0x00, 0x00};
+    uint8_t wtxMult = 1;
+    uint32_t i;
+    int failed = 0;
+
+    /* Plain exchange: polled for, never waited on */
+    reset_faults();
+    failed |= transceive_apdu_async(conn_ctx, apdu, sizeof(apdu));
+    printf("async: %u polls, no sleep\n", (unsigned)gAsync.polls);
+
+    /* Chained C-APDU: each I-frame waits for the write guard */
+    reset_faults();
+    failed |= transceive_apdu_async(conn_ctx, chained_apdu(), TEST_CHAIN_LEN);
+    printf("async, chained: %u I-frames, %u polls\n", (unsigned)gFaults.iframes, (unsigned)gAsync.polls);
+    if (gFaults.iframes < 3) {
+        printf("FAIL: async chaining\n");
+        failed = 1;
+    }
+
+    /* R(NACK) from the SE: the back off comes back as the next poll time */
+    reset_faults();
+    gFaults.txCorrupt = PH_PROTO_7816_FRAME_RETRY_COUNT;
+    failed |= transceive_apdu_async(conn_ctx, apdu, sizeof(apdu));
+    printf("async, recovery: %u I-frames, last retry after %u us\n",
+        (unsigned)gFaults.iframes,
+        (unsigned)gFaults.iframeGapUs[PH_PROTO_7816_FRAME_RETRY_COUNT]);
+    if (gFaults.iframes != PH_PROTO_7816_FRAME_RETRY_COUNT + 1) {
+        printf("FAIL: async recovery\n");
+        failed = 1;
+    }
+    for (i = 1; i < gFaults.iframes && i <= PH_PROTO_7816_FRAME_RETRY_COUNT; i++) {
+        if (gFaults.iframeGapUs[i] < backoff_us(i - 1)) {
+            printf("FAIL: async retry %u too early\n", (unsigned)i);
+            failed = 1;
+        }
+    }
+
+    /* S(WTX) request of the SE: answered after PH_PROTO_7816_WTX_DELAY_US */
+    reset_faults();
+    inject_frame(1, 0xA5, 0xC3, &wtxMult, 1);
+    failed |= transceive_apdu_async(conn_ctx, apdu, sizeof(apdu));
+    printf("async, WTX: response sent %u us after the request\n", (unsigned)gFaults.sframeGapUs);
+    if (gFaults.sframes != 1 || gFaults.sframeGapUs < PH_PROTO_7816_WTX_DELAY_US) {
+        printf("FAIL: async WTX\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+int main(void)
+{
+    void *conn_ctx = NULL;
+    uint8_t atr[64];
+    phNxpEse_data atrRsp;
+    phNxpEse_initParams initParams;
+    int failed = 0;
+    int i;
+
+    initParams.initMode = ESE_MODE_NORMAL;
+    atrRsp.len          = sizeof(atr);
+    atrRsp.p_data       = atr;
+    if (phNxpEse_open(&conn_ctx, initParams, "emul") != ESESTATUS_SUCCESS ||
+        phNxpEse_init(conn_ctx, initParams, &atrRsp) != ESESTATUS_SUCCESS) {
+        printf("FAIL: open\n");
+        return 1;
+    }
+
+    /* Legacy polling: from the start, never faster than ESE_POLL_DELAY_MS */
+    phNxpEse_setWaitMode(conn_ctx, ESE_WAIT_POLL);
+    failed |= transceive(conn_ctx);
+    printf("poll: %u polls, %u in the first half, min gap %u us\n",
+        (unsigned)gPolls.count,
+        (unsigned)polls_before(TEST_LATENCY_US / 2),
+        (unsigned)min_poll_gap());
+    if (polls_before(TEST_LATENCY_US / 2) == 0 || min_poll_gap() < ESE_POLL_DELAY_MS * 1000u) {
+        printf("FAIL: ESE_WAIT_POLL\n");
+        failed = 1;
+    }
+
+    /* Adaptive: the first exchanges learn, the next ones sleep most of it */
+    phNxpEse_setWaitMode(conn_ctx, ESE_WAIT_ADAPTIVE);
+    failed |= transceive(conn_ctx);
+    failed |= transceive(conn_ctx);
+    for (i = 0; i < 3; i++) {
+        failed |= transceive(conn_ctx);
+        printf("adaptive: %u polls, %u in the first half\n",
+            (unsigned)gPolls.count,
+            (unsigned)polls_before(TEST_LATENCY_US / 2));
+        if (polls_before(TEST_LATENCY_US / 2) != 0) {
+            printf("FAIL: polled during the learned sleep\n");
+            failed = 1;
+        }
+    }
+
+    /* A bit later than learned: fine polling until the response is there */
+    gScriptLatencyUs = TEST_LATE_LATENCY_US;
+    failed |= transceive(conn_ctx);
+    printf("adaptive, late: %u polls, %u in the first half, min gap %u us\n",
+        (unsigned)gPolls.count,
+        (unsigned)polls_before(TEST_LATENCY_US / 2),
+        (unsigned)min_poll_gap());
+    if (polls_before(TEST_LATENCY_US / 2) != 0) {
+        printf("FAIL: polled during the learned sleep\n");
+        failed = 1;
+    }
+    if (min_poll_gap() >= ESE_POLL_DELAY_MS * 1000u) {
+        printf("FAIL: no fine polling\n");
+        failed = 1;
+    }
+
+    /* Much slower than learned: fine polling ends, the response still arrives */
+    gScriptLatencyUs = TEST_SLOW_LATENCY_US;
+    failed |= transceive(conn_ctx);
+    printf("adaptive, slow: %u polls\n", (unsigned)gPolls.count);
+
+    failed |= test_recovery(conn_ctx);
+    failed |= test_chaining(conn_ctx);
+    failed |= test_reads(conn_ctx);
+    failed |= test_async(conn_ctx);
+
+    phNxpEse_close(conn_ctx);
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
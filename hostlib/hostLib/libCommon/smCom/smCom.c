@@ -11,8 +11,16 @@
  * between Host and Secure Module
  */
 #include <stdio.h>
+#include <string.h>
 #include "smCom.h"
 #include "nxLog_smCom.h"
+#include "sm_metrics.h"
+#include "sm_timer.h"
+
+#if defined(__gnu_linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 #if defined(USE_RTOS) && (USE_RTOS == 1)
 #include "FreeRTOS.h"
@@ -71,6 +79,20 @@ static SemaphoreHandle_t gSmComlock;
 
 static ApduTransceiveFunction_t pSmCom_Transceive = NULL;
 static ApduTransceiveRawFunction_t pSmCom_TransceiveRaw = NULL;
+static ApduTransceiveRawStartFunction_t pSmCom_TransceiveStart = NULL;
+static ApduTransceivePollFunction_t pSmCom_TransceivePoll = NULL;
+
+/* Exchange started by smCom_TransceiveRawAsync(), one at a time */
+static struct
+{
+    U8 pending;
+    U8 *pTx; /* Referenced by the protocol layer until the exchange is complete */
+    U16 txLen;
+    U8 *pRx;
+    smComAsyncCallback_t pCallback;
+    void *pCbCtx;
+    int timerFd; /* Readable when the next smCom_AsyncPoll() is due, -1 if not available */
+} gSmComAsync = {0, NULL, 0, NULL, NULL, NULL, -1};
 
 /**
  * Install interconnect and protocol specific implementation of APDU transfer functions.
@@ -94,6 +116,9 @@ U16 smCom_Init(ApduTransceiveFunction_t pTransceive, ApduTransceiveRawFunction_t
 #endif
     pSmCom_Transceive = pTransceive;
     pSmCom_TransceiveRaw = pTransceiveRaw;
+    /* Installed separately by smCom_InitAsync() */
+    pSmCom_TransceiveStart = NULL;
+    pSmCom_TransceivePoll = NULL;
     ret = SMCOM_OK;
     return ret;
 }
@@ -110,6 +135,36 @@ void smCom_DeInit(void)
 #endif
     pSmCom_Transceive = NULL;
     pSmCom_TransceiveRaw = NULL;
+    pSmCom_TransceiveStart = NULL;
+    pSmCom_TransceivePoll = NULL;
+    gSmComAsync.pending = 0;
+#if defined(__gnu_linux__)
+    if (gSmComAsync.timerFd >= 0) {
+        close(gSmComAsync.timerFd);
+        gSmComAsync.timerFd = -1;
+    }
+#endif
+}
+
+/**
+ * Install the non blocking variant of the APDU transfer functions, used by
+ * smCom_TransceiveRawAsync(). To be called after smCom_Init().
+ *
+ */
+U16 smCom_InitAsync(ApduTransceiveRawStartFunction_t pTransceiveStart, ApduTransceivePollFunction_t pTransceivePoll)
+{
+    pSmCom_TransceiveStart = pTransceiveStart;
+    pSmCom_TransceivePoll = pTransceivePoll;
+    gSmComAsync.pending = 0;
+#if defined(__gnu_linux__)
+    if (gSmComAsync.timerFd < 0) {
+        gSmComAsync.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (gSmComAsync.timerFd < 0) {
+            LOG_W("timerfd_create failed, smCom_AsyncGetFd() not available");
+        }
+    }
+#endif
+    return SMCOM_OK;
 }
 
 /**
@@ -127,7 +182,9 @@ U32 smCom_Transceive(void *conn_ctx, apdu_t * pApdu)
     if (pSmCom_Transceive != NULL)
     {
         LOCK_TXN();
+        SM_METRICS_LINK_BEGIN(pApdu->pBuf);
         ret = pSmCom_Transceive(conn_ctx, pApdu);
+        SM_METRICS_LINK_END();
         UNLOCK_TXN();
     }
     return ret;
@@ -151,12 +208,205 @@ U32 smCom_TransceiveRaw(void *conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 * pRx
     if (pSmCom_TransceiveRaw != NULL)
     {
         LOCK_TXN();
+        SM_METRICS_LINK_BEGIN((txLen >= 4) ? pTx : NULL);
         ret = pSmCom_TransceiveRaw(conn_ctx, pTx, txLen, pRx, pRxLen);
+        SM_METRICS_LINK_END();
+        UNLOCK_TXN();
+    }
+    return ret;
+}
+
+/* Make the timer fd readable after delayUs, or disarm it once nothing is pending */
+static void smCom_AsyncArm(U32 delayUs)
+{
+#if defined(__gnu_linux__)
+    struct itimerspec its;
+    uint64_t expirations = 0;
+
+    if (gSmComAsync.timerFd < 0) {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    if (gSmComAsync.pending) {
+        its.it_value.tv_sec = delayUs / 1000000;
+        its.it_value.tv_nsec = (long)(delayUs % 1000000) * 1000;
+        if (delayUs == 0) {
+            /* A zero it_value disarms the timer, expire right away instead */
+            its.it_value.tv_nsec = 1;
+        }
+    }
+    /* Consume an expiry that was already signalled */
+    if (read(gSmComAsync.timerFd, &expirations, sizeof(expirations)) < 0) {
+        /* EAGAIN: nothing to consume */
+    }
+    if (timerfd_settime(gSmComAsync.timerFd, 0, &its, NULL) != 0) {
+        LOG_W("timerfd_settime failed");
+    }
+#else
+    (void)delayUs;
+#endif
+}
+
+/**
+ * Starts an APDU exchange without waiting for the response.
+ *
+ * The exchange is driven by smCom_AsyncPoll() or smCom_AsyncWait(), pCallback is
+ * called from there once it is complete. pTx and pRx must stay valid until then.
+ * Only one exchange can be in progress, synchronous exchanges fail meanwhile.
+ *
+ * @param[in] pTx          Command to be sent to secure module
+ * @param[in] txLen        Length of command to be sent
+ * @param[out] pRx         Buffer to contain response
+ * @param[in] rxBufLen     Size of pRx
+ * @param[in] pCallback    Completion callback, can be NULL
+ * @param[in] pCbCtx       Passed to pCallback
+ *
+ * @retval ::SMCOM_OK          Exchange started
+ * @retval ::SMCOM_SND_FAILED  Send Failed, or an exchange is already in progress
+ * @retval ::SMCOM_NO_PRIOR_INIT  No asynchronous transfer functions installed
+ */
+U32 smCom_TransceiveRawAsync(
+    void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 rxBufLen, smComAsyncCallback_t pCallback, void *pCbCtx)
+{
+    U32 ret = SMCOM_NO_PRIOR_INIT;
+    if ((pSmCom_TransceiveStart != NULL) && (pSmCom_TransceivePoll != NULL))
+    {
+        LOCK_TXN();
+        if (gSmComAsync.pending) {
+            LOG_E("Asynchronous exchange already in progress");
+            ret = SMCOM_SND_FAILED;
+        }
+        else {
+            SM_METRICS_LINK_BEGIN((txLen >= 4) ? pTx : NULL);
+            ret = pSmCom_TransceiveStart(conn_ctx, pTx, txLen, pRx, rxBufLen);
+            SM_METRICS_LINK_END();
+            if (ret == SMCOM_OK) {
+                gSmComAsync.pending = 1;
+                gSmComAsync.pTx = pTx;
+                gSmComAsync.txLen = txLen;
+                gSmComAsync.pRx = pRx;
+                gSmComAsync.pCallback = pCallback;
+                gSmComAsync.pCbCtx = pCbCtx;
+                smCom_AsyncArm(0);
+            }
+        }
         UNLOCK_TXN();
     }
     return ret;
 }
 
+/**
+ * Progresses the exchange started by smCom_TransceiveRawAsync().
+ *
+ * Call it when the fd of smCom_AsyncGetFd() is readable, or after *pNextPollUs.
+ * The completion callback is called from here.
+ *
+ * @note This does not sleep. The response of the SE is probed for, never
+ * waited on, and a frame that must not be sent yet (I2C write guard, T=1 error
+ * recovery backoff, answer to a WTX request) is sent by a later call: the delay
+ * is returned in *pNextPollUs. A step still blocks for the I2C transfers
+ * themselves.
+ *
+ * @param[out] pNextPollUs  While SMCOM_PENDING: micro seconds until the next call is useful. Can be NULL.
+ *
+ * @retval ::SMCOM_PENDING     Exchange still in progress
+ * @retval ::SMCOM_OK          Exchange complete, or none in progress
+ * @retval ::SMCOM_SND_FAILED  Exchange failed
+ */
+U32 smCom_AsyncPoll(void *conn_ctx, U32 *pNextPollUs)
+{
+    U32 ret = SMCOM_NO_PRIOR_INIT;
+    U32 rxLen = 0;
+    U32 nextPollUs = 0;
+    U8 *pRx = NULL;
+    smComAsyncCallback_t pCallback = NULL;
+    void *pCbCtx = NULL;
+
+    if (pNextPollUs != NULL) {
+        *pNextPollUs = 0;
+    }
+    if (pSmCom_TransceivePoll == NULL) {
+        return ret;
+    }
+    LOCK_TXN();
+    if (!gSmComAsync.pending) {
+        ret = SMCOM_OK;
+    }
+    else {
+        SM_METRICS_LINK_BEGIN((gSmComAsync.txLen >= 4) ? gSmComAsync.pTx : NULL);
+        ret = pSmCom_TransceivePoll(conn_ctx, &rxLen, &nextPollUs);
+        SM_METRICS_LINK_END();
+        if (ret != SMCOM_PENDING) {
+            gSmComAsync.pending = 0;
+            pRx = gSmComAsync.pRx;
+            pCallback = gSmComAsync.pCallback;
+            pCbCtx = gSmComAsync.pCbCtx;
+        }
+        smCom_AsyncArm(nextPollUs);
+    }
+    UNLOCK_TXN();
+
+    if (ret == SMCOM_PENDING) {
+        if (pNextPollUs != NULL) {
+            *pNextPollUs = nextPollUs;
+        }
+    }
+    else if (pCallback != NULL) {
+        /* Outside of the lock, the callback may start the next exchange */
+        pCallback(pCbCtx, ret, pRx, rxLen);
+    }
+    return ret;
+}
+
+/**
+ * Sleeps and polls until the exchange started by smCom_TransceiveRawAsync() is complete.
+ *
+ * @param[in] timeoutMs    Give up after this time, the exchange stays in progress
+ *
+ * @retval ::SMCOM_PENDING     Timeout
+ * @retval ::SMCOM_OK          Exchange complete, or none in progress
+ * @retval ::SMCOM_SND_FAILED  Exchange failed
+ */
+U32 smCom_AsyncWait(void *conn_ctx, U32 timeoutMs)
+{
+    U32 ret = SMCOM_NO_PRIOR_INIT;
+    U32 nextPollUs = 0;
+    uint64_t nowUs = sm_get_time_us();
+    uint64_t deadlineUs = nowUs + ((uint64_t)timeoutMs * 1000);
+
+    for (;;) {
+        ret = smCom_AsyncPoll(conn_ctx, &nextPollUs);
+        if (ret != SMCOM_PENDING) {
+            break;
+        }
+        nowUs = sm_get_time_us();
+        if (nowUs >= deadlineUs) {
+            break;
+        }
+        if (nextPollUs > (deadlineUs - nowUs)) {
+            nextPollUs = (U32)(deadlineUs - nowUs);
+        }
+        if (nextPollUs >= 1000) {
+            sm_sleep(nextPollUs / 1000);
+        }
+        if ((nextPollUs % 1000) != 0) {
+            sm_usleep(nextPollUs % 1000);
+        }
+    }
+    return ret;
+}
+
+/**
+ * File descriptor that becomes readable when smCom_AsyncPoll() is due, to be
+ * added to an epoll / poll / select loop. Linux only.
+ *
+ * @return The timer fd, -1 if not available
+ */
+int smCom_AsyncGetFd(void)
+{
+    return gSmComAsync.timerFd;
+}
+
 #if defined(SMCOM_JRCP_V2)
 void smCom_Echo(void *conn_ctx, const char *comp, const char *level, const char *buffer)
 {
@@ -171,4 +421,4 @@ void smCom_Echo(void *conn_ctx, const char *comp, const char *level, const char
     smComJRCP_Echo(conn_ctx, comp, level, buffer);
     UNLOCK_TXN();
 }
-#endif
\ No newline at end of file
+#endif
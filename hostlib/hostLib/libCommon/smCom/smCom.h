@@ -28,17 +28,40 @@ extern "C" {
 #define SMCOM_NO_PRIOR_INIT   0x7015  //!< The callbacks doing the actual transfer have not been installed
 #define SMCOM_COM_ALREADY_OPEN      0x7016  //!< Communication link is already open with device
 #define SMCOM_COM_INIT_FAILED       0x7017  //!< Communication init failed
+#define SMCOM_PENDING         0x7018  //!< Asynchronous exchange is still in progress
 
 
 /* ------------------------------------------------------------------------- */
 typedef U32 (*ApduTransceiveFunction_t) (void* conn_ctx, apdu_t * pAdpu);
 typedef U32 (*ApduTransceiveRawFunction_t) (void* conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 * pRxLen);
+/** Sends the first frame of an exchange and returns, SMCOM_OK if it was sent */
+typedef U32 (*ApduTransceiveRawStartFunction_t) (void* conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 rxBufLen);
+/** Progresses the exchange without waiting for the response. SMCOM_PENDING and the delay until the
+ * next call is useful, or the final status and response length. Never sleeps, delays before the
+ * next frame (WTX, T=1 error recovery) come back as the delay, see smCom_AsyncPoll() */
+typedef U32 (*ApduTransceivePollFunction_t) (void* conn_ctx, U32 * pRxLen, U32 * pNextPollUs);
+
+/** Completion of smCom_TransceiveRawAsync(), called from smCom_AsyncPoll() / smCom_AsyncWait()
+ *
+ * @param pCbCtx  Context given to smCom_TransceiveRawAsync()
+ * @param status  SMCOM_OK or error code
+ * @param pRx     Response buffer given to smCom_TransceiveRawAsync()
+ * @param rxLen   Length of the response
+ */
+typedef void (*smComAsyncCallback_t) (void * pCbCtx, U32 status, U8 * pRx, U32 rxLen);
 
 U16 smCom_Init(ApduTransceiveFunction_t pTransceive, ApduTransceiveRawFunction_t pTransceiveRaw);
 void smCom_DeInit(void);
 U32 smCom_Transceive(void *conn_ctx, apdu_t *pApdu);
 U32 smCom_TransceiveRaw(void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 *pRxLen);
 
+U16 smCom_InitAsync(ApduTransceiveRawStartFunction_t pTransceiveStart, ApduTransceivePollFunction_t pTransceivePoll);
+U32 smCom_TransceiveRawAsync(
+    void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 rxBufLen, smComAsyncCallback_t pCallback, void *pCbCtx);
+U32 smCom_AsyncPoll(void *conn_ctx, U32 *pNextPollUs);
+U32 smCom_AsyncWait(void *conn_ctx, U32 timeoutMs);
+int smCom_AsyncGetFd(void);
+
 #if defined(SMCOM_JRCP_V2)
 void smCom_Echo(void *conn_ctx, const char *comp, const char *level, const char *buffer);
 #endif
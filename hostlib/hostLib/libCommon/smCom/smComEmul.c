@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * This file implements the SmCom layer to the SE05x emulator.
+ *
+ * The emulator answers at once; the time the real SE would have needed is
+ * spent with sm_usleep() for the blocking exchange, or reported through
+ * the poll interval for the asynchronous one.
+ *
+ *****************************************************************************/
+
+#ifdef SMCOM_EMUL
+
+#include <string.h>
+
+#include "smComEmul.h"
+#include "se05x_emul.h"
+#include "sm_apdu.h"
+#include "sm_timer.h"
+
+#include "nxLog_smCom.h"
+#include "nxEnsure.h"
+
+/* ESE_MODE_RESUME of smComT1oI2C.h, without pulling in the T=1 stack */
+#define EMUL_MODE_RESUME 2
+
+static U32 smComEmul_Transceive(void *conn_ctx, apdu_t *pApdu);
+static U32 smComEmul_TransceiveRaw(void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 *pRxLen);
+static U32 smComEmul_TransceiveRawStart(void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 rxBufLen);
+static U32 smComEmul_TransceivePoll(void *conn_ctx, U32 *pRxLen, U32 *pNextPollUs);
+
+/* Exchange started with smComEmul_TransceiveRawStart */
+static struct
+{
+    U8 busy;
+    U32 rxLen;
+    uint64_t readyAtUs;
+} gEmulAsync;
+
+U16 smComEmul_Init(void **conn_ctx, const char *pConnString)
+{
+    (void)pConnString;
+    if (conn_ctx != NULL) {
+        *conn_ctx = NULL;
+    }
+    return SMCOM_OK;
+}
+
+U16 smComEmul_Open(void *conn_ctx, U8 *atr, U16 *atrLen)
+{
+    U16 smComStatus;
+
+    (void)conn_ctx;
+    (void)atr;
+    if (atrLen != NULL) {
+        *atrLen = 0;
+    }
+    memset(&gEmulAsync, 0, sizeof(gEmulAsync));
+    smComStatus = smCom_Init(&smComEmul_Transceive, &smComEmul_TransceiveRaw);
+    if (smComStatus == SMCOM_OK) {
+        smComStatus = smCom_InitAsync(&smComEmul_TransceiveRawStart, &smComEmul_TransceivePoll);
+    }
+    return smComStatus;
+}
+
+U16 smComEmul_Close(void *conn_ctx, U8 mode)
+{
+    (void)conn_ctx;
+    memset(&gEmulAsync, 0, sizeof(gEmulAsync));
+    if (mode != EMUL_MODE_RESUME) {
+        se05x_emul_reset();
+    }
+    return SMCOM_OK;
+}
+
+static U32 smComEmul_Transceive(void *conn_ctx, apdu_t *pApdu)
+{
+    U32 respLen = MAX_APDU_BUF_LENGTH;
+    U32 retCode = SMCOM_COM_FAILED;
+
+    ENSURE_OR_GO_EXIT(pApdu != NULL);
+
+    retCode      = smComEmul_TransceiveRaw(conn_ctx, (U8 *)pApdu->pBuf, pApdu->buflen, pApdu->pBuf, &respLen);
+    pApdu->rxlen = (U16)respLen;
+exit:
+    return retCode;
+}
+
+static U32 smComEmul_TransceiveRaw(void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 *pRxLen)
+{
+    size_t rxLen       = *pRxLen;
+    uint32_t latencyUs = 0;
+
+    (void)conn_ctx;
+    LOG_MAU8_D("APDU Tx>", pTx, txLen);
+    (void)se05x_emul_process(pTx, txLen, pRx, &rxLen, &latencyUs);
+    if (rxLen == 0) {
+        *pRxLen = 0;
+        LOG_E(" Transcive Failed ");
+        return SMCOM_SND_FAILED;
+    }
+    if (latencyUs > 0) {
+        sm_usleep(latencyUs);
+    }
+    *pRxLen = (U32)rxLen;
+    LOG_MAU8_D("APDU Rx<", pRx, *pRxLen);
+    return SMCOM_OK;
+}
+
+static U32 smComEmul_TransceiveRawStart(void *conn_ctx, U8 *pTx, U16 txLen, U8 *pRx, U32 rxBufLen)
+{
+    size_t rxLen       = rxBufLen;
+    uint32_t latencyUs = 0;
+
+    (void)conn_ctx;
+    LOG_MAU8_D("APDU Tx>", pTx, txLen);
+    (void)se05x_emul_process(pTx, txLen, pRx, &rxLen, &latencyUs);
+    if (rxLen == 0) {
+        LOG_E(" Transcive Failed ");
+        return SMCOM_SND_FAILED;
+    }
+    gEmulAsync.busy      = 1;
+    gEmulAsync.rxLen     = (U32)rxLen;
+    gEmulAsync.readyAtUs = sm_get_time_us() + latencyUs;
+    return SMCOM_OK;
+}
+
+static U32 smComEmul_TransceivePoll(void *conn_ctx, U32 *pRxLen, U32 *pNextPollUs)
+{
+    uint64_t now = sm_get_time_us();
+
+    (void)conn_ctx;
+    if (!gEmulAsync.busy) {
+        *pRxLen = 0;
+        LOG_E(" Transcive Failed ");
+        return SMCOM_SND_FAILED;
+    }
+    if (now < gEmulAsync.readyAtUs) {
+        if (pNextPollUs != NULL) {
+            *pNextPollUs = (U32)(gEmulAsync.readyAtUs - now);
+        }
+        return SMCOM_PENDING;
+    }
+    gEmulAsync.busy = 0;
+    *pRxLen         = gEmulAsync.rxLen;
+    return SMCOM_OK;
+}
+
+#endif /* SMCOM_EMUL */
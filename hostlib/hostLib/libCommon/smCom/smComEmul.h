@@ -0,0 +1,51 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * This file provides the API of the SmCom layer to the SE05x emulator,
+ * see se05x_emul.h.
+ *
+ *****************************************************************************/
+
+#ifndef _SMCOMEMUL_H_
+#define _SMCOMEMUL_H_
+
+#include "smCom.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Prepare the emulator. No physical connection is made.
+ * @param conn_ctx      OUT: connection context, set to NULL
+ * @param pConnString   IN: ignored
+ * @return SMCOM_OK
+ */
+U16 smComEmul_Init(void **conn_ctx, const char *pConnString);
+
+/**
+ * Power up the emulated SE and register it with smCom.
+ * @param conn_ctx      IN: connection context
+ * @param atr           IN: buffer for the ATR, none is returned
+ * @param atrLen        IN: size of atr; OUT: 0
+ * @return
+ */
+U16 smComEmul_Open(void *conn_ctx, U8 *atr, U16 *atrLen);
+
+/**
+ * Power down the emulated SE. Persistent objects are kept.
+ * @param conn_ctx      IN: connection context
+ * @param mode          IN: ESE_MODE_RESUME keeps sessions and Platform SCP
+ * @return SMCOM_OK
+ */
+U16 smComEmul_Close(void *conn_ctx, U8 mode);
+
+#if defined(__cplusplus)
+}
+#endif
+#endif /* _SMCOMEMUL_H_ */
@@ -17,11 +17,13 @@
 #include "smComT1oI2C.h"
 #include "phNxpEse_Api.h"
 #include "phNxpEseProto7816_3.h"
+#include "phNxpEsePal_i2c.h"
 
 #include "i2c_a7.h"
 #include "sm_printf.h"
 #include "phEseStatus.h"
 #include "sm_apdu.h"
+#include "sm_timer.h"
 
 #ifdef FLOW_VERBOSE
 #define NX_LOG_ENABLE_SMCOM_DEBUG 1
@@ -32,8 +34,30 @@
 #include "nxLog_smCom.h"
 #include "nxEnsure.h"
 
+/* Time the SE needs to boot after axReset_PowerUp() or se05x_ic_reset(),
+ * before it answers on I2C */
+#ifndef T1oI2C_BOOT_TIME_MS
+#define T1oI2C_BOOT_TIME_MS 3
+#endif
+
+/* Pause between two ATR requests of smComT1oI2C_Open while the SE boots */
+#ifndef T1oI2C_READY_POLL_MS
+#define T1oI2C_READY_POLL_MS 1
+#endif
+
+/* How many times smComT1oI2C_Open repeats the ATR request while the SE is
+ * still booting, i.e. while it NACKs its address and sends no frame. Other
+ * failures are not repeated. A failed request, with its own interface reset
+ * retries, takes longer than the boot, so this counts requests, not time.
+ * With the WAKE_UP_DELAY_MS of each request, the waits cover four boot times. */
+#ifndef T1oI2C_READY_RETRIES
+#define T1oI2C_READY_RETRIES ((4 * T1oI2C_BOOT_TIME_MS) / (WAKE_UP_DELAY_MS + T1oI2C_READY_POLL_MS) + 1)
+#endif
+
 static U32 smComT1oI2C_Transceive(void* conn_ctx, apdu_t * pApdu);
 static U32 smComT1oI2C_TransceiveRaw(void* conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 * pRxLen);
+static U32 smComT1oI2C_TransceiveRawStart(void* conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 rxBufLen);
+static U32 smComT1oI2C_TransceivePoll(void* conn_ctx, U32 * pRxLen, U32 * pNextPollUs);
 U16 smComT1oI2C_AnswerToReset(void* conn_ctx, U8 *T1oI2Catr, U16 *T1oI2CatrLen);
 
 U16 smComT1oI2C_Close(void *conn_ctx, U8 mode)
@@ -45,7 +69,13 @@ U16 smComT1oI2C_Close(void *conn_ctx, U8 mode)
      * the application must pass conn_ctx to close the connection.
      */
     if (conn_ctx) {
-        status=phNxpEse_EndOfApdu(conn_ctx);
+        if (mode == ESE_MODE_RESUME) {
+            /* Keep the session with the SE open, only release the link */
+            status = ESESTATUS_SUCCESS;
+        }
+        else {
+            status = phNxpEse_EndOfApdu(conn_ctx);
+        }
         //status=phNxpEse_chipReset();
         if(status ==ESESTATUS_SUCCESS)
         {
@@ -108,18 +138,31 @@ U16 smComT1oI2C_Resume(void **conn_ctx, const char *pConnString)
 U16 smComT1oI2C_Open(void *conn_ctx, U8 mode, U8 seqCnt, U8 *T1oI2Catr, U16 *T1oI2CatrLen)
 {
     ESESTATUS ret;
+    U16 smComStatus;
     phNxpEse_data AtrRsp;
     phNxpEse_initParams initParams;
-    initParams.initMode = ESE_MODE_NORMAL;
-    AtrRsp.len = *T1oI2CatrLen;
-    AtrRsp.p_data = T1oI2Catr;
+    U32 retries = 0;
+    initParams.initMode = (mode == ESE_MODE_RESUME) ? ESE_MODE_RESUME : ESE_MODE_NORMAL;
 
     if (conn_ctx == NULL) {
         // Connection context is stored in global variable contained in phNxpEse_Api.c
         smComT1oI2C_Init(NULL, NULL);
     }
 
-    ret=phNxpEse_init(conn_ctx, initParams, &AtrRsp);
+    for (;;) {
+        AtrRsp.len = *T1oI2CatrLen;
+        AtrRsp.p_data = T1oI2Catr;
+        ret=phNxpEse_init(conn_ctx, initParams, &AtrRsp);
+        /* Poll for the ATR instead of waiting a fixed boot time. Only an SE
+         * that does not answer at all may still boot. */
+        if (ret != ESESTATUS_RESPONSE_TIMEOUT || initParams.initMode == ESE_MODE_RESUME ||
+            retries >= T1oI2C_READY_RETRIES) {
+            break;
+        }
+        retries++;
+        LOG_D("No ATR yet, SE may still boot");
+        sm_sleep(T1oI2C_READY_POLL_MS);
+    }
     if (ret != ESESTATUS_SUCCESS)
     {
         *T1oI2CatrLen=0;
@@ -130,7 +173,11 @@ U16 smComT1oI2C_Open(void *conn_ctx, U8 mode, U8 seqCnt, U8 *T1oI2Catr, U16 *T1o
     {
        *T1oI2CatrLen = AtrRsp.len ; /*Retrive INF FIELD*/
     }
-    return smCom_Init(&smComT1oI2C_Transceive, &smComT1oI2C_TransceiveRaw);
+    smComStatus = smCom_Init(&smComT1oI2C_Transceive, &smComT1oI2C_TransceiveRaw);
+    if (smComStatus == SMCOM_OK) {
+        smComStatus = smCom_InitAsync(&smComT1oI2C_TransceiveRawStart, &smComT1oI2C_TransceivePoll);
+    }
+    return smComStatus;
 }
 
 static U32 smComT1oI2C_Transceive(void* conn_ctx, apdu_t * pApdu)
@@ -175,6 +222,48 @@ static U32 smComT1oI2C_TransceiveRaw(void* conn_ctx, U8 * pTx, U16 txLen, U8 * p
     return SMCOM_OK;
 }
 
+static U32 smComT1oI2C_TransceiveRawStart(void* conn_ctx, U8 * pTx, U16 txLen, U8 * pRx, U32 rxBufLen)
+{
+    phNxpEse_data pCmdTrans;
+    phNxpEse_data pRspTrans={0};
+    ESESTATUS txnStatus;
+
+    pCmdTrans.len = txLen;
+    pCmdTrans.p_data = pTx;
+
+    pRspTrans.len = rxBufLen;
+    pRspTrans.p_data = pRx;
+
+    LOG_MAU8_D("APDU Tx>", pTx, txLen);
+    txnStatus = phNxpEse_TransceiveStart(conn_ctx, &pCmdTrans, &pRspTrans);
+    if ( txnStatus != ESESTATUS_SUCCESS )
+    {
+        LOG_E(" Transcive Failed ");
+        return SMCOM_SND_FAILED;
+    }
+
+    return SMCOM_OK;
+}
+
+static U32 smComT1oI2C_TransceivePoll(void* conn_ctx, U32 * pRxLen, U32 * pNextPollUs)
+{
+    ESESTATUS txnStatus;
+
+    txnStatus = phNxpEse_TransceivePoll(conn_ctx, pRxLen, pNextPollUs);
+    if ( txnStatus == ESESTATUS_PENDING )
+    {
+        return SMCOM_PENDING;
+    }
+    else if ( txnStatus != ESESTATUS_SUCCESS )
+    {
+        *pRxLen = 0;
+        LOG_E(" Transcive Failed ");
+        return SMCOM_SND_FAILED;
+    }
+
+    return SMCOM_OK;
+}
+
 U16 smComT1oI2C_AnswerToReset(void* conn_ctx, U8 *T1oI2Catr, U16 *T1oI2CatrLen)
 {
     phNxpEse_data pRsp= {0};
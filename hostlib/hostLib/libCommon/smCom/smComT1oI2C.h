@@ -36,7 +36,9 @@ extern "C" {
  * @param conn_ctx  connection context
  * @param mode      Ese Communication mode either
  *                  ESE_MODE_NORMAL: All wired transaction other OSU or
- *                  ESE_MODE_OSU :Jcop Os update mode
+ *                  ESE_MODE_OSU :Jcop Os update mode or
+ *                  ESE_MODE_RESUME: Only release the link, the session
+ *                  with the SE is kept open for a later resume
  * @return
  */
 U16 smComT1oI2C_Close(void *conn_ctx, U8 mode);
@@ -52,6 +54,7 @@ U16 smComT1oI2C_ComReset(void *conn_ctx);
  * Initializes or resumes the T=1 o I2C communication layer.
  * @param conn_ctx      IN: connection context
  * @param mode          Ese Communication mode either ESE_MODE_NORMAL: All wired transaction other OSU or ESE_MODE_OSU :Jcop Os update mode
+ *                      or ESE_MODE_RESUME: Only re-synchronise the link, no interface reset and no ATR
  * @param T1oI2Catr     IN: Pointer to buffer to contain SCI2C_ATR value
  * @param T1oI2CatrLen  IN: Size of buffer provided; OUT: Actual length of atr retrieved
  * @return
@@ -0,0 +1,399 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * I2C driver that talks to the SE05x emulator instead of an I2C bus.
+ *
+ * Build it in place of platform/linux/i2c_a7.c to run the complete T=1
+ * over I2C stack (framing, chaining, CRC, S-blocks, NAD polling) against
+ * se05x_emul.c. This file plays the SE side of the link: it answers the
+ * frames written by the host, and NACKs reads until the emulated
+ * processing time of a command has passed.
+ *
+ * WTX requests are never sent, the emulated SE answers in one frame
+ * however long the command takes.
+ *
+ **/
+
+#include "i2c_a7.h"
+#include <string.h>
+
+#include "phNxpEseCrc16.h"
+#include "se05x_emul.h"
+#include "sm_timer.h"
+
+#include "nxLog_smCom.h"
+
+#if defined(T1oI2C)
+
+/** Time the emulated SE needs to answer an R-block or S-block */
+#ifndef I2C_EMUL_FRAME_LATENCY_US
+#define I2C_EMUL_FRAME_LATENCY_US 100
+#endif
+
+/** Largest C-APDU / R-APDU passed through the emulated link */
+#ifndef I2C_EMUL_MAX_APDU
+#define I2C_EMUL_MAX_APDU 4352
+#endif
+
+#define I2C_EMUL_NAD_HOST 0x5A
+#define I2C_EMUL_NAD_SE 0xA5
+#define I2C_EMUL_IFS 254
+
+#define I2C_EMUL_PCB_R 0x80
+#define I2C_EMUL_PCB_S_REQ 0xC0
+#define I2C_EMUL_PCB_S_RSP 0xE0
+#define I2C_EMUL_PCB_M 0x20
+
+#define I2C_EMUL_S_RESYNCH 0x00
+#define I2C_EMUL_S_IFS 0x01
+#define I2C_EMUL_S_ABORT 0x02
+#define I2C_EMUL_S_CIP 0x04
+#define I2C_EMUL_S_END_APDU 0x05
+#define I2C_EMUL_S_CHIP_RST 0x06
+#define I2C_EMUL_S_ATR 0x07
+#define I2C_EMUL_S_SWR 0x0F
+#define I2C_EMUL_S_COLD_RST 0x1E
+
+#if defined(T1oI2C_GP1_0)
+#define I2C_EMUL_HDR_LEN 4
+#else
+#define I2C_EMUL_HDR_LEN 3
+#endif
+#define I2C_EMUL_CRC_LEN 2
+
+/* ATR / CIP of the emulated SE, BWT 1000 ms, IFSC 254 */
+#if defined(T1oI2C_GP1_0)
+/* PVER, IIN, PLID (I2C), PLP, DLLP: BWT IFSC, HB */
+static const U8 gEmulAtr[] = {0x01,
+    0x05,
+    0xA0,
+    0x00,
+    0x00,
+    0x03,
+    0x96,
+    0x02,
+    0x06,
+    0x03,
+    0xE8,
+    0x00,
+    0x01,
+    0x00,
+    0x64,
+    0x04,
+    0x03,
+    0xE8,
+    0x00,
+    I2C_EMUL_IFS,
+    0x05,
+    'E',
+    'M',
+    'U',
+    'L',
+    '0'};
+#else
+/* PVER, VID, DLLP: BWT IFSC, PLID (I2C), PLP, HB */
+static const U8 gEmulAtr[] = {0x00,
+    0xA0,
+    0x00,
+    0x00,
+    0x03,
+    0x96,
+    0x04,
+    0x03,
+    0xE8,
+    0x00,
+    I2C_EMUL_IFS,
+    0x02,
+    0x0B,
+    0x03,
+    0xE8,
+    0x08,
+    0x01,
+    0x00,
+    0x00,
+    0x00,
+    0x00,
+    0x64,
+    0x00,
+    0x00,
+    0x05,
+    'E',
+    'M',
+    'U',
+    'L',
+    '0'};
+#endif
+
+/* SE side of the T=1 link */
+static struct
+{
+    /* Frame being read by the host, kept for a retransmission */
+    U8 frame[I2C_EMUL_HDR_LEN + I2C_EMUL_MAX_APDU + I2C_EMUL_CRC_LEN];
+    size_t frameLen;
+    size_t framePos;
+    uint64_t readyAtUs;
+    /* C-APDU collected from chained I-blocks */
+    U8 cmd[I2C_EMUL_MAX_APDU];
+    size_t cmdLen;
+    /* R-APDU, sent in I-blocks of up to ifsd bytes */
+    U8 rsp[I2C_EMUL_MAX_APDU];
+    size_t rspLen;
+    size_t rspPos;
+    /* N(S) of the next I-block of the SE */
+    U8 seSeq;
+    U16 ifsd;
+} gEmulLink;
+
+static int gEmulLinkOpen;
+
+static void emul_link_reset(void)
+{
+    gEmulLink.frameLen = 0;
+    gEmulLink.framePos = 0;
+    gEmulLink.cmdLen   = 0;
+    gEmulLink.rspLen   = 0;
+    gEmulLink.rspPos   = 0;
+    gEmulLink.seSeq    = 0;
+    gEmulLink.ifsd     = I2C_EMUL_IFS;
+}
+
+static void emul_link_frame(U8 pcb, const U8 *inf, size_t infLen, uint32_t latencyUs)
+{
+    U8 *p = gEmulLink.frame;
+    U16 crc;
+
+    *p++ = I2C_EMUL_NAD_SE;
+    *p++ = pcb;
+#if defined(T1oI2C_GP1_0)
+    *p++ = (U8)(infLen >> 8);
+#endif
+    *p++ = (U8)infLen;
+    if (infLen > 0) {
+        memcpy(p, inf, infLen);
+        p += infLen;
+    }
+    crc  = phNxpEseCrc16_Compute(gEmulLink.frame, (uint32_t)(p - gEmulLink.frame));
+    *p++ = (U8)(crc >> 8);
+    *p++ = (U8)crc;
+
+    gEmulLink.frameLen  = (size_t)(p - gEmulLink.frame);
+    gEmulLink.framePos  = 0;
+    gEmulLink.readyAtUs = sm_get_time_us() + latencyUs;
+}
+
+/* Next I-block of the R-APDU */
+static void emul_link_send_rsp(uint32_t latencyUs)
+{
+    size_t chunk = gEmulLink.rspLen - gEmulLink.rspPos;
+    U8 pcb       = (U8)(gEmulLink.seSeq << 6);
+
+    if (chunk > gEmulLink.ifsd) {
+        chunk = gEmulLink.ifsd;
+        pcb |= I2C_EMUL_PCB_M;
+    }
+    emul_link_frame(pcb, &gEmulLink.rsp[gEmulLink.rspPos], chunk, latencyUs);
+    gEmulLink.rspPos += chunk;
+    gEmulLink.seSeq ^= 1;
+}
+
+static void emul_link_resend(void)
+{
+    gEmulLink.framePos  = 0;
+    gEmulLink.readyAtUs = sm_get_time_us() + I2C_EMUL_FRAME_LATENCY_US;
+}
+
+static void emul_link_i_block(U8 pcb, const U8 *inf, size_t infLen)
+{
+    size_t rspLen      = sizeof(gEmulLink.rsp);
+    uint32_t latencyUs = 0;
+
+    if (gEmulLink.cmdLen + infLen > sizeof(gEmulLink.cmd)) {
+        LOG_E("emul: C-APDU too long");
+        gEmulLink.cmdLen = 0;
+        emul_link_frame((U8)(I2C_EMUL_PCB_R | (((pcb >> 6) & 1) << 4) | 0x02), NULL, 0, I2C_EMUL_FRAME_LATENCY_US);
+        return;
+    }
+    memcpy(&gEmulLink.cmd[gEmulLink.cmdLen], inf, infLen);
+    gEmulLink.cmdLen += infLen;
+    if (pcb & I2C_EMUL_PCB_M) {
+        /* R(ACK), N(R) is the next I-block expected from the host */
+        emul_link_frame((U8)(I2C_EMUL_PCB_R | ((((pcb >> 6) & 1) ^ 1) << 4)), NULL, 0, I2C_EMUL_FRAME_LATENCY_US);
+        return;
+    }
+
+    (void)se05x_emul_process(gEmulLink.cmd, gEmulLink.cmdLen, gEmulLink.rsp, &rspLen, &latencyUs);
+    gEmulLink.cmdLen = 0;
+    gEmulLink.rspLen = rspLen;
+    gEmulLink.rspPos = 0;
+    emul_link_send_rsp(latencyUs);
+}
+
+static void emul_link_r_block(U8 pcb)
+{
+    U8 nr = (pcb >> 4) & 1;
+
+    if (gEmulLink.rspPos < gEmulLink.rspLen && nr == gEmulLink.seSeq && (pcb & 0x0F) == 0) {
+        /* Host acknowledged the last I-block of a chain */
+        emul_link_send_rsp(I2C_EMUL_FRAME_LATENCY_US);
+    }
+    else {
+        emul_link_resend();
+    }
+}
+
+static void emul_link_s_block(U8 pcb, const U8 *inf, size_t infLen)
+{
+    U8 type = pcb & 0x3F;
+
+    switch (type) {
+    case I2C_EMUL_S_RESYNCH:
+        emul_link_reset();
+        break;
+    case I2C_EMUL_S_IFS:
+        if (infLen == 1) {
+            gEmulLink.ifsd = inf[0];
+        }
+        else if (infLen == 2) {
+            gEmulLink.ifsd = (U16)((inf[0] << 8) | inf[1]);
+        }
+        if (gEmulLink.ifsd == 0 || gEmulLink.ifsd > I2C_EMUL_MAX_APDU) {
+            gEmulLink.ifsd = I2C_EMUL_IFS;
+        }
+        /* Echo the IFS */
+        emul_link_frame((U8)(I2C_EMUL_PCB_S_RSP | type), inf, infLen, I2C_EMUL_FRAME_LATENCY_US);
+        return;
+#if defined(T1oI2C_GP1_0)
+    case I2C_EMUL_S_CIP:
+        emul_link_reset();
+        emul_link_frame((U8)(I2C_EMUL_PCB_S_RSP | type), gEmulAtr, sizeof(gEmulAtr), I2C_EMUL_FRAME_LATENCY_US);
+        return;
+    case I2C_EMUL_S_COLD_RST:
+        emul_link_reset();
+        se05x_emul_reset();
+        break;
+    case I2C_EMUL_S_SWR:
+        emul_link_reset();
+        break;
+#else
+    case I2C_EMUL_S_ATR:
+    case I2C_EMUL_S_SWR:
+        /* Interface reset answers with the ATR as well */
+        emul_link_reset();
+        emul_link_frame((U8)(I2C_EMUL_PCB_S_RSP | type), gEmulAtr, sizeof(gEmulAtr), I2C_EMUL_FRAME_LATENCY_US);
+        return;
+    case I2C_EMUL_S_CHIP_RST:
+        emul_link_reset();
+        se05x_emul_reset();
+        break;
+#endif
+    case I2C_EMUL_S_ABORT:
+        gEmulLink.cmdLen = 0;
+        gEmulLink.rspLen = 0;
+        gEmulLink.rspPos = 0;
+        break;
+    default:
+        /* End of APDU, release: nothing to do */
+        break;
+    }
+    emul_link_frame((U8)(I2C_EMUL_PCB_S_RSP | type), NULL, 0, I2C_EMUL_FRAME_LATENCY_US);
+}
+
+i2c_error_t axI2CInit(void **conn_ctx, const char *pDevName)
+{
+    AX_UNUSED_ARG(pDevName);
+    if (!gEmulLinkOpen) {
+        emul_link_reset();
+        gEmulLinkOpen = 1;
+    }
+    /* Any non NULL handle, there is one emulated SE */
+    *conn_ctx = &gEmulLink;
+    LOG_D("emul: I2C link to the SE05x emulator");
+    return I2C_OK;
+}
+
+void axI2CTerm(void *conn_ctx, int mode)
+{
+    AX_UNUSED_ARG(conn_ctx);
+    AX_UNUSED_ARG(mode);
+    gEmulLinkOpen = 0;
+}
+
+i2c_error_t axI2CWrite(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pTx, unsigned short txLen)
+{
+    size_t infLen;
+    U16 crc;
+    U8 pcb;
+
+    AX_UNUSED_ARG(conn_ctx);
+    AX_UNUSED_ARG(bus);
+    AX_UNUSED_ARG(addr);
+    if (pTx == NULL || txLen < I2C_EMUL_HDR_LEN + I2C_EMUL_CRC_LEN) {
+        return I2C_FAILED;
+    }
+    LOG_MAU8_D("TX (axI2CWrite) > ", pTx, txLen);
+
+#if defined(T1oI2C_GP1_0)
+    infLen = ((size_t)pTx[2] << 8) | pTx[3];
+#else
+    infLen = pTx[2];
+#endif
+    pcb = pTx[1];
+    crc = phNxpEseCrc16_Compute(pTx, txLen - I2C_EMUL_CRC_LEN);
+    if (pTx[0] != I2C_EMUL_NAD_HOST || infLen + I2C_EMUL_HDR_LEN + I2C_EMUL_CRC_LEN != txLen ||
+        pTx[txLen - 2] != (U8)(crc >> 8) || pTx[txLen - 1] != (U8)crc) {
+        /* R(NAK) with a CRC / parity error */
+        LOG_W("emul: corrupt frame from host");
+        emul_link_frame((U8)(I2C_EMUL_PCB_R | 0x01), NULL, 0, I2C_EMUL_FRAME_LATENCY_US);
+        return I2C_OK;
+    }
+
+    if ((pcb & 0x80) == 0) {
+        emul_link_i_block(pcb, &pTx[I2C_EMUL_HDR_LEN], infLen);
+    }
+    else if ((pcb & 0xC0) == I2C_EMUL_PCB_R) {
+        emul_link_r_block(pcb);
+    }
+    else if ((pcb & 0xE0) == I2C_EMUL_PCB_S_REQ) {
+        emul_link_s_block(pcb, &pTx[I2C_EMUL_HDR_LEN], infLen);
+    }
+    else {
+        /* S-block response, the emulated SE never sends a request */
+        emul_link_resend();
+    }
+    return I2C_OK;
+}
+
+i2c_error_t axI2CRead(void *conn_ctx, unsigned char bus, unsigned char addr, unsigned char *pRx, unsigned short rxLen)
+{
+    size_t avail;
+
+    AX_UNUSED_ARG(conn_ctx);
+    AX_UNUSED_ARG(bus);
+    AX_UNUSED_ARG(addr);
+    if (pRx == NULL) {
+        return I2C_FAILED;
+    }
+    if (gEmulLink.framePos >= gEmulLink.frameLen || sm_get_time_us() < gEmulLink.readyAtUs) {
+        /* SE busy, or nothing to send */
+        return I2C_NACK_ON_ADDRESS;
+    }
+    avail = gEmulLink.frameLen - gEmulLink.framePos;
+    if (avail > rxLen) {
+        avail = rxLen;
+    }
+    memcpy(pRx, &gEmulLink.frame[gEmulLink.framePos], avail);
+    if (avail < rxLen) {
+        /* Reading past the frame, the bus reads back idle bytes */
+        memset(&pRx[avail], 0xFF, rxLen - avail);
+    }
+    gEmulLink.framePos += avail;
+    LOG_MAU8_D("RX (axI2CRead) < ", pRx, rxLen);
+    return I2C_OK;
+}
+
+#endif /* T1oI2C */
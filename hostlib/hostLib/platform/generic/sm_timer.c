@@ -18,6 +18,9 @@
 #include <unistd.h>
 #endif
 #include <time.h>
+#if defined(__gnu_linux__) || defined(__clang__)
+#include <errno.h>
+#endif
 #include "sm_timer.h"
 
 #if defined(USE_RTOS) && USE_RTOS == 1
@@ -68,10 +71,37 @@ void sm_usleep(uint32_t microsec)
 #elif defined(_WIN32)
     #pragma message ( "No sm_usleep implemented" )
 #elif defined(__gnu_linux__) || defined __clang__
-    usleep(microsec);
+    struct timespec ts;
+    ts.tv_sec = microsec / 1000000;
+    ts.tv_nsec = (long)(microsec % 1000000) * 1000;
+    /* Unlike usleep, resume the remaining time when interrupted by a signal */
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {
+        ;
+    }
 #elif defined(__OpenBSD__)
 	#warning "No sm_usleep implemented"
 #else
 	//#warning "No sm_usleep implemented"
 #endif
 }
+
+/**
+ * Monotonic time stamp in micro seconds.
+ *
+ * Only differences between two values are meaningful. The resolution is
+ * platform dependent (one RTOS tick on FreeRTOS).
+ */
+uint64_t sm_get_time_us(void)
+{
+#if defined(__gnu_linux__) || defined __clang__
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+    return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+#elif defined(USE_RTOS) && USE_RTOS == 1
+    return ((uint64_t)xTaskGetTickCount() * 1000000u) / configTICK_RATE_HZ;
+#else
+    return ((uint64_t)clock() * 1000000u) / CLOCKS_PER_SEC;
+#endif
+}
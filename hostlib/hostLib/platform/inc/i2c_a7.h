@@ -91,8 +91,14 @@ extern "C"{
 #if defined(SCI2C)
 #define MAX_DATA_LEN      270
 #elif defined(T1oI2C)
+#if defined(T1oI2C_GP1_0) && defined(T1oI2C_GP1_0_MAX_IFS)
+/* GP frames have a 2 byte LEN, the INF field may be larger than 254 bytes.
+ * NAD + PCB + LEN + INF + CRC */
+#define MAX_DATA_LEN      (6 + T1oI2C_GP1_0_MAX_IFS)
+#else
 #define MAX_DATA_LEN      260
 #endif
+#endif
 
 
 i2c_error_t axI2CInit(void **conn_ctx, const char *pDevName);
@@ -24,6 +24,8 @@ extern "C" {
 uint32_t sm_initSleep(void);
 void sm_sleep(uint32_t msec);
 void sm_usleep(uint32_t microsec);
+/* monotonic time stamp in micro seconds, used to measure elapsed time */
+uint64_t sm_get_time_us(void);
 
 #ifdef __cplusplus
 }
@@ -17,6 +17,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <sys/file.h>
 #include <sys/stat.h>
 #include <linux/i2c-dev.h>
 #include <linux/i2c.h>
@@ -33,6 +34,72 @@ static int default_axSmDevice_addr = 0x48;      // 7-bit address
 
 #define DEV_NAME_BUFFER_SIZE 64
 
+/* 1 to hold an exclusive flock() on the i2c device while it is open.
+ *
+ * The SE has one T=1 link and one Platform SCP session, so a second
+ * process opening the device waits here instead of interleaving its
+ * frames with ours. The lock covers the whole bus: it also blocks other
+ * processes that talk to other devices on it, so it is off by default and
+ * meant for buses where the SE is the only device. Every process that
+ * shares the SE must be built with it. The kernel drops the lock on close(), also when the
+ * owner dies. The lock belongs to the open file, so a forked child must
+ * open its own connection instead of using the inherited one.
+ *
+ * The wait is bounded by AX_I2C_LOCK_TIMEOUT_MS, after which axI2CInit
+ * fails, so that a stuck or long lived owner does not hang other clients
+ * silently. */
+#ifndef AX_I2C_EXCLUSIVE_ACCESS
+#define AX_I2C_EXCLUSIVE_ACCESS 0
+#endif
+
+/* How long to wait for another process to close the device. 0 fails at once. */
+#ifndef AX_I2C_LOCK_TIMEOUT_MS
+#define AX_I2C_LOCK_TIMEOUT_MS 10000
+#endif
+
+/* Interval between two attempts to take the lock */
+#ifndef AX_I2C_LOCK_POLL_MS
+#define AX_I2C_LOCK_POLL_MS 10
+#endif
+
+#if AX_I2C_EXCLUSIVE_ACCESS
+static long axI2CElapsedMs(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)(now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/* 0 when locked, or when locking is not supported. -1 on timeout. */
+static int axI2CLockDevice(int axSmDevice, const char *pdev_name)
+{
+    struct timespec start;
+
+    if (flock(axSmDevice, LOCK_EX | LOCK_NB) == 0) {
+        return 0;
+    }
+    if (errno != EWOULDBLOCK) {
+        LOG_W("Could not lock %s (errno %d), access is not exclusive", pdev_name, errno);
+        return 0;
+    }
+    LOG_I("%s is in use by another process, waiting up to %d ms", pdev_name, AX_I2C_LOCK_TIMEOUT_MS);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (flock(axSmDevice, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK && errno != EINTR) {
+            LOG_W("Could not lock %s (errno %d), access is not exclusive", pdev_name, errno);
+            return 0;
+        }
+        if (axI2CElapsedMs(&start) >= AX_I2C_LOCK_TIMEOUT_MS) {
+            LOG_E("%s is still in use by another process after %d ms", pdev_name, AX_I2C_LOCK_TIMEOUT_MS);
+            return -1;
+        }
+        usleep(AX_I2C_LOCK_POLL_MS * 1000);
+    }
+    LOG_D("I2CInit: %s locked", pdev_name);
+    return 0;
+}
+#endif
+
 /**
 * Opens the communication channel to I2C device
 */
@@ -88,6 +155,14 @@ i2c_error_t axI2CInit(void **conn_ctx, const char *pDevName)
         return I2C_FAILED;
     }
 
+#if AX_I2C_EXCLUSIVE_ACCESS
+    if (axI2CLockDevice(axSmDevice, pdev_name) != 0)
+    {
+        close(axSmDevice);
+        return I2C_FAILED;
+    }
+#endif
+
     if (ioctl(axSmDevice, I2C_SLAVE, dev_addr) < 0)
     {
         LOG_E("I2C driver failed setting address\n");
@@ -233,8 +308,16 @@ i2c_error_t axI2CWrite(void* conn_ctx, unsigned char bus, unsigned char addr, un
     nrWritten = write(axSmDevice, pTx, txLen);
     if (nrWritten < 0)
     {
-       LOG_E("Failed writing data (nrWritten=%d).\n", nrWritten);
-       rv = I2C_FAILED;
+        // No ACK in the address phase, e.g. the SE is still booting. ENXIO
+        // per the kernel I2C fault codes, EREMOTEIO on some bus drivers (bcm2835)
+        if (errno == ENXIO || errno == EREMOTEIO) {
+            LOG_D("Write not acknowledged (errno %d)", errno);
+            rv = I2C_NACK_ON_ADDRESS;
+        }
+        else {
+            LOG_E("Failed writing data (nrWritten=%d).\n", nrWritten);
+            rv = I2C_FAILED;
+        }
     }
     else
     {
@@ -4,19 +4,44 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 #include "sm_timer.h"
 #include "ax_reset.h"
 #include "se05x_apis.h"
 
 #define EN_PIN 22
 
+/* 1 to drive EN_PIN through /sys/class/gpio, for kernels without the GPIO
+ * character device */
+#ifndef AX_RESET_GPIO_SYSFS
+#define AX_RESET_GPIO_SYSFS 0
+#endif
+
+/* GPIO character device with EN_PIN as line offset */
+#ifndef AX_RESET_GPIO_CHIP
+#define AX_RESET_GPIO_CHIP "/dev/gpiochip0"
+#endif
+
+/* Time the SE is held powered down by axReset_ResetPluseDUT */
+#ifndef AX_RESET_PULSE_US
+#define AX_RESET_PULSE_US 2000
+#endif
+
+#if AX_RESET_GPIO_SYSFS
+
+/* How long, at most, udev may take to make the exported pin writable */
+#define SYSFS_EXPORT_WAIT_MS 1000
+#define SYSFS_EXPORT_POLL_MS 10
+
 void axReset_HostConfigure()
 {
     int fd;
+    int waitedMs = 0;
     char buf[50];
     /* Open export file to export GPIO */
     fd = open("/sys/class/gpio/export", O_WRONLY);
@@ -32,17 +57,18 @@ void axReset_HostConfigure()
     }
     close(fd);
 
-    /* Open direction file to configure GPIO direction */
+    /* Open direction file to configure GPIO direction, once udev let us */
     snprintf(buf, sizeof(buf), "/sys/class/gpio/gpio%d/direction", EN_PIN);
     fd = open(buf, O_WRONLY);
-    if (fd < 0) {
-        sm_usleep(1000 * 1000);
+    while (fd < 0 && waitedMs < SYSFS_EXPORT_WAIT_MS) {
+        sm_sleep(SYSFS_EXPORT_POLL_MS);
+        waitedMs += SYSFS_EXPORT_POLL_MS;
         fd = open(buf, O_WRONLY);
-        if (fd < 0) {
-            axReset_HostUnconfigure();
-            perror("Failed to open GPIO direction file ");
-            return;
-        }
+    }
+    if (fd < 0) {
+        axReset_HostUnconfigure();
+        perror("Failed to open GPIO direction file ");
+        return;
     }
     /* Configure direction of exported GPIO */
     if (write(fd, "out", 3) < 1) {
@@ -75,6 +101,137 @@ void axReset_HostUnconfigure()
     return;
 }
 
+static void axReset_SetEnable(int enable)
+{
+    int fd;
+    char buf[50];
+    char logic[10];
+    snprintf(buf, sizeof(buf), "/sys/class/gpio/gpio%d/value", EN_PIN);
+    fd = open(buf, O_WRONLY);
+    if (fd < 0) {
+        perror("Failed to open GPIO value file ");
+        axReset_HostUnconfigure();
+        return;
+    }
+
+    snprintf(logic, sizeof(logic), "%d", enable ? SE_RESET_LOGIC : !SE_RESET_LOGIC);
+    if (write(fd, logic, 1) < 1) {
+        perror("Failed to toggle GPIO ");
+        axReset_HostUnconfigure();
+    }
+
+    close(fd);
+}
+
+#else /* AX_RESET_GPIO_SYSFS */
+
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/* Line request of EN_PIN, held until axReset_HostUnconfigure */
+static int gEnLineFd = -1;
+
+/* Request EN_PIN as output, driving logic */
+static int axReset_RequestLine(int logic)
+{
+    int chipFd;
+    int ret;
+
+    chipFd = open(AX_RESET_GPIO_CHIP, O_RDONLY | O_CLOEXEC);
+    if (chipFd < 0) {
+        perror("Failed to open GPIO chip ");
+        return -1;
+    }
+#if defined(GPIO_V2_GET_LINE_IOCTL)
+    {
+        struct gpio_v2_line_request req;
+        memset(&req, 0, sizeof(req));
+        req.offsets[0]                  = EN_PIN;
+        req.num_lines                   = 1;
+        req.config.flags                = GPIO_V2_LINE_FLAG_OUTPUT;
+        req.config.num_attrs            = 1;
+        req.config.attrs[0].attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = logic ? 1 : 0;
+        req.config.attrs[0].mask        = 1;
+        strncpy(req.consumer, "se05x_enable", sizeof(req.consumer) - 1);
+        ret = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req);
+        if (ret >= 0) {
+            gEnLineFd = req.fd;
+        }
+    }
+#else
+    {
+        struct gpiohandle_request req;
+        memset(&req, 0, sizeof(req));
+        req.lineoffsets[0]    = EN_PIN;
+        req.lines             = 1;
+        req.flags             = GPIOHANDLE_REQUEST_OUTPUT;
+        req.default_values[0] = logic ? 1 : 0;
+        strncpy(req.consumer_label, "se05x_enable", sizeof(req.consumer_label) - 1);
+        ret = ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+        if (ret >= 0) {
+            gEnLineFd = req.fd;
+        }
+    }
+#endif
+    if (ret < 0) {
+        perror("Failed to request Enable pin ");
+    }
+    close(chipFd);
+    return ret;
+}
+
+void axReset_HostConfigure()
+{
+    if (gEnLineFd >= 0) {
+        return;
+    }
+    /* Driven low first, like a freshly exported sysfs pin */
+    (void)axReset_RequestLine(0);
+}
+
+void axReset_HostUnconfigure()
+{
+    if (gEnLineFd >= 0) {
+        close(gEnLineFd);
+        gEnLineFd = -1;
+    }
+}
+
+static void axReset_SetEnable(int enable)
+{
+    int logic = enable ? SE_RESET_LOGIC : !SE_RESET_LOGIC;
+    int ret;
+
+    if (gEnLineFd < 0) {
+        /* Not configured yet, request the line at the wanted level */
+        (void)axReset_RequestLine(logic);
+        return;
+    }
+#if defined(GPIO_V2_LINE_SET_VALUES_IOCTL)
+    {
+        struct gpio_v2_line_values values;
+        memset(&values, 0, sizeof(values));
+        values.bits = logic ? 1 : 0;
+        values.mask = 1;
+        ret         = ioctl(gEnLineFd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+    }
+#else
+    {
+        struct gpiohandle_data data;
+        memset(&data, 0, sizeof(data));
+        data.values[0] = logic ? 1 : 0;
+        ret            = ioctl(gEnLineFd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
+    }
+#endif
+    if (ret < 0) {
+        perror("Failed to toggle GPIO ");
+        axReset_HostUnconfigure();
+    }
+}
+
+#endif /* AX_RESET_GPIO_SYSFS */
+
 /*
  * Where applicable, PowerCycle the SE
  *
@@ -82,8 +239,20 @@ void axReset_HostUnconfigure()
  */
 void axReset_ResetPluseDUT()
 {
+    struct timespec deadline;
+
     axReset_PowerDown();
-    sm_usleep(2000);
+    /* Measured from the toggle, so the pulse is AX_RESET_PULSE_US whatever
+     * the scheduler does in between */
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += AX_RESET_PULSE_US / 1000000;
+    deadline.tv_nsec += (long)(AX_RESET_PULSE_US % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
     axReset_PowerUp();
     return;
 }
@@ -95,24 +264,7 @@ void axReset_ResetPluseDUT()
  */
 void axReset_PowerDown()
 {
-    int fd;
-    char buf[50];
-    char logic[10];
-    snprintf(buf, sizeof(buf), "/sys/class/gpio/gpio%d/value", EN_PIN);
-    fd = open(buf, O_WRONLY);
-    if (fd < 0) {
-        perror("Failed to open GPIO value file ");
-        axReset_HostUnconfigure();
-        return;
-    }
-
-    snprintf(logic, sizeof(logic), "%d", !SE_RESET_LOGIC);
-    if (write(fd, logic, 1) < 1) {
-        perror("Failed to toggle GPIO high ");
-        axReset_HostUnconfigure();
-    }
-
-    close(fd);
+    axReset_SetEnable(0);
 }
 
 /*
@@ -122,33 +274,22 @@ void axReset_PowerDown()
  */
 void axReset_PowerUp()
 {
-    int fd;
-    char buf[50];
-    char logic[10];
-    snprintf(buf, sizeof(buf), "/sys/class/gpio/gpio%d/value", EN_PIN);
-    fd = open(buf, O_WRONLY);
-    if (fd < 0) {
-        perror("Failed to open GPIO value file ");
-        axReset_HostUnconfigure();
-        return;
-    }
-
-    snprintf(logic, sizeof(logic), "%d", SE_RESET_LOGIC);
-    if (write(fd, logic, 1) < 1) {
-        perror("Failed to toggle GPIO high ");
-        axReset_HostUnconfigure();
-    }
-
-    close(fd);
+    axReset_SetEnable(1);
 }
 
 #if SSS_HAVE_APPLET_SE05X_IOT || SSS_HAVE_APPLET_LOOPBACK
 
+#include "smComT1oI2C.h"
+
+/*
+ * The SE is not waited for here: the ATR request of the next
+ * smComT1oI2C_Open starts with WAKE_UP_DELAY_MS, longer than the boot
+ * time, and is repeated T1oI2C_READY_POLL_MS apart if the SE still boots.
+ */
 void se05x_ic_reset()
 {
     axReset_ResetPluseDUT();
-    smComT1oI2C_ComReset();
-    sm_usleep(3000);
+    smComT1oI2C_ComReset(NULL);
     return;
 }
 
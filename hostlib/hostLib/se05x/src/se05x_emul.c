@@ -0,0 +1,2542 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * SE05x applet emulator, see se05x_emul.h
+ */
+
+/* The EC_KEY API is deprecated with OpenSSL 3.0, but it is still there and
+ * it is the only one that also builds against 1.1 */
+#ifndef OPENSSL_SUPPRESS_DEPRECATED
+#define OPENSSL_SUPPRESS_DEPRECATED
+#endif
+
+#include "se05x_emul.h"
+
+#if SSS_HAVE_HOSTCRYPTO_OPENSSL
+
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rand.h>
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000)
+#include <openssl/core_names.h>
+#else
+#include <openssl/cmac.h>
+#endif
+
+#include "Applet_SE050_Ver.h"
+#include "nxLog_hostLib.h"
+#include "nxScp03_Const.h"
+#include "se05x_enums.h"
+#include "sm_const.h"
+
+/* ************************************************************************** */
+/* Defines                                                                    */
+/* ************************************************************************** */
+
+/* Platform SCP03 static keys of the emulated SE. Same as the host side
+ * defaults, so that the examples connect without a key file. */
+#ifndef SE05X_EMUL_KEY_ENC
+#include "ex_sss_tp_scp03_keys.h"
+#define SE05X_EMUL_KEY_ENC SSS_AUTH_KEY_ENC
+#define SE05X_EMUL_KEY_MAC SSS_AUTH_KEY_MAC
+#define SE05X_EMUL_KEY_DEK SSS_AUTH_KEY_DEK
+#endif
+
+/** Largest R-APDU data field the emulator builds */
+#ifndef SE05X_EMUL_MAX_RSP
+#define SE05X_EMUL_MAX_RSP 4096
+#endif
+
+/** Extra processing time of a command wrapped in Platform SCP03 */
+#ifndef SE05X_EMUL_SCP_LATENCY_US
+#define SE05X_EMUL_SCP_LATENCY_US 300
+#endif
+
+#define EMUL_MAX_CRYPTO_OBJECTS 16
+#define EMUL_MAX_SESSIONS 2
+#define EMUL_SESSION_ID_LEN 8
+#define EMUL_SCP_KEY_LEN 16
+#define EMUL_UNIQUE_ID_LEN 18
+
+/* Longest TLV header of the responses: tag, 0x82, length */
+#define EMUL_TLV_HDR_MAX 4
+/* Where a TLV value is built in place before emul_rsp_put() */
+#define EMUL_RSP_VALUE(rsp) (&(rsp)->buf[(rsp)->len + EMUL_TLV_HDR_MAX])
+
+/* Status words not in smStatus_t */
+#define EMUL_SW_FILE_NOT_FOUND ((smStatus_t)0x6A82)
+#define EMUL_SW_WRONG_P1P2 ((smStatus_t)0x6A86)
+#define EMUL_SW_INS_NOT_SUPPORTED ((smStatus_t)0x6D00)
+#define EMUL_SW_CLA_NOT_SUPPORTED ((smStatus_t)0x6E00)
+
+#define EMUL_SCP_NONE 0
+#define EMUL_SCP_INITIALIZED 1
+#define EMUL_SCP_AUTHENTICATED 2
+
+#define EMUL_APPLET_VERSION \
+    ((APPLET_SE050_VER_MAJOR << 24) | (APPLET_SE050_VER_MINOR << 16) | (APPLET_SE050_VER_DEV << 8))
+
+/* From 4.3 on the SE increments the SCP03 counter after every response,
+ * see the matching switch in sss_se05x_session_open() */
+#define EMUL_SCP_COUNT_ALL (EMUL_APPLET_VERSION >= 0x04030000u)
+
+/* ************************************************************************** */
+/* Structures and Typedefs                                                    */
+/* ************************************************************************** */
+
+typedef struct
+{
+    uint8_t cla;
+    uint8_t ins;
+    uint8_t p1;
+    uint8_t p2;
+    /* Width of the Lc field as sent, 0, 1 or 3 */
+    uint8_t lcWidth;
+    uint8_t hasLe;
+    const uint8_t *data;
+    size_t len;
+} emul_apdu_t;
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len;
+    size_t max;
+} emul_rsp_t;
+
+typedef struct
+{
+    uint32_t id;
+    uint8_t used;
+    /* Survives DeleteAll, can not be deleted */
+    uint8_t reserved;
+    uint8_t transient;
+    /* SE05x_SecObjTyp_t, as ReadType reports it */
+    uint8_t type;
+    /* kSE05x_P1_EC etc. */
+    uint8_t credType;
+    /* kSE05x_P1_KEY_PAIR, kSE05x_P1_PRIVATE or kSE05x_P1_PUBLIC */
+    uint8_t keyPart;
+    uint8_t curve;
+    /* Symmetric key, UserID or binary file contents */
+    uint8_t *data;
+    size_t len;
+    EC_KEY *ec;
+} emul_object_t;
+
+typedef struct
+{
+    uint16_t id;
+    uint8_t used;
+    /* SE05x_CryptoContext_t */
+    uint8_t context;
+    /* Digest mode, cipher mode or MAC algorithm */
+    uint8_t subType;
+    /* Set by CipherInit / MACInit / DigestInit */
+    uint8_t active;
+    /* MAC: validate instead of generate */
+    uint8_t validate;
+    uint32_t keyId;
+    EVP_MD_CTX *md;
+    EVP_CIPHER_CTX *cipher;
+    /* MAC input, kept until MACFinal */
+    uint8_t *macData;
+    size_t macLen;
+} emul_crypto_obj_t;
+
+typedef struct
+{
+    uint8_t used;
+    uint8_t verified;
+    uint8_t id[EMUL_SESSION_ID_LEN];
+    uint32_t authId;
+} emul_session_t;
+
+typedef struct
+{
+    uint8_t state;
+    uint8_t hostChallenge[SCP_GP_HOST_CHALLENGE_LEN];
+    uint8_t cardChallenge[SCP_GP_CARD_CHALLENGE_LEN];
+    uint8_t sEnc[EMUL_SCP_KEY_LEN];
+    uint8_t sMac[EMUL_SCP_KEY_LEN];
+    uint8_t sRmac[EMUL_SCP_KEY_LEN];
+    uint8_t mcv[EMUL_SCP_KEY_LEN];
+    uint8_t counter[EMUL_SCP_KEY_LEN];
+} emul_scp_t;
+
+typedef struct
+{
+    uint8_t ins;
+    uint8_t p1;
+    uint8_t p2;
+    uint32_t baseUs;
+    uint32_t perByteNs;
+} emul_latency_t;
+
+typedef struct
+{
+    uint8_t initialized;
+    uint8_t selected;
+    emul_object_t obj[SE05X_EMUL_MAX_OBJECTS];
+    emul_crypto_obj_t cryptoObj[EMUL_MAX_CRYPTO_OBJECTS];
+    emul_session_t session[EMUL_MAX_SESSIONS];
+    emul_scp_t scp;
+    uint8_t curveSet[kSE05x_ECCurve_Total_Weierstrass_Curves];
+    uint8_t keyEnc[EMUL_SCP_KEY_LEN];
+    uint8_t keyMac[EMUL_SCP_KEY_LEN];
+    uint8_t keyDek[EMUL_SCP_KEY_LEN];
+    emul_latency_t latency[SE05X_EMUL_MAX_LATENCY];
+    size_t latencyCount;
+    uint32_t latencyScale;
+    /* Set by a handler whose cost differs from the rest of its INS/P1/P2,
+     * e.g. key generation with WriteECKey. 0 to use the APDU's P2. */
+    uint8_t latencyP2;
+    uint8_t rspData[SE05X_EMUL_MAX_RSP];
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000)
+    EVP_MAC *cmac;
+#endif
+} emul_state_t;
+
+/* ************************************************************************** */
+/* Global Variables                                                           */
+/* ************************************************************************** */
+
+static emul_state_t gEmul;
+
+/* Ballpark timings of an SE050 with a 7.x applet. Good enough to see the
+ * relative cost of host side changes; for absolute numbers measure the
+ * part in use and override with se05x_emul_set_latency(). */
+static const emul_latency_t gEmulDefaultLatency[] = {
+    /* ins, p1, p2, baseUs, perByteNs */
+    {SE05X_EMUL_ANY, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 1000, 0},
+    {INS_GP_SELECT, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 2000, 0},
+    {INS_GP_INITIALIZE_UPDATE, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 3000, 0},
+    {INS_GP_EXTERNAL_AUTHENTICATE, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 3000, 0},
+    /* Writes go to flash */
+    {kSE05x_INS_WRITE, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 12000, 10000},
+    {kSE05x_INS_WRITE, kSE05x_P1_EC, kSE05x_P2_GENERATE, 90000, 0},
+    {kSE05x_INS_WRITE, kSE05x_P1_CRYPTO_OBJ, SE05X_EMUL_ANY, 3000, 0},
+    {kSE05x_INS_READ, SE05X_EMUL_ANY, SE05X_EMUL_ANY, 1500, 3000},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_SIGNATURE, kSE05x_P2_SIGN, 50000, 0},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_SIGNATURE, kSE05x_P2_VERIFY, 60000, 0},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_EC, kSE05x_P2_DH, 60000, 0},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_CIPHER, SE05X_EMUL_ANY, 2000, 4000},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_MAC, SE05X_EMUL_ANY, 2000, 4000},
+    {kSE05x_INS_CRYPTO, kSE05x_P1_DEFAULT, SE05X_EMUL_ANY, 1500, 2000},
+    {kSE05x_INS_MGMT, SE05X_EMUL_ANY, kSE05x_P2_RANDOM, 1000, 10000},
+    {kSE05x_INS_MGMT, SE05X_EMUL_ANY, kSE05x_P2_SESSION_CREATE, 3000, 0},
+    {kSE05x_INS_MGMT, SE05X_EMUL_ANY, kSE05x_P2_DELETE_OBJECT, 8000, 0},
+    {kSE05x_INS_MGMT, SE05X_EMUL_ANY, kSE05x_P2_DELETE_ALL, 50000, 0},
+};
+
+/* ************************************************************************** */
+/* Static function declarations                                               */
+/* ************************************************************************** */
+
+static smStatus_t emul_dispatch(const emul_apdu_t *apdu, emul_rsp_t *rsp, emul_session_t *session);
+
+/* ************************************************************************** */
+/* Helpers                                                                    */
+/* ************************************************************************** */
+
+static void emul_init(void)
+{
+    if (gEmul.initialized) {
+        return;
+    }
+    gEmul.initialized = 1;
+    se05x_emul_factory_reset();
+}
+
+/* Parse a short or extended C-APDU, as built by smCom / se05x_tlv.c */
+static int emul_parse_apdu(const uint8_t *buf, size_t bufLen, emul_apdu_t *apdu)
+{
+    const uint8_t *p;
+    size_t rem;
+    size_t lc;
+
+    memset(apdu, 0, sizeof(*apdu));
+    if (bufLen < 4) {
+        return -1;
+    }
+    apdu->cla = buf[0];
+    apdu->ins = buf[1];
+    apdu->p1  = buf[2];
+    apdu->p2  = buf[3];
+    p         = &buf[4];
+    rem       = bufLen - 4;
+
+    if (rem == 0) {
+        return 0;
+    }
+    if (p[0] != 0) {
+        /* Short Lc, or a short Le only */
+        if (rem == 1) {
+            apdu->hasLe = 1;
+            return 0;
+        }
+        lc = p[0];
+        if (rem == 1 + lc) {
+            apdu->hasLe = 0;
+        }
+        else if (rem == 2 + lc) {
+            apdu->hasLe = 1;
+        }
+        else {
+            return -1;
+        }
+        apdu->lcWidth = 1;
+        apdu->data    = &p[1];
+        apdu->len     = lc;
+        return 0;
+    }
+    if (rem == 1 || rem == 3) {
+        /* Le only, short or extended */
+        apdu->hasLe = 1;
+        return 0;
+    }
+    if (rem < 3) {
+        return -1;
+    }
+    lc = ((size_t)p[1] << 8) | p[2];
+    if (rem == 3 + lc) {
+        apdu->hasLe = 0;
+    }
+    else if (rem == 5 + lc) {
+        apdu->hasLe = 1;
+    }
+    else {
+        return -1;
+    }
+    apdu->lcWidth = 3;
+    apdu->data    = &p[3];
+    apdu->len     = lc;
+    return 0;
+}
+
+/* Find a TLV. BER lengths as written by tlvSet_* */
+static int emul_tlv_find(const uint8_t *buf, size_t bufLen, uint8_t tag, const uint8_t **pValue, size_t *pValueLen)
+{
+    size_t i = 0;
+    size_t len;
+    uint8_t t;
+
+    while (i + 2 <= bufLen) {
+        t   = buf[i++];
+        len = buf[i++];
+        if (len == 0x81) {
+            if (i + 1 > bufLen) {
+                return -1;
+            }
+            len = buf[i++];
+        }
+        else if (len == 0x82) {
+            if (i + 2 > bufLen) {
+                return -1;
+            }
+            len = ((size_t)buf[i] << 8) | buf[i + 1];
+            i += 2;
+        }
+        else if (len > 0x7F) {
+            return -1;
+        }
+        if (len > bufLen - i) {
+            return -1;
+        }
+        if (t == tag) {
+            *pValue    = &buf[i];
+            *pValueLen = len;
+            return 0;
+        }
+        i += len;
+    }
+    return -1;
+}
+
+static int emul_tlv_u32(const emul_apdu_t *apdu, uint8_t tag, uint32_t *pValue)
+{
+    const uint8_t *v;
+    size_t len;
+    if (emul_tlv_find(apdu->data, apdu->len, tag, &v, &len) != 0 || len != 4) {
+        return -1;
+    }
+    *pValue = ((uint32_t)v[0] << 24) | ((uint32_t)v[1] << 16) | ((uint32_t)v[2] << 8) | v[3];
+    return 0;
+}
+
+static int emul_tlv_u16(const emul_apdu_t *apdu, uint8_t tag, uint16_t *pValue)
+{
+    const uint8_t *v;
+    size_t len;
+    if (emul_tlv_find(apdu->data, apdu->len, tag, &v, &len) != 0 || len != 2) {
+        return -1;
+    }
+    *pValue = (uint16_t)((v[0] << 8) | v[1]);
+    return 0;
+}
+
+static int emul_tlv_u8(const emul_apdu_t *apdu, uint8_t tag, uint8_t *pValue)
+{
+    const uint8_t *v;
+    size_t len;
+    if (emul_tlv_find(apdu->data, apdu->len, tag, &v, &len) != 0 || len != 1) {
+        return -1;
+    }
+    *pValue = v[0];
+    return 0;
+}
+
+static int emul_tlv_buf(const emul_apdu_t *apdu, uint8_t tag, const uint8_t **pValue, size_t *pValueLen)
+{
+    return emul_tlv_find(apdu->data, apdu->len, tag, pValue, pValueLen);
+}
+
+/* value may also be built in place, at EMUL_RSP_VALUE(rsp) */
+static smStatus_t emul_rsp_put(emul_rsp_t *rsp, uint8_t tag, const uint8_t *value, size_t valueLen)
+{
+    size_t hdrLen = (valueLen <= 0x7F) ? 2 : ((valueLen <= 0xFF) ? 3 : 4);
+
+    if (valueLen > 0xFFFF || (rsp->max - rsp->len) < (hdrLen + valueLen)) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    rsp->buf[rsp->len++] = tag;
+    if (valueLen <= 0x7F) {
+        rsp->buf[rsp->len++] = (uint8_t)valueLen;
+    }
+    else if (valueLen <= 0xFF) {
+        rsp->buf[rsp->len++] = 0x81;
+        rsp->buf[rsp->len++] = (uint8_t)valueLen;
+    }
+    else {
+        rsp->buf[rsp->len++] = 0x82;
+        rsp->buf[rsp->len++] = (uint8_t)(valueLen >> 8);
+        rsp->buf[rsp->len++] = (uint8_t)valueLen;
+    }
+    if (valueLen > 0) {
+        memmove(&rsp->buf[rsp->len], value, valueLen);
+        rsp->len += valueLen;
+    }
+    return SM_OK;
+}
+
+static smStatus_t emul_rsp_u8(emul_rsp_t *rsp, uint8_t tag, uint8_t value)
+{
+    return emul_rsp_put(rsp, tag, &value, 1);
+}
+
+static smStatus_t emul_rsp_u16(emul_rsp_t *rsp, uint8_t tag, uint16_t value)
+{
+    uint8_t v[2];
+    v[0] = (uint8_t)(value >> 8);
+    v[1] = (uint8_t)value;
+    return emul_rsp_put(rsp, tag, v, sizeof(v));
+}
+
+/* CMAC over the concatenation of nSeg segments, AES key of keyLen bytes */
+static int emul_cmac(
+    const uint8_t *key, size_t keyLen, const uint8_t *const seg[], const size_t segLen[], size_t nSeg, uint8_t *mac)
+{
+    int ret = -1;
+    size_t i;
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000)
+    EVP_MAC_CTX *ctx = NULL;
+    OSSL_PARAM params[2];
+    size_t macLen     = 0;
+    char *cipherName  = (keyLen == 32) ? "AES-256-CBC" : ((keyLen == 24) ? "AES-192-CBC" : "AES-128-CBC");
+
+    if (gEmul.cmac == NULL) {
+        gEmul.cmac = EVP_MAC_fetch(NULL, "CMAC", NULL);
+        if (gEmul.cmac == NULL) {
+            goto exit;
+        }
+    }
+    ctx = EVP_MAC_CTX_new(gEmul.cmac);
+    if (ctx == NULL) {
+        goto exit;
+    }
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_CIPHER, cipherName, 0);
+    params[1] = OSSL_PARAM_construct_end();
+    if (EVP_MAC_init(ctx, key, keyLen, params) != 1) {
+        goto exit;
+    }
+    for (i = 0; i < nSeg; i++) {
+        if (segLen[i] > 0 && EVP_MAC_update(ctx, seg[i], segLen[i]) != 1) {
+            goto exit;
+        }
+    }
+    if (EVP_MAC_final(ctx, mac, &macLen, 16) != 1) {
+        goto exit;
+    }
+    ret = 0;
+exit:
+    EVP_MAC_CTX_free(ctx);
+#else
+    CMAC_CTX *ctx = CMAC_CTX_new();
+    size_t macLen = 0;
+    const EVP_CIPHER *cipher =
+        (keyLen == 32) ? EVP_aes_256_cbc() : ((keyLen == 24) ? EVP_aes_192_cbc() : EVP_aes_128_cbc());
+
+    if (ctx == NULL || CMAC_Init(ctx, key, keyLen, cipher, NULL) != 1) {
+        goto exit;
+    }
+    for (i = 0; i < nSeg; i++) {
+        if (segLen[i] > 0 && CMAC_Update(ctx, seg[i], segLen[i]) != 1) {
+            goto exit;
+        }
+    }
+    if (CMAC_Final(ctx, mac, &macLen) != 1) {
+        goto exit;
+    }
+    ret = 0;
+exit:
+    CMAC_CTX_free(ctx);
+#endif
+    return ret;
+}
+
+static const EVP_CIPHER *emul_aes_cipher(uint8_t mode, size_t keyLen)
+{
+    switch (mode) {
+    case kSE05x_CipherMode_AES_ECB_NOPAD:
+        return (keyLen == 16) ? EVP_aes_128_ecb() : ((keyLen == 24) ? EVP_aes_192_ecb() : EVP_aes_256_ecb());
+    case kSE05x_CipherMode_AES_CBC_NOPAD:
+    case kSE05x_CipherMode_AES_CBC_PKCS5:
+        return (keyLen == 16) ? EVP_aes_128_cbc() : ((keyLen == 24) ? EVP_aes_192_cbc() : EVP_aes_256_cbc());
+    case kSE05x_CipherMode_AES_CTR:
+        return (keyLen == 16) ? EVP_aes_128_ctr() : ((keyLen == 24) ? EVP_aes_192_ctr() : EVP_aes_256_ctr());
+    default:
+        return NULL;
+    }
+}
+
+static const EVP_MD *emul_digest_md(uint8_t digestMode)
+{
+    switch (digestMode) {
+    case kSE05x_DigestMode_SHA:
+        return EVP_sha1();
+    case kSE05x_DigestMode_SHA224:
+        return EVP_sha224();
+    case kSE05x_DigestMode_SHA256:
+        return EVP_sha256();
+    case kSE05x_DigestMode_SHA384:
+        return EVP_sha384();
+    case kSE05x_DigestMode_SHA512:
+        return EVP_sha512();
+    default:
+        return NULL;
+    }
+}
+
+static const EVP_MD *emul_hmac_md(uint8_t macAlgo)
+{
+    switch (macAlgo) {
+    case kSE05x_MACAlgo_HMAC_SHA1:
+        return EVP_sha1();
+    case kSE05x_MACAlgo_HMAC_SHA256:
+        return EVP_sha256();
+    case kSE05x_MACAlgo_HMAC_SHA384:
+        return EVP_sha384();
+    case kSE05x_MACAlgo_HMAC_SHA512:
+        return EVP_sha512();
+    default:
+        return NULL;
+    }
+}
+
+static int emul_curve_nid(uint8_t curve)
+{
+    switch (curve) {
+    case kSE05x_ECCurve_NIST_P192:
+        return NID_X9_62_prime192v1;
+    case kSE05x_ECCurve_NIST_P224:
+        return NID_secp224r1;
+    case kSE05x_ECCurve_NIST_P256:
+        return NID_X9_62_prime256v1;
+    case kSE05x_ECCurve_NIST_P384:
+        return NID_secp384r1;
+    case kSE05x_ECCurve_NIST_P521:
+        return NID_secp521r1;
+    case kSE05x_ECCurve_Brainpool160:
+        return NID_brainpoolP160r1;
+    case kSE05x_ECCurve_Brainpool192:
+        return NID_brainpoolP192r1;
+    case kSE05x_ECCurve_Brainpool224:
+        return NID_brainpoolP224r1;
+    case kSE05x_ECCurve_Brainpool256:
+        return NID_brainpoolP256r1;
+    case kSE05x_ECCurve_Brainpool320:
+        return NID_brainpoolP320r1;
+    case kSE05x_ECCurve_Brainpool384:
+        return NID_brainpoolP384r1;
+    case kSE05x_ECCurve_Brainpool512:
+        return NID_brainpoolP512r1;
+    case kSE05x_ECCurve_Secp160k1:
+        return NID_secp160k1;
+    case kSE05x_ECCurve_Secp192k1:
+        return NID_secp192k1;
+    case kSE05x_ECCurve_Secp224k1:
+        return NID_secp224k1;
+    case kSE05x_ECCurve_Secp256k1:
+        return NID_secp256k1;
+    default:
+        return NID_undef;
+    }
+}
+
+static size_t emul_ec_field_len(const EC_KEY *ec)
+{
+    return (size_t)((EC_GROUP_get_degree(EC_KEY_get0_group(ec)) + 7) / 8);
+}
+
+/* Uncompressed public point, 04 || X || Y */
+static size_t emul_ec_public(const EC_KEY *ec, uint8_t *buf, size_t bufLen)
+{
+    const EC_POINT *pub = EC_KEY_get0_public_key(ec);
+    if (pub == NULL) {
+        return 0;
+    }
+    return EC_POINT_point2oct(EC_KEY_get0_group(ec), pub, POINT_CONVERSION_UNCOMPRESSED, buf, bufLen, NULL);
+}
+
+/* ************************************************************************** */
+/* Secure objects                                                             */
+/* ************************************************************************** */
+
+static emul_object_t *emul_obj_find(uint32_t id)
+{
+    size_t i;
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        if (gEmul.obj[i].used && gEmul.obj[i].id == id) {
+            return &gEmul.obj[i];
+        }
+    }
+    return NULL;
+}
+
+static emul_object_t *emul_obj_alloc(uint32_t id)
+{
+    size_t i;
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        if (!gEmul.obj[i].used) {
+            memset(&gEmul.obj[i], 0, sizeof(gEmul.obj[i]));
+            gEmul.obj[i].used = 1;
+            gEmul.obj[i].id   = id;
+            return &gEmul.obj[i];
+        }
+    }
+    return NULL;
+}
+
+static void emul_obj_clear_contents(emul_object_t *obj)
+{
+    if (obj->data != NULL) {
+        OPENSSL_cleanse(obj->data, obj->len);
+        free(obj->data);
+    }
+    obj->data = NULL;
+    obj->len  = 0;
+    EC_KEY_free(obj->ec);
+    obj->ec = NULL;
+}
+
+static void emul_obj_free(emul_object_t *obj)
+{
+    emul_obj_clear_contents(obj);
+    memset(obj, 0, sizeof(*obj));
+}
+
+static smStatus_t emul_obj_set_data(emul_object_t *obj, const uint8_t *data, size_t len)
+{
+    uint8_t *copy = NULL;
+    if (len > 0) {
+        copy = malloc(len);
+        if (copy == NULL) {
+            return SM_ERR_FILE_FULL;
+        }
+        memcpy(copy, data, len);
+    }
+    emul_obj_clear_contents(obj);
+    obj->data = copy;
+    obj->len  = len;
+    return SM_OK;
+}
+
+static uint8_t emul_ec_object_type(uint8_t curve, uint8_t keyPart)
+{
+    uint8_t part = (keyPart == kSE05x_P1_KEY_PAIR) ? 0 : ((keyPart == kSE05x_P1_PRIVATE) ? 1 : 2);
+#if APPLET_SE050_VER_MAJOR >= 7
+    if (curve >= kSE05x_ECCurve_NIST_P192 && curve <= kSE05x_ECCurve_Total_Weierstrass_Curves) {
+        return (uint8_t)(kSE05x_SecObjTyp_EC_KEY_PAIR_NIST_P192 + 4 * (curve - 1) + part);
+    }
+#else
+    (void)curve;
+#endif
+    return (uint8_t)(kSE05x_SecObjTyp_EC_KEY_PAIR + part);
+}
+
+/* Object is written by this command: create it, or check it may be overwritten */
+static smStatus_t emul_obj_for_write(
+    const emul_apdu_t *apdu, uint32_t id, uint8_t credType, uint8_t keyPart, emul_object_t **pObj, int *pCreated)
+{
+    emul_object_t *obj = emul_obj_find(id);
+
+    *pCreated = 0;
+    if (obj != NULL) {
+        if (obj->reserved) {
+            return SM_ERR_COMMAND_NOT_ALLOWED;
+        }
+        if (obj->credType != credType || obj->keyPart != keyPart) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+    }
+    else {
+        obj = emul_obj_alloc(id);
+        if (obj == NULL) {
+            return SM_ERR_FILE_FULL;
+        }
+        obj->credType  = credType;
+        obj->keyPart   = keyPart;
+        obj->transient = (apdu->ins & kSE05x_INS_TRANSIENT) ? 1 : 0;
+        *pCreated      = 1;
+    }
+    *pObj = obj;
+    return SM_OK;
+}
+
+/* ************************************************************************** */
+/* Crypto objects and sessions                                                */
+/* ************************************************************************** */
+
+static emul_crypto_obj_t *emul_crypto_obj_find(uint16_t id)
+{
+    size_t i;
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        if (gEmul.cryptoObj[i].used && gEmul.cryptoObj[i].id == id) {
+            return &gEmul.cryptoObj[i];
+        }
+    }
+    return NULL;
+}
+
+/* Drop the state of an operation, keep the object */
+static void emul_crypto_obj_stop(emul_crypto_obj_t *co)
+{
+    EVP_MD_CTX_free(co->md);
+    co->md = NULL;
+    EVP_CIPHER_CTX_free(co->cipher);
+    co->cipher = NULL;
+    if (co->macData != NULL) {
+        OPENSSL_cleanse(co->macData, co->macLen);
+        free(co->macData);
+    }
+    co->macData  = NULL;
+    co->macLen   = 0;
+    co->active   = 0;
+    co->validate = 0;
+    co->keyId    = 0;
+}
+
+static void emul_crypto_obj_free(emul_crypto_obj_t *co)
+{
+    emul_crypto_obj_stop(co);
+    memset(co, 0, sizeof(*co));
+}
+
+static emul_session_t *emul_session_find(const uint8_t *id)
+{
+    size_t i;
+    for (i = 0; i < EMUL_MAX_SESSIONS; i++) {
+        if (gEmul.session[i].used && memcmp(gEmul.session[i].id, id, EMUL_SESSION_ID_LEN) == 0) {
+            return &gEmul.session[i];
+        }
+    }
+    return NULL;
+}
+
+static void emul_close_sessions(void)
+{
+    memset(gEmul.session, 0, sizeof(gEmul.session));
+}
+
+static void emul_scp_close(void)
+{
+    OPENSSL_cleanse(&gEmul.scp, sizeof(gEmul.scp));
+    gEmul.scp.state = EMUL_SCP_NONE;
+}
+
+/* ************************************************************************** */
+/* Applet select and Platform SCP03                                           */
+/* ************************************************************************** */
+
+static smStatus_t emul_select(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+#ifdef APPLET_NAME
+    const uint8_t appletName[] = APPLET_NAME;
+#endif
+#ifdef SSD_NAME
+    const uint8_t ssdName[] = SSD_NAME;
+#endif
+    /* Version, applet config and secure box version, as for GetVersion */
+    const uint8_t selectRsp[] = {(uint8_t)APPLET_SE050_VER_MAJOR,
+        (uint8_t)APPLET_SE050_VER_MINOR,
+        (uint8_t)APPLET_SE050_VER_DEV,
+        0xFF,
+        0xFF,
+        0x01,
+        0x0B};
+
+    if (apdu->p1 != 0x04) {
+        return EMUL_SW_WRONG_P1P2;
+    }
+    /* Selecting ends the sessions and the secure channel */
+    emul_close_sessions();
+    emul_scp_close();
+    gEmul.selected = 0;
+#ifdef APPLET_NAME
+    if (apdu->len > 0 && apdu->len <= sizeof(appletName) && memcmp(apdu->data, appletName, apdu->len) == 0) {
+        gEmul.selected = 1;
+        if (sizeof(selectRsp) > rsp->max) {
+            return SM_ERR_WRONG_LENGTH;
+        }
+        memcpy(rsp->buf, selectRsp, sizeof(selectRsp));
+        rsp->len = sizeof(selectRsp);
+        return SM_OK;
+    }
+#endif
+#ifdef SSD_NAME
+    if (apdu->len == sizeof(ssdName) && memcmp(apdu->data, ssdName, sizeof(ssdName)) == 0) {
+        return SM_OK;
+    }
+#endif
+    return EMUL_SW_FILE_NOT_FOUND;
+}
+
+/* SCP03 KDF in counter mode, one block, see nxScp03_setDerivationData() */
+static int emul_scp_derive(const uint8_t *key, uint8_t ddConstant, uint16_t ddL, uint8_t *out)
+{
+    uint8_t dd[DD_LABEL_LEN + 4];
+    const uint8_t *seg[3];
+    size_t segLen[3];
+
+    memset(dd, 0, sizeof(dd));
+    dd[DD_LABEL_LEN - 1] = ddConstant;
+    dd[DD_LABEL_LEN]     = 0x00;
+    dd[DD_LABEL_LEN + 1] = (uint8_t)(ddL >> 8);
+    dd[DD_LABEL_LEN + 2] = (uint8_t)ddL;
+    dd[DD_LABEL_LEN + 3] = DATA_DERIVATION_KDF_CTR;
+    seg[0]               = dd;
+    segLen[0]            = sizeof(dd);
+    seg[1]               = gEmul.scp.hostChallenge;
+    segLen[1]            = sizeof(gEmul.scp.hostChallenge);
+    seg[2]               = gEmul.scp.cardChallenge;
+    segLen[2]            = sizeof(gEmul.scp.cardChallenge);
+    return emul_cmac(key, EMUL_SCP_KEY_LEN, seg, segLen, 3, out);
+}
+
+static smStatus_t emul_initialize_update(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint8_t cryptogram[EMUL_SCP_KEY_LEN];
+    uint8_t *out = rsp->buf;
+
+    if (apdu->len != SCP_GP_HOST_CHALLENGE_LEN) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    if (rsp->max < SCP_GP_IU_KEY_DIV_DATA_LEN + SCP_GP_IU_KEY_INFO_LEN + SCP_GP_CARD_CHALLENGE_LEN +
+                       SCP_GP_IU_CARD_CRYPTOGRAM_LEN) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    emul_scp_close();
+    memcpy(gEmul.scp.hostChallenge, apdu->data, SCP_GP_HOST_CHALLENGE_LEN);
+    if (RAND_bytes(gEmul.scp.cardChallenge, SCP_GP_CARD_CHALLENGE_LEN) != 1) {
+        return SM_NOT_OK;
+    }
+    if (emul_scp_derive(gEmul.keyEnc, DATA_DERIVATION_SENC, DATA_DERIVATION_L_128BIT, gEmul.scp.sEnc) != 0 ||
+        emul_scp_derive(gEmul.keyMac, DATA_DERIVATION_SMAC, DATA_DERIVATION_L_128BIT, gEmul.scp.sMac) != 0 ||
+        emul_scp_derive(gEmul.keyMac, DATA_DERIVATION_SRMAC, DATA_DERIVATION_L_128BIT, gEmul.scp.sRmac) != 0 ||
+        emul_scp_derive(gEmul.scp.sMac, DATA_CARD_CRYPTOGRAM, DATA_DERIVATION_L_64BIT, cryptogram) != 0) {
+        return SM_NOT_OK;
+    }
+
+    /* Key diversification data, key information, card challenge, card cryptogram */
+    memset(out, 0, SCP_GP_IU_KEY_DIV_DATA_LEN);
+    out += SCP_GP_IU_KEY_DIV_DATA_LEN;
+    *out++ = apdu->p1;
+    *out++ = 0x03;
+    *out++ = 0x70;
+    memcpy(out, gEmul.scp.cardChallenge, SCP_GP_CARD_CHALLENGE_LEN);
+    out += SCP_GP_CARD_CHALLENGE_LEN;
+    memcpy(out, cryptogram, SCP_GP_IU_CARD_CRYPTOGRAM_LEN);
+    out += SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
+    rsp->len        = (size_t)(out - rsp->buf);
+    gEmul.scp.state = EMUL_SCP_INITIALIZED;
+    return SM_OK;
+}
+
+static smStatus_t emul_external_authenticate(const uint8_t *raw, const emul_apdu_t *apdu)
+{
+    uint8_t cryptogram[EMUL_SCP_KEY_LEN];
+    uint8_t mac[EMUL_SCP_KEY_LEN];
+    const uint8_t *seg[2];
+    size_t segLen[2];
+
+    if (gEmul.scp.state != EMUL_SCP_INITIALIZED) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    if (apdu->len != SCP_GP_IU_CARD_CRYPTOGRAM_LEN + SCP_COMMAND_MAC_SIZE || apdu->lcWidth != 1) {
+        emul_scp_close();
+        return SM_ERR_WRONG_LENGTH;
+    }
+    if (emul_scp_derive(gEmul.scp.sMac, DATA_HOST_CRYPTOGRAM, DATA_DERIVATION_L_64BIT, cryptogram) != 0) {
+        return SM_NOT_OK;
+    }
+    /* MAC chaining value of 16 zero bytes, header, Lc and host cryptogram */
+    memset(gEmul.scp.mcv, 0, sizeof(gEmul.scp.mcv));
+    seg[0]    = gEmul.scp.mcv;
+    segLen[0] = sizeof(gEmul.scp.mcv);
+    seg[1]    = raw;
+    segLen[1] = 5 + SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
+    if (emul_cmac(gEmul.scp.sMac, EMUL_SCP_KEY_LEN, seg, segLen, 2, mac) != 0) {
+        return SM_NOT_OK;
+    }
+    if (CRYPTO_memcmp(cryptogram, apdu->data, SCP_GP_IU_CARD_CRYPTOGRAM_LEN) != 0 ||
+        CRYPTO_memcmp(mac, &apdu->data[SCP_GP_IU_CARD_CRYPTOGRAM_LEN], SCP_COMMAND_MAC_SIZE) != 0) {
+        LOG_W("emul: EXTERNAL AUTHENTICATE failed");
+        emul_scp_close();
+        return SM_ERR_SECURITY_STATUS;
+    }
+    memcpy(gEmul.scp.mcv, mac, sizeof(gEmul.scp.mcv));
+    memset(gEmul.scp.counter, 0, sizeof(gEmul.scp.counter));
+    gEmul.scp.counter[EMUL_SCP_KEY_LEN - 1] = 1;
+    gEmul.scp.state                          = EMUL_SCP_AUTHENTICATED;
+    return SM_OK;
+}
+
+static void emul_scp_inc_counter(void)
+{
+    int i;
+    for (i = EMUL_SCP_KEY_LEN - 1; i >= 0; i--) {
+        if (++gEmul.scp.counter[i] != 0) {
+            break;
+        }
+    }
+}
+
+/* AES-CBC with the session ENC key */
+static int emul_scp_cbc(int enc, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len)
+{
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int outLen          = 0;
+    int ret             = -1;
+
+    if (ctx == NULL) {
+        return -1;
+    }
+    if (EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), NULL, gEmul.scp.sEnc, iv, enc) == 1 &&
+        EVP_CIPHER_CTX_set_padding(ctx, 0) == 1 && EVP_CipherUpdate(ctx, out, &outLen, in, (int)len) == 1 &&
+        (size_t)outLen == len) {
+        ret = 0;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ret;
+}
+
+/* ICV: the counter encrypted with S-ENC. For responses the counter is
+ * marked with 0x80 in its first byte. */
+static int emul_scp_icv(uint8_t *icv, int response, int previous)
+{
+    uint8_t block[EMUL_SCP_KEY_LEN];
+    uint8_t zero[EMUL_SCP_KEY_LEN] = {0};
+    int i;
+
+    memcpy(block, gEmul.scp.counter, sizeof(block));
+    if (previous) {
+        for (i = EMUL_SCP_KEY_LEN - 1; i >= 0; i--) {
+            if (block[i]-- != 0) {
+                break;
+            }
+        }
+    }
+    if (response) {
+        block[0] = SCP_DATA_PAD_BYTE;
+    }
+    return emul_scp_cbc(1, zero, block, icv, sizeof(block));
+}
+
+/* Check the C-MAC and decrypt the command data in place */
+static smStatus_t emul_scp_unwrap(const uint8_t *raw, emul_apdu_t *apdu, uint8_t *plain, size_t *pPlainLen)
+{
+    uint8_t mac[EMUL_SCP_KEY_LEN];
+    uint8_t icv[EMUL_SCP_KEY_LEN];
+    const uint8_t *seg[2];
+    size_t segLen[2];
+    size_t encLen;
+    size_t i;
+
+    if (apdu->len < SCP_COMMAND_MAC_SIZE) {
+        return SM_ERR_SECURITY_STATUS;
+    }
+    encLen    = apdu->len - SCP_COMMAND_MAC_SIZE;
+    seg[0]    = gEmul.scp.mcv;
+    segLen[0] = sizeof(gEmul.scp.mcv);
+    seg[1]    = raw;
+    segLen[1] = 4 + apdu->lcWidth + encLen;
+    if (emul_cmac(gEmul.scp.sMac, EMUL_SCP_KEY_LEN, seg, segLen, 2, mac) != 0) {
+        return SM_NOT_OK;
+    }
+    if (CRYPTO_memcmp(mac, &apdu->data[encLen], SCP_COMMAND_MAC_SIZE) != 0) {
+        LOG_W("emul: C-MAC did not verify");
+        return SM_ERR_SECURITY_STATUS;
+    }
+    memcpy(gEmul.scp.mcv, mac, sizeof(gEmul.scp.mcv));
+
+    *pPlainLen = 0;
+    if (encLen > 0) {
+        if ((encLen % EMUL_SCP_KEY_LEN) != 0 || encLen > *pPlainLen + SE05X_EMUL_MAX_RSP) {
+            return SM_ERR_SECURITY_STATUS;
+        }
+        if (emul_scp_icv(icv, 0, 0) != 0 || emul_scp_cbc(0, icv, apdu->data, plain, encLen) != 0) {
+            return SM_NOT_OK;
+        }
+        /* Strip the 80 00.. padding */
+        i = encLen;
+        while (i > encLen - EMUL_SCP_KEY_LEN && plain[i - 1] == 0x00) {
+            i--;
+        }
+        if (plain[i - 1] != SCP_DATA_PAD_BYTE) {
+            return SM_ERR_SECURITY_STATUS;
+        }
+        *pPlainLen = i - 1;
+    }
+    apdu->cla &= (uint8_t)~CLA_GP_SECURITY_BIT;
+    apdu->data = plain;
+    apdu->len  = *pPlainLen;
+    return SM_OK;
+}
+
+/* Encrypt the response data in place and append the R-MAC.
+ * rsp->buf must have room for the padding and the R-MAC. */
+static smStatus_t emul_scp_wrap(emul_rsp_t *rsp, smStatus_t sw, size_t plainCmdLen)
+{
+    uint8_t icv[EMUL_SCP_KEY_LEN];
+    uint8_t mac[EMUL_SCP_KEY_LEN];
+    uint8_t swBuf[2];
+    const uint8_t *seg[3];
+    size_t segLen[3];
+    size_t padded;
+
+    if (rsp->len > 0) {
+        padded = (rsp->len / EMUL_SCP_KEY_LEN + 1) * EMUL_SCP_KEY_LEN;
+        if (padded + SCP_COMMAND_MAC_SIZE > rsp->max) {
+            return SM_ERR_WRONG_LENGTH;
+        }
+        rsp->buf[rsp->len] = SCP_DATA_PAD_BYTE;
+        memset(&rsp->buf[rsp->len + 1], 0, padded - rsp->len - 1);
+        if (emul_scp_icv(icv, 1, (!EMUL_SCP_COUNT_ALL) && plainCmdLen == 0) != 0 ||
+            emul_scp_cbc(1, icv, rsp->buf, rsp->buf, padded) != 0) {
+            return SM_NOT_OK;
+        }
+        rsp->len = padded;
+    }
+    else if (SCP_COMMAND_MAC_SIZE > rsp->max) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    swBuf[0]  = (uint8_t)(sw >> 8);
+    swBuf[1]  = (uint8_t)sw;
+    seg[0]    = gEmul.scp.mcv;
+    segLen[0] = sizeof(gEmul.scp.mcv);
+    seg[1]    = rsp->buf;
+    segLen[1] = rsp->len;
+    seg[2]    = swBuf;
+    segLen[2] = sizeof(swBuf);
+    if (emul_cmac(gEmul.scp.sRmac, EMUL_SCP_KEY_LEN, seg, segLen, 3, mac) != 0) {
+        return SM_NOT_OK;
+    }
+    memcpy(&rsp->buf[rsp->len], mac, SCP_COMMAND_MAC_SIZE);
+    rsp->len += SCP_COMMAND_MAC_SIZE;
+    return SM_OK;
+}
+
+/* ************************************************************************** */
+/* Object management                                                          */
+/* ************************************************************************** */
+
+static smStatus_t emul_write_ec_key(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    uint8_t curve         = 0;
+    uint8_t keyPart       = apdu->p1 & kSE05x_P1_MASK_KEY_TYPE;
+    const uint8_t *priv   = NULL;
+    const uint8_t *pub    = NULL;
+    size_t privLen        = 0;
+    size_t pubLen         = 0;
+    emul_object_t *obj    = NULL;
+    EC_KEY *ec            = NULL;
+    EC_POINT *point       = NULL;
+    BIGNUM *d             = NULL;
+    int created           = 0;
+    smStatus_t retStatus  = SM_ERR_WRONG_DATA;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    (void)emul_tlv_u8(apdu, kSE05x_TAG_2, &curve);
+    (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &priv, &privLen);
+    (void)emul_tlv_buf(apdu, kSE05x_TAG_4, &pub, &pubLen);
+    if (keyPart == 0) {
+        keyPart = kSE05x_P1_KEY_PAIR;
+    }
+
+    retStatus = emul_obj_for_write(apdu, id, kSE05x_P1_EC, keyPart, &obj, &created);
+    if (retStatus != SM_OK) {
+        return retStatus;
+    }
+    if (!created) {
+        curve = obj->curve;
+    }
+    retStatus = SM_ERR_WRONG_DATA;
+    ec        = EC_KEY_new_by_curve_name(emul_curve_nid(curve));
+    if (ec == NULL) {
+        goto cleanup;
+    }
+
+    if (priv == NULL && pub == NULL) {
+        /* Generate */
+        if (keyPart == kSE05x_P1_PUBLIC || EC_KEY_generate_key(ec) != 1) {
+            goto cleanup;
+        }
+        gEmul.latencyP2 = kSE05x_P2_GENERATE;
+    }
+    else {
+        if (priv != NULL) {
+            if (keyPart == kSE05x_P1_PUBLIC) {
+                goto cleanup;
+            }
+            d = BN_bin2bn(priv, (int)privLen, NULL);
+            if (d == NULL || EC_KEY_set_private_key(ec, d) != 1) {
+                goto cleanup;
+            }
+        }
+        point = EC_POINT_new(EC_KEY_get0_group(ec));
+        if (point == NULL) {
+            goto cleanup;
+        }
+        if (pub != NULL) {
+            if (keyPart == kSE05x_P1_PRIVATE ||
+                EC_POINT_oct2point(EC_KEY_get0_group(ec), point, pub, pubLen, NULL) != 1) {
+                goto cleanup;
+            }
+        }
+        else if (d != NULL) {
+            /* Derive the public key of a pair or private key */
+            if (EC_POINT_mul(EC_KEY_get0_group(ec), point, d, NULL, NULL, NULL) != 1) {
+                goto cleanup;
+            }
+        }
+        if (EC_KEY_set_public_key(ec, point) != 1) {
+            goto cleanup;
+        }
+        if (keyPart == kSE05x_P1_KEY_PAIR && d == NULL && obj->ec != NULL &&
+            EC_KEY_get0_private_key(obj->ec) != NULL) {
+            /* Public part of an existing pair */
+            if (EC_KEY_set_private_key(ec, EC_KEY_get0_private_key(obj->ec)) != 1) {
+                goto cleanup;
+            }
+        }
+    }
+
+    emul_obj_clear_contents(obj);
+    obj->ec    = ec;
+    ec         = NULL;
+    obj->curve = curve;
+    obj->type  = emul_ec_object_type(curve, keyPart);
+    retStatus  = SM_OK;
+
+cleanup:
+    if (retStatus != SM_OK && created) {
+        emul_obj_free(obj);
+    }
+    EC_POINT_free(point);
+    BN_clear_free(d);
+    EC_KEY_free(ec);
+    return retStatus;
+}
+
+static smStatus_t emul_write_symm_key(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    const uint8_t *key;
+    const uint8_t *kek;
+    size_t keyLen;
+    size_t kekLen;
+    uint8_t credType = apdu->p1 & kSE05x_P1_MASK_CRED_TYPE;
+    emul_object_t *obj;
+    int created;
+    smStatus_t retStatus;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0 || emul_tlv_buf(apdu, kSE05x_TAG_3, &key, &keyLen) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (emul_tlv_buf(apdu, kSE05x_TAG_2, &kek, &kekLen) == 0) {
+        /* RFC3394 wrapped keys are not emulated */
+        return SM_ERR_WRONG_DATA;
+    }
+    if (credType == kSE05x_P1_AES && keyLen != 16 && keyLen != 24 && keyLen != 32) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (keyLen == 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    retStatus = emul_obj_for_write(apdu, id, credType, 0, &obj, &created);
+    if (retStatus != SM_OK) {
+        return retStatus;
+    }
+    retStatus = emul_obj_set_data(obj, key, keyLen);
+    if (retStatus != SM_OK) {
+        if (created) {
+            emul_obj_free(obj);
+        }
+        return retStatus;
+    }
+    obj->type = (credType == kSE05x_P1_AES) ? kSE05x_SecObjTyp_AES_KEY :
+                                              ((credType == kSE05x_P1_DES) ? kSE05x_SecObjTyp_DES_KEY :
+                                                                             kSE05x_SecObjTyp_HMAC_KEY);
+    return SM_OK;
+}
+
+static smStatus_t emul_write_binary(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    uint16_t offset = 0;
+    uint16_t length = 0;
+    const uint8_t *data = NULL;
+    size_t dataLen      = 0;
+    emul_object_t *obj;
+    int created;
+    smStatus_t retStatus;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_2, &offset);
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_3, &length);
+    (void)emul_tlv_buf(apdu, kSE05x_TAG_4, &data, &dataLen);
+
+    if (emul_obj_find(id) == NULL && length == 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    retStatus = emul_obj_for_write(apdu, id, kSE05x_P1_BINARY, 0, &obj, &created);
+    if (retStatus != SM_OK) {
+        return retStatus;
+    }
+    if (created) {
+        obj->data = calloc(1, length);
+        if (obj->data == NULL) {
+            emul_obj_free(obj);
+            return SM_ERR_FILE_FULL;
+        }
+        obj->len  = length;
+        obj->type = kSE05x_SecObjTyp_BINARY_FILE;
+    }
+    if ((size_t)offset + dataLen > obj->len) {
+        if (created) {
+            emul_obj_free(obj);
+        }
+        return SM_ERR_WRONG_DATA;
+    }
+    if (dataLen > 0) {
+        memcpy(&obj->data[offset], data, dataLen);
+    }
+    return SM_OK;
+}
+
+static smStatus_t emul_write_userid(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    const uint8_t *value;
+    size_t valueLen;
+    emul_object_t *obj;
+    int created;
+    smStatus_t retStatus;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0 || emul_tlv_buf(apdu, kSE05x_TAG_2, &value, &valueLen) != 0 ||
+        valueLen == 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    retStatus = emul_obj_for_write(apdu, id, kSE05x_P1_UserID, 0, &obj, &created);
+    if (retStatus != SM_OK) {
+        return retStatus;
+    }
+    retStatus = emul_obj_set_data(obj, value, valueLen);
+    if (retStatus != SM_OK) {
+        if (created) {
+            emul_obj_free(obj);
+        }
+        return retStatus;
+    }
+    obj->type = kSE05x_SecObjTyp_UserID;
+    return SM_OK;
+}
+
+/* Counter: created with its size (and value), then incremented or set to a
+ * higher value */
+static smStatus_t emul_write_counter(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    uint16_t size        = 0;
+    const uint8_t *value = NULL;
+    size_t valueLen      = 0;
+    emul_object_t *obj;
+    int created;
+    size_t i;
+    smStatus_t retStatus;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_2, &size);
+    (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &value, &valueLen);
+
+    if (emul_obj_find(id) == NULL && (size == 0 || size > 8)) {
+        return SM_ERR_WRONG_DATA;
+    }
+    retStatus = emul_obj_for_write(apdu, id, kSE05x_P1_COUNTER, 0, &obj, &created);
+    if (retStatus != SM_OK) {
+        return retStatus;
+    }
+    if (created) {
+        obj->data = calloc(1, size);
+        if (obj->data == NULL) {
+            emul_obj_free(obj);
+            return SM_ERR_FILE_FULL;
+        }
+        obj->len  = size;
+        obj->type = kSE05x_SecObjTyp_COUNTER;
+        if (value == NULL) {
+            return SM_OK;
+        }
+    }
+    if (value != NULL) {
+        if (valueLen != obj->len || (!created && memcmp(value, obj->data, obj->len) <= 0)) {
+            if (created) {
+                emul_obj_free(obj);
+            }
+            return SM_ERR_WRONG_DATA;
+        }
+        memcpy(obj->data, value, obj->len);
+        return SM_OK;
+    }
+    for (i = obj->len; i > 0; i--) {
+        if (++obj->data[i - 1] != 0) {
+            return SM_OK;
+        }
+    }
+    /* Was at its maximum */
+    memset(obj->data, 0xFF, obj->len);
+    return SM_ERR_CONDITIONS_NOT_SATISFIED;
+}
+
+static smStatus_t emul_create_crypto_obj(const emul_apdu_t *apdu)
+{
+    uint16_t id;
+    uint8_t context;
+    uint8_t subType;
+    size_t i;
+
+    if (emul_tlv_u16(apdu, kSE05x_TAG_1, &id) != 0 || emul_tlv_u8(apdu, kSE05x_TAG_2, &context) != 0 ||
+        emul_tlv_u8(apdu, kSE05x_TAG_3, &subType) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (emul_crypto_obj_find(id) != NULL) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        if (!gEmul.cryptoObj[i].used) {
+            memset(&gEmul.cryptoObj[i], 0, sizeof(gEmul.cryptoObj[i]));
+            gEmul.cryptoObj[i].used    = 1;
+            gEmul.cryptoObj[i].id      = id;
+            gEmul.cryptoObj[i].context = context;
+            gEmul.cryptoObj[i].subType = subType;
+            return SM_OK;
+        }
+    }
+    return SM_ERR_FILE_FULL;
+}
+
+static smStatus_t emul_read_object(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t id;
+    uint16_t offset = 0;
+    uint16_t length = 0;
+    uint8_t point[1 + 2 * 66];
+    size_t pointLen;
+    emul_object_t *obj;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_2, &offset);
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_3, &length);
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    switch (obj->credType) {
+    case kSE05x_P1_EC:
+        if (obj->keyPart == kSE05x_P1_PRIVATE) {
+            return SM_ERR_COMMAND_NOT_ALLOWED;
+        }
+        pointLen = emul_ec_public(obj->ec, point, sizeof(point));
+        if (pointLen == 0) {
+            return SM_NOT_OK;
+        }
+        return emul_rsp_put(rsp, kSE05x_TAG_1, point, pointLen);
+    case kSE05x_P1_BINARY:
+        if (offset > obj->len) {
+            return SM_ERR_WRONG_DATA;
+        }
+        if (length == 0) {
+            length = (uint16_t)(obj->len - offset);
+        }
+        if ((size_t)offset + length > obj->len) {
+            return SM_ERR_WRONG_DATA;
+        }
+        return emul_rsp_put(rsp, kSE05x_TAG_1, &obj->data[offset], length);
+    case kSE05x_P1_COUNTER:
+        return emul_rsp_put(rsp, kSE05x_TAG_1, obj->data, obj->len);
+    default:
+        /* Secrets are not readable */
+        return SM_ERR_COMMAND_NOT_ALLOWED;
+    }
+}
+
+static smStatus_t emul_read_type(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t id;
+    emul_object_t *obj;
+    smStatus_t retStatus;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    retStatus = emul_rsp_u8(rsp, kSE05x_TAG_1, obj->type);
+    if (retStatus == SM_OK) {
+        retStatus = emul_rsp_u8(rsp,
+            kSE05x_TAG_2,
+            obj->transient ? kSE05x_TransientIndicator_TRANSIENT : kSE05x_TransientIndicator_PERSISTENT);
+    }
+    return retStatus;
+}
+
+static smStatus_t emul_read_size(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t id;
+    emul_object_t *obj;
+    size_t size;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    size = (obj->ec != NULL) ? emul_ec_field_len(obj->ec) : obj->len;
+    return emul_rsp_u16(rsp, kSE05x_TAG_1, (uint16_t)size);
+}
+
+static smStatus_t emul_read_id_list(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint16_t offset = 0;
+    uint8_t filter  = 0xFF;
+    uint8_t list[SE05X_EMUL_MAX_OBJECTS * 4];
+    size_t listLen = 0;
+    size_t index   = 0;
+    size_t i;
+    smStatus_t retStatus;
+
+    (void)emul_tlv_u16(apdu, kSE05x_TAG_1, &offset);
+    (void)emul_tlv_u8(apdu, kSE05x_TAG_2, &filter);
+    /* All IDs fit in one page, offset counts objects */
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        emul_object_t *obj = &gEmul.obj[i];
+        if (!obj->used || (filter != 0xFF && filter != obj->type)) {
+            continue;
+        }
+        if (index++ < offset) {
+            continue;
+        }
+        list[listLen++] = (uint8_t)(obj->id >> 24);
+        list[listLen++] = (uint8_t)(obj->id >> 16);
+        list[listLen++] = (uint8_t)(obj->id >> 8);
+        list[listLen++] = (uint8_t)(obj->id);
+    }
+    retStatus = emul_rsp_u8(rsp, kSE05x_TAG_1, kSE05x_MoreIndicator_NO_MORE);
+    if (retStatus == SM_OK) {
+        retStatus = emul_rsp_put(rsp, kSE05x_TAG_2, list, listLen);
+    }
+    return retStatus;
+}
+
+static smStatus_t emul_read_crypto_obj_list(emul_rsp_t *rsp)
+{
+    uint8_t list[EMUL_MAX_CRYPTO_OBJECTS * 4];
+    size_t listLen = 0;
+    size_t i;
+
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        emul_crypto_obj_t *co = &gEmul.cryptoObj[i];
+        if (!co->used) {
+            continue;
+        }
+        list[listLen++] = (uint8_t)(co->id >> 8);
+        list[listLen++] = (uint8_t)(co->id);
+        list[listLen++] = co->context;
+        list[listLen++] = co->subType;
+    }
+    return emul_rsp_put(rsp, kSE05x_TAG_1, list, listLen);
+}
+
+static smStatus_t emul_curve(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint8_t curve = 0;
+    uint32_t id;
+    emul_object_t *obj;
+    uint8_t list[kSE05x_ECCurve_Total_Weierstrass_Curves];
+    size_t i;
+    uint8_t ins = apdu->ins & kSE05x_INS_MASK_INSTRUCTION;
+
+    if (ins == kSE05x_INS_READ && apdu->p2 == kSE05x_P2_LIST) {
+        for (i = 0; i < sizeof(list); i++) {
+            list[i] = gEmul.curveSet[i] ? kSE05x_SetIndicator_SET : kSE05x_SetIndicator_NOT_SET;
+        }
+        return emul_rsp_put(rsp, kSE05x_TAG_1, list, sizeof(list));
+    }
+    if (ins == kSE05x_INS_READ && apdu->p2 == kSE05x_P2_ID) {
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        obj = emul_obj_find(id);
+        if (obj == NULL) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        if (obj->credType != kSE05x_P1_EC) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        return emul_rsp_u8(rsp, kSE05x_TAG_1, obj->curve);
+    }
+
+    if (emul_tlv_u8(apdu, kSE05x_TAG_1, &curve) != 0 || curve < kSE05x_ECCurve_NIST_P192 ||
+        curve > kSE05x_ECCurve_Total_Weierstrass_Curves) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (ins == kSE05x_INS_WRITE && apdu->p2 == kSE05x_P2_CREATE) {
+        if (gEmul.curveSet[curve - 1]) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        gEmul.curveSet[curve - 1] = 1;
+        return SM_OK;
+    }
+    if (ins == kSE05x_INS_WRITE && apdu->p2 == kSE05x_P2_PARAM) {
+        /* Parameters of the well known curves are built in */
+        return SM_OK;
+    }
+    if (ins == kSE05x_INS_MGMT && apdu->p2 == kSE05x_P2_DELETE_OBJECT) {
+        if (!gEmul.curveSet[curve - 1]) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        gEmul.curveSet[curve - 1] = 0;
+        return SM_OK;
+    }
+    return EMUL_SW_INS_NOT_SUPPORTED;
+}
+
+/* ************************************************************************** */
+/* Crypto                                                                     */
+/* ************************************************************************** */
+
+static smStatus_t emul_ecdsa(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t id;
+    const uint8_t *input;
+    const uint8_t *sigDer = NULL;
+    size_t inputLen;
+    size_t sigDerLen = 0;
+    emul_object_t *obj;
+    ECDSA_SIG *sig       = NULL;
+    uint8_t der[2 * 66 + 16];
+    uint8_t *pDer        = der;
+    int derLen;
+    int verified;
+    smStatus_t retStatus = SM_ERR_WRONG_DATA;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0 || emul_tlv_buf(apdu, kSE05x_TAG_3, &input, &inputLen) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    if (obj->credType != kSE05x_P1_EC) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+
+    if (apdu->p2 == kSE05x_P2_SIGN) {
+        if (obj->keyPart == kSE05x_P1_PUBLIC) {
+            return SM_ERR_COMMAND_NOT_ALLOWED;
+        }
+        sig = ECDSA_do_sign(input, (int)inputLen, obj->ec);
+        if (sig == NULL) {
+            goto cleanup;
+        }
+        derLen = i2d_ECDSA_SIG(sig, NULL);
+        if (derLen <= 0 || (size_t)derLen > sizeof(der)) {
+            goto cleanup;
+        }
+        derLen    = i2d_ECDSA_SIG(sig, &pDer);
+        retStatus = emul_rsp_put(rsp, kSE05x_TAG_1, der, (size_t)derLen);
+    }
+    else {
+        if (obj->keyPart == kSE05x_P1_PRIVATE || emul_tlv_buf(apdu, kSE05x_TAG_5, &sigDer, &sigDerLen) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        sig      = d2i_ECDSA_SIG(NULL, &sigDer, (long)sigDerLen);
+        verified = (sig != NULL) && (ECDSA_do_verify(input, (int)inputLen, sig, obj->ec) == 1);
+        retStatus =
+            emul_rsp_u8(rsp, kSE05x_TAG_1, (uint8_t)(verified ? kSE05x_Result_SUCCESS : kSE05x_Result_FAILURE));
+    }
+
+cleanup:
+    ECDSA_SIG_free(sig);
+    return retStatus;
+}
+
+static smStatus_t emul_ecdh(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t id;
+    const uint8_t *peer;
+    size_t peerLen;
+    emul_object_t *obj;
+    EC_POINT *point = NULL;
+    uint8_t secret[66];
+    int secretLen;
+    smStatus_t retStatus = SM_ERR_WRONG_DATA;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0 || emul_tlv_buf(apdu, kSE05x_TAG_2, &peer, &peerLen) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    if (obj->credType != kSE05x_P1_EC || obj->keyPart == kSE05x_P1_PUBLIC) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    point = EC_POINT_new(EC_KEY_get0_group(obj->ec));
+    if (point == NULL || EC_POINT_oct2point(EC_KEY_get0_group(obj->ec), point, peer, peerLen, NULL) != 1) {
+        goto cleanup;
+    }
+    secretLen = ECDH_compute_key(secret, emul_ec_field_len(obj->ec), point, obj->ec, NULL);
+    if (secretLen <= 0) {
+        goto cleanup;
+    }
+    retStatus = emul_rsp_put(rsp, kSE05x_TAG_1, secret, (size_t)secretLen);
+    OPENSSL_cleanse(secret, sizeof(secret));
+
+cleanup:
+    EC_POINT_free(point);
+    return retStatus;
+}
+
+static emul_object_t *emul_symm_key(uint32_t id, uint8_t credType, smStatus_t *pStatus)
+{
+    emul_object_t *obj = emul_obj_find(id);
+    if (obj == NULL) {
+        *pStatus = EMUL_SW_FILE_NOT_FOUND;
+        return NULL;
+    }
+    if (obj->credType != credType) {
+        *pStatus = SM_ERR_CONDITIONS_NOT_SATISFIED;
+        return NULL;
+    }
+    *pStatus = SM_OK;
+    return obj;
+}
+
+static smStatus_t emul_cipher_init_ctx(
+    EVP_CIPHER_CTX **pCtx, const emul_object_t *key, uint8_t mode, int enc, const uint8_t *iv, size_t ivLen)
+{
+    const EVP_CIPHER *cipher = emul_aes_cipher(mode, key->len);
+
+    if (cipher == NULL) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (mode != kSE05x_CipherMode_AES_ECB_NOPAD && ivLen != 16) {
+        return SM_ERR_WRONG_DATA;
+    }
+    *pCtx = EVP_CIPHER_CTX_new();
+    if (*pCtx == NULL || EVP_CipherInit_ex(*pCtx, cipher, NULL, key->data, ivLen ? iv : NULL, enc) != 1 ||
+        EVP_CIPHER_CTX_set_padding(*pCtx, mode == kSE05x_CipherMode_AES_CBC_PKCS5) != 1) {
+        EVP_CIPHER_CTX_free(*pCtx);
+        *pCtx = NULL;
+        return SM_NOT_OK;
+    }
+    return SM_OK;
+}
+
+/* Update, and finish if final is set, straight into the response TAG_1 */
+static smStatus_t emul_cipher_run(EVP_CIPHER_CTX *ctx, const uint8_t *in, size_t inLen, int final, emul_rsp_t *rsp)
+{
+    uint8_t *out = EMUL_RSP_VALUE(rsp);
+    int outLen   = 0;
+    int finLen   = 0;
+
+    if (inLen > 0xFF00 || rsp->max < rsp->len + EMUL_TLV_HDR_MAX + inLen + 16) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    if (inLen > 0 && EVP_CipherUpdate(ctx, out, &outLen, in, (int)inLen) != 1) {
+        return SM_ERR_WRONG_DATA;
+    }
+    if (final && EVP_CipherFinal_ex(ctx, &out[outLen], &finLen) != 1) {
+        return SM_ERR_WRONG_DATA;
+    }
+    return emul_rsp_put(rsp, kSE05x_TAG_1, out, (size_t)(outLen + finLen));
+}
+
+static smStatus_t emul_cipher(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t keyId;
+    uint16_t coId;
+    uint8_t mode;
+    const uint8_t *in  = NULL;
+    const uint8_t *iv  = NULL;
+    size_t inLen       = 0;
+    size_t ivLen       = 0;
+    emul_object_t *key;
+    emul_crypto_obj_t *co;
+    EVP_CIPHER_CTX *ctx = NULL;
+    smStatus_t retStatus;
+    int enc;
+
+    switch (apdu->p2) {
+    case kSE05x_P2_ENCRYPT_ONESHOT:
+    case kSE05x_P2_DECRYPT_ONESHOT:
+        enc = (apdu->p2 == kSE05x_P2_ENCRYPT_ONESHOT);
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &keyId) != 0 || emul_tlv_u8(apdu, kSE05x_TAG_2, &mode) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &in, &inLen);
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_4, &iv, &ivLen);
+        key = emul_symm_key(keyId, kSE05x_P1_AES, &retStatus);
+        if (key == NULL) {
+            return retStatus;
+        }
+        retStatus = emul_cipher_init_ctx(&ctx, key, mode, enc, iv, ivLen);
+        if (retStatus == SM_OK) {
+            retStatus = emul_cipher_run(ctx, in, inLen, 1, rsp);
+        }
+        EVP_CIPHER_CTX_free(ctx);
+        return retStatus;
+
+    case kSE05x_P2_ENCRYPT:
+    case kSE05x_P2_DECRYPT:
+        enc = (apdu->p2 == kSE05x_P2_ENCRYPT);
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &keyId) != 0 || emul_tlv_u16(apdu, kSE05x_TAG_2, &coId) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_4, &iv, &ivLen);
+        co = emul_crypto_obj_find(coId);
+        if (co == NULL) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        if (co->context != kSE05x_CryptoContext_CIPHER) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        key = emul_symm_key(keyId, kSE05x_P1_AES, &retStatus);
+        if (key == NULL) {
+            return retStatus;
+        }
+        emul_crypto_obj_stop(co);
+        retStatus = emul_cipher_init_ctx(&co->cipher, key, co->subType, enc, iv, ivLen);
+        if (retStatus == SM_OK) {
+            co->active = 1;
+            co->keyId  = keyId;
+        }
+        return retStatus;
+
+    case kSE05x_P2_UPDATE:
+    case kSE05x_P2_FINAL:
+        if (emul_tlv_u16(apdu, kSE05x_TAG_2, &coId) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &in, &inLen);
+        co = emul_crypto_obj_find(coId);
+        if (co == NULL) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        if (!co->active || co->cipher == NULL) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        retStatus = emul_cipher_run(co->cipher, in, inLen, apdu->p2 == kSE05x_P2_FINAL, rsp);
+        if (apdu->p2 == kSE05x_P2_FINAL || retStatus != SM_OK) {
+            emul_crypto_obj_stop(co);
+        }
+        return retStatus;
+
+    default:
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+}
+
+/* MAC over data with the key of keyId */
+static smStatus_t emul_mac_compute(
+    uint32_t keyId, uint8_t macAlgo, const uint8_t *data, size_t dataLen, uint8_t *mac, size_t *pMacLen)
+{
+    emul_object_t *key;
+    const EVP_MD *md;
+    unsigned int hmacLen = 0;
+    smStatus_t retStatus;
+
+    if (macAlgo == kSE05x_MACAlgo_CMAC_128) {
+        const uint8_t *seg[1];
+        size_t segLen[1];
+        key = emul_symm_key(keyId, kSE05x_P1_AES, &retStatus);
+        if (key == NULL) {
+            return retStatus;
+        }
+        seg[0]    = data;
+        segLen[0] = dataLen;
+        if (emul_cmac(key->data, key->len, seg, segLen, 1, mac) != 0) {
+            return SM_NOT_OK;
+        }
+        *pMacLen = 16;
+        return SM_OK;
+    }
+    md = emul_hmac_md(macAlgo);
+    if (md == NULL) {
+        return SM_ERR_WRONG_DATA;
+    }
+    key = emul_symm_key(keyId, kSE05x_P1_HMAC, &retStatus);
+    if (key == NULL) {
+        return retStatus;
+    }
+    if (HMAC(md, key->data, (int)key->len, data, dataLen, mac, &hmacLen) == NULL) {
+        return SM_NOT_OK;
+    }
+    *pMacLen = hmacLen;
+    return SM_OK;
+}
+
+static smStatus_t emul_mac_result(
+    emul_rsp_t *rsp, int validate, const uint8_t *mac, size_t macLen, const uint8_t *expected, size_t expectedLen)
+{
+    int ok;
+    if (!validate) {
+        return emul_rsp_put(rsp, kSE05x_TAG_1, mac, macLen);
+    }
+    ok = (expected != NULL) && (expectedLen > 0) && (expectedLen <= macLen) &&
+         (CRYPTO_memcmp(mac, expected, expectedLen) == 0);
+    return emul_rsp_u8(rsp, kSE05x_TAG_1, (uint8_t)(ok ? kSE05x_Result_SUCCESS : kSE05x_Result_FAILURE));
+}
+
+static smStatus_t emul_mac(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t keyId;
+    uint16_t coId;
+    uint8_t macAlgo;
+    const uint8_t *in       = NULL;
+    const uint8_t *expected = NULL;
+    size_t inLen            = 0;
+    size_t expectedLen      = 0;
+    uint8_t mac[64];
+    size_t macLen = 0;
+    emul_crypto_obj_t *co;
+    uint8_t *grown;
+    smStatus_t retStatus;
+
+    switch (apdu->p2) {
+    case kSE05x_P2_GENERATE_ONESHOT:
+    case kSE05x_P2_VALIDATE_ONESHOT:
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &keyId) != 0 || emul_tlv_u8(apdu, kSE05x_TAG_2, &macAlgo) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &in, &inLen);
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_5, &expected, &expectedLen);
+        retStatus = emul_mac_compute(keyId, macAlgo, in, inLen, mac, &macLen);
+        if (retStatus != SM_OK) {
+            return retStatus;
+        }
+        return emul_mac_result(
+            rsp, apdu->p2 == kSE05x_P2_VALIDATE_ONESHOT, mac, macLen, expected, expectedLen);
+
+    case kSE05x_P2_GENERATE:
+    case kSE05x_P2_VALIDATE:
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &keyId) != 0 || emul_tlv_u16(apdu, kSE05x_TAG_2, &coId) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        co = emul_crypto_obj_find(coId);
+        if (co == NULL) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        if (co->context != kSE05x_CryptoContext_SIGNATURE) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        emul_crypto_obj_stop(co);
+        co->active   = 1;
+        co->keyId    = keyId;
+        co->validate = (apdu->p2 == kSE05x_P2_VALIDATE);
+        return SM_OK;
+
+    case kSE05x_P2_UPDATE:
+    case kSE05x_P2_FINAL:
+        if (emul_tlv_u16(apdu, kSE05x_TAG_2, &coId) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_1, &in, &inLen);
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &expected, &expectedLen);
+        co = emul_crypto_obj_find(coId);
+        if (co == NULL) {
+            return EMUL_SW_FILE_NOT_FOUND;
+        }
+        if (!co->active) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        /* The input is kept until MACFinal, the MAC is computed in one go */
+        if (inLen > 0) {
+            grown = realloc(co->macData, co->macLen + inLen);
+            if (grown == NULL) {
+                emul_crypto_obj_stop(co);
+                return SM_ERR_FILE_FULL;
+            }
+            co->macData = grown;
+            memcpy(&co->macData[co->macLen], in, inLen);
+            co->macLen += inLen;
+        }
+        if (apdu->p2 == kSE05x_P2_UPDATE) {
+            return SM_OK;
+        }
+        retStatus = emul_mac_compute(co->keyId, co->subType, co->macData, co->macLen, mac, &macLen);
+        if (retStatus == SM_OK) {
+            retStatus = emul_mac_result(rsp, co->validate, mac, macLen, expected, expectedLen);
+        }
+        emul_crypto_obj_stop(co);
+        return retStatus;
+
+    default:
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+}
+
+static smStatus_t emul_digest(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint16_t coId;
+    uint8_t mode;
+    const uint8_t *in = NULL;
+    size_t inLen      = 0;
+    uint8_t hash[EVP_MAX_MD_SIZE];
+    unsigned int hashLen = 0;
+    const EVP_MD *md;
+    emul_crypto_obj_t *co;
+    smStatus_t retStatus;
+
+    if (apdu->p2 == kSE05x_P2_ONESHOT) {
+        if (emul_tlv_u8(apdu, kSE05x_TAG_1, &mode) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        (void)emul_tlv_buf(apdu, kSE05x_TAG_2, &in, &inLen);
+        md = emul_digest_md(mode);
+        if (md == NULL) {
+            return SM_ERR_WRONG_DATA;
+        }
+        if (EVP_Digest(in, inLen, hash, &hashLen, md, NULL) != 1) {
+            return SM_NOT_OK;
+        }
+        return emul_rsp_put(rsp, kSE05x_TAG_1, hash, hashLen);
+    }
+
+    if (emul_tlv_u16(apdu, kSE05x_TAG_2, &coId) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    (void)emul_tlv_buf(apdu, kSE05x_TAG_3, &in, &inLen);
+    co = emul_crypto_obj_find(coId);
+    if (co == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    if (co->context != kSE05x_CryptoContext_DIGEST) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+
+    switch (apdu->p2) {
+    case kSE05x_P2_INIT:
+        md = emul_digest_md(co->subType);
+        if (md == NULL) {
+            return SM_ERR_WRONG_DATA;
+        }
+        emul_crypto_obj_stop(co);
+        co->md = EVP_MD_CTX_new();
+        if (co->md == NULL || EVP_DigestInit_ex(co->md, md, NULL) != 1) {
+            emul_crypto_obj_stop(co);
+            return SM_NOT_OK;
+        }
+        co->active = 1;
+        return SM_OK;
+    case kSE05x_P2_UPDATE:
+    case kSE05x_P2_FINAL:
+        if (!co->active || co->md == NULL) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        if (inLen > 0 && EVP_DigestUpdate(co->md, in, inLen) != 1) {
+            emul_crypto_obj_stop(co);
+            return SM_NOT_OK;
+        }
+        if (apdu->p2 == kSE05x_P2_UPDATE) {
+            return SM_OK;
+        }
+        retStatus = SM_NOT_OK;
+        if (EVP_DigestFinal_ex(co->md, hash, &hashLen) == 1) {
+            retStatus = emul_rsp_put(rsp, kSE05x_TAG_1, hash, hashLen);
+        }
+        emul_crypto_obj_stop(co);
+        return retStatus;
+    default:
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+}
+
+/* ************************************************************************** */
+/* Management and sessions                                                    */
+/* ************************************************************************** */
+
+static smStatus_t emul_delete_object(const emul_apdu_t *apdu)
+{
+    uint32_t id;
+    emul_object_t *obj;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(id);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    if (obj->reserved) {
+        return SM_ERR_COMMAND_NOT_ALLOWED;
+    }
+    emul_obj_free(obj);
+    return SM_OK;
+}
+
+static void emul_delete_all(void)
+{
+    size_t i;
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        if (gEmul.obj[i].used && !gEmul.obj[i].reserved) {
+            emul_obj_free(&gEmul.obj[i]);
+        }
+    }
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        emul_crypto_obj_free(&gEmul.cryptoObj[i]);
+    }
+    memset(gEmul.curveSet, 0, sizeof(gEmul.curveSet));
+}
+
+static smStatus_t emul_create_session(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    uint32_t authId;
+    emul_object_t *obj;
+    size_t i;
+
+    if (emul_tlv_u32(apdu, kSE05x_TAG_1, &authId) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    obj = emul_obj_find(authId);
+    if (obj == NULL) {
+        return EMUL_SW_FILE_NOT_FOUND;
+    }
+    if (obj->credType != kSE05x_P1_UserID) {
+        /* AESKey / ECKey sessions are not emulated */
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    for (i = 0; i < EMUL_MAX_SESSIONS; i++) {
+        if (!gEmul.session[i].used) {
+            if (RAND_bytes(gEmul.session[i].id, EMUL_SESSION_ID_LEN) != 1) {
+                return SM_NOT_OK;
+            }
+            gEmul.session[i].used     = 1;
+            gEmul.session[i].verified = 0;
+            gEmul.session[i].authId   = authId;
+            return emul_rsp_put(rsp, kSE05x_TAG_1, gEmul.session[i].id, EMUL_SESSION_ID_LEN);
+        }
+    }
+    return SM_ERR_FILE_FULL;
+}
+
+static smStatus_t emul_mgmt(const emul_apdu_t *apdu, emul_rsp_t *rsp, emul_session_t *session)
+{
+    uint32_t id;
+    uint16_t size;
+    uint8_t memType;
+    const uint8_t *userId;
+    size_t userIdLen;
+    emul_object_t *obj;
+    const uint8_t version[] = {(uint8_t)APPLET_SE050_VER_MAJOR,
+        (uint8_t)APPLET_SE050_VER_MINOR,
+        (uint8_t)APPLET_SE050_VER_DEV,
+        0xFF,
+        0xFF,
+        0x01,
+        0x0B};
+
+    switch (apdu->p2) {
+    case kSE05x_P2_VERSION:
+        return emul_rsp_put(rsp, kSE05x_TAG_1, version, sizeof(version));
+    case kSE05x_P2_MEMORY:
+        if (emul_tlv_u8(apdu, kSE05x_TAG_1, &memType) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        return emul_rsp_u16(rsp, kSE05x_TAG_1, (memType == kSE05x_MemoryType_PERSISTENT) ? 0x7FFF : 0x1000);
+    case kSE05x_P2_RANDOM:
+        if (emul_tlv_u16(apdu, kSE05x_TAG_1, &size) != 0 || size > rsp->max - rsp->len - EMUL_TLV_HDR_MAX) {
+            return SM_ERR_WRONG_DATA;
+        }
+        if (RAND_bytes(EMUL_RSP_VALUE(rsp), size) != 1) {
+            return SM_NOT_OK;
+        }
+        return emul_rsp_put(rsp, kSE05x_TAG_1, EMUL_RSP_VALUE(rsp), size);
+    case kSE05x_P2_EXIST:
+        if (emul_tlv_u32(apdu, kSE05x_TAG_1, &id) != 0) {
+            return SM_ERR_WRONG_DATA;
+        }
+        return emul_rsp_u8(
+            rsp, kSE05x_TAG_1, (uint8_t)(emul_obj_find(id) ? kSE05x_Result_SUCCESS : kSE05x_Result_FAILURE));
+    case kSE05x_P2_DELETE_OBJECT:
+        if (apdu->p1 == kSE05x_P1_CRYPTO_OBJ) {
+            uint16_t coId;
+            emul_crypto_obj_t *co;
+            if (emul_tlv_u16(apdu, kSE05x_TAG_1, &coId) != 0) {
+                return SM_ERR_WRONG_DATA;
+            }
+            co = emul_crypto_obj_find(coId);
+            if (co == NULL) {
+                return EMUL_SW_FILE_NOT_FOUND;
+            }
+            emul_crypto_obj_free(co);
+            return SM_OK;
+        }
+        return emul_delete_object(apdu);
+    case kSE05x_P2_DELETE_ALL:
+        emul_delete_all();
+        return SM_OK;
+    case kSE05x_P2_SESSION_CREATE:
+        return emul_create_session(apdu, rsp);
+    case kSE05x_P2_SESSION_UserID:
+        if (session == NULL) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        obj = emul_obj_find(session->authId);
+        if (obj == NULL || emul_tlv_buf(apdu, kSE05x_TAG_1, &userId, &userIdLen) != 0 || userIdLen != obj->len ||
+            CRYPTO_memcmp(userId, obj->data, userIdLen) != 0) {
+            return SM_ERR_SECURITY_STATUS;
+        }
+        session->verified = 1;
+        return SM_OK;
+    case kSE05x_P2_SESSION_CLOSE:
+        if (session != NULL) {
+            memset(session, 0, sizeof(*session));
+        }
+        return SM_OK;
+    case kSE05x_P2_SESSION_REFRESH:
+    case kSE05x_P2_SESSION_POLICY:
+        return (session != NULL) ? SM_OK : SM_ERR_CONDITIONS_NOT_SATISFIED;
+    default:
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+}
+
+/* Command wrapped in a session: session ID TLV and the inner C-APDU in TAG_1 */
+static smStatus_t emul_process_in_session(const emul_apdu_t *apdu, emul_rsp_t *rsp)
+{
+    const uint8_t *sessionId;
+    const uint8_t *inner;
+    size_t sessionIdLen;
+    size_t innerLen;
+    emul_session_t *session;
+    emul_apdu_t innerApdu;
+
+    if (emul_tlv_buf(apdu, kSE05x_TAG_SESSION_ID, &sessionId, &sessionIdLen) != 0 ||
+        sessionIdLen != EMUL_SESSION_ID_LEN || emul_tlv_buf(apdu, kSE05x_TAG_1, &inner, &innerLen) != 0) {
+        return SM_ERR_WRONG_DATA;
+    }
+    session = emul_session_find(sessionId);
+    if (session == NULL) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    if (emul_parse_apdu(inner, innerLen, &innerApdu) != 0) {
+        return SM_ERR_WRONG_LENGTH;
+    }
+    if (innerApdu.cla & CLA_GP_SECURITY_BIT) {
+        /* Applet level secure messaging, AESKey / ECKey sessions */
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    if (!session->verified && !((innerApdu.ins & kSE05x_INS_MASK_INSTRUCTION) == kSE05x_INS_MGMT &&
+                                   (innerApdu.p2 == kSE05x_P2_SESSION_UserID ||
+                                       innerApdu.p2 == kSE05x_P2_SESSION_CLOSE))) {
+        return SM_ERR_SECURITY_STATUS;
+    }
+    return emul_dispatch(&innerApdu, rsp, session);
+}
+
+/* ************************************************************************** */
+/* Dispatch                                                                   */
+/* ************************************************************************** */
+
+static smStatus_t emul_dispatch(const emul_apdu_t *apdu, emul_rsp_t *rsp, emul_session_t *session)
+{
+    uint8_t ins = apdu->ins & kSE05x_INS_MASK_INSTRUCTION;
+
+    if (apdu->cla != kSE05x_CLA) {
+        return EMUL_SW_CLA_NOT_SUPPORTED;
+    }
+    if (!gEmul.selected) {
+        return SM_ERR_CONDITIONS_NOT_SATISFIED;
+    }
+    if ((apdu->ins & kSE05x_INS_ATTEST) && ins != kSE05x_INS_WRITE) {
+        /* Attested reads are not emulated */
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+
+    switch (ins) {
+    case kSE05x_INS_WRITE:
+        switch (apdu->p1 & kSE05x_P1_MASK_CRED_TYPE) {
+        case kSE05x_P1_EC:
+            return emul_write_ec_key(apdu);
+        case kSE05x_P1_AES:
+        case kSE05x_P1_DES:
+        case kSE05x_P1_HMAC:
+            return emul_write_symm_key(apdu);
+        case kSE05x_P1_BINARY:
+            return emul_write_binary(apdu);
+        case kSE05x_P1_UserID:
+            return emul_write_userid(apdu);
+        case kSE05x_P1_COUNTER:
+            return emul_write_counter(apdu);
+        case kSE05x_P1_CURVE:
+            return emul_curve(apdu, rsp);
+        case kSE05x_P1_CRYPTO_OBJ:
+            return emul_create_crypto_obj(apdu);
+        default:
+            return EMUL_SW_INS_NOT_SUPPORTED;
+        }
+    case kSE05x_INS_READ:
+        switch (apdu->p1) {
+        case kSE05x_P1_DEFAULT:
+            switch (apdu->p2) {
+            case kSE05x_P2_DEFAULT:
+                return emul_read_object(apdu, rsp);
+            case kSE05x_P2_TYPE:
+                return emul_read_type(apdu, rsp);
+            case kSE05x_P2_SIZE:
+                return emul_read_size(apdu, rsp);
+            case kSE05x_P2_LIST:
+                return emul_read_id_list(apdu, rsp);
+            default:
+                return EMUL_SW_INS_NOT_SUPPORTED;
+            }
+        case kSE05x_P1_CURVE:
+            return emul_curve(apdu, rsp);
+        case kSE05x_P1_CRYPTO_OBJ:
+            return (apdu->p2 == kSE05x_P2_LIST) ? emul_read_crypto_obj_list(rsp) : EMUL_SW_INS_NOT_SUPPORTED;
+        default:
+            return EMUL_SW_INS_NOT_SUPPORTED;
+        }
+    case kSE05x_INS_CRYPTO:
+        switch (apdu->p1) {
+        case kSE05x_P1_SIGNATURE:
+            return (apdu->p2 == kSE05x_P2_SIGN || apdu->p2 == kSE05x_P2_VERIFY) ? emul_ecdsa(apdu, rsp) :
+                                                                                  EMUL_SW_INS_NOT_SUPPORTED;
+        case kSE05x_P1_EC:
+            return (apdu->p2 == kSE05x_P2_DH) ? emul_ecdh(apdu, rsp) : EMUL_SW_INS_NOT_SUPPORTED;
+        case kSE05x_P1_CIPHER:
+            return emul_cipher(apdu, rsp);
+        case kSE05x_P1_MAC:
+            return emul_mac(apdu, rsp);
+        case kSE05x_P1_DEFAULT:
+            return emul_digest(apdu, rsp);
+        default:
+            return EMUL_SW_INS_NOT_SUPPORTED;
+        }
+    case kSE05x_INS_MGMT:
+        if (apdu->p1 == kSE05x_P1_CURVE) {
+            return emul_curve(apdu, rsp);
+        }
+        return emul_mgmt(apdu, rsp, session);
+    case kSE05x_INS_PROCESS:
+        if (session != NULL) {
+            return SM_ERR_CONDITIONS_NOT_SATISFIED;
+        }
+        return emul_process_in_session(apdu, rsp);
+    default:
+        return EMUL_SW_INS_NOT_SUPPORTED;
+    }
+}
+
+static uint32_t emul_latency(const emul_apdu_t *apdu, size_t rspLen)
+{
+    uint8_t ins = apdu->ins;
+    uint8_t p1  = apdu->p1;
+    uint8_t p2  = (gEmul.latencyP2 != 0) ? gEmul.latencyP2 : apdu->p2;
+    const emul_latency_t *best = NULL;
+    int bestScore              = -1;
+    uint64_t us;
+    size_t i;
+
+    if (apdu->cla == kSE05x_CLA && (ins & kSE05x_INS_MASK_INSTRUCTION) <= kSE05x_INS_PROCESS) {
+        ins = ins & kSE05x_INS_MASK_INSTRUCTION;
+        if (ins == kSE05x_INS_WRITE) {
+            p1 &= kSE05x_P1_MASK_CRED_TYPE;
+        }
+    }
+    for (i = 0; i < gEmul.latencyCount; i++) {
+        const emul_latency_t *l = &gEmul.latency[i];
+        int score               = 0;
+        if ((l->ins != SE05X_EMUL_ANY && l->ins != ins) || (l->p1 != SE05X_EMUL_ANY && l->p1 != p1) ||
+            (l->p2 != SE05X_EMUL_ANY && l->p2 != p2)) {
+            continue;
+        }
+        score += (l->ins != SE05X_EMUL_ANY) ? 4 : 0;
+        score += (l->p1 != SE05X_EMUL_ANY) ? 2 : 0;
+        score += (l->p2 != SE05X_EMUL_ANY) ? 1 : 0;
+        if (score >= bestScore) {
+            best      = l;
+            bestScore = score;
+        }
+    }
+    if (best == NULL) {
+        return 0;
+    }
+    us = best->baseUs + ((uint64_t)best->perByteNs * (apdu->len + rspLen)) / 1000;
+    us = us * gEmul.latencyScale / 100;
+    return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+/* ************************************************************************** */
+/* Public Functions                                                           */
+/* ************************************************************************** */
+
+smStatus_t se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs)
+{
+    static uint8_t plain[SE05X_EMUL_MAX_RSP];
+    emul_apdu_t apdu;
+    emul_rsp_t out;
+    size_t plainLen     = 0;
+    int scp             = 0;
+    uint32_t latencyUs  = 0;
+    smStatus_t sw;
+
+    if (cmd == NULL || rsp == NULL || rspLen == NULL || *rspLen < 2) {
+        return SM_NOT_OK;
+    }
+    emul_init();
+
+    out.buf         = gEmul.rspData;
+    out.len         = 0;
+    /* Keep room for the SCP03 padding and R-MAC */
+    out.max         = sizeof(gEmul.rspData) - EMUL_SCP_KEY_LEN - SCP_COMMAND_MAC_SIZE;
+    gEmul.latencyP2 = 0;
+
+    if (emul_parse_apdu(cmd, cmdLen, &apdu) != 0) {
+        sw = SM_ERR_WRONG_LENGTH;
+    }
+    else if (apdu.cla == CLA_ISO7816 && apdu.ins == INS_GP_SELECT) {
+        sw = emul_select(&apdu, &out);
+    }
+    else if (apdu.cla == CLA_GP_7816 && apdu.ins == INS_GP_INITIALIZE_UPDATE) {
+        sw = emul_initialize_update(&apdu, &out);
+    }
+    else if (apdu.cla == (CLA_GP_7816 | CLA_GP_SECURITY_BIT) && apdu.ins == INS_GP_EXTERNAL_AUTHENTICATE) {
+        sw = emul_external_authenticate(cmd, &apdu);
+    }
+    else if (apdu.cla & CLA_GP_SECURITY_BIT) {
+        scp = 1;
+        if (gEmul.scp.state != EMUL_SCP_AUTHENTICATED) {
+            sw = SM_ERR_SECURITY_STATUS;
+        }
+        else {
+            sw = emul_scp_unwrap(cmd, &apdu, plain, &plainLen);
+            if (sw == SM_OK) {
+                sw = emul_dispatch(&apdu, &out, NULL);
+            }
+            else {
+                /* The secure channel is gone */
+                emul_scp_close();
+                scp = 0;
+            }
+        }
+    }
+    else if (gEmul.scp.state == EMUL_SCP_AUTHENTICATED) {
+        /* Plain command inside a secure channel */
+        emul_scp_close();
+        sw = SM_ERR_SECURITY_STATUS;
+    }
+    else {
+        sw = emul_dispatch(&apdu, &out, NULL);
+    }
+
+    if (sw != SM_OK) {
+        out.len = 0;
+    }
+    latencyUs = emul_latency(&apdu, out.len);
+
+    if (scp && gEmul.scp.state == EMUL_SCP_AUTHENTICATED) {
+        latencyUs += SE05X_EMUL_SCP_LATENCY_US * gEmul.latencyScale / 100;
+        if (sw == SM_OK) {
+            out.max = sizeof(gEmul.rspData);
+            sw      = emul_scp_wrap(&out, sw, plainLen);
+            if (sw != SM_OK) {
+                out.len = 0;
+            }
+        }
+        /* Same rules as se05x_DeCrypt() / nxpSCP03_Decrypt_ResponseAPDU() */
+        if (EMUL_SCP_COUNT_ALL || (sw == SM_OK && plainLen > 0) || (sw != SM_OK && plainLen != 8)) {
+            emul_scp_inc_counter();
+        }
+    }
+    OPENSSL_cleanse(plain, plainLen);
+
+    if (out.len + 2 > *rspLen) {
+        *rspLen = 0;
+        return SM_NOT_OK;
+    }
+    memcpy(rsp, out.buf, out.len);
+    rsp[out.len]     = (uint8_t)(sw >> 8);
+    rsp[out.len + 1] = (uint8_t)sw;
+    *rspLen          = out.len + 2;
+    if (pLatencyUs != NULL) {
+        *pLatencyUs = latencyUs;
+    }
+    LOG_D("emul: %02X %02X %02X %02X -> %04X, %u us", cmd[0], cmdLen > 1 ? cmd[1] : 0, cmdLen > 2 ? cmd[2] : 0,
+        cmdLen > 3 ? cmd[3] : 0, sw, latencyUs);
+    return sw;
+}
+
+void se05x_emul_reset(void)
+{
+    size_t i;
+
+    emul_init();
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        if (gEmul.obj[i].used && gEmul.obj[i].transient) {
+            emul_obj_free(&gEmul.obj[i]);
+        }
+    }
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        if (gEmul.cryptoObj[i].used) {
+            emul_crypto_obj_stop(&gEmul.cryptoObj[i]);
+        }
+    }
+    emul_close_sessions();
+    emul_scp_close();
+    gEmul.selected = 0;
+}
+
+void se05x_emul_factory_reset(void)
+{
+    const uint8_t keyEnc[] = SE05X_EMUL_KEY_ENC;
+    const uint8_t keyMac[] = SE05X_EMUL_KEY_MAC;
+    const uint8_t keyDek[] = SE05X_EMUL_KEY_DEK;
+    uint8_t uid[EMUL_UNIQUE_ID_LEN];
+    emul_object_t *obj;
+    size_t i;
+
+    gEmul.initialized = 1;
+    for (i = 0; i < SE05X_EMUL_MAX_OBJECTS; i++) {
+        emul_obj_free(&gEmul.obj[i]);
+    }
+    for (i = 0; i < EMUL_MAX_CRYPTO_OBJECTS; i++) {
+        emul_crypto_obj_free(&gEmul.cryptoObj[i]);
+    }
+    emul_close_sessions();
+    emul_scp_close();
+    gEmul.selected = 0;
+    memset(gEmul.curveSet, 0, sizeof(gEmul.curveSet));
+
+    memcpy(gEmul.keyEnc, keyEnc, sizeof(gEmul.keyEnc));
+    memcpy(gEmul.keyMac, keyMac, sizeof(gEmul.keyMac));
+    memcpy(gEmul.keyDek, keyDek, sizeof(gEmul.keyDek));
+
+    memcpy(gEmul.latency, gEmulDefaultLatency, sizeof(gEmulDefaultLatency));
+    gEmul.latencyCount = sizeof(gEmulDefaultLatency) / sizeof(gEmulDefaultLatency[0]);
+    gEmul.latencyScale = 100;
+
+    /* Trust provisioned unique ID */
+    if (RAND_bytes(uid, sizeof(uid)) == 1) {
+        obj = emul_obj_alloc(kSE05x_AppletResID_UNIQUE_ID);
+        if (obj != NULL && emul_obj_set_data(obj, uid, sizeof(uid)) == SM_OK) {
+            obj->reserved = 1;
+            obj->credType = kSE05x_P1_BINARY;
+            obj->type     = kSE05x_SecObjTyp_BINARY_FILE;
+        }
+    }
+}
+
+void se05x_emul_set_latency(uint8_t ins, uint8_t p1, uint8_t p2, uint32_t baseUs, uint32_t perByteNs)
+{
+    size_t i;
+
+    emul_init();
+    for (i = 0; i < gEmul.latencyCount; i++) {
+        if (gEmul.latency[i].ins == ins && gEmul.latency[i].p1 == p1 && gEmul.latency[i].p2 == p2) {
+            break;
+        }
+    }
+    if (i == gEmul.latencyCount) {
+        if (gEmul.latencyCount >= SE05X_EMUL_MAX_LATENCY) {
+            LOG_W("emul: latency table full");
+            return;
+        }
+        gEmul.latencyCount++;
+    }
+    gEmul.latency[i].ins       = ins;
+    gEmul.latency[i].p1        = p1;
+    gEmul.latency[i].p2        = p2;
+    gEmul.latency[i].baseUs    = baseUs;
+    gEmul.latency[i].perByteNs = perByteNs;
+}
+
+void se05x_emul_set_latency_scale(uint32_t percent)
+{
+    emul_init();
+    gEmul.latencyScale = percent;
+}
+
+void se05x_emul_set_scp03_keys(const uint8_t *enc, const uint8_t *mac, const uint8_t *dek)
+{
+    emul_init();
+    if (enc != NULL) {
+        memcpy(gEmul.keyEnc, enc, sizeof(gEmul.keyEnc));
+    }
+    if (mac != NULL) {
+        memcpy(gEmul.keyMac, mac, sizeof(gEmul.keyMac));
+    }
+    if (dek != NULL) {
+        memcpy(gEmul.keyDek, dek, sizeof(gEmul.keyDek));
+    }
+    emul_scp_close();
+}
+
+#endif /* SSS_HAVE_HOSTCRYPTO_OPENSSL */
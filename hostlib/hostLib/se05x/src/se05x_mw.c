@@ -27,6 +27,7 @@ smStatus_t Se05x_API_DeleteAll_Iterative(pSe05xSession_t session_ctx)
     size_t i;
     smStatus_t retStatus  = SM_NOT_OK;
     uint16_t outputOffset = 0;
+    session_ctx->objEpoch++;
     do {
         retStatus = Se05x_API_ReadIDList(session_ctx, outputOffset, 0xFF, &pmore, list, &listlen);
         if (retStatus != SM_OK) {
@@ -12,7 +12,10 @@
 #include "nxEnsure.h"
 #include "smCom.h"
 #include "sm_apdu.h"
+#include "sm_metrics.h"
+#include "sm_timer.h"
 #include <limits.h>
+#include <stdint.h>
 
 #ifdef FLOW_VERBOSE
 #define VERBOSE_APDU_LOGS 1
@@ -28,6 +31,11 @@
 #define SE05X_TLV_BUF_SIZE_RSP 900
 #endif
 
+/* DoAPDUTxRx_Batch() polls the command in flight in slices of this length */
+#ifndef SE05X_BATCH_WAIT_MS
+#define SE05X_BATCH_WAIT_MS 1000
+#endif
+
 int tlvSet_U8(uint8_t **buf, size_t *bufLen, SE05x_TAG_t tag, uint8_t value)
 {
     uint8_t *pBuf            = *buf;
@@ -586,6 +594,161 @@ smStatus_t DoAPDUTxRx(
     return apduStatus;
 }
 
+/* Completion of the smCom exchange of one command of DoAPDUTxRx_Batch() */
+typedef struct
+{
+    U32 status;
+    U32 rxLen;
+} se05x_batch_link_t;
+
+static void se05x_batch_link_done(void *pCbCtx, U32 status, U8 *pRx, U32 rxLen)
+{
+    se05x_batch_link_t *pLink = (se05x_batch_link_t *)pCbCtx;
+
+    AX_UNUSED_ARG(pRx);
+    pLink->status = status;
+    pLink->rxLen  = rxLen;
+}
+
+/* Wraps command ``pApdu`` into the raw C-APDU ``pTx``, as fp_TXn would
+ * send it. 0 if the command cannot be wrapped ahead: with SCP03 or a
+ * tunnel, the wrapping depends on the previous command. */
+static size_t se05x_batch_prepare(Se05xSession_t *pSessionCtx, Se05xBatchApdu_t *pApdu, uint8_t *pTx, size_t txBufLen)
+{
+    smStatus_t ret = SM_NOT_OK;
+
+#if SSS_HAVE_APPLET_SE05X_IOT
+    if ((pSessionCtx->fp_Transform == &se05x_Transform) && (pSessionCtx->fp_RawTXn != NULL) &&
+        (pSessionCtx->pChannelCtx == NULL) && (pSessionCtx->pdynScp03Ctx == NULL) &&
+        (pSessionCtx->authType != kSSS_AuthType_SCP03) && (txBufLen > SE05X_APDU_FRAME_HDR_MAX)) {
+        size_t txLen       = 0;
+        tlvHeader_t outHdr = {
+            0,
+        };
+        SM_METRICS_START(phaseStartUs);
+        /* Wrapped behind the room for the APDU header, framed in place */
+        txLen = txBufLen - SE05X_APDU_FRAME_HDR_MAX;
+        ret   = se05x_Transform(pSessionCtx,
+            &pApdu->hdr,
+            pApdu->cmdBuf,
+            pApdu->cmdBufLen,
+            &outHdr,
+            &pTx[SE05X_APDU_FRAME_HDR_MAX],
+            &txLen,
+            pApdu->hasle);
+        if (ret == SM_OK) {
+            ret = se05x_FrameApdu(&outHdr, &pTx[SE05X_APDU_FRAME_HDR_MAX], txLen, pApdu->hasle, pTx, &txBufLen);
+        }
+        SM_METRICS_PHASE(SM_METRICS_PHASE_WRAP, pApdu->hdr.hdr, phaseStartUs);
+    }
+    if ((ret != SM_OK) || (txBufLen > 0xFFFFu)) {
+        return 0;
+    }
+    return txBufLen;
+#else
+    AX_UNUSED_ARG(pSessionCtx);
+    AX_UNUSED_ARG(pApdu);
+    AX_UNUSED_ARG(pTx);
+    AX_UNUSED_ARG(txBufLen);
+    AX_UNUSED_ARG(ret);
+    return 0;
+#endif
+}
+
+smStatus_t DoAPDUTxRx_Batch(Se05xSession_t *pSessionCtx,
+    Se05xBatchApdu_t *pApdus,
+    size_t apduCount,
+    uint8_t stopOnError,
+    fp_Se05xBatchApduDone_t fpDone,
+    void *pDoneCtx)
+{
+    smStatus_t batchStatus = SM_OK;
+    /* Scratch responses for the commands that only need the SW, and the
+     * wrapped commands. Command i uses slot i % 2, command i + 1 is wrapped
+     * into the other one while command i is in flight. */
+    uint8_t rxBuf[2][SE05X_TLV_BUF_SIZE_RSP + 2];
+    uint8_t txBuf[2][SE05X_TLV_BUF_SIZE_CMD];
+    size_t txLen[2] = {0, 0};
+    int async       = 1;
+    size_t i;
+
+    if ((pSessionCtx == NULL) || (pSessionCtx->fp_TXn == NULL) || ((pApdus == NULL) && (apduCount > 0))) {
+        return SM_NOT_OK;
+    }
+
+    for (i = 0; i < apduCount; i++) {
+        pApdus[i].status = SM_NOT_OK;
+    }
+
+    if (apduCount > 0) {
+        txLen[0] = se05x_batch_prepare(pSessionCtx, &pApdus[0], txBuf[0], sizeof(txBuf[0]));
+    }
+    for (i = 0; i < apduCount; i++) {
+        Se05xBatchApdu_t *pApdu = &pApdus[i];
+        uint8_t *rsp            = pApdu->rspBuf;
+        size_t rspLen           = pApdu->rspBufLen;
+        size_t slot             = i % 2;
+        se05x_batch_link_t link = {SMCOM_SND_FAILED, 0};
+        U32 ret                 = SMCOM_NO_PRIOR_INIT;
+        SM_METRICS_START(startUs);
+
+        if (rsp == NULL) {
+            rsp    = rxBuf[slot];
+            rspLen = sizeof(rxBuf[slot]);
+        }
+        if (async && (txLen[slot] > 0)) {
+            ret = smCom_TransceiveRawAsync(pSessionCtx->conn_ctx,
+                txBuf[slot],
+                (U16)txLen[slot],
+                rsp,
+                (U32)rspLen,
+                &se05x_batch_link_done,
+                &link);
+            /* No asynchronous transport, or it is busy: no use wrapping ahead */
+            async = (ret == SMCOM_OK);
+        }
+        if (async && (i + 1 < apduCount)) {
+            /* The SE processes command i, meanwhile wrap command i + 1 */
+            txLen[1 - slot] =
+                se05x_batch_prepare(pSessionCtx, &pApdus[i + 1], txBuf[1 - slot], sizeof(txBuf[1 - slot]));
+        }
+        if (ret == SMCOM_OK) {
+            while (smCom_AsyncWait(pSessionCtx->conn_ctx, SE05X_BATCH_WAIT_MS) == SMCOM_PENDING) {
+                /* The T=1 layer ends the exchange, by its own timeout at the latest */
+            }
+            /* Unwrapped as by fp_TXn */
+            SM_METRICS_START(phaseStartUs);
+            rspLen        = link.rxLen;
+            pApdu->status = (smStatus_t)link.status;
+            if (pSessionCtx->fp_DeCrypt != NULL) {
+                pApdu->status = pSessionCtx->fp_DeCrypt(pSessionCtx, pApdu->cmdBufLen, rsp, &rspLen, pApdu->hasle);
+            }
+            SM_METRICS_PHASE(SM_METRICS_PHASE_UNWRAP, pApdu->hdr.hdr, phaseStartUs);
+            SM_METRICS_APDU(
+                pApdu->hdr.hdr, startUs, txLen[slot], (pApdu->status == SM_OK) ? rsp : NULL, rspLen);
+        }
+        else {
+            /* Not wrapped ahead, or no asynchronous transport */
+            pApdu->status = pSessionCtx->fp_TXn(
+                pSessionCtx, &pApdu->hdr, pApdu->cmdBuf, pApdu->cmdBufLen, rsp, &rspLen, pApdu->hasle);
+        }
+        pApdu->rspBufLen = (pApdu->rspBuf == NULL) ? 0 : rspLen;
+
+        if (fpDone != NULL) {
+            fpDone(pDoneCtx, i, pApdu);
+        }
+        if (pApdu->status != SM_OK) {
+            if (batchStatus == SM_OK) {
+                batchStatus = pApdu->status;
+            }
+            if (stopOnError) {
+                break;
+            }
+        }
+    }
+    return batchStatus;
+}
+
 #if SSS_HAVE_APPLET_SE05X_IOT
 int tlvSet_u8buf_I2CM(uint8_t **buf, size_t *bufLen, SE05x_I2CM_TAG_t tag, const uint8_t *cmd, size_t cmdLen)
 {
@@ -713,6 +876,48 @@ smStatus_t se05x_Transform(struct Se05xSession *pSession,
     return SM_OK;
 }
 
+smStatus_t se05x_FrameApdu(
+    const tlvHeader_t *hdr, const uint8_t *cmdBuf, size_t cmdBufLen, uint8_t hasle, uint8_t *txBuf, size_t *ptxBufLen)
+{
+    size_t i       = 0;
+    smStatus_t ret = SM_NOT_OK;
+
+    ENSURE_OR_GO_EXIT(*ptxBufLen >= SE05X_APDU_FRAME_HDR_MAX + 2);
+    ENSURE_OR_GO_EXIT(cmdBufLen <= *ptxBufLen - (SE05X_APDU_FRAME_HDR_MAX + 2));
+    if (cmdBufLen > 0) {
+        // The Lc field must be extended in case the length does not fit
+        // into a single byte (Note, while the standard would allow to
+        // encode 0x100 as 0x00 in the Lc field, nobody who is sane in his mind
+        // would actually do that).
+        i = sizeof(*hdr) + (((cmdBufLen < 0xFF) && !hasle) ? 1 : 3);
+        /* Data first, it may lie where the header goes */
+        memmove(&txBuf[i], cmdBuf, cmdBufLen);
+        if ((cmdBufLen < 0xFF) && !hasle) {
+            txBuf[sizeof(*hdr)] = (uint8_t)cmdBufLen;
+        }
+        else {
+            txBuf[sizeof(*hdr)]     = 0x00;
+            txBuf[sizeof(*hdr) + 1] = 0xFFu & (cmdBufLen >> 8);
+            txBuf[sizeof(*hdr) + 2] = 0xFFu & (cmdBufLen);
+        }
+        i += cmdBufLen;
+    }
+    else {
+        i          = sizeof(*hdr);
+        txBuf[i++] = 0x00;
+    }
+    memcpy(&txBuf[0], hdr, sizeof(*hdr));
+
+    if (hasle) {
+        txBuf[i++] = 0x00;
+        txBuf[i++] = 0x00;
+    }
+    *ptxBufLen = i;
+    ret        = SM_OK;
+exit:
+    return ret;
+}
+
 smStatus_t se05x_DeCrypt(
     struct Se05xSession *pSessionCtx, size_t cmd_cmacLen, uint8_t *rsp, size_t *rspLength, uint8_t hasle)
 {
@@ -765,18 +970,21 @@ smStatus_t se05x_Transform_scp(struct Se05xSession *pSession,
     uint8_t macToAdd[16]    = {0};
     size_t macLen           = 16;
     size_t i                = 0;
+    size_t encRoom          = 0;
 
     Se05xApdu_t se05xApdu = {0};
 
     se05xApdu.se05xTxBuf    = txBuf;
     se05xApdu.se05xTxBufLen = *ptxBufLen;
     se05xApdu.se05xCmd_hdr  = hdr;
-    se05xApdu.se05xCmd      = cmdApduBuf;
-    se05xApdu.se05xCmdLen   = cmdApduBufLen;
 
-    /*Encrypt the Tx APDU */
-    sss_status = nxSCP03_Encrypt_CommandAPDU(pSession->pdynScp03Ctx, se05xApdu.se05xCmd, &(se05xApdu.se05xCmdLen));
-    ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
+    /* The command is encrypted straight into its final place in txBuf.
+     * Lay out the wrapped header first, with the length it will have once padded. */
+    ENSURE_OR_GO_CLEANUP(cmdApduBufLen < (SIZE_MAX - SCP_KEY_SIZE));
+    se05xApdu.se05xCmdLen = SCP_PADDED_LEN(cmdApduBufLen);
+    /* Add CMAC Length in SE05X command LC */
+    se05xApdu.se05xCmdLC  = se05xApdu.se05xCmdLen + SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
+    se05xApdu.se05xCmdLCW = (se05xApdu.se05xCmdLC == 0) ? 0 : (((se05xApdu.se05xCmdLC < 0xFF) && !(hasle)) ? 1 : 3);
 
     if (pSession->hasSession) {
 #if SSSFTR_SE05X_AuthECKey || SSSFTR_SE05X_AuthSession
@@ -787,10 +995,6 @@ smStatus_t se05x_Transform_scp(struct Se05xSession *pSession,
         outhdr->hdr[2] = kSE05x_P1_DEFAULT;
         outhdr->hdr[3] = kSE05x_P2_DEFAULT;
 
-        /* Add CMAC Length in SE05X command LC */
-        se05xApdu.se05xCmdLC  = se05xApdu.se05xCmdLen + SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
-        se05xApdu.se05xCmdLCW = (se05xApdu.se05xCmdLC == 0) ? 0 : (((se05xApdu.se05xCmdLC < 0xFF) && !(hasle)) ? 1 : 3);
-
         se05xApdu.wsSe05x_tag1Len = sizeof(*(se05xApdu.se05xCmd_hdr)) + se05xApdu.se05xCmdLCW + se05xApdu.se05xCmdLC;
         se05xApdu.wsSe05x_tag1W   = ((se05xApdu.wsSe05x_tag1Len <= 0x7F) ? 1 :
                                      (se05xApdu.wsSe05x_tag1Len <= 0xFF) ? 2 :
@@ -799,6 +1003,10 @@ smStatus_t se05x_Transform_scp(struct Se05xSession *pSession,
         se05xApdu.wsSe05x_cmd = se05xApdu.se05xTxBuf;
         uint8_t *wsCmd        = se05xApdu.wsSe05x_cmd;
 
+        /* Session ID TLV and TAG_1 header */
+        if ((2 + sizeof(pSession->value) + 1 + se05xApdu.wsSe05x_tag1W) > *ptxBufLen) {
+            goto cleanup;
+        }
         wsCmd[i++] = kSE05x_TAG_SESSION_ID;
         wsCmd[i++] = sizeof(pSession->value);
         memcpy(&wsCmd[i], pSession->value, sizeof(pSession->value));
@@ -818,82 +1026,59 @@ smStatus_t se05x_Transform_scp(struct Se05xSession *pSession,
             wsCmd[i++] = (uint8_t)((se05xApdu.wsSe05x_tag1Len >> 8) & 0xFF);
             wsCmd[i++] = (uint8_t)((se05xApdu.wsSe05x_tag1Len) & 0xFF);
         }
-
-        if (i > *ptxBufLen) {
-            goto cleanup;
-        }
         se05xApdu.wsSe05x_tag1Cmd = &wsCmd[i];
         se05xApdu.wsSe05x_tag1CmdLen =
             sizeof(*(se05xApdu.se05xCmd_hdr)) + se05xApdu.se05xCmdLCW + se05xApdu.se05xCmdLen;
-
-        memcpy(&wsCmd[i], se05xApdu.se05xCmd_hdr, sizeof(*(se05xApdu.se05xCmd_hdr)));
-        /* Pad CLA byte with 0x04 to indicate use of SCP03*/
-        wsCmd[i] |= 0x04;
-        i += sizeof(*(se05xApdu.se05xCmd_hdr));
-
-        // In case there is a payload, indicate how long it is
-        // in Lc in the header. Do not include an Lc in case there
-        //is no payload.
-        if (se05xApdu.se05xCmdLCW > 0) {
-            // The Lc field must be extended in case the length does not fit
-            // into a single byte (Note, while the standard would allow to
-            // encode 0x100 as 0x00 in the Lc field, nobody who is sane in his mind
-            // would actually do that).
-            if (se05xApdu.se05xCmdLCW == 1) {
-                wsCmd[i++] = (uint8_t)se05xApdu.se05xCmdLC;
-            }
-            else {
-                wsCmd[i++] = 0x00;
-                wsCmd[i++] = 0xFFu & (se05xApdu.se05xCmdLC >> 8);
-                wsCmd[i++] = 0xFFu & (se05xApdu.se05xCmdLC);
-            }
-        }
-        memcpy(&wsCmd[i], se05xApdu.se05xCmd, se05xApdu.se05xCmdLen);
-        ENSURE_OR_GO_CLEANUP((UINT_MAX - i) >= se05xApdu.se05xCmdLen);
-        i += se05xApdu.se05xCmdLen;
-        se05xApdu.wsSe05x_cmdLen = i;
-        se05xApdu.dataToMac      = se05xApdu.wsSe05x_tag1Cmd;
-        se05xApdu.dataToMacLen   = se05xApdu.wsSe05x_tag1CmdLen;
+#else
+        goto cleanup;
 #endif
     }
-    else {
-        /* If there is no session create the tx buffer with SE05X command only*/
-        se05xApdu.se05xCmdLC  = se05xApdu.se05xCmdLen + SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
-        se05xApdu.se05xCmdLCW = (se05xApdu.se05xCmdLC == 0) ? 0 : (((se05xApdu.se05xCmdLC < 0xFF) && !(hasle)) ? 1 : 3);
-
-        se05xApdu.dataToMac = &txBuf[i]; /* Mac is calculated from this data */
-        ENSURE_OR_GO_CLEANUP((UINT_MAX - se05xApdu.se05xCmdLCW) >= se05xApdu.se05xCmdLC);
-        se05xApdu.dataToMacLen = sizeof(*(se05xApdu.se05xCmd_hdr)) + se05xApdu.se05xCmdLCW + se05xApdu.se05xCmdLC -
-                                 SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
-        ENSURE_OR_GO_CLEANUP(se05xApdu.dataToMacLen > 0);
-
-        memcpy(&txBuf[i], se05xApdu.se05xCmd_hdr, sizeof(*se05xApdu.se05xCmd_hdr));
-        txBuf[i] |= 0x4;
-        if ((UINT_MAX - i) < sizeof(*se05xApdu.se05xCmd_hdr)) {
-            goto cleanup;
-        }
-        i += sizeof(*se05xApdu.se05xCmd_hdr);
 
-        if (se05xApdu.se05xCmdLCW > 0) {
-            if (se05xApdu.se05xCmdLCW == 1) {
-                txBuf[i++] = (uint8_t)se05xApdu.se05xCmdLC;
-            }
-            else {
-                txBuf[i++] = 0x00;
-                txBuf[i++] = 0xFFu & (se05xApdu.se05xCmdLC >> 8);
-                txBuf[i++] = 0xFFu & (se05xApdu.se05xCmdLC);
-            }
+    /* Room for header, Lc, encrypted payload, MAC and Le */
+    if ((*ptxBufLen - i) < (sizeof(*se05xApdu.se05xCmd_hdr) + se05xApdu.se05xCmdLCW + se05xApdu.se05xCmdLC + 2)) {
+        goto cleanup;
+    }
+
+    se05xApdu.dataToMac = &txBuf[i]; /* Mac is calculated from this data */
+    memcpy(&txBuf[i], se05xApdu.se05xCmd_hdr, sizeof(*se05xApdu.se05xCmd_hdr));
+    /* Pad CLA byte with 0x04 to indicate use of SCP03*/
+    txBuf[i] |= 0x4;
+    i += sizeof(*se05xApdu.se05xCmd_hdr);
+
+    // In case there is a payload, indicate how long it is
+    // in Lc in the header. Do not include an Lc in case there
+    //is no payload.
+    if (se05xApdu.se05xCmdLCW > 0) {
+        // The Lc field must be extended in case the length does not fit
+        // into a single byte (Note, while the standard would allow to
+        // encode 0x100 as 0x00 in the Lc field, nobody who is sane in his mind
+        // would actually do that).
+        if (se05xApdu.se05xCmdLCW == 1) {
+            txBuf[i++] = (uint8_t)se05xApdu.se05xCmdLC;
+        }
+        else {
+            txBuf[i++] = 0x00;
+            txBuf[i++] = 0xFFu & (se05xApdu.se05xCmdLC >> 8);
+            txBuf[i++] = 0xFFu & (se05xApdu.se05xCmdLC);
         }
-        memcpy(&txBuf[i], se05xApdu.se05xCmd, se05xApdu.se05xCmdLen);
-        i += se05xApdu.se05xCmdLen;
     }
 
+    /*Encrypt the Tx APDU, from cmdApduBuf into txBuf */
+    se05xApdu.se05xCmd = &txBuf[i];
+    encRoom            = *ptxBufLen - i;
+    sss_status         = nxSCP03_Encrypt_CommandAPDU_To(
+        pSession->pdynScp03Ctx, cmdApduBuf, cmdApduBufLen, se05xApdu.se05xCmd, &encRoom);
+    ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
+    ENSURE_OR_GO_CLEANUP(encRoom == se05xApdu.se05xCmdLen);
+    i += se05xApdu.se05xCmdLen;
+    se05xApdu.wsSe05x_cmdLen = i;
+    se05xApdu.dataToMacLen   = (size_t)(&txBuf[i] - se05xApdu.dataToMac);
+
     ///*Calculate MAC over encrypted APDU */
     sss_status = nxpSCP03_CalculateMac_CommandAPDU(
         pSession->pdynScp03Ctx, se05xApdu.dataToMac, se05xApdu.dataToMacLen, macToAdd, &macLen);
     ENSURE_OR_GO_CLEANUP(sss_status == kStatus_SSS_Success);
     memcpy(&txBuf[i], macToAdd, SCP_GP_IU_CARD_CRYPTOGRAM_LEN);
-    ENSURE_OR_GO_CLEANUP((UINT_MAX - i) >= SCP_GP_IU_CARD_CRYPTOGRAM_LEN);
     i += SCP_GP_IU_CARD_CRYPTOGRAM_LEN;
 
     if (!pSession->hasSession) {
@@ -1521,6 +1521,9 @@ smStatus_t Se05x_API_CreateECCurve(pSe05xSession_t session_ctx, SE05x_ECCurve_t
         goto cleanup;
     }
     retStatus = DoAPDUTx_s_Case3(session_ctx, &hdr, cmdbuf, cmdbufLen);
+    if (retStatus == SM_OK) {
+        session_ctx->ecCurveBitmap |= SE05X_EC_CURVE_BIT(curveID);
+    }
 
 cleanup:
     return retStatus;
@@ -1644,6 +1647,13 @@ smStatus_t Se05x_API_DeleteECCurve(pSe05xSession_t session_ctx, SE05x_ECCurve_t
         goto cleanup;
     }
     retStatus = DoAPDUTx_s_Case3(session_ctx, &hdr, cmdbuf, cmdbufLen);
+    if (retStatus == SM_OK) {
+        session_ctx->ecCurveBitmap &= ~SE05X_EC_CURVE_BIT(curveID);
+    }
+    else {
+        /* Not known what is left on the SE */
+        session_ctx->ecCurveBitmap = 0;
+    }
 
 cleanup:
     return retStatus;
@@ -3926,6 +3936,8 @@ smStatus_t Se05x_API_DeleteAll(pSe05xSession_t session_ctx)
     nLog("APDU", NX_LEVEL_DEBUG, "DeleteAll []");
 #endif /* VERBOSE_APDU_LOGS */
     retStatus = DoAPDUTx_s_Case3(session_ctx, &hdr, cmdbuf, cmdbufLen);
+    session_ctx->ecCurveBitmap = 0;
+    session_ctx->objEpoch++;
     return retStatus;
 }
 // LCOV_EXCL_STOP
\ No newline at end of file
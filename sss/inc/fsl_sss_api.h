@@ -584,6 +584,34 @@ typedef struct
         uint8_t data[SSS_SYMMETRIC_MAX_CONTEXT_SIZE];
     } extension;
 } sss_symmetric_t;
+
+/** @brief One message of a batch operation
+ *
+ * Used by @ref sss_cipher_one_go_batch, @ref sss_mac_one_go_batch and
+ * @ref sss_digest_one_go_batch.
+ */
+typedef struct
+{
+    /** Key for this message, NULL to use the key of the context.
+     * Not used for digest. */
+    sss_object_t *keyObject;
+    /** Initialization Vector, cipher only. Handled as for @ref sss_cipher_one_go */
+    uint8_t *iv;
+    /** Length of iv in bytes */
+    size_t ivLen;
+    /** Input data */
+    const uint8_t *srcData;
+    /** Length of srcData in bytes */
+    size_t srcLen;
+    /** Output data: cipher / plain text, MAC or digest.
+     * With kMode_SSS_Mac_Validate, the MAC to be validated. */
+    uint8_t *destData;
+    /** [in,out] Size of destData on entry, length of the output on return.
+     * With kMode_SSS_Mac_Validate, the length of the MAC. */
+    size_t destLen;
+    /** Status of this message */
+    sss_status_t status;
+} sss_batch_item_t;
 /** @} */
 
 /**
@@ -1205,6 +1233,23 @@ sss_status_t sss_cipher_one_go_v2(sss_symmetric_t *context,
     uint8_t *destData,
     size_t *dataLen);
 
+/** @brief Symmetric cipher of several independent messages in one blocking function call.
+ *  Same as calling @ref sss_cipher_one_go_v2 for each item, the key of an item
+ *  replacing the key of the context for that item. Key setup is only done again
+ *  when the key changes from one item to the next.
+ *
+ * All items are processed, the status of each one is set in its status field.
+ *
+ * @param context Pointer to symmetric crypto context.
+ * @param items Messages to process.
+ * @param itemCount Number of entries in items.
+ * @returns Status of the operation
+ * @retval #kStatus_SSS_Success All items were processed successfully.
+ * @retval #kStatus_SSS_InvalidArgument One of the arguments is invalid for the function to execute.
+ * @return Otherwise the status of the first failing item.
+ */
+sss_status_t sss_cipher_one_go_batch(sss_symmetric_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @brief Symmetric cipher init.
  *  The function starts the symmetric cipher operation.
  *
@@ -1385,6 +1430,10 @@ sss_status_t sss_aead_update_aad(sss_aead_t *context, const uint8_t *aadData, si
  * The integration check is done by @ref sss_aead_finish(). Until then it is not sure if the decrypt data is
  * authentic.
  *
+ * AES-CCM decryption outputs nothing here, on every backend. The whole plain text is returned by
+ * @ref sss_aead_finish() once the tag has been verified, so its destData must hold the complete payload.
+ * AES-CCM encryption outputs the cipher text as the data comes in.
+ *
  * @param context Pointer to aead crypto context.
  * @param srcData Buffer containing the input data.
  * @param srcLen Length of the input data in bytes.
@@ -1405,6 +1454,8 @@ sss_status_t sss_aead_update(
  * srcData. It finalizes the AEAD operations and computes the tag (encryption) or compares the computed tag with the
  * tag supplied in the parameter (decryption).
  *
+ * For AES-CCM decryption destData receives the complete plain text, and only if the tag matches.
+ *
  * @param context Pointer to aead crypto context.
  * @param srcData Buffer containing final chunk of input data.
  * @param srcLen Length of final chunk of input data in bytes.
@@ -1476,6 +1527,22 @@ sss_status_t sss_digest_context_init(
 sss_status_t sss_digest_one_go(
     sss_digest_t *context, const uint8_t *message, size_t messageLen, uint8_t *digest, size_t *digestLen);
 
+/** @brief Message digest of several independent messages in one blocking function call.
+ *  Same as calling @ref sss_digest_one_go for each item.
+ *
+ * All items are processed, the status of each one is set in its status field.
+ *
+ * @param context Pointer to digest context.
+ * @param items Messages to process. keyObject, iv and ivLen are not used.
+ * @param itemCount Number of entries in items.
+ *
+ * @returns Status of the operation
+ * @retval #kStatus_SSS_Success All items were processed successfully.
+ * @retval #kStatus_SSS_InvalidArgument One of the arguments is invalid for the function to execute.
+ * @return Otherwise the status of the first failing item.
+ */
+sss_status_t sss_digest_one_go_batch(sss_digest_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @brief Init digest for a message.
  *  The function blocks current thread until the operation completes or an error occurs.
  *
@@ -1563,6 +1630,25 @@ sss_status_t sss_mac_context_init(
 sss_status_t sss_mac_one_go(
     sss_mac_t *context, const uint8_t *message, size_t messageLen, uint8_t *mac, size_t *macLen);
 
+/** @brief Message MAC of several independent messages in one blocking function call.
+ *  Same as calling @ref sss_mac_one_go for each item, the key of an item
+ *  replacing the key of the context for that item. Key setup is only done again
+ *  when the key changes from one item to the next.
+ *
+ * All items are processed, the status of each one is set in its status field.
+ * With kMode_SSS_Mac_Validate, an item whose MAC does not match gets kStatus_SSS_Fail.
+ *
+ * @param context Pointer to mac context.
+ * @param items Messages to process. iv and ivLen are not used.
+ * @param itemCount Number of entries in items.
+ *
+ * @returns Status of the operation
+ * @retval #kStatus_SSS_Success All items were processed successfully.
+ * @retval #kStatus_SSS_InvalidArgument One of the arguments is invalid for the function to execute.
+ * @return Otherwise the status of the first failing item.
+ */
+sss_status_t sss_mac_one_go_batch(sss_mac_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @brief Init mac for a message.
  *  The function blocks current thread until the operation completes or an error occurs.
  *
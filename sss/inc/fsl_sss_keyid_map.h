@@ -44,6 +44,18 @@
 
 #define KEYSTORE_MAGIC (0xA71C401L)
 #define KEYSTORE_VERSION (0x0004)
+
+/* Keep persistent keys of the host crypto key stores in one memory mapped
+ * file (sss_ks.bin) instead of one file per key plus sss_fat.bin.
+ * POSIX only. */
+#ifndef SSS_KS_MMAP
+#define SSS_KS_MMAP 0
+#endif
+
+/* With SSS_KS_MMAP, how many persistent objects can be loaded at a time */
+#ifndef KS_MMAP_MAX_LOADED
+#define KS_MMAP_MAX_LOADED 256
+#endif
 /* ************************************************************************** */
 /* Structrues and Typedefs                                                    */
 /* ************************************************************************** */
@@ -179,4 +191,54 @@ void ks_sw_getKeyFileName(
     char *const file_name, const size_t size, const sss_object_t *sss_key, const char *root_folder);
 sss_status_t ks_sw_fat_load(const char *szRootPath, keyStoreTable_t *pKeystore_shadow);
 
+#if SSS_KS_MMAP
+/** Single file key store, indexed by extKeyId.
+ *
+ * Records are appended. ks_mmap_commit() makes everything written so far
+ * durable, records written after the last commit are dropped at the next
+ * open. Not thread safe, like the FAT based key store. */
+typedef struct _ks_mmap_t ks_mmap_t;
+
+/** Open or create szRootPath/sss_ks.bin
+ *
+ * When sss_ks.bin does not exist yet, the keys of a FAT based key store in
+ * szRootPath (sss_fat.bin and its key files) are imported into it. */
+sss_status_t ks_mmap_open(ks_mmap_t **ppStore, const char *szRootPath);
+
+void ks_mmap_close(ks_mmap_t *pStore);
+
+/** Add or replace the key extKeyId.
+ *
+ * Nothing is written if the stored record is the same, so that saving a
+ * whole key store only appends the keys that changed. */
+sss_status_t ks_mmap_put(
+    ks_mmap_t *pStore, uint32_t extKeyId, uint8_t keyPart, uint8_t cipherType, const uint8_t *data, size_t dataLen);
+
+/** Look up extKeyId.
+ *
+ * ppData points into the mapped file, it is valid until the next
+ * ks_mmap_put / ks_mmap_remove / ks_mmap_compact / ks_mmap_close. */
+sss_status_t ks_mmap_get(ks_mmap_t *pStore,
+    uint32_t extKeyId,
+    uint8_t *pKeyPart,
+    uint8_t *pCipherType,
+    const uint8_t **ppData,
+    size_t *pDataLen);
+
+/** Remove extKeyId, fails if it is not there */
+sss_status_t ks_mmap_remove(ks_mmap_t *pStore, uint32_t extKeyId);
+
+/** Make the records written so far durable */
+sss_status_t ks_mmap_commit(ks_mmap_t *pStore);
+
+/** Rewrite the file with only the current keys. Needs a commit first.
+ *
+ * On failure the store may be closed, it must then only be passed to
+ * ks_mmap_close(). */
+sss_status_t ks_mmap_compact(ks_mmap_t *pStore);
+
+/** Number of keys */
+size_t ks_mmap_count(ks_mmap_t *pStore);
+#endif /* SSS_KS_MMAP */
+
 #endif /* SSS_INC_KEYID_MAP_H_ */
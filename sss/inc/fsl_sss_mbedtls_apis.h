@@ -265,6 +265,16 @@ sss_status_t sss_mbedtls_key_store_erase_key(sss_mbedtls_key_store_t *keyStore,
  */
 void sss_mbedtls_key_store_context_free(sss_mbedtls_key_store_t *keyStore);
 
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0 && defined(MBEDTLS_FS_IO)
+/** Free all parsed keys kept by the key cache.
+ *
+ * Keys still referenced by a key object are freed with that object.
+ * Entries are dropped when a key is saved or erased through this process,
+ * call this when the key store may have been changed by another one.
+ */
+void sss_mbedtls_pk_cache_flush(void);
+#endif
+
 /*! @} */ /* end of : sss_mbedtls_keystore */
 
 /**
@@ -345,6 +355,12 @@ sss_status_t sss_mbedtls_cipher_one_go_v2(sss_mbedtls_symmetric_t *context,
     uint8_t *destData,
     size_t *pDataLen);
 
+/** @copydoc sss_cipher_one_go_batch
+ *
+ */
+sss_status_t sss_mbedtls_cipher_one_go_batch(
+    sss_mbedtls_symmetric_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_cipher_init
  *
  */
@@ -461,6 +477,11 @@ sss_status_t sss_mbedtls_mac_context_init(sss_mbedtls_mac_t *context,
 sss_status_t sss_mbedtls_mac_one_go(
     sss_mbedtls_mac_t *context, const uint8_t *message, size_t messageLen, uint8_t *mac, size_t *macLen);
 
+/** @copydoc sss_mac_one_go_batch
+ *
+ */
+sss_status_t sss_mbedtls_mac_one_go_batch(sss_mbedtls_mac_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_mac_init
  *
  */
@@ -499,6 +520,11 @@ sss_status_t sss_mbedtls_digest_context_init(
 sss_status_t sss_mbedtls_digest_one_go(
     sss_mbedtls_digest_t *context, const uint8_t *message, size_t messageLen, uint8_t *digest, size_t *digestLen);
 
+/** @copydoc sss_digest_one_go_batch
+ *
+ */
+sss_status_t sss_mbedtls_digest_one_go_batch(sss_mbedtls_digest_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_digest_init
  *
  */
@@ -636,6 +662,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_cipher_one_go(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen),(srcData),(destData),(dataLen))
 #       define sss_cipher_one_go_v2(context,iv,ivLen,srcData,srcLen,destData,pDataLen) \
             sss_mbedtls_cipher_one_go_v2(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen),(srcData),(srcLen),(destData),(pDataLen))
+#       define sss_cipher_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_cipher_one_go_batch(((sss_mbedtls_symmetric_t * ) context),(items),(itemCount))
 #       define sss_cipher_init(context,iv,ivLen) \
             sss_mbedtls_cipher_init(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen))
 #       define sss_cipher_update(context,srcData,srcLen,destData,destLen) \
@@ -666,6 +694,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_mac_context_init(((sss_mbedtls_mac_t * ) context),((sss_mbedtls_session_t * ) session),((sss_mbedtls_object_t * ) keyObject),(algorithm),(mode))
 #       define sss_mac_one_go(context,message,messageLen,mac,macLen) \
             sss_mbedtls_mac_one_go(((sss_mbedtls_mac_t * ) context),(message),(messageLen),(mac),(macLen))
+#       define sss_mac_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_mac_one_go_batch(((sss_mbedtls_mac_t * ) context),(items),(itemCount))
 #       define sss_mac_init(context) \
             sss_mbedtls_mac_init(((sss_mbedtls_mac_t * ) context))
 #       define sss_mac_update(context,message,messageLen) \
@@ -679,6 +709,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_digest_context_init(((sss_mbedtls_digest_t * ) context),((sss_mbedtls_session_t * ) session),(algorithm),(mode))
 #       define sss_digest_one_go(context,message,messageLen,digest,digestLen) \
             sss_mbedtls_digest_one_go(((sss_mbedtls_digest_t * ) context),(message),(messageLen),(digest),(digestLen))
+#       define sss_digest_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_digest_one_go_batch(((sss_mbedtls_digest_t * ) context),(items),(itemCount))
 #       define sss_digest_init(context) \
             sss_mbedtls_digest_init(((sss_mbedtls_digest_t * ) context))
 #       define sss_digest_update(context,message,messageLen) \
@@ -784,6 +816,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_cipher_one_go(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen),(srcData),(destData),(dataLen))
 #       define sss_host_cipher_one_go_v2(context,iv,ivLen,srcData,srcLen,destData,pDataLen) \
             sss_mbedtls_cipher_one_go_v2(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen),(srcData),(srcLen),(destData),(pDataLen))
+#       define sss_host_cipher_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_cipher_one_go_batch(((sss_mbedtls_symmetric_t * ) context),(items),(itemCount))
 #       define sss_host_cipher_init(context,iv,ivLen) \
             sss_mbedtls_cipher_init(((sss_mbedtls_symmetric_t * ) context),(iv),(ivLen))
 #       define sss_host_cipher_update(context,srcData,srcLen,destData,destLen) \
@@ -814,6 +848,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_mac_context_init(((sss_mbedtls_mac_t * ) context),((sss_mbedtls_session_t * ) session),((sss_mbedtls_object_t * ) keyObject),(algorithm),(mode))
 #       define sss_host_mac_one_go(context,message,messageLen,mac,macLen) \
             sss_mbedtls_mac_one_go(((sss_mbedtls_mac_t * ) context),(message),(messageLen),(mac),(macLen))
+#       define sss_host_mac_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_mac_one_go_batch(((sss_mbedtls_mac_t * ) context),(items),(itemCount))
 #       define sss_host_mac_init(context) \
             sss_mbedtls_mac_init(((sss_mbedtls_mac_t * ) context))
 #       define sss_host_mac_update(context,message,messageLen) \
@@ -827,6 +863,8 @@ sss_status_t sss_mbedtls_rng_context_free(sss_mbedtls_rng_context_t *context);
             sss_mbedtls_digest_context_init(((sss_mbedtls_digest_t * ) context),((sss_mbedtls_session_t * ) session),(algorithm),(mode))
 #       define sss_host_digest_one_go(context,message,messageLen,digest,digestLen) \
             sss_mbedtls_digest_one_go(((sss_mbedtls_digest_t * ) context),(message),(messageLen),(digest),(digestLen))
+#       define sss_host_digest_one_go_batch(context,items,itemCount) \
+            sss_mbedtls_digest_one_go_batch(((sss_mbedtls_digest_t * ) context),(items),(itemCount))
 #       define sss_host_digest_init(context) \
             sss_mbedtls_digest_init(((sss_mbedtls_digest_t * ) context))
 #       define sss_host_digest_update(context,message,messageLen) \
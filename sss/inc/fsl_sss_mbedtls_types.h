@@ -28,6 +28,7 @@
 #endif
 
 #include <fsl_sss_keyid_map.h>
+#include <mbedtls/aes.h>
 #include <mbedtls/cipher.h>
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/entropy.h>
@@ -67,6 +68,25 @@
 
 #define SSS_AEAD_TYPE_IS_MBEDTLS(context) (context && SSS_SESSION_TYPE_IS_MBEDTLS(context->session))
 
+#ifndef SSS_MBEDTLS_PK_CACHE_BUDGET
+/** Bytes of parsed persistent keys kept for the next
+ * sss_key_object_get_handle() of the same keyId. 0 disables the cache. */
+#define SSS_MBEDTLS_PK_CACHE_BUDGET 0
+#endif
+
+#ifndef SSS_MBEDTLS_CCM_DECRYPT_MAX
+/** Largest payloadLen of a multi step AES CCM decrypt. The plain text is
+ * only released once the tag is verified, until then it is held on the
+ * heap, payloadLen bytes from sss_aead_init() to sss_aead_finish(). */
+#define SSS_MBEDTLS_CCM_DECRYPT_MAX (64 * 1024)
+#endif
+
+#ifndef SSS_MBEDTLS_CTX_POOL_SIZE
+/** Cipher and message digest contexts a session keeps set up for the next
+ * operation, of each kind. 0 sets up and frees a context per operation. */
+#define SSS_MBEDTLS_CTX_POOL_SIZE 0
+#endif
+
 /* ************************************************************************** */
 /* Structrues and Typedefs                                                    */
 /* ************************************************************************** */
@@ -85,6 +105,10 @@ typedef struct _sss_mbedtls_session
     /* Root Path for persitant key store */
     const char *szRootPath;
 #endif
+#if SSS_MBEDTLS_CTX_POOL_SIZE > 0
+    /** Idle contexts, allocated on first use */
+    struct _sss_mbedtls_ctx_pool *ctx_pool;
+#endif
 } sss_mbedtls_session_t;
 
 struct _sss_mbedtls_object;
@@ -99,6 +123,10 @@ typedef struct _sss_mbedtls_key_store
     uint32_t max_object_count;
 
     keyStoreTable_t *keystore_shadow;
+#if SSS_KS_MMAP
+    /** Persistent keys, used instead of keystore_shadow */
+    ks_mmap_t *mmap_store;
+#endif
 #endif
 } sss_mbedtls_key_store_t;
 
@@ -118,6 +146,8 @@ typedef struct _sss_mbedtls_object
     uint32_t contents_must_free : 1;
     /** Type of key. Persistnet/trainsient @ref sss_key_object_mode_t */
     uint32_t keyMode : 3;
+    /** Contents are a parsed key shared through the key cache */
+    uint32_t contents_cached : 1;
     /** Max size allocated */
     size_t contents_max_size;
     size_t contents_size;
@@ -173,6 +203,22 @@ typedef struct _sss_mbedtls_mac
     mbedtls_md_context_t *HmacCtx;
 } sss_mbedtls_mac_t;
 
+/** CCM state, MAC and key stream are computed as the data comes in */
+typedef struct
+{
+    mbedtls_aes_context aes;
+    /** CBC-MAC over B0, the AAD and the payload */
+    uint8_t cbcMac[16];
+    /** Counter block of the next key stream block */
+    uint8_t ctr[16];
+    /** Bytes added to cbcMac since it was last encrypted */
+    size_t macOffset;
+    size_t aadOffset;
+    size_t tagLen;
+    /** B0 is processed */
+    uint8_t started;
+} sss_mbedtls_ccm_t;
+
 typedef struct _sss_mbedtls_aead
 {
     /*! Virtual connection between application (user context) and specific
@@ -184,16 +230,15 @@ typedef struct _sss_mbedtls_aead
 
     /*! Implementation specific part */
     mbedtls_gcm_context *gcm_ctx; /*!< Reference to gcm context. */
-    mbedtls_ccm_context *ccm_ctx; /*!< Reference to ccm context. */
+    sss_mbedtls_ccm_t *ccm_ctx;   /*!< Reference to ccm context. */
     uint8_t *pNonce;              /*!< Reference to IV. */
     size_t nonceLen;              /*!< Store IV len. */
-    const uint8_t *pCcm_aad;      /*!< Reference to AAD */
     size_t ccm_aadLen;            /*!< Store AAD len. */
-    uint8_t *pCcm_data;           /*!< Ref to CCM data dynamic allocated.. */
     size_t ccm_dataTotalLen;      /*!< Store CCM data total len. */
     size_t ccm_dataoffset;        /*!< Store CCM data offset. */
-    uint8_t cache_data[16];       /*!< Cache for GCM data  */
-    size_t cache_data_len;        /*!< Store GCM Cache len*/
+    uint8_t *pCcm_data;           /*!< CCM decrypt: plain text, held back until the tag is verified */
+    uint8_t cache_data[16];       /*!< Cache for GCM data, CCM key stream */
+    size_t cache_data_len;        /*!< Store GCM Cache len, CCM key stream left */
 } sss_mbedtls_aead_t;
 
 typedef struct _sss_mbedtls_digest
@@ -236,6 +281,17 @@ sss_status_t ks_mbedtls_remove_key(const sss_mbedtls_object_t *sss_key);
 
 sss_status_t ks_mbedtls_fat_update(sss_mbedtls_key_store_t *keyStore);
 
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0
+/** Set up keyObject with the cached parse of keyId, fails on a miss */
+sss_status_t ks_mbedtls_pk_cache_get(sss_mbedtls_object_t *keyObject, uint32_t keyId);
+
+/** Hand the key just parsed into keyObject over to the cache */
+void ks_mbedtls_pk_cache_put(sss_mbedtls_object_t *keyObject);
+
+/** Forget the cached parse of keyId, e.g. because it is written / removed */
+void ks_mbedtls_pk_cache_drop(sss_mbedtls_key_store_t *keyStore, uint32_t keyId);
+#endif
+
 #endif /* MBEDTLS_FS_IO */
 
 /* Low Level API Key object create */
@@ -345,6 +345,12 @@ sss_status_t sss_openssl_cipher_one_go_v2(sss_openssl_symmetric_t *context,
     uint8_t *destData,
     size_t *pDataLen);
 
+/** @copydoc sss_cipher_one_go_batch
+ *
+ */
+sss_status_t sss_openssl_cipher_one_go_batch(
+    sss_openssl_symmetric_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_cipher_init
  *
  */
@@ -461,6 +467,11 @@ sss_status_t sss_openssl_mac_context_init(sss_openssl_mac_t *context,
 sss_status_t sss_openssl_mac_one_go(
     sss_openssl_mac_t *context, const uint8_t *message, size_t messageLen, uint8_t *mac, size_t *macLen);
 
+/** @copydoc sss_mac_one_go_batch
+ *
+ */
+sss_status_t sss_openssl_mac_one_go_batch(sss_openssl_mac_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_mac_init
  *
  */
@@ -499,6 +510,11 @@ sss_status_t sss_openssl_digest_context_init(
 sss_status_t sss_openssl_digest_one_go(
     sss_openssl_digest_t *context, const uint8_t *message, size_t messageLen, uint8_t *digest, size_t *digestLen);
 
+/** @copydoc sss_digest_one_go_batch
+ *
+ */
+sss_status_t sss_openssl_digest_one_go_batch(sss_openssl_digest_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_digest_init
  *
  */
@@ -636,6 +652,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_cipher_one_go(((sss_openssl_symmetric_t * ) context),(iv),(ivLen),(srcData),(destData),(dataLen))
 #       define sss_cipher_one_go_v2(context,iv,ivLen,srcData,srcLen,destData,pDataLen) \
             sss_openssl_cipher_one_go_v2(((sss_openssl_symmetric_t * ) context),(iv),(ivLen),(srcData),(srcLen),(destData),(pDataLen))
+#       define sss_cipher_one_go_batch(context,items,itemCount) \
+            sss_openssl_cipher_one_go_batch(((sss_openssl_symmetric_t * ) context),(items),(itemCount))
 #       define sss_cipher_init(context,iv,ivLen) \
             sss_openssl_cipher_init(((sss_openssl_symmetric_t * ) context),(iv),(ivLen))
 #       define sss_cipher_update(context,srcData,srcLen,destData,destLen) \
@@ -666,6 +684,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_mac_context_init(((sss_openssl_mac_t * ) context),((sss_openssl_session_t * ) session),((sss_openssl_object_t * ) keyObject),(algorithm),(mode))
 #       define sss_mac_one_go(context,message,messageLen,mac,macLen) \
             sss_openssl_mac_one_go(((sss_openssl_mac_t * ) context),(message),(messageLen),(mac),(macLen))
+#       define sss_mac_one_go_batch(context,items,itemCount) \
+            sss_openssl_mac_one_go_batch(((sss_openssl_mac_t * ) context),(items),(itemCount))
 #       define sss_mac_init(context) \
             sss_openssl_mac_init(((sss_openssl_mac_t * ) context))
 #       define sss_mac_update(context,message,messageLen) \
@@ -679,6 +699,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_digest_context_init(((sss_openssl_digest_t * ) context),((sss_openssl_session_t * ) session),(algorithm),(mode))
 #       define sss_digest_one_go(context,message,messageLen,digest,digestLen) \
             sss_openssl_digest_one_go(((sss_openssl_digest_t * ) context),(message),(messageLen),(digest),(digestLen))
+#       define sss_digest_one_go_batch(context,items,itemCount) \
+            sss_openssl_digest_one_go_batch(((sss_openssl_digest_t * ) context),(items),(itemCount))
 #       define sss_digest_init(context) \
             sss_openssl_digest_init(((sss_openssl_digest_t * ) context))
 #       define sss_digest_update(context,message,messageLen) \
@@ -786,6 +808,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_cipher_one_go(((sss_openssl_symmetric_t * ) context),(iv),(ivLen),(srcData),(destData),(dataLen))
 #       define sss_host_cipher_one_go_v2(context,iv,ivLen,srcData,srcLen,destData,pDataLen) \
             sss_openssl_cipher_one_go_v2(((sss_openssl_symmetric_t * ) context),(iv),(ivLen),(srcData),(srcLen),(destData),(pDataLen))
+#       define sss_host_cipher_one_go_batch(context,items,itemCount) \
+            sss_openssl_cipher_one_go_batch(((sss_openssl_symmetric_t * ) context),(items),(itemCount))
 #       define sss_host_cipher_init(context,iv,ivLen) \
             sss_openssl_cipher_init(((sss_openssl_symmetric_t * ) context),(iv),(ivLen))
 #       define sss_host_cipher_update(context,srcData,srcLen,destData,destLen) \
@@ -816,6 +840,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_mac_context_init(((sss_openssl_mac_t * ) context),((sss_openssl_session_t * ) session),((sss_openssl_object_t * ) keyObject),(algorithm),(mode))
 #       define sss_host_mac_one_go(context,message,messageLen,mac,macLen) \
             sss_openssl_mac_one_go(((sss_openssl_mac_t * ) context),(message),(messageLen),(mac),(macLen))
+#       define sss_host_mac_one_go_batch(context,items,itemCount) \
+            sss_openssl_mac_one_go_batch(((sss_openssl_mac_t * ) context),(items),(itemCount))
 #       define sss_host_mac_init(context) \
             sss_openssl_mac_init(((sss_openssl_mac_t * ) context))
 #       define sss_host_mac_update(context,message,messageLen) \
@@ -829,6 +855,8 @@ sss_status_t sss_openssl_rng_context_free(sss_openssl_rng_context_t *context);
             sss_openssl_digest_context_init(((sss_openssl_digest_t * ) context),((sss_openssl_session_t * ) session),(algorithm),(mode))
 #       define sss_host_digest_one_go(context,message,messageLen,digest,digestLen) \
             sss_openssl_digest_one_go(((sss_openssl_digest_t * ) context),(message),(messageLen),(digest),(digestLen))
+#       define sss_host_digest_one_go_batch(context,items,itemCount) \
+            sss_openssl_digest_one_go_batch(((sss_openssl_digest_t * ) context),(items),(itemCount))
 #       define sss_host_digest_init(context) \
             sss_openssl_digest_init(((sss_openssl_digest_t * ) context))
 #       define sss_host_digest_update(context,message,messageLen) \
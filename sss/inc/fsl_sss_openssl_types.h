@@ -61,6 +61,9 @@
 
 struct _sss_openssl_session;
 
+/** Algorithm handles fetched once per session, see sss_openssl_session_open() */
+struct _sss_openssl_evp_cache;
+
 typedef struct _sss_openssl_session
 {
     /*! Indicates which security subsystem is selected to be used. */
@@ -68,8 +71,32 @@ typedef struct _sss_openssl_session
 
     /* Root Path for persitant key store */
     const char *szRootPath;
+
+    /*! Fetched ciphers / digests / MACs. NULL with OpenSSL 1.x, or if the
+     * fetch failed, then the built in EVP_aes_128_cbc() etc. are used. */
+    struct _sss_openssl_evp_cache *evp;
 } sss_openssl_session_t;
 
+/** CPU features OpenSSL can use, kSSS_OpenSSL_SessionProp_Accel */
+#define SSS_OPENSSL_ACCEL_AES (1u << 0)    /*!< AES-NI / ARMv8 AES */
+#define SSS_OPENSSL_ACCEL_SHA (1u << 1)    /*!< SHA-NI / ARMv8 SHA2 */
+#define SSS_OPENSSL_ACCEL_VAES (1u << 2)   /*!< VAES, AES on wide vector registers */
+#define SSS_OPENSSL_ACCEL_PCLMUL (1u << 3) /*!< Carry-less multiply, for GCM */
+
+/** OpenSSL Properties that can be represented as 32bit numbers */
+typedef enum
+{
+    /** Bitmap of SSS_OPENSSL_ACCEL_* */
+    kSSS_OpenSSL_SessionProp_Accel = kSSS_SessionProp_u32_Proprietary_Start + 1,
+} sss_openssl_session_prop_u32_t;
+
+/** OpenSSL Properties that can be represented as an array */
+typedef enum
+{
+    /** Name of the provider that implements AES, string */
+    kSSS_OpenSSL_SessionProp_Provider = kSSS_SessionProp_au8_Proprietary_Start + 1,
+} sss_openssl_session_prop_au8_t;
+
 struct _sss_openssl_object;
 
 typedef struct _sss_openssl_key_store
@@ -81,6 +108,10 @@ typedef struct _sss_openssl_key_store
     uint32_t max_object_count;
 
     keyStoreTable_t *keystore_shadow;
+#if SSS_KS_MMAP
+    /** Persistent keys, used instead of keystore_shadow */
+    ks_mmap_t *mmap_store;
+#endif
 
 } sss_openssl_key_store_t;
 
@@ -150,6 +181,9 @@ typedef struct
     sss_mode_t mode;                 /*!  */
 #if (OPENSSL_VERSION_NUMBER >= 0x30000000)
     EVP_MAC_CTX *mac_ctx;
+    /*! CMAC key length, or 1 for HMAC, the parameters of mac_ctx are set
+     * for. 0 if not set yet. */
+    size_t paramsKeyLen;
 #else
     CMAC_CTX *cmac_ctx;
     HMAC_CTX *hmac_ctx;
@@ -68,6 +68,97 @@ void sss_se05x_session_close(sss_se05x_session_t *session);
  */
 void sss_se05x_session_delete(sss_se05x_session_t *session);
 
+#if SSS_HAVE_SCP_SCP03_SSS
+/** Size of the blob written by sss_se05x_session_checkpoint() */
+#define SSS_SE05X_SESSION_CHECKPOINT_LEN (4 + 8 + 16 + 96 + 16)
+
+#ifndef SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID
+/** Counter object on the SE that session checkpoints are bound to.
+ * Created by the first sss_se05x_session_checkpoint(). */
+#define SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID 0x7D5C0001u
+#endif
+
+/** Save the state of an open Platform SCP03 session.
+ *
+ * The session ID, the SCP03 session keys, MCV and command counter are
+ * written to ``pBlob``, encrypted and authenticated with keys derived
+ * from the static ENC and MAC keys of ``pConnectCtx``. The checkpoint
+ * counter on the SE is incremented and its value bound to the blob.
+ *
+ * The blob is only valid until the next APDU sent over ``session``.
+ * Release the link with sss_se05x_session_detach() so that the session
+ * stays open on the SE, and resume it with sss_se05x_session_resume().
+ *
+ * @param session     Open Platform SCP03 session
+ * @param pConnectCtx Connection context the session was opened with
+ * @param[out] pBlob  Buffer of at least SSS_SE05X_SESSION_CHECKPOINT_LEN
+ * @param[in,out] pBlobLen IN: Size of pBlob, OUT: Length of the blob
+ */
+sss_status_t sss_se05x_session_checkpoint(
+    sss_se05x_session_t *session, SE05x_Connect_Ctx_t *pConnectCtx, uint8_t *pBlob, size_t *pBlobLen);
+
+/** Resume a session saved with sss_se05x_session_checkpoint().
+ *
+ * The link is only re-synchronised (no interface reset, no ATR), the
+ * applet is not selected again and no SCP03 handshake is done. The
+ * checkpoint counter is incremented and read back: a blob that was
+ * already resumed from, or an older one, is refused.
+ * ``pConnectCtx`` must hold the same static keys as at checkpoint time,
+ * the restored session keys are set in its dynamic context.
+ *
+ * Only one process may use the session at a time, and the blob must be
+ * taken again before handing the session over to the next one.
+ */
+sss_status_t sss_se05x_session_resume(
+    sss_se05x_session_t *session, SE05x_Connect_Ctx_t *pConnectCtx, const uint8_t *pBlob, size_t blobLen);
+
+/** Release the link of ``session`` without closing the session on the SE.
+ *
+ * Unlike sss_se05x_session_close(), no CloseSession APDU and no end of
+ * APDU session are sent.
+ */
+void sss_se05x_session_detach(sss_se05x_session_t *session);
+#endif
+
+#ifndef SSS_SE05X_OBJ_CACHE_ENTRIES
+/** Number of objects for which sss_se05x_key_object_get_handle() keeps
+ * type, cipher type and curve on the host. 0 disables the cache. */
+#define SSS_SE05X_OBJ_CACHE_ENTRIES 0
+#endif
+
+#ifndef SSS_SE05X_MAC_BATCH_MAX
+/** Commands sss_se05x_mac_one_go_batch() prepares before sending them with
+ * DoAPDUTxRx_Batch(). They share one buffer of SE05X_MAX_BUF_SIZE_CMD bytes. */
+#define SSS_SE05X_MAC_BATCH_MAX 8
+#endif
+
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+/** Forget all object metadata cached for ``session``.
+ *
+ * Entries are dropped on erase / set / generate through any sss session of
+ * this process and on Se05x_API_DeleteAll(). The cache assumes no other
+ * writer: a cached object still gets a handle after it was deleted by
+ * another process or with Se05x_API_DeleteSecureObject(). Call this when
+ * objects may have been changed by someone else.
+ */
+void sss_se05x_obj_cache_flush(sss_se05x_session_t *session);
+
+#if !AX_EMBEDDED
+/** Write the object metadata cached for ``session`` to ``path``.
+ *
+ * A fingerprint of the SE (free persistent memory and ReadIDList) is
+ * stored with it.
+ */
+sss_status_t sss_se05x_obj_cache_save(sss_se05x_session_t *session, const char *path);
+
+/** Fill the cache of ``session`` from a file written by sss_se05x_obj_cache_save().
+ *
+ * Nothing is loaded if the fingerprint of the SE no longer matches.
+ */
+sss_status_t sss_se05x_obj_cache_load(sss_se05x_session_t *session, const char *path);
+#endif
+#endif
+
 /*! @} */ /* end of : sss_se05x_session */
 
 /**
@@ -198,6 +289,24 @@ sss_status_t sss_se05x_derive_key_sobj_one_go(sss_se05x_derive_key_t *context,
 sss_status_t sss_se05x_derive_key_dh(
     sss_se05x_derive_key_t *context, sss_se05x_object_t *otherPartyKeyObject, sss_se05x_object_t *derivedKeyObject);
 
+/** ECDH with a peer public key given as point, e.g. an ephemeral TLS key.
+ *
+ * The point is sent inline in one ECDHGenerateSharedSecret APDU and the
+ * secret is returned to the host. No object is created for the peer key
+ * or for the secret.
+ *
+ * @param context           Initialised with the own key pair, kAlgorithm_SSS_ECDH
+ * @param pPeerPoint        Public point, 0x04 || X || Y for Weierstrass
+ *                          curves, the little endian u for Montgomery curves
+ * @param[out] pSharedSecret Shared secret, as sss_se05x_derive_key_dh() stores it
+ * @param[in,out] pSharedSecretLen IN: size of pSharedSecret, OUT: length of the secret
+ */
+sss_status_t sss_se05x_derive_key_dh_inline(sss_se05x_derive_key_t *context,
+    const uint8_t *pPeerPoint,
+    size_t peerPointLen,
+    uint8_t *pSharedSecret,
+    size_t *pSharedSecretLen);
+
 /** @copydoc sss_derive_key_context_free
  *
  */
@@ -255,6 +364,67 @@ sss_status_t sss_se05x_key_store_generate_key(
 sss_status_t sss_se05x_key_store_get_key(
     sss_se05x_key_store_t *keyStore, sss_se05x_object_t *keyObject, uint8_t *data, size_t *dataLen, size_t *pKeyBitLen);
 
+#if SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET
+
+#ifndef SSS_SE05X_BINARY_STREAM_CHUNK
+/** Max bytes of a binary object moved by one APDU.
+ *
+ * The rest of the applet buffer is left for the TLV headers, SCP03
+ * padding and MAC. On SE051, the policy of the object is also sent with
+ * every write and is taken from this. */
+#define SSS_SE05X_BINARY_STREAM_CHUNK (SE05X_MAX_BUF_SIZE_CMD - 64)
+#endif
+
+/** Open a read / write cursor on a binary file or certificate.
+ *
+ * If the object exists, ``createSize`` is ignored and the cursor covers
+ * the current size of the object. Otherwise the object is created with
+ * ``createSize`` bytes and ``policies`` by the first write, which needs
+ * SSSFTR_SE05X_KEY_SET.
+ *
+ * Chunks are sized to @ref SSS_SE05X_BINARY_STREAM_CHUNK, so that a large
+ * certificate needs far fewer APDUs than with sss_se05x_key_store_set_key().
+ *
+ * @param[out] stream  Cursor, at offset 0
+ * @param keyStore     Key store of the session
+ * @param keyObject    Object, with ``keyId`` set
+ * @param createSize   Size of the object, if it has to be created
+ * @param policies     Policy of the object, if it has to be created. May be NULL
+ */
+sss_status_t sss_se05x_binary_stream_open(sss_se05x_binary_stream_t *stream,
+    sss_se05x_key_store_t *keyStore,
+    sss_se05x_object_t *keyObject,
+    size_t createSize,
+    sss_policy_t *policies);
+
+/** Move the cursor to ``offset`` */
+sss_status_t sss_se05x_binary_stream_seek(sss_se05x_binary_stream_t *stream, size_t offset);
+
+/** Read from the cursor directly into ``data``.
+ *
+ * @param[in,out] dataLen IN: Size of data, OUT: Bytes read. Less than
+ *                        requested only at the end of the object.
+ */
+sss_status_t sss_se05x_binary_stream_read(sss_se05x_binary_stream_t *stream, uint8_t *data, size_t *dataLen);
+
+/** Read from the cursor up to the end of the object, handing every chunk to ``fpSink``.
+ *
+ * Lets the caller write a large object to a file, socket or flash
+ * without a buffer for the whole object.
+ */
+sss_status_t sss_se05x_binary_stream_read_cb(
+    sss_se05x_binary_stream_t *stream, fp_sss_se05x_binary_stream_sink_t fpSink, void *pSinkCtx);
+
+#if SSSFTR_SE05X_KEY_SET
+/** Write ``data`` at the cursor. Writes may not go past the size of the object. */
+sss_status_t sss_se05x_binary_stream_write(sss_se05x_binary_stream_t *stream, const uint8_t *data, size_t dataLen);
+#endif
+
+/** Release the cursor. Nothing is sent to the SE05X. */
+void sss_se05x_binary_stream_close(sss_se05x_binary_stream_t *stream);
+
+#endif /* SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET */
+
 /** @copydoc sss_key_store_open_key
  *
  * In SE05X, these keys can be used as KEK encryption key
@@ -374,6 +544,11 @@ sss_status_t sss_se05x_cipher_one_go_v2(sss_se05x_symmetric_t *context,
     uint8_t *destData,
     size_t *pDataLen);
 
+/** @copydoc sss_cipher_one_go_batch
+ *
+ */
+sss_status_t sss_se05x_cipher_one_go_batch(sss_se05x_symmetric_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_cipher_init
  *
  */
@@ -490,6 +665,11 @@ sss_status_t sss_se05x_mac_context_init(sss_se05x_mac_t *context,
 sss_status_t sss_se05x_mac_one_go(
     sss_se05x_mac_t *context, const uint8_t *message, size_t messageLen, uint8_t *mac, size_t *macLen);
 
+/** @copydoc sss_mac_one_go_batch
+ *
+ */
+sss_status_t sss_se05x_mac_one_go_batch(sss_se05x_mac_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_mac_init
  *
  */
@@ -528,6 +708,11 @@ sss_status_t sss_se05x_digest_context_init(
 sss_status_t sss_se05x_digest_one_go(
     sss_se05x_digest_t *context, const uint8_t *message, size_t messageLen, uint8_t *digest, size_t *digestLen);
 
+/** @copydoc sss_digest_one_go_batch
+ *
+ */
+sss_status_t sss_se05x_digest_one_go_batch(sss_se05x_digest_t *context, sss_batch_item_t *items, size_t itemCount);
+
 /** @copydoc sss_digest_init
  *
  */
@@ -636,6 +821,18 @@ SE05x_DigestMode_t se05x_get_sha_algo(sss_algorithm_t algorithm);
 sss_status_t sss_se05x_key_store_create_curve(Se05xSession_t *pSession, uint32_t curve_id);
 #endif
 
+#if SSSFTR_SE05X_ECC && SSSFTR_SE05X_KEY_SET
+/** Read the list of EC curves created on the SE into ``session``.
+ *
+ * Key generation and EC key injection only create a curve when it is not
+ * in this list. It is otherwise read on first use and then kept up to date
+ * by Se05x_API_CreateECCurve() and Se05x_API_DeleteECCurve() of the same
+ * session. Call this again when curves may have been deleted through
+ * another session.
+ */
+sss_status_t sss_se05x_session_prefetch_curves(sss_se05x_session_t *session);
+#endif
+
 /* clang-format off */
 #   if (SSS_HAVE_SSS == 1)
         /* Direct Call : session */
@@ -726,6 +923,8 @@ sss_status_t sss_se05x_key_store_create_curve(Se05xSession_t *pSession, uint32_t
             sss_se05x_cipher_one_go(((sss_se05x_symmetric_t * ) context),(iv),(ivLen),(srcData),(destData),(dataLen))
 #       define sss_cipher_one_go_v2(context,iv,ivLen,srcData,srcLen,destData,pDataLen) \
             sss_se05x_cipher_one_go_v2(((sss_se05x_symmetric_t * ) context),(iv),(ivLen),(srcData),(srcLen),(destData),(pDataLen))
+#       define sss_cipher_one_go_batch(context,items,itemCount) \
+            sss_se05x_cipher_one_go_batch(((sss_se05x_symmetric_t * ) context),(items),(itemCount))
 #       define sss_cipher_init(context,iv,ivLen) \
             sss_se05x_cipher_init(((sss_se05x_symmetric_t * ) context),(iv),(ivLen))
 #       define sss_cipher_update(context,srcData,srcLen,destData,destLen) \
@@ -756,6 +955,8 @@ sss_status_t sss_se05x_key_store_create_curve(Se05xSession_t *pSession, uint32_t
             sss_se05x_mac_context_init(((sss_se05x_mac_t * ) context),((sss_se05x_session_t * ) session),((sss_se05x_object_t * ) keyObject),(algorithm),(mode))
 #       define sss_mac_one_go(context,message,messageLen,mac,macLen) \
             sss_se05x_mac_one_go(((sss_se05x_mac_t * ) context),(message),(messageLen),(mac),(macLen))
+#       define sss_mac_one_go_batch(context,items,itemCount) \
+            sss_se05x_mac_one_go_batch(((sss_se05x_mac_t * ) context),(items),(itemCount))
 #       define sss_mac_init(context) \
             sss_se05x_mac_init(((sss_se05x_mac_t * ) context))
 #       define sss_mac_update(context,message,messageLen) \
@@ -769,6 +970,8 @@ sss_status_t sss_se05x_key_store_create_curve(Se05xSession_t *pSession, uint32_t
             sss_se05x_digest_context_init(((sss_se05x_digest_t * ) context),((sss_se05x_session_t * ) session),(algorithm),(mode))
 #       define sss_digest_one_go(context,message,messageLen,digest,digestLen) \
             sss_se05x_digest_one_go(((sss_se05x_digest_t * ) context),(message),(messageLen),(digest),(digestLen))
+#       define sss_digest_one_go_batch(context,items,itemCount) \
+            sss_se05x_digest_one_go_batch(((sss_se05x_digest_t * ) context),(items),(itemCount))
 #       define sss_digest_init(context) \
             sss_se05x_digest_init(((sss_se05x_digest_t * ) context))
 #       define sss_digest_update(context,message,messageLen) \
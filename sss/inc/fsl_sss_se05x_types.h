@@ -154,6 +154,30 @@ typedef struct _sss_se05x_object
 
 } sss_se05x_object_t;
 
+/** Cursor over a binary file / certificate in the SE05X
+ *
+ * See sss_se05x_binary_stream_open() */
+typedef struct
+{
+    /** Key store holding the object */
+    sss_se05x_key_store_t *keyStore;
+    /** Id of the object */
+    uint32_t keyId;
+    /** Size of the object */
+    uint16_t size;
+    /** Next byte to read / write */
+    uint16_t offset;
+    /** Object does not exist yet and is created by the first write */
+    uint8_t create;
+    /** Length of policy */
+    size_t policyLen;
+    /** Object policy, sent with the creating write (and with every write on SE051) */
+    uint8_t policy[MAX_POLICY_BUFFER_SIZE];
+} sss_se05x_binary_stream_t;
+
+/** Called by sss_se05x_binary_stream_read_cb() for every chunk read from the SE05X */
+typedef sss_status_t (*fp_sss_se05x_binary_stream_sink_t)(void *pSinkCtx, const uint8_t *data, size_t dataLen);
+
 /** @copydoc sss_derive_key_t */
 typedef struct
 {
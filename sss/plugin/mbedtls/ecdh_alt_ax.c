@@ -31,6 +31,10 @@
 #include "fsl_sss_ftr_default.h"
 #endif
 
+#if SSS_HAVE_APPLET_SE05X_IOT
+#include "fsl_sss_se05x_apis.h"
+#endif
+
 #if defined(FLOW_VERBOSE) && FLOW_VERBOSE == 1
 #include "sm_printf.h"
 #include "sm_types.h"
@@ -208,6 +212,47 @@ int mbedtls_ecdh_gen_public(mbedtls_ecp_group *grp,
     return 1;
 }
 
+#if SSS_HAVE_APPLET_SE05X_IOT
+/*
+ * Shared secret with the peer point sent inline, one APDU and no objects
+ */
+static int ecdh_compute_shared_se05x(mbedtls_ecp_group *grp, mbedtls_mpi *z, const mbedtls_ecp_point *Q)
+{
+    int ret;
+    uint8_t peerPoint[160];
+    size_t peerPointLen = 0;
+    uint8_t sharedSecret[128];
+    size_t sharedSecretLen = sizeof(sharedSecret);
+    sss_se05x_derive_key_t context;
+    sss_status_t status;
+
+    ret = mbedtls_ecp_point_write_binary(
+        grp, Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &peerPointLen, peerPoint, sizeof(peerPoint));
+    if (ret != 0) {
+        return ret;
+    }
+
+    status = sss_se05x_derive_key_context_init(&context,
+        (sss_se05x_session_t *)grp->pSSSObject->keyStore->session,
+        (sss_se05x_object_t *)grp->pSSSObject,
+        kAlgorithm_SSS_ECDH,
+        kMode_SSS_ComputeSharedSecret);
+    if (status != kStatus_SSS_Success) {
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    LOG_D("%s: Using SE for DH key gen", __FUNCTION__);
+    status = sss_se05x_derive_key_dh_inline(&context, peerPoint, peerPointLen, sharedSecret, &sharedSecretLen);
+    sss_se05x_derive_key_context_free(&context);
+    if (status != kStatus_SSS_Success) {
+        LOG_E("sss_se05x_derive_key_dh_inline Failed");
+        return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+
+    return mbedtls_mpi_read_binary(z, sharedSecret, sharedSecretLen);
+}
+#endif
+
 /*
  * Compute shared secret (SEC1 3.3.1)
  */
@@ -247,6 +292,11 @@ int mbedtls_ecdh_compute_shared(mbedtls_ecp_group *grp,
              grp->pSSSObject->cipherType == kSSS_CipherType_EC_NIST_K ||
              grp->pSSSObject->cipherType == kSSS_CipherType_EC_BRAINPOOL ||
              grp->pSSSObject->cipherType == kSSS_CipherType_EC_MONTGOMERY) {
+#if SSS_HAVE_APPLET_SE05X_IOT
+        if (grp->pSSSObject->keyStore->session->subsystem == kType_SSS_SE_SE05x) {
+            return ecdh_compute_shared_se05x(grp, z, Q);
+        }
+#endif
         if (0 == mbedtls_ecp_point_write_binary(grp,
                      Q,
                      MBEDTLS_ECP_PF_UNCOMPRESSED,
@@ -33,6 +33,7 @@
 
 #include <nxLog_sss.h>
 #include "fsl_sss_util_asn1_der.h"
+#include "ecdsa_verify_alt.h"
 
 #include "mbedtls/ecdsa.h"
 #include "mbedtls/asn1write.h"
@@ -43,6 +44,10 @@
 #include "mbedtls/hmac_drbg.h"
 #endif
 
+#if defined(__GNUC__) && !defined(AX_EMBEDDED)
+#include <pthread.h>
+#endif
+
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
 #else
@@ -65,6 +70,25 @@
 /* Used for SSS object init */
 static sss_key_store_t *ecdsa_verify_ssskeystore = NULL;
 
+static sss_mbedtls_verify_mode_t ecdsa_verify_mode = SSS_MBEDTLS_VERIFY_MODE_DEFAULT;
+static fp_sss_mbedtls_verify_policy_t ecdsa_verify_policy = NULL;
+static void *ecdsa_verify_policy_ctx = NULL;
+
+/* Groups used for host verifies. Loaded once per curve, with the comb
+ * table of G (grp->T) computed up front, so that it is read only and
+ * shared by all verifies on that curve. A group of a parsed certificate
+ * is freed with it, together with its table. */
+static mbedtls_ecp_group ecdsa_verify_groups[SSS_MBEDTLS_VERIFY_GROUPS];
+
+#if defined(__GNUC__) && !defined(AX_EMBEDDED)
+static pthread_mutex_t ecdsa_verify_groups_lock = PTHREAD_MUTEX_INITIALIZER;
+#define VERIFY_GROUPS_LOCK() pthread_mutex_lock(&ecdsa_verify_groups_lock)
+#define VERIFY_GROUPS_UNLOCK() pthread_mutex_unlock(&ecdsa_verify_groups_lock)
+#else
+#define VERIFY_GROUPS_LOCK()
+#define VERIFY_GROUPS_UNLOCK()
+#endif
+
 #if defined(MBEDTLS_ECP_RESTARTABLE)
 
 /*
@@ -387,6 +411,105 @@ void sss_mbedtls_set_sss_keystore(sss_key_store_t *ssskeystore)
     ecdsa_verify_ssskeystore = ssskeystore;
 }
 
+void sss_mbedtls_set_verify_mode(sss_mbedtls_verify_mode_t mode)
+{
+    ecdsa_verify_mode = mode;
+}
+
+void sss_mbedtls_set_verify_policy(fp_sss_mbedtls_verify_policy_t fpPolicy, void *policyCtx)
+{
+    ecdsa_verify_policy_ctx = policyCtx;
+    ecdsa_verify_policy     = fpPolicy;
+}
+
+static sss_mbedtls_verify_mode_t ecdsa_verify_route(const mbedtls_ecp_group *grp, const mbedtls_ecp_point *Q)
+{
+    if (ecdsa_verify_ssskeystore == NULL) {
+        return kSSS_MbedTLS_Verify_Host;
+    }
+    if (ecdsa_verify_policy != NULL) {
+        return ecdsa_verify_policy(grp, Q, ecdsa_verify_policy_ctx);
+    }
+    return ecdsa_verify_mode;
+}
+
+/*
+ * Cached group of curve id, NULL if there is none and no slot is left
+ */
+static mbedtls_ecp_group *ecdsa_verify_group(mbedtls_ecp_group_id id)
+{
+    mbedtls_ecp_group *pGrp = NULL;
+    mbedtls_ecp_group tmp;
+    mbedtls_ecp_point R;
+    mbedtls_mpi one;
+    size_t i;
+    int ret = 0;
+
+    if (id == MBEDTLS_ECP_DP_NONE || !mbedtls_ecdsa_can_do(id)) {
+        return NULL;
+    }
+
+    VERIFY_GROUPS_LOCK();
+    for (i = 0; i < SSS_MBEDTLS_VERIFY_GROUPS; i++) {
+        if (ecdsa_verify_groups[i].id == id) {
+            pGrp = &ecdsa_verify_groups[i];
+            break;
+        }
+    }
+    VERIFY_GROUPS_UNLOCK();
+    if (pGrp != NULL) {
+        return pGrp;
+    }
+
+    /* 1 * G fills tmp.T. Done without the lock, a racing thread may do the same */
+    memset(&tmp, 0, sizeof(tmp));
+    mbedtls_ecp_group_init(&tmp);
+    mbedtls_ecp_point_init(&R);
+    mbedtls_mpi_init(&one);
+    MBEDTLS_MPI_CHK(mbedtls_ecp_group_load(&tmp, id));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&one, 1));
+    MBEDTLS_MPI_CHK(mbedtls_ecp_mul(&tmp, &R, &one, &tmp.G, NULL, NULL));
+
+    VERIFY_GROUPS_LOCK();
+    for (i = 0; i < SSS_MBEDTLS_VERIFY_GROUPS; i++) {
+        if (ecdsa_verify_groups[i].id == id) {
+            pGrp = &ecdsa_verify_groups[i];
+            break;
+        }
+        if (ecdsa_verify_groups[i].id == MBEDTLS_ECP_DP_NONE) {
+            pGrp  = &ecdsa_verify_groups[i];
+            *pGrp = tmp;
+            mbedtls_ecp_group_init(&tmp);
+            break;
+        }
+    }
+    VERIFY_GROUPS_UNLOCK();
+
+cleanup:
+    if (ret != 0) {
+        LOG_W("Could not prepare curve %d for host verify", id);
+    }
+    mbedtls_ecp_group_free(&tmp);
+    mbedtls_ecp_point_free(&R);
+    mbedtls_mpi_free(&one);
+    return pGrp;
+}
+
+static int ecdsa_verify_host(mbedtls_ecp_group *grp,
+    const unsigned char *buf,
+    size_t blen,
+    const mbedtls_ecp_point *Q,
+    const mbedtls_mpi *r,
+    const mbedtls_mpi *s)
+{
+    mbedtls_ecp_group *pGrp = ecdsa_verify_group(grp->id);
+
+    if (pGrp == NULL) {
+        pGrp = grp;
+    }
+    return mbedtls_ecdsa_verify_o(pGrp, buf, blen, Q, r, s);
+}
+
 /*
  * Verify ECDSA signature of hashed message
  */
@@ -404,7 +527,7 @@ int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp,
     ECDSA_VALIDATE_RET(s != NULL);
     ECDSA_VALIDATE_RET(buf != NULL || blen == 0);
 
-    if (ecdsa_verify_ssskeystore != NULL) {
+    if (ecdsa_verify_route(grp, Q) == kSSS_MbedTLS_Verify_SE) {
         sss_cipher_type_t cipherType = kSSS_CipherType_NONE;
         sss_object_t sssKeyObject    = {
             0,
@@ -554,8 +677,8 @@ int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp,
             keyBitLen    = 256;
             break;
         default:
-            /* Rollback to verification on host if SE is not initialised */
-            return mbedtls_ecdsa_verify_o(grp, buf, blen, Q, r, s);
+            /* Rollback to verification on host for curves the SE does not know */
+            return ecdsa_verify_host(grp, buf, blen, Q, r, s);
         }
 
         ret = mbedtls_ecp_point_write_binary(
@@ -622,8 +745,8 @@ int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp,
         return 0;
     }
     else {
-        /* Rollback to verification on host if SE is not initialised */
-        return mbedtls_ecdsa_verify_o(grp, buf, blen, Q, r, s);
+        /* Public key only, verify on host */
+        return ecdsa_verify_host(grp, buf, blen, Q, r, s);
     }
 }
 #endif /* !MBEDTLS_ECDSA_VERIFY_ALT */
@@ -1,12 +1,53 @@
 /*
- * Copyright 2018-2020 NXP
+ * Copyright 2018-2020,2026 NXP
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#ifndef SSS_MBEDTLS_ECDSA_VERIFY_ALT_H
+#define SSS_MBEDTLS_ECDSA_VERIFY_ALT_H
+
 #include "fsl_sss_api.h"
+#include "mbedtls/ecp.h"
+
+/** Where mbedtls_ecdsa_verify() checks a signature */
+typedef enum
+{
+    /** On the host. A public key verify has no secret to protect */
+    kSSS_MbedTLS_Verify_Host = 0,
+    /** Inject the public key into the SE and verify there */
+    kSSS_MbedTLS_Verify_SE = 1,
+} sss_mbedtls_verify_mode_t;
+
+/** Per verify choice of the mode, e.g. to use the SE for some keys only */
+typedef sss_mbedtls_verify_mode_t (*fp_sss_mbedtls_verify_policy_t)(
+    const mbedtls_ecp_group *grp, const mbedtls_ecp_point *Q, void *policyCtx);
+
+#ifndef SSS_MBEDTLS_VERIFY_MODE_DEFAULT
+#define SSS_MBEDTLS_VERIFY_MODE_DEFAULT kSSS_MbedTLS_Verify_Host
+#endif
+
+/** Curves for which a group with its pre-computed base point table is
+ * kept for host verifies */
+#ifndef SSS_MBEDTLS_VERIFY_GROUPS
+#define SSS_MBEDTLS_VERIFY_GROUPS 4
+#endif
 
 /*
  *  Set sss keystore for ecdsa verify
  */
-void sss_mbedtls_set_sss_keystore(sss_key_store_t *ssskeystore);
\ No newline at end of file
+void sss_mbedtls_set_sss_keystore(sss_key_store_t *ssskeystore);
+
+/*
+ *  Set where ecdsa verify runs when no policy is set.
+ *  kSSS_MbedTLS_Verify_SE needs a keystore, see sss_mbedtls_set_sss_keystore
+ */
+void sss_mbedtls_set_verify_mode(sss_mbedtls_verify_mode_t mode);
+
+/*
+ *  Set a policy choosing the mode per verify. NULL to use the mode of
+ *  sss_mbedtls_set_verify_mode
+ */
+void sss_mbedtls_set_verify_policy(fp_sss_mbedtls_verify_policy_t fpPolicy, void *policyCtx);
+
+#endif /* SSS_MBEDTLS_ECDSA_VERIFY_ALT_H */
@@ -56,7 +56,9 @@
 #if SSS_HAVE_MBEDTLS_ALT
 /**
  * - MBEDTLS_ECDSA_VERIFY_ALT
- * To use SE for all public key ecdsa verify operation, enable MBEDTLS_ECDSA_VERIFY_ALT
+ * To use SE for public key ecdsa verify operations, enable MBEDTLS_ECDSA_VERIFY_ALT
+ * and call sss_mbedtls_set_verify_mode() / sss_mbedtls_set_verify_policy().
+ * By default verifies stay on the host, with cached curve tables.
  */
 // #ifndef MBEDTLS_ECDSA_VERIFY_ALT
 //     #define MBEDTLS_ECDSA_VERIFY_ALT
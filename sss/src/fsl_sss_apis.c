@@ -1644,6 +1644,30 @@ sss_status_t sss_cipher_one_go_v2(sss_symmetric_t *context,
     return kStatus_SSS_InvalidArgument;
 }
 
+sss_status_t sss_cipher_one_go_batch(sss_symmetric_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+    LOG_D("FN: %s", __FUNCTION__);
+#if SSS_HAVE_APPLET_SE05X_IOT && SSSFTR_SE05X_AES
+    if (SSS_SYMMETRIC_TYPE_IS_SE05X(context)) {
+        sss_se05x_symmetric_t *se05x_context = (sss_se05x_symmetric_t *)context;
+        return sss_se05x_cipher_one_go_batch(se05x_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_APPLET_SE05X_IOT */
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+    if (SSS_SYMMETRIC_TYPE_IS_MBEDTLS(context)) {
+        sss_mbedtls_symmetric_t *mbedtls_context = (sss_mbedtls_symmetric_t *)context;
+        return sss_mbedtls_cipher_one_go_batch(mbedtls_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_MBEDTLS */
+#if SSS_HAVE_HOSTCRYPTO_OPENSSL
+    if (SSS_SYMMETRIC_TYPE_IS_OPENSSL(context)) {
+        sss_openssl_symmetric_t *openssl_context = (sss_openssl_symmetric_t *)context;
+        return sss_openssl_cipher_one_go_batch(openssl_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_OPENSSL */
+    return kStatus_SSS_InvalidArgument;
+}
+
 sss_status_t sss_cipher_init(sss_symmetric_t *context, uint8_t *iv, size_t ivLen)
 {
 #if SSS_HAVE_SSCP
@@ -2136,6 +2160,30 @@ sss_status_t sss_mac_one_go(sss_mac_t *context, const uint8_t *message, size_t m
     return kStatus_SSS_InvalidArgument;
 }
 
+sss_status_t sss_mac_one_go_batch(sss_mac_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+    LOG_D("FN: %s", __FUNCTION__);
+#if SSS_HAVE_APPLET_SE05X_IOT
+    if (SSS_MAC_TYPE_IS_SE05X(context)) {
+        sss_se05x_mac_t *se05x_context = (sss_se05x_mac_t *)context;
+        return sss_se05x_mac_one_go_batch(se05x_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_APPLET_SE05X_IOT */
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+    if (SSS_MAC_TYPE_IS_MBEDTLS(context)) {
+        sss_mbedtls_mac_t *mbedtls_context = (sss_mbedtls_mac_t *)context;
+        return sss_mbedtls_mac_one_go_batch(mbedtls_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_MBEDTLS */
+#if SSS_HAVE_HOSTCRYPTO_OPENSSL
+    if (SSS_MAC_TYPE_IS_OPENSSL(context)) {
+        sss_openssl_mac_t *openssl_context = (sss_openssl_mac_t *)context;
+        return sss_openssl_mac_one_go_batch(openssl_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_OPENSSL */
+    return kStatus_SSS_InvalidArgument;
+}
+
 sss_status_t sss_mac_init(sss_mac_t *context)
 {
     LOG_D("FN: %s", __FUNCTION__);
@@ -2333,6 +2381,29 @@ sss_status_t sss_digest_one_go(
     return kStatus_SSS_InvalidArgument;
 }
 
+sss_status_t sss_digest_one_go_batch(sss_digest_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+#if SSS_HAVE_APPLET_SE05X_IOT
+    if (SSS_DIGEST_TYPE_IS_SE05X(context)) {
+        sss_se05x_digest_t *se05x_context = (sss_se05x_digest_t *)context;
+        return sss_se05x_digest_one_go_batch(se05x_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_APPLET_SE05X_IOT */
+#if SSS_HAVE_HOSTCRYPTO_MBEDTLS
+    if (SSS_DIGEST_TYPE_IS_MBEDTLS(context)) {
+        sss_mbedtls_digest_t *mbedtls_context = (sss_mbedtls_digest_t *)context;
+        return sss_mbedtls_digest_one_go_batch(mbedtls_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_MBEDTLS */
+#if SSS_HAVE_HOSTCRYPTO_OPENSSL
+    if (SSS_DIGEST_TYPE_IS_OPENSSL(context)) {
+        sss_openssl_digest_t *openssl_context = (sss_openssl_digest_t *)context;
+        return sss_openssl_digest_one_go_batch(openssl_context, items, itemCount);
+    }
+#endif /* SSS_HAVE_HOSTCRYPTO_OPENSSL */
+    return kStatus_SSS_InvalidArgument;
+}
+
 sss_status_t sss_digest_init(sss_digest_t *context)
 {
 #if SSS_HAVE_SSCP
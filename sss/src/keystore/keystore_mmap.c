@@ -0,0 +1,803 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Key store in PC : all keys in one memory mapped file */
+
+/* ************************************************************************** */
+/* Includes                                                                   */
+/* ************************************************************************** */
+
+#if defined(SSS_USE_FTR_FILE)
+#include "fsl_sss_ftr.h"
+#else
+#include "fsl_sss_ftr_default.h"
+#endif
+
+#include <fsl_sss_keyid_map.h>
+
+#if SSS_KS_MMAP
+
+#include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <nxEnsure.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nxLog_sss.h"
+#include "sm_types.h"
+
+/* ************************************************************************** */
+/* Local Defines                                                              */
+/* ************************************************************************** */
+
+/* Key store file name */
+#define KS_MMAP_FILENAME "sss_ks.bin"
+/* File allocation table of the FAT based key store, see keystore_pc.c */
+#define KS_FAT_FILENAME "sss_fat.bin"
+#define MAX_FILE_NAME_SIZE 255
+
+#define KS_MMAP_MAGIC (0x534B534DUL) /* "SKSM" */
+#define KS_MMAP_VERSION (0x0001)
+
+/* Record is a removal of extKeyId */
+#define KS_MMAP_REC_REMOVED (1u << 0)
+
+/* Records start and end 8 byte aligned */
+#define KS_MMAP_ALIGN(LEN) (((LEN) + 7u) & ~(size_t)7u)
+
+/* Smallest mapping, the file is mapped with room to grow */
+#define KS_MMAP_MIN_MAP (1024u * 1024u)
+
+/* Compact at open once removed / replaced records take more than this and
+ * more than the live ones */
+#define KS_MMAP_COMPACT_MIN (64u * 1024u)
+
+/* Index slot states */
+#define KS_MMAP_SLOT_FREE 0
+#define KS_MMAP_SLOT_USED 1
+
+/* ************************************************************************** */
+/* Structures and Typedefs                                                    */
+/* ************************************************************************** */
+
+/* Start of the file. commitLen is the commit point: records after it were
+ * not committed and are dropped at open. */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerLen;
+    uint64_t commitLen;
+    uint8_t reserved[16];
+} ks_mmap_header_t;
+
+/* Before the data of each record */
+typedef struct
+{
+    uint32_t extKeyId;
+    uint32_t dataLen;
+    uint8_t keyPart;
+    uint8_t cipherType;
+    uint8_t flags;
+    uint8_t reserved;
+    /* FNV-1a of the fields above and the data */
+    uint32_t check;
+} ks_mmap_record_t;
+
+/* Hash index entry. offset is 0 for a removed key. */
+typedef struct
+{
+    uint32_t extKeyId;
+    uint32_t state;
+    uint64_t offset;
+} ks_mmap_slot_t;
+
+struct _ks_mmap_t
+{
+    int fd;
+    char file_name[MAX_FILE_NAME_SIZE];
+    const uint8_t *base;
+    size_t mapLen;
+    /** Committed part of the file */
+    size_t commitLen;
+    /** End of the last record written */
+    size_t endLen;
+    /** Bytes of records still in use / superseded */
+    size_t liveLen;
+    size_t deadLen;
+    ks_mmap_slot_t *slots;
+    size_t nSlots;
+    size_t nUsed;
+};
+
+/* ************************************************************************** */
+/* Static function declarations                                               */
+/* ************************************************************************** */
+
+static uint32_t ks_mmap_fnv1a(uint32_t hash, const uint8_t *data, size_t len);
+static ks_mmap_slot_t *ks_mmap_slot(ks_mmap_t *pStore, uint32_t extKeyId);
+static sss_status_t ks_mmap_index_grow(ks_mmap_t *pStore);
+static sss_status_t ks_mmap_index_set(ks_mmap_t *pStore, uint32_t extKeyId, uint64_t offset);
+static sss_status_t ks_mmap_map(ks_mmap_t *pStore, size_t minLen);
+static sss_status_t ks_mmap_pwrite(int fd, const void *buf, size_t len, size_t offset);
+static sss_status_t ks_mmap_append(ks_mmap_t *pStore,
+    uint32_t extKeyId,
+    uint8_t keyPart,
+    uint8_t cipherType,
+    uint8_t flags,
+    const uint8_t *data,
+    size_t dataLen);
+static sss_status_t ks_mmap_scan(ks_mmap_t *pStore);
+static sss_status_t ks_mmap_sync_dir(const char *file_name);
+static sss_status_t ks_mmap_open_file(ks_mmap_t *pStore);
+static void ks_mmap_close_file(ks_mmap_t *pStore);
+static sss_status_t ks_mmap_import_fat(ks_mmap_t *pStore, const char *szRootPath);
+
+/* ************************************************************************** */
+/* Public Functions                                                           */
+/* ************************************************************************** */
+
+sss_status_t ks_mmap_open(ks_mmap_t **ppStore, const char *szRootPath)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ks_mmap_t *pStore   = NULL;
+    char fat_name[MAX_FILE_NAME_SIZE];
+
+    ENSURE_OR_GO_CLEANUP(ppStore);
+    ENSURE_OR_GO_CLEANUP(szRootPath);
+    pStore = SSS_CALLOC(1, sizeof(*pStore));
+    ENSURE_OR_GO_CLEANUP(pStore);
+    pStore->fd = -1;
+    SNPRINTF(pStore->file_name, sizeof(pStore->file_name), "%s/" KS_MMAP_FILENAME, szRootPath);
+    SNPRINTF(fat_name, sizeof(fat_name), "%s/" KS_FAT_FILENAME, szRootPath);
+
+    if (0 != access(pStore->file_name, F_OK) && 0 == access(fat_name, F_OK)) {
+        /* First open of a FAT based key store */
+        retval = ks_mmap_import_fat(pStore, szRootPath);
+        ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    }
+    retval = ks_mmap_open_file(pStore);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+
+    if (pStore->deadLen > KS_MMAP_COMPACT_MIN && pStore->deadLen > pStore->liveLen) {
+        LOG_I("Compacting %s, %u bytes unused", pStore->file_name, (unsigned)pStore->deadLen);
+        if (ks_mmap_compact(pStore) != kStatus_SSS_Success) {
+            if (pStore->fd < 0) {
+                /* Failed after the rename, the store is closed */
+                LOG_E("Compacting %s failed, can not reopen it", pStore->file_name);
+                retval = kStatus_SSS_Fail;
+                goto cleanup;
+            }
+            LOG_W("Compacting %s failed, going on with it as is", pStore->file_name);
+        }
+    }
+    *ppStore = pStore;
+    pStore   = NULL;
+
+cleanup:
+    if (pStore != NULL) {
+        ks_mmap_close(pStore);
+        retval = kStatus_SSS_Fail;
+    }
+    return retval;
+}
+
+void ks_mmap_close(ks_mmap_t *pStore)
+{
+    if (pStore != NULL) {
+        ks_mmap_close_file(pStore);
+        SSS_FREE(pStore);
+    }
+}
+
+sss_status_t ks_mmap_put(
+    ks_mmap_t *pStore, uint32_t extKeyId, uint8_t keyPart, uint8_t cipherType, const uint8_t *data, size_t dataLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ENSURE_OR_GO_CLEANUP(pStore);
+    ENSURE_OR_GO_CLEANUP(extKeyId != 0);
+    ENSURE_OR_GO_CLEANUP(data != NULL || dataLen == 0);
+    {
+        uint8_t oldKeyPart;
+        uint8_t oldCipherType;
+        const uint8_t *oldData;
+        size_t oldDataLen;
+        if (kStatus_SSS_Success == ks_mmap_get(pStore, extKeyId, &oldKeyPart, &oldCipherType, &oldData, &oldDataLen) &&
+            oldKeyPart == keyPart && oldCipherType == cipherType && oldDataLen == dataLen &&
+            (dataLen == 0 || 0 == memcmp(oldData, data, dataLen))) {
+            /* Unchanged, do not grow the file with a dead record */
+            retval = kStatus_SSS_Success;
+            goto cleanup;
+        }
+    }
+    retval = ks_mmap_append(pStore, extKeyId, keyPart, cipherType, 0, data, dataLen);
+cleanup:
+    return retval;
+}
+
+sss_status_t ks_mmap_get(ks_mmap_t *pStore,
+    uint32_t extKeyId,
+    uint8_t *pKeyPart,
+    uint8_t *pCipherType,
+    const uint8_t **ppData,
+    size_t *pDataLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ks_mmap_slot_t *pSlot;
+    const ks_mmap_record_t *pRec;
+
+    ENSURE_OR_GO_CLEANUP(pStore);
+    pSlot = ks_mmap_slot(pStore, extKeyId);
+    if (pSlot == NULL || pSlot->state == KS_MMAP_SLOT_FREE || pSlot->offset == 0) {
+        goto cleanup;
+    }
+    pRec = (const ks_mmap_record_t *)(pStore->base + pSlot->offset);
+    if (pKeyPart != NULL) {
+        *pKeyPart = pRec->keyPart;
+    }
+    if (pCipherType != NULL) {
+        *pCipherType = pRec->cipherType;
+    }
+    if (ppData != NULL) {
+        *ppData = (const uint8_t *)(pRec + 1);
+    }
+    if (pDataLen != NULL) {
+        *pDataLen = pRec->dataLen;
+    }
+    retval = kStatus_SSS_Success;
+cleanup:
+    return retval;
+}
+
+sss_status_t ks_mmap_remove(ks_mmap_t *pStore, uint32_t extKeyId)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ENSURE_OR_GO_CLEANUP(pStore);
+    retval = ks_mmap_get(pStore, extKeyId, NULL, NULL, NULL, NULL);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    retval = ks_mmap_append(pStore, extKeyId, 0, 0, KS_MMAP_REC_REMOVED, NULL, 0);
+cleanup:
+    return retval;
+}
+
+sss_status_t ks_mmap_commit(ks_mmap_t *pStore)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint64_t commitLen;
+
+    ENSURE_OR_GO_CLEANUP(pStore);
+    if (pStore->endLen == pStore->commitLen) {
+        retval = kStatus_SSS_Success;
+        goto cleanup;
+    }
+    /* Records first, then the commit point */
+    ENSURE_OR_GO_CLEANUP(0 == fdatasync(pStore->fd));
+    commitLen = pStore->endLen;
+    retval    = ks_mmap_pwrite(pStore->fd, &commitLen, sizeof(commitLen), offsetof(ks_mmap_header_t, commitLen));
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    retval = kStatus_SSS_Fail;
+    ENSURE_OR_GO_CLEANUP(0 == fdatasync(pStore->fd));
+    pStore->commitLen = pStore->endLen;
+    retval            = kStatus_SSS_Success;
+cleanup:
+    return retval;
+}
+
+sss_status_t ks_mmap_compact(ks_mmap_t *pStore)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    char tmp_name[MAX_FILE_NAME_SIZE + 4];
+    ks_mmap_header_t header;
+    size_t outLen = sizeof(header);
+    size_t i;
+    int fd = -1;
+
+    ENSURE_OR_GO_CLEANUP(pStore);
+    /* Uncommitted records are not carried over */
+    ENSURE_OR_GO_CLEANUP(pStore->endLen == pStore->commitLen);
+    SNPRINTF(tmp_name, sizeof(tmp_name), "%s.tmp", pStore->file_name);
+    fd = open(tmp_name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ENSURE_OR_GO_CLEANUP(fd >= 0);
+
+    for (i = 0; i < pStore->nSlots; i++) {
+        const ks_mmap_slot_t *pSlot = &pStore->slots[i];
+        if (pSlot->state == KS_MMAP_SLOT_USED && pSlot->offset != 0) {
+            const ks_mmap_record_t *pRec = (const ks_mmap_record_t *)(pStore->base + pSlot->offset);
+            size_t recLen                = KS_MMAP_ALIGN(sizeof(*pRec) + pRec->dataLen);
+            retval                       = ks_mmap_pwrite(fd, pRec, recLen, outLen);
+            ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+            outLen += recLen;
+        }
+    }
+    memset(&header, 0, sizeof(header));
+    header.magic     = KS_MMAP_MAGIC;
+    header.version   = KS_MMAP_VERSION;
+    header.headerLen = sizeof(header);
+    header.commitLen = outLen;
+    retval           = ks_mmap_pwrite(fd, &header, sizeof(header), 0);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    retval = kStatus_SSS_Fail;
+    ENSURE_OR_GO_CLEANUP(0 == fsync(fd));
+    close(fd);
+    fd = -1;
+
+    if (0 != rename(tmp_name, pStore->file_name)) {
+        unlink(tmp_name);
+        goto cleanup;
+    }
+    /* The rename itself is durable only once the directory is */
+    retval = ks_mmap_sync_dir(pStore->file_name);
+    ks_mmap_close_file(pStore);
+    if (ks_mmap_open_file(pStore) != kStatus_SSS_Success) {
+        retval = kStatus_SSS_Fail;
+    }
+
+cleanup:
+    if (fd >= 0) {
+        close(fd);
+        unlink(tmp_name);
+    }
+    return retval;
+}
+
+size_t ks_mmap_count(ks_mmap_t *pStore)
+{
+    size_t count = 0;
+    size_t i;
+    if (pStore != NULL) {
+        for (i = 0; i < pStore->nSlots; i++) {
+            if (pStore->slots[i].state == KS_MMAP_SLOT_USED && pStore->slots[i].offset != 0) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* ************************************************************************** */
+/* Private Functions                                                          */
+/* ************************************************************************** */
+
+static uint32_t ks_mmap_fnv1a(uint32_t hash, const uint8_t *data, size_t len)
+{
+    size_t i;
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Slot of extKeyId, or the free slot where it would go */
+static ks_mmap_slot_t *ks_mmap_slot(ks_mmap_t *pStore, uint32_t extKeyId)
+{
+    uint32_t h = extKeyId;
+    size_t i;
+
+    if (pStore->nSlots == 0) {
+        return NULL;
+    }
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    i = h & (pStore->nSlots - 1);
+    while (pStore->slots[i].state != KS_MMAP_SLOT_FREE && pStore->slots[i].extKeyId != extKeyId) {
+        i = (i + 1) & (pStore->nSlots - 1);
+    }
+    return &pStore->slots[i];
+}
+
+static sss_status_t ks_mmap_index_grow(ks_mmap_t *pStore)
+{
+    ks_mmap_slot_t *pOld = pStore->slots;
+    size_t nOld          = pStore->nSlots;
+    size_t i;
+
+    pStore->nSlots = (nOld == 0) ? 1024 : nOld * 2;
+    pStore->slots  = SSS_CALLOC(pStore->nSlots, sizeof(*pStore->slots));
+    if (pStore->slots == NULL) {
+        pStore->slots  = pOld;
+        pStore->nSlots = nOld;
+        return kStatus_SSS_Fail;
+    }
+    for (i = 0; i < nOld; i++) {
+        if (pOld[i].state == KS_MMAP_SLOT_USED) {
+            *ks_mmap_slot(pStore, pOld[i].extKeyId) = pOld[i];
+        }
+    }
+    if (pOld != NULL) {
+        SSS_FREE(pOld);
+    }
+    return kStatus_SSS_Success;
+}
+
+/* Point extKeyId to the record at offset, 0 when it is removed */
+static sss_status_t ks_mmap_index_set(ks_mmap_t *pStore, uint32_t extKeyId, uint64_t offset)
+{
+    ks_mmap_slot_t *pSlot;
+
+    /* Keep the load at most 1/2 */
+    if ((pStore->nUsed + 1) * 2 > pStore->nSlots) {
+        if (ks_mmap_index_grow(pStore) != kStatus_SSS_Success) {
+            return kStatus_SSS_Fail;
+        }
+    }
+    pSlot = ks_mmap_slot(pStore, extKeyId);
+    if (pSlot->state == KS_MMAP_SLOT_FREE) {
+        pSlot->state    = KS_MMAP_SLOT_USED;
+        pSlot->extKeyId = extKeyId;
+        pStore->nUsed++;
+    }
+    else if (pSlot->offset != 0) {
+        const ks_mmap_record_t *pPrev = (const ks_mmap_record_t *)(pStore->base + pSlot->offset);
+        size_t prevLen                = KS_MMAP_ALIGN(sizeof(*pPrev) + pPrev->dataLen);
+        pStore->liveLen -= prevLen;
+        pStore->deadLen += prevLen;
+    }
+    pSlot->offset = offset;
+    return kStatus_SSS_Success;
+}
+
+/* Map at least minLen bytes of the file */
+static sss_status_t ks_mmap_map(ks_mmap_t *pStore, size_t minLen)
+{
+    size_t mapLen = KS_MMAP_MIN_MAP;
+    void *pMap;
+
+    if (pStore->base != NULL && minLen <= pStore->mapLen) {
+        return kStatus_SSS_Success;
+    }
+    while (mapLen < minLen * 2) {
+        mapLen *= 2;
+    }
+    /* Mapped past the end of the file, only the written part is read */
+    pMap = mmap(NULL, mapLen, PROT_READ, MAP_SHARED, pStore->fd, 0);
+    if (pMap == MAP_FAILED) {
+        LOG_E("mmap of %s failed, errno=%d", pStore->file_name, errno);
+        return kStatus_SSS_Fail;
+    }
+    if (pStore->base != NULL) {
+        munmap((void *)pStore->base, pStore->mapLen);
+    }
+    pStore->base   = (const uint8_t *)pMap;
+    pStore->mapLen = mapLen;
+    return kStatus_SSS_Success;
+}
+
+static sss_status_t ks_mmap_pwrite(int fd, const void *buf, size_t len, size_t offset)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len > 0) {
+        ssize_t written = pwrite(fd, p, len, (off_t)offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            LOG_E("Writing key store failed, errno=%d", errno);
+            return kStatus_SSS_Fail;
+        }
+        p += written;
+        len -= (size_t)written;
+        offset += (size_t)written;
+    }
+    return kStatus_SSS_Success;
+}
+
+static sss_status_t ks_mmap_append(ks_mmap_t *pStore,
+    uint32_t extKeyId,
+    uint8_t keyPart,
+    uint8_t cipherType,
+    uint8_t flags,
+    const uint8_t *data,
+    size_t dataLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ks_mmap_record_t rec;
+    const uint8_t pad[8] = {0};
+    size_t offset        = pStore->endLen;
+    size_t recLen        = KS_MMAP_ALIGN(sizeof(rec) + dataLen);
+
+    ENSURE_OR_GO_CLEANUP(dataLen <= UINT32_MAX - sizeof(rec));
+    memset(&rec, 0, sizeof(rec));
+    rec.extKeyId   = extKeyId;
+    rec.dataLen    = (uint32_t)dataLen;
+    rec.keyPart    = keyPart;
+    rec.cipherType = cipherType;
+    rec.flags      = flags;
+    rec.check      = ks_mmap_fnv1a(2166136261u, (const uint8_t *)&rec, offsetof(ks_mmap_record_t, check));
+    rec.check      = ks_mmap_fnv1a(rec.check, data, dataLen);
+
+    retval = ks_mmap_pwrite(pStore->fd, &rec, sizeof(rec), offset);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    if (dataLen > 0) {
+        retval = ks_mmap_pwrite(pStore->fd, data, dataLen, offset + sizeof(rec));
+        ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    }
+    if (recLen > sizeof(rec) + dataLen) {
+        retval = ks_mmap_pwrite(pStore->fd, pad, recLen - sizeof(rec) - dataLen, offset + sizeof(rec) + dataLen);
+        ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    }
+    retval = ks_mmap_map(pStore, offset + recLen);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    pStore->endLen = offset + recLen;
+
+    retval = ks_mmap_index_set(pStore, extKeyId, (flags & KS_MMAP_REC_REMOVED) ? 0 : offset);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    if (flags & KS_MMAP_REC_REMOVED) {
+        pStore->deadLen += recLen;
+    }
+    else {
+        pStore->liveLen += recLen;
+    }
+cleanup:
+    return retval;
+}
+
+/* Build the index from the committed records */
+static sss_status_t ks_mmap_scan(ks_mmap_t *pStore)
+{
+    size_t offset = sizeof(ks_mmap_header_t);
+
+    while (offset < pStore->commitLen) {
+        const ks_mmap_record_t *pRec = (const ks_mmap_record_t *)(pStore->base + offset);
+        size_t recLen;
+        uint32_t check;
+
+        if (pStore->commitLen - offset < sizeof(*pRec) ||
+            pRec->dataLen > pStore->commitLen - offset - sizeof(*pRec)) {
+            LOG_E("%s: record at %u is truncated", pStore->file_name, (unsigned)offset);
+            return kStatus_SSS_Fail;
+        }
+        check = ks_mmap_fnv1a(2166136261u, (const uint8_t *)pRec, offsetof(ks_mmap_record_t, check));
+        check = ks_mmap_fnv1a(check, (const uint8_t *)(pRec + 1), pRec->dataLen);
+        if (check != pRec->check) {
+            LOG_E("%s: record at %u is corrupt", pStore->file_name, (unsigned)offset);
+            return kStatus_SSS_Fail;
+        }
+        recLen = KS_MMAP_ALIGN(sizeof(*pRec) + pRec->dataLen);
+        if (ks_mmap_index_set(pStore, pRec->extKeyId, (pRec->flags & KS_MMAP_REC_REMOVED) ? 0 : offset) !=
+            kStatus_SSS_Success) {
+            return kStatus_SSS_Fail;
+        }
+        if (pRec->flags & KS_MMAP_REC_REMOVED) {
+            pStore->deadLen += recLen;
+        }
+        else {
+            pStore->liveLen += recLen;
+        }
+        offset += recLen;
+    }
+    return kStatus_SSS_Success;
+}
+
+/* fsync the directory holding file_name */
+static sss_status_t ks_mmap_sync_dir(const char *file_name)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    char dir_name[MAX_FILE_NAME_SIZE];
+    char *pSlash;
+    int fd = -1;
+
+    SNPRINTF(dir_name, sizeof(dir_name), "%s", file_name);
+    pSlash = strrchr(dir_name, '/');
+    if (pSlash == NULL) {
+        SNPRINTF(dir_name, sizeof(dir_name), ".");
+    }
+    else if (pSlash == dir_name) {
+        pSlash[1] = '\0';
+    }
+    else {
+        *pSlash = '\0';
+    }
+    fd = open(dir_name, O_RDONLY);
+    if (fd < 0) {
+        LOG_E("Can not open %s, errno=%d", dir_name, errno);
+        goto cleanup;
+    }
+    ENSURE_OR_GO_CLEANUP(0 == fsync(fd));
+    retval = kStatus_SSS_Success;
+cleanup:
+    if (fd >= 0) {
+        close(fd);
+    }
+    return retval;
+}
+
+static sss_status_t ks_mmap_open_file(ks_mmap_t *pStore)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    ks_mmap_header_t header;
+    struct stat st;
+
+    pStore->fd = open(pStore->file_name, O_RDWR | O_CREAT, 0600);
+    if (pStore->fd < 0) {
+        LOG_E("Can not open %s, errno=%d", pStore->file_name, errno);
+        goto cleanup;
+    }
+    ENSURE_OR_GO_CLEANUP(0 == fstat(pStore->fd, &st));
+    if (st.st_size == 0) {
+        memset(&header, 0, sizeof(header));
+        header.magic     = KS_MMAP_MAGIC;
+        header.version   = KS_MMAP_VERSION;
+        header.headerLen = sizeof(header);
+        header.commitLen = sizeof(header);
+        retval           = ks_mmap_pwrite(pStore->fd, &header, sizeof(header), 0);
+        ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+        retval = kStatus_SSS_Fail;
+        ENSURE_OR_GO_CLEANUP(0 == fdatasync(pStore->fd));
+    }
+    else {
+        ENSURE_OR_GO_CLEANUP(pread(pStore->fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header));
+        if (header.magic != KS_MMAP_MAGIC || header.version != KS_MMAP_VERSION ||
+            header.headerLen != sizeof(header)) {
+            LOG_E("%s is not a key store of this version", pStore->file_name);
+            goto cleanup;
+        }
+        if (header.commitLen < sizeof(header) || header.commitLen > (uint64_t)st.st_size) {
+            LOG_E("%s is truncated", pStore->file_name);
+            goto cleanup;
+        }
+        if ((uint64_t)st.st_size > header.commitLen) {
+            /* Written but never committed */
+            LOG_W("%s: dropping %u uncommitted bytes",
+                pStore->file_name,
+                (unsigned)((uint64_t)st.st_size - header.commitLen));
+            ENSURE_OR_GO_CLEANUP(0 == ftruncate(pStore->fd, (off_t)header.commitLen));
+        }
+    }
+    pStore->commitLen = (size_t)header.commitLen;
+    pStore->endLen    = pStore->commitLen;
+
+    retval = ks_mmap_map(pStore, pStore->commitLen);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    retval = ks_mmap_index_grow(pStore);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    retval = ks_mmap_scan(pStore);
+
+cleanup:
+    if (retval != kStatus_SSS_Success) {
+        ks_mmap_close_file(pStore);
+    }
+    return retval;
+}
+
+static void ks_mmap_close_file(ks_mmap_t *pStore)
+{
+    if (pStore->base != NULL) {
+        munmap((void *)pStore->base, pStore->mapLen);
+    }
+    if (pStore->fd >= 0) {
+        close(pStore->fd);
+    }
+    if (pStore->slots != NULL) {
+        SSS_FREE(pStore->slots);
+    }
+    pStore->fd        = -1;
+    pStore->base      = NULL;
+    pStore->mapLen    = 0;
+    pStore->slots     = NULL;
+    pStore->nSlots    = 0;
+    pStore->nUsed     = 0;
+    pStore->commitLen = 0;
+    pStore->endLen    = 0;
+    pStore->liveLen   = 0;
+    pStore->deadLen   = 0;
+}
+
+/* Create the key store file from sss_fat.bin and the per key files of the
+ * FAT based key store in szRootPath. The keys are written to a temporary
+ * file that is renamed once committed, an import cut short starts over at
+ * the next open. The FAT based files are left as they are. */
+static sss_status_t ks_mmap_import_fat(ks_mmap_t *pStore, const char *szRootPath)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    char store_name[MAX_FILE_NAME_SIZE];
+    char file_name[MAX_FILE_NAME_SIZE];
+    keyStoreTable_t fat;
+    keyIdAndTypeIndexLookup_t *pEntries = NULL;
+    uint8_t *pKey                       = NULL;
+    FILE *fp                            = NULL;
+    size_t nKeys                        = 0;
+    size_t i;
+
+    memcpy(store_name, pStore->file_name, sizeof(store_name));
+    SNPRINTF(file_name, sizeof(file_name), "%s/" KS_FAT_FILENAME, szRootPath);
+    fp = fopen(file_name, "rb");
+    ENSURE_OR_GO_CLEANUP(fp);
+    pEntries = SSS_CALLOC(KS_N_ENTIRES, sizeof(*pEntries));
+    ENSURE_OR_GO_CLEANUP(pEntries);
+    /* Same layout as written by ks_sw_fat_update() */
+    if (1 != fread(&fat, sizeof(fat), 1, fp) || fat.magic != KEYSTORE_MAGIC || fat.version != KEYSTORE_VERSION ||
+        fat.maxEntries != KS_N_ENTIRES ||
+        KS_N_ENTIRES != fread(pEntries, sizeof(*pEntries), KS_N_ENTIRES, fp)) {
+        LOG_E("%s is not a key store of this version, can not import it", file_name);
+        goto cleanup;
+    }
+    fclose(fp);
+    fp = NULL;
+
+    SNPRINTF(pStore->file_name, sizeof(pStore->file_name), "%s.tmp", store_name);
+    unlink(pStore->file_name);
+    retval = ks_mmap_open_file(pStore);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+
+    for (i = 0; i < KS_N_ENTIRES; i++) {
+        const keyIdAndTypeIndexLookup_t *pEntry = &pEntries[i];
+        long fileLen;
+        /* AES / HMAC keys take one entry per 16 bytes */
+        if (pEntry->extKeyId == 0 ||
+            kStatus_SSS_Success == ks_mmap_get(pStore, pEntry->extKeyId, NULL, NULL, NULL, NULL)) {
+            continue;
+        }
+        /* Name as from ks_sw_getKeyFileName() */
+        SNPRINTF(file_name,
+            sizeof(file_name),
+            "%s/sss_%08X_%04d_%04d.bin",
+            szRootPath,
+            (unsigned int)pEntry->extKeyId,
+            (int)(pEntry->keyPart & 0x0F),
+            (int)pEntry->cipherType);
+        fp = fopen(file_name, "rb");
+        if (fp == NULL) {
+            LOG_W("%s is missing, key 0x%08X is not imported", file_name, (unsigned int)pEntry->extKeyId);
+            continue;
+        }
+        retval = kStatus_SSS_Fail;
+        ENSURE_OR_GO_CLEANUP(0 == fseek(fp, 0, SEEK_END));
+        fileLen = ftell(fp);
+        ENSURE_OR_GO_CLEANUP(fileLen >= 0);
+        ENSURE_OR_GO_CLEANUP(0 == fseek(fp, 0, SEEK_SET));
+        pKey = SSS_MALLOC(fileLen > 0 ? (size_t)fileLen : 1);
+        ENSURE_OR_GO_CLEANUP(pKey);
+        ENSURE_OR_GO_CLEANUP(fileLen == 0 || 1 == fread(pKey, (size_t)fileLen, 1, fp));
+        fclose(fp);
+        fp = NULL;
+
+        retval = ks_mmap_put(
+            pStore, pEntry->extKeyId, (uint8_t)(pEntry->keyPart & 0x0F), pEntry->cipherType, pKey, (size_t)fileLen);
+        ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+        SSS_FREE(pKey);
+        pKey = NULL;
+        nKeys++;
+    }
+    retval = ks_mmap_commit(pStore);
+    ENSURE_OR_GO_CLEANUP(retval == kStatus_SSS_Success);
+    ks_mmap_close_file(pStore);
+
+    retval = kStatus_SSS_Fail;
+    if (0 != rename(pStore->file_name, store_name)) {
+        LOG_E("Can not rename %s, errno=%d", pStore->file_name, errno);
+        goto cleanup;
+    }
+    retval = ks_mmap_sync_dir(store_name);
+    LOG_I("Imported %u keys of %s/" KS_FAT_FILENAME " into %s", (unsigned)nKeys, szRootPath, store_name);
+
+cleanup:
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    if (pKey != NULL) {
+        SSS_FREE(pKey);
+    }
+    if (pEntries != NULL) {
+        SSS_FREE(pEntries);
+    }
+    if (retval != kStatus_SSS_Success && pStore->fd >= 0) {
+        ks_mmap_close_file(pStore);
+        unlink(pStore->file_name);
+    }
+    memcpy(pStore->file_name, store_name, sizeof(store_name));
+    return retval;
+}
+
+#endif /* SSS_KS_MMAP */
@@ -44,6 +44,73 @@
 /* Public Functions                                                           */
 /* ************************************************************************** */
 
+/* Create sss_key from its serialized form, as written by ks_openssl_store_key() */
+static sss_status_t ks_openssl_parse_key(sss_openssl_object_t *sss_key,
+    uint32_t extKeyId,
+    sss_key_part_t keyPart,
+    sss_cipher_type_t cipherType,
+    const uint8_t *keyBuf,
+    size_t size)
+{
+    sss_status_t retval;
+    const uint8_t *buf_ptr = keyBuf;
+    EVP_PKEY *pkey         = NULL;
+
+    retval = sss_openssl_key_object_allocate(sss_key, extKeyId, keyPart, cipherType, size, kKeyObject_Mode_Persistent);
+    if (retval == kStatus_SSS_Success) {
+        switch (sss_key->cipherType) {
+        case kSSS_CipherType_RSA:
+        case kSSS_CipherType_RSA_CRT: {
+            if (sss_key->contents != NULL) {
+                SSS_FREE((void *)sss_key->contents);
+            }
+            if (sss_key->objectType == kSSS_KeyPart_Public) {
+                pkey = d2i_PublicKey(EVP_PKEY_RSA, NULL, &buf_ptr, (long)size);
+            }
+            else {
+                pkey = d2i_AutoPrivateKey(NULL, &buf_ptr, (long)size);
+            }
+
+            if (pkey == NULL) {
+                retval = kStatus_SSS_Fail;
+            }
+            else {
+                sss_key->contents = (void *)pkey;
+            }
+
+            sss_key->keyBitLen = EVP_PKEY_bits(pkey);
+        } break;
+        case kSSS_CipherType_EC_NIST_P:
+        case kSSS_CipherType_EC_NIST_K:
+        case kSSS_CipherType_EC_BRAINPOOL:
+        case kSSS_CipherType_EC_MONTGOMERY:
+        case kSSS_CipherType_EC_TWISTED_ED: {
+            if (sss_key->contents != NULL) {
+                EVP_PKEY_free((EVP_PKEY *)sss_key->contents);
+            }
+            if (sss_key->objectType == kSSS_KeyPart_Public) {
+                pkey = d2i_PublicKey(EVP_PKEY_EC, NULL, &buf_ptr, (long)size);
+            }
+            else {
+                pkey = d2i_AutoPrivateKey(NULL, &buf_ptr, (long)size);
+            }
+
+            if (pkey == NULL) {
+                retval = kStatus_SSS_Fail;
+            }
+            else {
+                sss_key->contents = (void *)pkey;
+            }
+            sss_key->keyBitLen = EVP_PKEY_bits(pkey);
+        } break;
+        default: {
+            retval = sss_openssl_key_store_set_key(sss_key->keyStore, sss_key, keyBuf, size, size * 8, NULL, 0);
+        } break;
+        }
+    }
+    return retval;
+}
+
 sss_status_t ks_openssl_load_key(sss_openssl_object_t *sss_key, keyStoreTable_t *keystore_shadow, uint32_t extKeyId)
 {
     sss_status_t retval = kStatus_SSS_Fail;
@@ -53,7 +120,21 @@ sss_status_t ks_openssl_load_key(sss_openssl_object_t *sss_key, keyStoreTable_t
     size_t size = 0;
     uint32_t i;
     keyIdAndTypeIndexLookup_t *shadowEntry = NULL;
-    EVP_PKEY *pkey                         = NULL;
+
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        uint8_t keyPart;
+        uint8_t cipherType;
+        const uint8_t *pData;
+        retval = ks_mmap_get(sss_key->keyStore->mmap_store, extKeyId, &keyPart, &cipherType, &pData, &size);
+        if (retval == kStatus_SSS_Success) {
+            /* Parsed straight from the mapped file */
+            retval = ks_openssl_parse_key(
+                sss_key, extKeyId, (sss_key_part_t)keyPart, (sss_cipher_type_t)cipherType, pData, size);
+        }
+        return retval;
+    }
+#endif
 
     for (i = 0; i < sss_key->keyStore->max_object_count; i++) {
         if (keystore_shadow->entries[i].extKeyId == extKeyId) {
@@ -76,8 +157,7 @@ sss_status_t ks_openssl_load_key(sss_openssl_object_t *sss_key, keyStoreTable_t
         else {
             /*Buffer: max RSA key*/
             uint8_t keyBuf[3000];
-            const uint8_t *buf_ptr = keyBuf;
-            long signed_size       = 0;
+            long signed_size = 0;
             fseek(fp, 0, SEEK_END);
             signed_size = ftell(fp);
             if (signed_size < 0) {
@@ -91,63 +171,12 @@ sss_status_t ks_openssl_load_key(sss_openssl_object_t *sss_key, keyStoreTable_t
                 LOG_E("Error in fread");
             }
             fclose(fp);
-            retval = sss_openssl_key_object_allocate(sss_key,
+            retval = ks_openssl_parse_key(sss_key,
                 shadowEntry->extKeyId,
                 (sss_key_part_t)(shadowEntry->keyPart & 0x0F),
                 (sss_cipher_type_t)(shadowEntry->cipherType),
-                size,
-                kKeyObject_Mode_Persistent);
-            if (retval == kStatus_SSS_Success) {
-                switch (sss_key->cipherType) {
-                case kSSS_CipherType_RSA:
-                case kSSS_CipherType_RSA_CRT: {
-                    if (sss_key->contents != NULL) {
-                        SSS_FREE((void *)sss_key->contents);
-                    }
-                    if (sss_key->objectType == kSSS_KeyPart_Public) {
-                        pkey = d2i_PublicKey(EVP_PKEY_RSA, NULL, &buf_ptr, (long)size);
-                    }
-                    else {
-                        pkey = d2i_AutoPrivateKey(NULL, &buf_ptr, (long)size);
-                    }
-
-                    if (pkey == NULL) {
-                        retval = kStatus_SSS_Fail;
-                    }
-                    else {
-                        sss_key->contents = (void *)pkey;
-                    }
-
-                    sss_key->keyBitLen = EVP_PKEY_bits(pkey);
-                } break;
-                case kSSS_CipherType_EC_NIST_P:
-                case kSSS_CipherType_EC_NIST_K:
-                case kSSS_CipherType_EC_BRAINPOOL:
-                case kSSS_CipherType_EC_MONTGOMERY:
-                case kSSS_CipherType_EC_TWISTED_ED: {
-                    if (sss_key->contents != NULL) {
-                        EVP_PKEY_free((EVP_PKEY *)sss_key->contents);
-                    }
-                    if (sss_key->objectType == kSSS_KeyPart_Public) {
-                        pkey = d2i_PublicKey(EVP_PKEY_EC, NULL, &buf_ptr, (long)size);
-                    }
-                    else {
-                        pkey = d2i_AutoPrivateKey(NULL, &buf_ptr, (long)size);
-                    }
-
-                    if (pkey == NULL) {
-                        retval = kStatus_SSS_Fail;
-                    }
-                    else {
-                        sss_key->contents = (void *)pkey;
-                    }
-                    sss_key->keyBitLen = EVP_PKEY_bits(pkey);
-                } break;
-                default: {
-                    retval = sss_openssl_key_store_set_key(sss_key->keyStore, sss_key, keyBuf, size, size * 8, NULL, 0);
-                } break;
-                }
-            }
+                keyBuf,
+                size);
         }
     }
     return retval;
@@ -157,8 +186,60 @@ sss_status_t ks_openssl_store_key(const sss_openssl_object_t *sss_key)
 {
     sss_status_t retval = kStatus_SSS_Fail;
     char file_name[MAX_FILE_NAME_SIZE];
-    FILE *fp              = NULL;
-    unsigned char *Buffer = NULL;
+    FILE *fp                   = NULL;
+    unsigned char *Buffer      = NULL;
+    const unsigned char *pData = NULL;
+    int len                    = 0;
+    EVP_PKEY *pk;
+    pk = (EVP_PKEY *)sss_key->contents;
+    switch (sss_key->objectType) {
+    case kSSS_KeyPart_Default:
+        pData = sss_key->contents;
+        len   = (int)sss_key->contents_max_size;
+        break;
+    case kSSS_KeyPart_Pair:
+    case kSSS_KeyPart_Private:
+        len = i2d_PrivateKey(pk, NULL);
+        if (len < 0) {
+            goto exit;
+        }
+        //Buffer = (unsigned char *)malloc(len + 1);
+        len = i2d_PrivateKey(pk, &Buffer);
+        if (len < 0) {
+            goto exit;
+        }
+        pData = Buffer;
+        break;
+    case kSSS_KeyPart_Public:
+        len = i2d_PublicKey(pk, NULL);
+        if (len < 0) {
+            goto exit;
+        }
+
+        //Buffer = (unsigned char *)malloc(len + 1);
+        len = i2d_PublicKey(pk, &Buffer);
+        if (len < 0) {
+            goto exit;
+        }
+        pData = Buffer;
+        break;
+    default:
+        LOG_E("Invalid objectType");
+        goto exit;
+    }
+
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        retval = ks_mmap_put(sss_key->keyStore->mmap_store,
+            sss_key->keyId,
+            (uint8_t)sss_key->objectType,
+            (uint8_t)sss_key->cipherType,
+            pData,
+            (size_t)len);
+        goto exit;
+    }
+#endif
+
     ks_sw_getKeyFileName(
         file_name, sizeof(file_name), (const sss_object_t *)sss_key, sss_key->keyStore->session->szRootPath);
     fp = fopen(file_name, "wb+");
@@ -167,45 +248,10 @@ sss_status_t ks_openssl_store_key(const sss_openssl_object_t *sss_key)
         retval = kStatus_SSS_Fail;
     }
     else {
-        int len = 0;
-        EVP_PKEY *pk;
-        pk = (EVP_PKEY *)sss_key->contents;
-        switch (sss_key->objectType) {
-        case kSSS_KeyPart_Default:
-            fwrite(sss_key->contents, sss_key->contents_max_size, 1, fp);
-            retval = kStatus_SSS_Success;
-            break;
-        case kSSS_KeyPart_Pair:
-        case kSSS_KeyPart_Private:
-            len = i2d_PrivateKey(pk, NULL);
-            if (len < 0) {
-                goto exit;
-            }
-            //Buffer = (unsigned char *)malloc(len + 1);
-            len = i2d_PrivateKey(pk, &Buffer);
-            if (len < 0) {
-                goto exit;
-            }
-            break;
-        case kSSS_KeyPart_Public:
-            len = i2d_PublicKey(pk, NULL);
-            if (len < 0) {
-                goto exit;
-            }
-
-            //Buffer = (unsigned char *)malloc(len + 1);
-            len = i2d_PublicKey(pk, &Buffer);
-            if (len < 0) {
-                goto exit;
-            }
-            break;
-        default:
-            LOG_E("Invalid objectType");
-        }
-        if (len > 0 && retval != kStatus_SSS_Success) {
-            fwrite(Buffer, len, 1, fp);
-            retval = kStatus_SSS_Success;
+        if (len > 0) {
+            fwrite(pData, len, 1, fp);
         }
+        retval = kStatus_SSS_Success;
     }
 exit:
     if (fp != NULL) {
@@ -227,6 +273,11 @@ sss_status_t ks_openssl_remove_key(const sss_openssl_object_t *sss_key)
 {
     sss_status_t retval = kStatus_SSS_Fail;
     char file_name[MAX_FILE_NAME_SIZE];
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        return ks_mmap_remove(sss_key->keyStore->mmap_store, sss_key->keyId);
+    }
+#endif
     ks_sw_getKeyFileName(
         file_name, sizeof(file_name), (const sss_object_t *)sss_key, sss_key->keyStore->session->szRootPath);
     if (0 == UNLINK(file_name)) {
@@ -151,6 +151,11 @@ static sss_status_t ks_sw_fat_update(keyStoreTable_t *keystore_shadow, const cha
 #if defined(MBEDTLS_FS_IO)
 sss_status_t ks_mbedtls_fat_update(sss_mbedtls_key_store_t *keyStore)
 {
+#if SSS_KS_MMAP
+    if (keyStore->mmap_store != NULL) {
+        return ks_mmap_commit(keyStore->mmap_store);
+    }
+#endif
     return ks_sw_fat_update(keyStore->keystore_shadow, keyStore->session->szRootPath);
 }
 #endif
@@ -158,6 +163,11 @@ sss_status_t ks_mbedtls_fat_update(sss_mbedtls_key_store_t *keyStore)
 #if SSS_HAVE_HOSTCRYPTO_OPENSSL
 sss_status_t ks_openssl_fat_update(sss_openssl_key_store_t *keyStore)
 {
+#if SSS_KS_MMAP
+    if (keyStore->mmap_store != NULL) {
+        return ks_mmap_commit(keyStore->mmap_store);
+    }
+#endif
     return ks_sw_fat_update(keyStore->keystore_shadow, keyStore->session->szRootPath);
 }
 #endif
@@ -197,6 +207,27 @@ cleanup:
 }
 
 #if defined(MBEDTLS_FS_IO)
+/* Create sss_key from its serialized form, as written by ks_mbedtls_store_key() */
+static sss_status_t ks_mbedtls_parse_key(sss_mbedtls_object_t *sss_key,
+    uint32_t extKeyId,
+    sss_key_part_t keyPart,
+    sss_cipher_type_t cipherType,
+    const uint8_t *keyBuf,
+    size_t size)
+{
+    sss_status_t retval;
+    retval = ks_mbedtls_key_object_create(sss_key, extKeyId, keyPart, cipherType, size, kKeyObject_Mode_Persistent);
+    if (retval == kStatus_SSS_Success) {
+        retval = sss_mbedtls_key_store_set_key(sss_key->keyStore, sss_key, keyBuf, size, size * 8 /* FIXME */, NULL, 0);
+    }
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0
+    if (retval == kStatus_SSS_Success) {
+        ks_mbedtls_pk_cache_put(sss_key);
+    }
+#endif
+    return retval;
+}
+
 sss_status_t ks_mbedtls_load_key(sss_mbedtls_object_t *sss_key, keyStoreTable_t *keystore_shadow, uint32_t extKeyId)
 {
     sss_status_t retval = kStatus_SSS_Fail;
@@ -207,6 +238,27 @@ sss_status_t ks_mbedtls_load_key(sss_mbedtls_object_t *sss_key, keyStoreTable_t
     uint32_t i;
     keyIdAndTypeIndexLookup_t *shadowEntry = NULL;
 
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0
+    if (kStatus_SSS_Success == ks_mbedtls_pk_cache_get(sss_key, extKeyId)) {
+        return kStatus_SSS_Success;
+    }
+#endif
+
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        uint8_t keyPart;
+        uint8_t cipherType;
+        const uint8_t *pData;
+        retval = ks_mmap_get(sss_key->keyStore->mmap_store, extKeyId, &keyPart, &cipherType, &pData, &size);
+        if (retval == kStatus_SSS_Success) {
+            /* Parsed straight from the mapped file */
+            retval = ks_mbedtls_parse_key(
+                sss_key, extKeyId, (sss_key_part_t)keyPart, (sss_cipher_type_t)cipherType, pData, size);
+        }
+        return retval;
+    }
+#endif
+
     for (i = 0; i < sss_key->keyStore->max_object_count; i++) {
         if (keystore_shadow->entries[i].extKeyId == extKeyId) {
             shadowEntry         = &keystore_shadow->entries[i];
@@ -256,16 +308,12 @@ sss_status_t ks_mbedtls_load_key(sss_mbedtls_object_t *sss_key, keyStoreTable_t
                 return retval;
             }
             fclose(fp);
-            retval = ks_mbedtls_key_object_create(sss_key,
+            retval = ks_mbedtls_parse_key(sss_key,
                 shadowEntry->extKeyId,
                 (sss_key_part_t)(shadowEntry->keyPart & 0x0F),
                 (sss_cipher_type_t)(shadowEntry->cipherType),
-                size,
-                kKeyObject_Mode_Persistent);
-            if (retval == kStatus_SSS_Success) {
-                retval = sss_mbedtls_key_store_set_key(
-                    sss_key->keyStore, sss_key, keyBuf, size, size * 8 /* FIXME */, NULL, 0);
-            }
+                keyBuf,
+                size);
             if (keyBuf != NULL) {
                 SSS_FREE(keyBuf);
             }
@@ -279,6 +327,56 @@ sss_status_t ks_mbedtls_store_key(const sss_mbedtls_object_t *sss_key)
     sss_status_t retval = kStatus_SSS_Fail;
     char file_name[MAX_FILE_NAME_SIZE];
     FILE *fp = NULL;
+    /* Buffer to hold max RSA Key*/
+    uint8_t key_buf[3000];
+    int ret                    = 0;
+    const unsigned char *pData = NULL;
+    size_t dataLen             = 0;
+    mbedtls_pk_context *pk;
+    memset(key_buf, 0, sizeof(key_buf));
+    pk = (mbedtls_pk_context *)sss_key->contents;
+    switch (sss_key->objectType) {
+    case kSSS_KeyPart_Default:
+        /* Allows to skip writing pem/der files */
+        pData   = sss_key->contents;
+        dataLen = sss_key->contents_max_size;
+        break;
+    case kSSS_KeyPart_Pair:
+    case kSSS_KeyPart_Private:
+        ret = mbedtls_pk_write_key_der(pk, key_buf, sizeof(key_buf));
+        break;
+    case kSSS_KeyPart_Public:
+        ret = mbedtls_pk_write_pubkey_der(pk, key_buf, sizeof(key_buf));
+        break;
+    default:
+        LOG_E("Invalid objectType");
+    }
+    if (ret > 0) {
+        /* DER is written at the end of key_buf */
+        pData   = key_buf + sizeof(key_buf) - ret;
+        dataLen = (size_t)ret;
+    }
+    if (pData == NULL) {
+        return kStatus_SSS_Fail;
+    }
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0
+    if (!sss_key->contents_cached) {
+        /* Not the key as loaded, the cached parse is outdated */
+        ks_mbedtls_pk_cache_drop(sss_key->keyStore, sss_key->keyId);
+    }
+#endif
+
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        return ks_mmap_put(sss_key->keyStore->mmap_store,
+            sss_key->keyId,
+            (uint8_t)sss_key->objectType,
+            (uint8_t)sss_key->cipherType,
+            pData,
+            dataLen);
+    }
+#endif
+
     ks_sw_getKeyFileName(
         file_name, sizeof(file_name), (const sss_object_t *)sss_key, sss_key->keyStore->session->szRootPath);
     fp = fopen(file_name, "wb+");
@@ -287,33 +385,8 @@ sss_status_t ks_mbedtls_store_key(const sss_mbedtls_object_t *sss_key)
         retval = kStatus_SSS_Fail;
     }
     else {
-        /* Buffer to hold max RSA Key*/
-        uint8_t key_buf[3000];
-        int ret          = 0;
-        unsigned char *c = key_buf;
-        memset(key_buf, 0, sizeof(key_buf));
-        mbedtls_pk_context *pk;
-        pk = (mbedtls_pk_context *)sss_key->contents;
-        switch (sss_key->objectType) {
-        case kSSS_KeyPart_Default:
-            fwrite(sss_key->contents, sss_key->contents_max_size, 1, fp);
-            retval = kStatus_SSS_Success; /* Allows to skip writing pem/der files */
-            break;
-        case kSSS_KeyPart_Pair:
-        case kSSS_KeyPart_Private:
-            ret = mbedtls_pk_write_key_der(pk, key_buf, sizeof(key_buf));
-            break;
-        case kSSS_KeyPart_Public:
-            ret = mbedtls_pk_write_pubkey_der(pk, key_buf, sizeof(key_buf));
-            break;
-        default:
-            LOG_E("Invalid objectType");
-        }
-        if (ret > 0 && retval != kStatus_SSS_Success) {
-            c = key_buf + sizeof(key_buf) - ret;
-            fwrite(c, ret, 1, fp);
-            retval = kStatus_SSS_Success;
-        }
+        fwrite(pData, dataLen, 1, fp);
+        retval = kStatus_SSS_Success;
         fflush(fp);
         fclose(fp);
     }
@@ -330,6 +403,14 @@ sss_status_t ks_mbedtls_remove_key(const sss_mbedtls_object_t *sss_key)
 {
     sss_status_t retval = kStatus_SSS_Fail;
     char file_name[MAX_FILE_NAME_SIZE];
+#if SSS_MBEDTLS_PK_CACHE_BUDGET > 0
+    ks_mbedtls_pk_cache_drop(sss_key->keyStore, sss_key->keyId);
+#endif
+#if SSS_KS_MMAP
+    if (sss_key->keyStore->mmap_store != NULL) {
+        return ks_mmap_remove(sss_key->keyStore->mmap_store, sss_key->keyId);
+    }
+#endif
     ks_sw_getKeyFileName(
         file_name, sizeof(file_name), (const sss_object_t *)sss_key, sss_key->keyStore->session->szRootPath);
     if (0 == UNLINK(file_name)) {
@@ -0,0 +1,360 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Single file key store of the host crypto (SSS_KS_MMAP=1), on a
+ * temporary directory:
+ * - put, get back after a reopen, for enough keys to grow the index
+ * - replace, and no new record for an unchanged put
+ * - remove
+ * - records that were not committed are gone after a reopen
+ * - compaction, explicit and at open
+ * - import of a FAT based key store (sss_fat.bin and one file per key)
+ */
+
+#include <fsl_sss_keyid_map.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TEST_N_KEYS 5000
+#define TEST_BIG_KEY_LEN 4096
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return 1;                                       \
+    }
+
+static char gRootPath[] = "/tmp/sss_ks_mmap_XXXXXX";
+static uint32_t gRandom = 0x2545F491u;
+
+static uint32_t xorshift32(void)
+{
+    gRandom ^= gRandom << 13;
+    gRandom ^= gRandom >> 17;
+    gRandom ^= gRandom << 5;
+    return gRandom;
+}
+
+/* Contents of key keyId in version v */
+static void key_data(uint32_t keyId, uint32_t v, uint8_t *data, size_t dataLen)
+{
+    size_t i;
+    for (i = 0; i < dataLen; i++) {
+        data[i] = (uint8_t)(keyId * 31u + v * 7u + i);
+    }
+}
+
+static size_t key_len(uint32_t keyId)
+{
+    return 16 + (keyId % 97);
+}
+
+static int check_key(ks_mmap_t *pStore, uint32_t keyId, uint32_t v, size_t dataLen)
+{
+    uint8_t expected[TEST_BIG_KEY_LEN];
+    uint8_t keyPart;
+    uint8_t cipherType;
+    const uint8_t *pData;
+    size_t len;
+
+    key_data(keyId, v, expected, dataLen);
+    CHECK(kStatus_SSS_Success == ks_mmap_get(pStore, keyId, &keyPart, &cipherType, &pData, &len));
+    CHECK(keyPart == kSSS_KeyPart_Default && cipherType == kSSS_CipherType_AES);
+    CHECK(len == dataLen && 0 == memcmp(pData, expected, dataLen));
+    return 0;
+}
+
+static int put_key(ks_mmap_t *pStore, uint32_t keyId, uint32_t v, size_t dataLen)
+{
+    uint8_t data[TEST_BIG_KEY_LEN];
+    key_data(keyId, v, data, dataLen);
+    CHECK(kStatus_SSS_Success ==
+          ks_mmap_put(pStore, keyId, kSSS_KeyPart_Default, kSSS_CipherType_AES, data, dataLen));
+    return 0;
+}
+
+static long file_size(const char *name)
+{
+    char path[sizeof(gRootPath) + 64];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", gRootPath, name);
+    return (0 == stat(path, &st)) ? (long)st.st_size : -1;
+}
+
+static void remove_root_files(void)
+{
+    char path[sizeof(gRootPath) + 256];
+    struct dirent *pEntry;
+    DIR *pDir = opendir(gRootPath);
+    if (pDir != NULL) {
+        while ((pEntry = readdir(pDir)) != NULL) {
+            if (pEntry->d_name[0] != '.') {
+                snprintf(path, sizeof(path), "%s/%s", gRootPath, pEntry->d_name);
+                remove(path);
+            }
+        }
+        closedir(pDir);
+    }
+}
+
+static int test_put_get(void)
+{
+    ks_mmap_t *pStore = NULL;
+    uint32_t keyId;
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(0 == ks_mmap_count(pStore));
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, 1, NULL, NULL, NULL, NULL));
+    for (keyId = 1; keyId <= TEST_N_KEYS; keyId++) {
+        CHECK(0 == put_key(pStore, keyId, 0, key_len(keyId)));
+    }
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    CHECK(TEST_N_KEYS == ks_mmap_count(pStore));
+    ks_mmap_close(pStore);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(TEST_N_KEYS == ks_mmap_count(pStore));
+    for (keyId = TEST_N_KEYS; keyId >= 1; keyId--) {
+        CHECK(0 == check_key(pStore, keyId, 0, key_len(keyId)));
+    }
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, TEST_N_KEYS + 1, NULL, NULL, NULL, NULL));
+    ks_mmap_close(pStore);
+    return 0;
+}
+
+static int test_replace_remove(void)
+{
+    ks_mmap_t *pStore = NULL;
+    long size;
+    int i;
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    /* Replaced with other contents and length */
+    CHECK(0 == put_key(pStore, 10, 1, 200));
+    /* Same contents, nothing is appended */
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    size = file_size("sss_ks.bin");
+    CHECK(0 == put_key(pStore, 10, 1, 200));
+    CHECK(0 == put_key(pStore, 11, 0, key_len(11)));
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    CHECK(size == file_size("sss_ks.bin"));
+
+    for (i = 0; i < 100; i++) {
+        uint32_t keyId = 20 + xorshift32() % 1000;
+        if (kStatus_SSS_Success == ks_mmap_get(pStore, keyId, NULL, NULL, NULL, NULL)) {
+            CHECK(kStatus_SSS_Success == ks_mmap_remove(pStore, keyId));
+        }
+        CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, keyId, NULL, NULL, NULL, NULL));
+        /* Already removed */
+        CHECK(kStatus_SSS_Success != ks_mmap_remove(pStore, keyId));
+    }
+    CHECK(kStatus_SSS_Success == ks_mmap_remove(pStore, 12));
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    ks_mmap_close(pStore);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(0 == check_key(pStore, 10, 1, 200));
+    CHECK(0 == check_key(pStore, 11, 0, key_len(11)));
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, 12, NULL, NULL, NULL, NULL));
+    /* A removed key can be put again */
+    CHECK(0 == put_key(pStore, 12, 2, 32));
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    ks_mmap_close(pStore);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(0 == check_key(pStore, 12, 2, 32));
+    ks_mmap_close(pStore);
+    return 0;
+}
+
+static int test_uncommitted(void)
+{
+    ks_mmap_t *pStore = NULL;
+    size_t count;
+    long size;
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    count = ks_mmap_count(pStore);
+    size  = file_size("sss_ks.bin");
+    CHECK(0 == put_key(pStore, 10, 3, 64));
+    CHECK(0 == put_key(pStore, TEST_N_KEYS + 1, 0, 64));
+    CHECK(kStatus_SSS_Success == ks_mmap_remove(pStore, 11));
+    /* Seen before the commit */
+    CHECK(0 == check_key(pStore, 10, 3, 64));
+    CHECK(0 == check_key(pStore, TEST_N_KEYS + 1, 0, 64));
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, 11, NULL, NULL, NULL, NULL));
+    /* Written, but not committed */
+    CHECK(size < file_size("sss_ks.bin"));
+    ks_mmap_close(pStore);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(size == file_size("sss_ks.bin"));
+    CHECK(count == ks_mmap_count(pStore));
+    CHECK(0 == check_key(pStore, 10, 1, 200));
+    CHECK(0 == check_key(pStore, 11, 0, key_len(11)));
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, TEST_N_KEYS + 1, NULL, NULL, NULL, NULL));
+    ks_mmap_close(pStore);
+    return 0;
+}
+
+static int test_compact(void)
+{
+    ks_mmap_t *pStore = NULL;
+    size_t count;
+    long size;
+    uint32_t v;
+
+    /* Explicit, needs a commit first */
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    count = ks_mmap_count(pStore);
+    CHECK(0 == put_key(pStore, 10, 4, 100));
+    CHECK(kStatus_SSS_Success != ks_mmap_compact(pStore));
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    size = file_size("sss_ks.bin");
+    CHECK(kStatus_SSS_Success == ks_mmap_compact(pStore));
+    CHECK(size > file_size("sss_ks.bin"));
+    CHECK(count == ks_mmap_count(pStore));
+    CHECK(0 == check_key(pStore, 10, 4, 100));
+    CHECK(0 == check_key(pStore, 11, 0, key_len(11)));
+    CHECK(0 > file_size("sss_ks.bin.tmp"));
+    ks_mmap_close(pStore);
+
+    /* At open, once most of the file is replaced keys */
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    size = file_size("sss_ks.bin");
+    for (v = 0; v < 200; v++) {
+        CHECK(0 == put_key(pStore, 1, v, TEST_BIG_KEY_LEN));
+    }
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    CHECK(size + 200 * TEST_BIG_KEY_LEN < file_size("sss_ks.bin"));
+    ks_mmap_close(pStore);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(size + 2 * TEST_BIG_KEY_LEN > file_size("sss_ks.bin"));
+    CHECK(count == ks_mmap_count(pStore));
+    CHECK(0 == check_key(pStore, 1, 199, TEST_BIG_KEY_LEN));
+    CHECK(0 == check_key(pStore, 2, 0, key_len(2)));
+    CHECK(0 == check_key(pStore, 10, 4, 100));
+    CHECK(0 > file_size("sss_ks.bin.tmp"));
+    ks_mmap_close(pStore);
+    return 0;
+}
+
+/* Write a key store as the FAT based keystore_pc.c does */
+static int write_fat_key(
+    keyStoreTable_t *pFat, uint32_t keyId, sss_key_part_t keyPart, sss_cipher_type_t cipherType, size_t dataLen)
+{
+    char path[sizeof(gRootPath) + 64];
+    uint8_t data[TEST_BIG_KEY_LEN];
+    FILE *fp;
+
+    CHECK(kStatus_SSS_Success ==
+          ks_common_update_fat(pFat, keyId, keyPart, cipherType, 0, 0, (uint16_t)dataLen));
+    key_data(keyId, 0, data, dataLen);
+    snprintf(path, sizeof(path), "%s/sss_%08X_%04d_%04d.bin", gRootPath, keyId, keyPart, cipherType);
+    fp = fopen(path, "wb");
+    CHECK(fp != NULL);
+    CHECK(1 == fwrite(data, dataLen, 1, fp));
+    fclose(fp);
+    return 0;
+}
+
+static int test_import_fat(void)
+{
+    keyIdAndTypeIndexLookup_t entries[KS_N_ENTIRES];
+    keyStoreTable_t fat;
+    char path[sizeof(gRootPath) + 64];
+    ks_mmap_t *pStore = NULL;
+    uint8_t expected[256];
+    uint8_t keyPart;
+    uint8_t cipherType;
+    const uint8_t *pData;
+    size_t len;
+    FILE *fp;
+
+    remove_root_files();
+    ks_common_init_fat(&fat, entries, KS_N_ENTIRES);
+    /* Takes two entries */
+    CHECK(0 == write_fat_key(&fat, 0x7DA10001, kSSS_KeyPart_Default, kSSS_CipherType_AES, 32));
+    CHECK(0 == write_fat_key(&fat, 0x7DA10002, kSSS_KeyPart_Pair, kSSS_CipherType_EC_NIST_P, 138));
+    CHECK(0 == write_fat_key(&fat, 0x7DA10003, kSSS_KeyPart_Public, kSSS_CipherType_EC_NIST_P, 91));
+    /* In the FAT, but its file is gone */
+    CHECK(kStatus_SSS_Success ==
+          ks_common_update_fat(&fat, 0x7DA10004, kSSS_KeyPart_Default, kSSS_CipherType_HMAC, 0, 0, 16));
+    snprintf(path, sizeof(path), "%s/sss_fat.bin", gRootPath);
+    fp = fopen(path, "wb");
+    CHECK(fp != NULL);
+    CHECK(1 == fwrite(&fat, sizeof(fat), 1, fp));
+    CHECK(1 == fwrite(entries, sizeof(entries), 1, fp));
+    fclose(fp);
+
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(3 == ks_mmap_count(pStore));
+    CHECK(0 > file_size("sss_ks.bin.tmp"));
+
+    key_data(0x7DA10001, 0, expected, 32);
+    CHECK(kStatus_SSS_Success == ks_mmap_get(pStore, 0x7DA10001, &keyPart, &cipherType, &pData, &len));
+    CHECK(keyPart == kSSS_KeyPart_Default && cipherType == kSSS_CipherType_AES);
+    CHECK(len == 32 && 0 == memcmp(pData, expected, len));
+
+    key_data(0x7DA10002, 0, expected, 138);
+    CHECK(kStatus_SSS_Success == ks_mmap_get(pStore, 0x7DA10002, &keyPart, &cipherType, &pData, &len));
+    CHECK(keyPart == kSSS_KeyPart_Pair && cipherType == kSSS_CipherType_EC_NIST_P);
+    CHECK(len == 138 && 0 == memcmp(pData, expected, len));
+
+    key_data(0x7DA10003, 0, expected, 91);
+    CHECK(kStatus_SSS_Success == ks_mmap_get(pStore, 0x7DA10003, &keyPart, &cipherType, &pData, &len));
+    CHECK(keyPart == kSSS_KeyPart_Public && cipherType == kSSS_CipherType_EC_NIST_P);
+    CHECK(len == 91 && 0 == memcmp(pData, expected, len));
+
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, 0x7DA10004, NULL, NULL, NULL, NULL));
+
+    /* Imported once only, a removed key does not come back */
+    CHECK(kStatus_SSS_Success == ks_mmap_remove(pStore, 0x7DA10003));
+    CHECK(kStatus_SSS_Success == ks_mmap_commit(pStore));
+    ks_mmap_close(pStore);
+    CHECK(kStatus_SSS_Success == ks_mmap_open(&pStore, gRootPath));
+    CHECK(2 == ks_mmap_count(pStore));
+    CHECK(kStatus_SSS_Success != ks_mmap_get(pStore, 0x7DA10003, NULL, NULL, NULL, NULL));
+    ks_mmap_close(pStore);
+
+    /* Not a FAT of this version: nothing is created */
+    remove_root_files();
+    fat.version = 0x0003;
+    fp          = fopen(path, "wb");
+    CHECK(fp != NULL);
+    CHECK(1 == fwrite(&fat, sizeof(fat), 1, fp));
+    CHECK(1 == fwrite(entries, sizeof(entries), 1, fp));
+    fclose(fp);
+    CHECK(kStatus_SSS_Success != ks_mmap_open(&pStore, gRootPath));
+    CHECK(0 > file_size("sss_ks.bin"));
+    CHECK(0 > file_size("sss_ks.bin.tmp"));
+    return 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    if (NULL == mkdtemp(gRootPath)) {
+        printf("FAIL: mkdtemp\n");
+        return 1;
+    }
+    failed = test_put_get() || test_replace_remove() || test_uncommitted() || test_compact() || test_import_fat();
+    remove_root_files();
+    rmdir(gRootPath);
+    if (failed) {
+        return 1;
+    }
+    printf("test_keystore_mmap: OK\n");
+    return 0;
+}
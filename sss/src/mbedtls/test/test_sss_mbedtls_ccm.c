@@ -0,0 +1,317 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * AES CCM of the mbedTLS host crypto (sss_aead_init / update_aad / update /
+ * finish) against the known answers of NIST SP 800-38C appendix C and of
+ * RFC 3610 packet vectors #1 and #2.
+ *
+ * For each vector:
+ * - encrypt, AAD and payload in one piece, then split at random points
+ * - decrypt, split at random points: update releases nothing, finish the
+ *   whole plain text
+ * - decrypt with a changed tag / cipher text: finish fails and releases
+ *   nothing
+ *
+ * SP 800-38C C.4 has 65536 bytes of AAD, its length is encoded on 6 bytes.
+ */
+
+#include <fsl_sss_mbedtls_apis.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_KEY_ID 0x7DA15001u
+#define TEST_MAX_LEN 32
+#define TEST_C4_AAD_LEN 65536
+#define TEST_SPLIT_ROUNDS 20
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return 1;                                       \
+    }
+
+typedef struct
+{
+    const char *name;
+    uint8_t key[16];
+    uint8_t nonce[13];
+    size_t nonceLen;
+    /** NULL: TEST_C4_AAD_LEN bytes of 00..FF repeated */
+    const uint8_t *aad;
+    size_t aadLen;
+    uint8_t plain[TEST_MAX_LEN];
+    size_t plainLen;
+    uint8_t cipher[TEST_MAX_LEN];
+    uint8_t tag[16];
+    size_t tagLen;
+} test_ccm_vector_t;
+
+static const uint8_t gAad_0_7[]  = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+static const uint8_t gAad_0_15[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+static const uint8_t gAad_0_19[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13};
+
+#define SP800_38C_KEY \
+    {0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F}
+#define RFC3610_KEY \
+    {0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF}
+
+static const test_ccm_vector_t gVectors[] = {
+    {
+        "SP 800-38C C.1",
+        SP800_38C_KEY,
+        {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16},
+        7,
+        gAad_0_7,
+        sizeof(gAad_0_7),
+        {0x20, 0x21, 0x22, 0x23},
+        4,
+        {0x71, 0x62, 0x01, 0x5B},
+        {0x4D, 0xAC, 0x25, 0x5D},
+        4,
+    },
+    {
+        "SP 800-38C C.2",
+        SP800_38C_KEY,
+        {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17},
+        8,
+        gAad_0_15,
+        sizeof(gAad_0_15),
+        {0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F},
+        16,
+        {0xD2, 0xA1, 0xF0, 0xE0, 0x51, 0xEA, 0x5F, 0x62, 0x08, 0x1A, 0x77, 0x92, 0x07, 0x3D, 0x59, 0x3D},
+        {0x1F, 0xC6, 0x4F, 0xBF, 0xAC, 0xCD},
+        6,
+    },
+    {
+        "SP 800-38C C.3",
+        SP800_38C_KEY,
+        {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B},
+        12,
+        gAad_0_19,
+        sizeof(gAad_0_19),
+        {0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B,
+            0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37},
+        24,
+        {0xE3, 0xB2, 0x01, 0xA9, 0xF5, 0xB7, 0x1A, 0x7A, 0x9B, 0x1C, 0xEA, 0xEC,
+            0xCD, 0x97, 0xE7, 0x0B, 0x61, 0x76, 0xAA, 0xD9, 0xA4, 0x42, 0x8A, 0xA5},
+        {0x48, 0x43, 0x92, 0xFB, 0xC1, 0xB0, 0x99, 0x51},
+        8,
+    },
+    {
+        "SP 800-38C C.4",
+        SP800_38C_KEY,
+        {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C},
+        13,
+        NULL,
+        TEST_C4_AAD_LEN,
+        {0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+            0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F},
+        32,
+        {0x69, 0x91, 0x5D, 0xAD, 0x1E, 0x84, 0xC6, 0x37, 0x6A, 0x68, 0xC2, 0x96, 0x7E, 0x4D, 0xAB, 0x61,
+            0x5A, 0xE0, 0xFD, 0x1F, 0xAE, 0xC4, 0x4C, 0xC4, 0x84, 0x82, 0x85, 0x29, 0x46, 0x3C, 0xCF, 0x72},
+        {0xB4, 0xAC, 0x6B, 0xEC, 0x93, 0xE8, 0x59, 0x8E, 0x7F, 0x0D, 0xAD, 0xBC, 0xEA, 0x5B},
+        14,
+    },
+    {
+        "RFC 3610 #1",
+        RFC3610_KEY,
+        {0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5},
+        13,
+        gAad_0_7,
+        sizeof(gAad_0_7),
+        {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13,
+            0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E},
+        23,
+        {0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2,
+            0xC0, 0xF9, 0x89, 0x80, 0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84},
+        {0x17, 0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0},
+        8,
+    },
+    {
+        "RFC 3610 #2",
+        RFC3610_KEY,
+        {0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5},
+        13,
+        gAad_0_7,
+        sizeof(gAad_0_7),
+        {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13,
+            0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F},
+        24,
+        {0x72, 0xC9, 0x1A, 0x36, 0xE1, 0x35, 0xF8, 0xCF, 0x29, 0x1C, 0xA8, 0x94,
+            0x08, 0x5C, 0x87, 0xE3, 0xCC, 0x15, 0xC4, 0x39, 0xC9, 0xE4, 0x3A, 0x3B},
+        {0xA0, 0x91, 0xD5, 0x6E, 0x10, 0x40, 0x09, 0x16},
+        8,
+    },
+};
+
+static sss_mbedtls_session_t gSession;
+static sss_mbedtls_key_store_t gKs;
+static uint8_t gC4Aad[TEST_C4_AAD_LEN];
+static uint32_t gRandState = 0x2545F491;
+
+/* xorshift32, fixed seed so that a failure can be reproduced */
+static uint32_t test_rand(void)
+{
+    gRandState ^= gRandState << 13;
+    gRandState ^= gRandState >> 17;
+    gRandState ^= gRandState << 5;
+    return gRandState;
+}
+
+/* Length of the next piece of a split, 0 to left bytes */
+static size_t test_piece(size_t left, int split)
+{
+    if (!split) {
+        return left;
+    }
+    return test_rand() % (left + 1);
+}
+
+/* One CCM operation, the AAD and the input given in pieces when split */
+static sss_status_t ccm_run(const test_ccm_vector_t *pV,
+    sss_mbedtls_object_t *pKey,
+    sss_mode_t mode,
+    int split,
+    const uint8_t *pIn,
+    uint8_t *pOut,
+    size_t *pOutLen,
+    uint8_t *pTag)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+    sss_mbedtls_aead_t ctx;
+    uint8_t nonce[13];
+    const uint8_t *aad = (pV->aad != NULL) ? pV->aad : gC4Aad;
+    size_t tagLen      = pV->tagLen;
+    size_t done        = 0;
+    size_t outLen      = 0;
+
+    memcpy(nonce, pV->nonce, pV->nonceLen);
+    if (kStatus_SSS_Success != sss_mbedtls_aead_context_init(&ctx, &gSession, pKey, kAlgorithm_SSS_AES_CCM, mode)) {
+        return kStatus_SSS_Fail;
+    }
+    status = sss_mbedtls_aead_init(&ctx, nonce, pV->nonceLen, pV->tagLen, pV->aadLen, pV->plainLen);
+    while (status == kStatus_SSS_Success && done < pV->aadLen) {
+        size_t piece = test_piece(pV->aadLen - done, split);
+        status       = sss_mbedtls_aead_update_aad(&ctx, &aad[done], piece);
+        done += piece;
+    }
+    /* All but the last piece through update, the last one through finish */
+    done = 0;
+    while (status == kStatus_SSS_Success && split && done < pV->plainLen && (test_rand() % 4) != 0) {
+        size_t piece  = test_piece(pV->plainLen - done, split);
+        size_t outMax = TEST_MAX_LEN - outLen;
+        status        = sss_mbedtls_aead_update(&ctx, &pIn[done], piece, &pOut[outLen], &outMax);
+        done += piece;
+        outLen += outMax;
+        if (mode == kMode_SSS_Decrypt && outMax != 0) {
+            printf("FAIL: %s, decrypt update released %u bytes\n", pV->name, (unsigned)outMax);
+            status = kStatus_SSS_Fail;
+        }
+    }
+    if (status == kStatus_SSS_Success) {
+        size_t outMax = TEST_MAX_LEN - outLen;
+        status        = sss_mbedtls_aead_finish(
+            &ctx, &pIn[done], pV->plainLen - done, &pOut[outLen], &outMax, pTag, &tagLen);
+        outLen += outMax;
+    }
+    *pOutLen = outLen;
+    sss_mbedtls_aead_context_free(&ctx);
+    return status;
+}
+
+static int test_vector(const test_ccm_vector_t *pV, sss_mbedtls_object_t *pKey)
+{
+    uint8_t out[TEST_MAX_LEN];
+    uint8_t tag[16];
+    size_t outLen;
+    int round;
+
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_set_key(&gKs, pKey, pV->key, sizeof(pV->key), 128, NULL, 0));
+
+    for (round = 0; round < TEST_SPLIT_ROUNDS; round++) {
+        int split = (round > 0);
+
+        memset(out, 0, sizeof(out));
+        memset(tag, 0, sizeof(tag));
+        CHECK(kStatus_SSS_Success == ccm_run(pV, pKey, kMode_SSS_Encrypt, split, pV->plain, out, &outLen, tag));
+        CHECK(outLen == pV->plainLen && 0 == memcmp(out, pV->cipher, pV->plainLen));
+        CHECK(0 == memcmp(tag, pV->tag, pV->tagLen));
+
+        memset(out, 0, sizeof(out));
+        memcpy(tag, pV->tag, pV->tagLen);
+        CHECK(kStatus_SSS_Success == ccm_run(pV, pKey, kMode_SSS_Decrypt, split, pV->cipher, out, &outLen, tag));
+        CHECK(outLen == pV->plainLen && 0 == memcmp(out, pV->plain, pV->plainLen));
+    }
+
+    /* Changed tag, then changed cipher text: no plain text at all */
+    memset(out, 0, sizeof(out));
+    memcpy(tag, pV->tag, pV->tagLen);
+    tag[pV->tagLen - 1] ^= 0x01;
+    CHECK(kStatus_SSS_Success != ccm_run(pV, pKey, kMode_SSS_Decrypt, 1, pV->cipher, out, &outLen, tag));
+    CHECK(outLen == 0);
+    {
+        uint8_t cipher[TEST_MAX_LEN];
+        static const uint8_t zero[TEST_MAX_LEN] = {0};
+        memcpy(cipher, pV->cipher, pV->plainLen);
+        cipher[0] ^= 0x80;
+        memcpy(tag, pV->tag, pV->tagLen);
+        CHECK(kStatus_SSS_Success != ccm_run(pV, pKey, kMode_SSS_Decrypt, 1, cipher, out, &outLen, tag));
+        CHECK(outLen == 0 && 0 == memcmp(out, zero, sizeof(out)));
+    }
+    return 0;
+}
+
+int main(void)
+{
+    sss_mbedtls_object_t key;
+    sss_mbedtls_aead_t ctx;
+    uint8_t nonce[13] = {0};
+    size_t i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(gC4Aad); i++) {
+        gC4Aad[i] = (uint8_t)i;
+    }
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_session_open(&gSession, kType_SSS_mbedTLS, 0, kSSS_ConnectionType_Plain, NULL));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_context_init(&gKs, &gSession));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_allocate(&gKs, 0));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_init(&key, &gKs));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_allocate_handle(&key,
+                                     TEST_KEY_ID,
+                                     kSSS_KeyPart_Default,
+                                     kSSS_CipherType_AES,
+                                     16,
+                                     kKeyObject_Mode_Transient));
+
+    for (i = 0; i < sizeof(gVectors) / sizeof(gVectors[0]); i++) {
+        if (test_vector(&gVectors[i], &key) != 0) {
+            printf("FAIL: %s\n", gVectors[i].name);
+            failed = 1;
+        }
+    }
+
+    /* The held back plain text of a decrypt is bounded */
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_aead_context_init(&ctx, &gSession, &key, kAlgorithm_SSS_AES_CCM, kMode_SSS_Decrypt));
+    CHECK(kStatus_SSS_Success != sss_mbedtls_aead_init(&ctx, nonce, 13, 16, 0, SSS_MBEDTLS_CCM_DECRYPT_MAX + 1));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_aead_init(&ctx, nonce, 13, 16, 0, SSS_MBEDTLS_CCM_DECRYPT_MAX));
+    sss_mbedtls_aead_context_free(&ctx);
+
+    sss_mbedtls_key_object_free(&key);
+    sss_mbedtls_key_store_context_free(&gKs);
+    sss_mbedtls_session_close(&gSession);
+    if (failed) {
+        return 1;
+    }
+    printf("test_sss_mbedtls_ccm: OK\n");
+    return 0;
+}
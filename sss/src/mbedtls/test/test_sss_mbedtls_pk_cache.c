@@ -0,0 +1,191 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Two key objects on the same key, shared through the key cache of the
+ * mbedTLS host crypto (SSS_MBEDTLS_PK_CACHE_BUDGET > 0), used from two
+ * threads with different RSA paddings.
+ *
+ * Each thread has its own session (DRBG) and key store on the same root
+ * path. One thread uses OAEP / PSS, the other one PKCS#1 v1.5:
+ * - every encrypt / decrypt and sign / verify round trip succeeds
+ * - the padding of the shared key is never changed
+ */
+
+#include <fsl_sss_mbedtls_apis.h>
+#include <mbedtls/rsa.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_KEY_ID 0x7DA15000u
+#define TEST_RSA_BITS 1024
+#define TEST_ROUNDS 64
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return 1;                                       \
+    }
+
+typedef struct
+{
+    sss_mbedtls_session_t session;
+    sss_mbedtls_key_store_t ks;
+    sss_mbedtls_object_t key;
+    sss_algorithm_t algoCrypt;
+    sss_algorithm_t algoSign;
+    int failed;
+} test_user_t;
+
+static char gRootPath[] = "/tmp/sss_pk_cache_XXXXXX";
+
+static int open_store(test_user_t *pUser)
+{
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_session_open(&pUser->session, kType_SSS_mbedTLS, 0, kSSS_ConnectionType_Plain, gRootPath));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_context_init(&pUser->ks, &pUser->session));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_load(&pUser->ks));
+    return 0;
+}
+
+static void close_store(test_user_t *pUser)
+{
+    sss_mbedtls_key_object_free(&pUser->key);
+    sss_mbedtls_key_store_context_free(&pUser->ks);
+    sss_mbedtls_session_close(&pUser->session);
+}
+
+static void remove_root_path(void)
+{
+    char path[sizeof(gRootPath) + 256];
+    struct dirent *pEntry;
+    DIR *pDir = opendir(gRootPath);
+    if (pDir != NULL) {
+        while ((pEntry = readdir(pDir)) != NULL) {
+            if (pEntry->d_name[0] != '.') {
+                snprintf(path, sizeof(path), "%s/%s", gRootPath, pEntry->d_name);
+                remove(path);
+            }
+        }
+        closedir(pDir);
+    }
+    rmdir(gRootPath);
+}
+
+static int save_rsa_key(void)
+{
+    test_user_t owner;
+    memset(&owner, 0, sizeof(owner));
+    CHECK(0 == open_store(&owner));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_init(&owner.key, &owner.ks));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_allocate_handle(&owner.key,
+                                     TEST_KEY_ID,
+                                     kSSS_KeyPart_Pair,
+                                     kSSS_CipherType_RSA,
+                                     1200,
+                                     kKeyObject_Mode_Persistent));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_generate_key(&owner.ks, &owner.key, TEST_RSA_BITS, NULL));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_save(&owner.ks));
+    close_store(&owner);
+    return 0;
+}
+
+static int crypt_and_sign(test_user_t *pUser)
+{
+    sss_mbedtls_asymmetric_t ctx;
+    uint8_t plain[32];
+    uint8_t cipher[TEST_RSA_BITS / 8];
+    uint8_t decrypted[TEST_RSA_BITS / 8];
+    uint8_t signature[TEST_RSA_BITS / 8];
+    size_t cipherLen    = sizeof(cipher);
+    size_t decryptedLen = sizeof(decrypted);
+    size_t signatureLen = sizeof(signature);
+
+    memset(plain, (int)pUser->algoCrypt, sizeof(plain));
+
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_asymmetric_context_init(&ctx, &pUser->session, &pUser->key, pUser->algoCrypt, kMode_SSS_Encrypt));
+    CHECK(kStatus_SSS_Success == sss_mbedtls_asymmetric_encrypt(&ctx, plain, sizeof(plain), cipher, &cipherLen));
+    ctx.mode = kMode_SSS_Decrypt;
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_asymmetric_decrypt(&ctx, cipher, cipherLen, decrypted, &decryptedLen));
+    CHECK(decryptedLen == sizeof(plain) && 0 == memcmp(decrypted, plain, sizeof(plain)));
+    sss_mbedtls_asymmetric_context_free(&ctx);
+
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_asymmetric_context_init(&ctx, &pUser->session, &pUser->key, pUser->algoSign, kMode_SSS_Sign));
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_asymmetric_sign_digest(&ctx, plain, sizeof(plain), signature, &signatureLen));
+    ctx.mode = kMode_SSS_Verify;
+    CHECK(kStatus_SSS_Success ==
+          sss_mbedtls_asymmetric_verify_digest(&ctx, plain, sizeof(plain), signature, signatureLen));
+    sss_mbedtls_asymmetric_context_free(&ctx);
+    return 0;
+}
+
+static void *user_thread(void *arg)
+{
+    test_user_t *pUser = (test_user_t *)arg;
+    int i;
+    for (i = 0; i < TEST_ROUNDS && !pUser->failed; i++) {
+        pUser->failed = crypt_and_sign(pUser);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    test_user_t users[2];
+    pthread_t threads[2];
+    mbedtls_rsa_context *pShared;
+    int padding;
+    int hashId;
+    int i;
+
+    CHECK(NULL != mkdtemp(gRootPath));
+    CHECK(0 == save_rsa_key());
+
+    memset(users, 0, sizeof(users));
+    users[0].algoCrypt = kAlgorithm_SSS_RSAES_PKCS1_OAEP_SHA256;
+    users[0].algoSign  = kAlgorithm_SSS_RSASSA_PKCS1_PSS_MGF1_SHA256;
+    users[1].algoCrypt = kAlgorithm_SSS_RSAES_PKCS1_V1_5;
+    users[1].algoSign  = kAlgorithm_SSS_RSASSA_PKCS1_V1_5_SHA256;
+    for (i = 0; i < 2; i++) {
+        CHECK(0 == open_store(&users[i]));
+        CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_init(&users[i].key, &users[i].ks));
+        CHECK(kStatus_SSS_Success == sss_mbedtls_key_object_get_handle(&users[i].key, TEST_KEY_ID));
+        CHECK(users[i].key.contents_cached);
+    }
+    /* Both objects use the same parsed key */
+    CHECK(users[0].key.contents == users[1].key.contents);
+    pShared = mbedtls_pk_rsa(*(mbedtls_pk_context *)users[0].key.contents);
+    padding = pShared->padding;
+    hashId  = pShared->hash_id;
+
+    for (i = 0; i < 2; i++) {
+        CHECK(0 == pthread_create(&threads[i], NULL, &user_thread, &users[i]));
+    }
+    for (i = 0; i < 2; i++) {
+        CHECK(0 == pthread_join(threads[i], NULL));
+        CHECK(!users[i].failed);
+    }
+    /* Only read, whatever padding the objects used */
+    CHECK(pShared->padding == padding && pShared->hash_id == hashId);
+
+    CHECK(kStatus_SSS_Success == sss_mbedtls_key_store_erase_key(&users[0].ks, &users[0].key));
+    for (i = 0; i < 2; i++) {
+        close_store(&users[i]);
+    }
+    sss_mbedtls_pk_cache_flush();
+    remove_root_path();
+    printf("test_sss_mbedtls_pk_cache: OK\n");
+    return 0;
+}
@@ -31,9 +31,13 @@ extern "C" {
 #include "se05x_APDU.h"
 #include "se05x_tlv.h"
 #include "smCom.h"
+#include "sm_metrics.h"
 #if defined(SMCOM_JRCP_V1_AM)
 #include "sm_timer.h"
 #endif
+#if defined(T1oI2C)
+#include "smComT1oI2C.h"
+#endif
 
 #if defined(USE_RTOS) && (USE_RTOS == 1)
 #define LOCK_TXN(lock)                                   \
@@ -908,6 +912,15 @@ cleanup:
 void sss_se05x_session_close(sss_se05x_session_t *session)
 {
     Se05x_API_CloseSession(&session->s_ctx);
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_flush(session);
+#endif
+#if SSS_HAVE_SCP_SCP03_SSS
+    if (session->s_ctx.pdynScp03Ctx != NULL) {
+        /* Wipe the expanded session keys */
+        nxScp03_DynCtx_KeyedFree(session->s_ctx.pdynScp03Ctx);
+    }
+#endif
     if (session->s_ctx.pChannelCtx == NULL) {
         SM_Close(session->s_ctx.conn_ctx, 0);
     }
@@ -919,6 +932,423 @@ void sss_se05x_session_delete(sss_se05x_session_t *session)
     AX_UNUSED_ARG(session);
 }
 
+#if SSS_HAVE_SCP_SCP03_SSS
+
+/* Session checkpoint blob:
+ *
+ *  magic (4) | counter (8) | IV (16) | state, AES-CBC with K-ENC (96) | CMAC with K-MAC (16)
+ *
+ * counter is the value of the Counter object SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID
+ * after the checkpoint incremented it, big endian. Resume increments it again
+ * and only keeps the session if it then reads counter + 1, so a blob is taken
+ * once: a copy of it, or an older blob, is refused.
+ *
+ * K-ENC and K-MAC are derived for each blob with the SCP03 KDF from the static
+ * ENC and MAC keys, with constants of their own and magic | counter as
+ * context. The static keys are not used on the blob directly.
+ *
+ * The CMAC is over magic, counter, IV and the encrypted state. The state is:
+ *
+ *  session ID (8) | hasSession (1) | SCP authType (1) | SecurityLevel (1) | RFU (1) | auth_id (4)
+ *  MCV (16) | command counter (16) | S-ENC (16) | S-MAC (16) | S-RMAC (16)
+ *
+ * The T=1 sequence numbers are not part of it, the link is re-synchronised
+ * on resume.
+ */
+#define SESSION_CHECKPOINT_MAGIC_LEN 4
+#define SESSION_CHECKPOINT_COUNTER_OFFSET (SESSION_CHECKPOINT_MAGIC_LEN)
+#define SESSION_CHECKPOINT_COUNTER_LEN 8
+#define SESSION_CHECKPOINT_IV_OFFSET (SESSION_CHECKPOINT_COUNTER_OFFSET + SESSION_CHECKPOINT_COUNTER_LEN)
+#define SESSION_CHECKPOINT_STATE_OFFSET (SESSION_CHECKPOINT_IV_OFFSET + AES_KEY_LEN_nBYTE)
+#define SESSION_CHECKPOINT_STATE_LEN 96
+#define SESSION_CHECKPOINT_MAC_OFFSET (SESSION_CHECKPOINT_STATE_OFFSET + SESSION_CHECKPOINT_STATE_LEN)
+
+#define SESSION_STATE_KEY_OFFSET 48
+
+/* Derivation constants of K-ENC / K-MAC, after the DATA_DERIVATION_* ones of SCP03 */
+#define SESSION_CHECKPOINT_DD_ENC 0x80
+#define SESSION_CHECKPOINT_DD_MAC 0x81
+/* Host key objects of K-ENC / K-MAC, transient */
+#define SESSION_CHECKPOINT_KEY_ID 0x7D5C0100u
+
+static const uint8_t gSessionCheckpointMagic[SESSION_CHECKPOINT_MAGIC_LEN] = {'S', 'C', 'P', 0x02};
+
+/* Derive K-ENC and K-MAC of the blob that starts with pHeader (magic | counter).
+ * pEnc / pMac must be zeroed, free them with sss_host_key_object_free() */
+static sss_status_t sss_se05x_checkpoint_keys(
+    NXSCP03_StaticCtx_t *pStatic_ctx, const uint8_t *pHeader, sss_object_t *pEnc, sss_object_t *pMac)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+    const uint8_t ddConstant[2] = {SESSION_CHECKPOINT_DD_ENC, SESSION_CHECKPOINT_DD_MAC};
+    uint8_t context[SESSION_CHECKPOINT_IV_OFFSET];
+    uint8_t key[AES_KEY_LEN_nBYTE];
+    uint8_t ddA[128];
+    uint16_t ddALen;
+    uint32_t keyLen;
+    sss_object_t *staticKeys[2];
+    sss_object_t *derivedKeys[2];
+    size_t i;
+
+    staticKeys[0]  = &pStatic_ctx->Enc;
+    staticKeys[1]  = &pStatic_ctx->Mac;
+    derivedKeys[0] = pEnc;
+    derivedKeys[1] = pMac;
+    memcpy(context, pHeader, sizeof(context));
+    for (i = 0; i < ARRAY_SIZE(derivedKeys); i++) {
+        ddALen = sizeof(ddA);
+        nxScp03_setDerivationData(ddA,
+            &ddALen,
+            ddConstant[i],
+            DATA_DERIVATION_L_128BIT,
+            DATA_DERIVATION_KDF_CTR,
+            context,
+            (uint16_t)sizeof(context));
+        keyLen = sizeof(key);
+        status = nxScp03_Generate_SessionKey(staticKeys[i], ddA, ddALen, key, &keyLen);
+        ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+        ENSURE_OR_GO_EXIT(keyLen == AES_KEY_LEN_nBYTE);
+
+        status = sss_host_key_object_init(derivedKeys[i], staticKeys[i]->keyStore);
+        ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+        status = sss_host_key_object_allocate_handle(derivedKeys[i],
+            SESSION_CHECKPOINT_KEY_ID + (uint32_t)i,
+            kSSS_KeyPart_Default,
+            kSSS_CipherType_AES,
+            AES_KEY_LEN_nBYTE,
+            kKeyObject_Mode_Transient);
+        ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+        status = sss_host_key_store_set_key(
+            derivedKeys[i]->keyStore, derivedKeys[i], key, AES_KEY_LEN_nBYTE, AES_KEY_LEN_nBYTE * 8, NULL, 0);
+        ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+    }
+exit:
+    memset(key, 0, sizeof(key));
+    return status;
+}
+
+/* Increment the checkpoint counter on the SE and read it back to pCounter.
+ * With create, the counter is created first if it does not exist. */
+static sss_status_t sss_se05x_checkpoint_counter_inc(pSe05xSession_t se05xSession, int create, uint8_t *pCounter)
+{
+    sss_status_t retval   = kStatus_SSS_Fail;
+    SE05x_Result_t exists = kSE05x_Result_NA;
+    size_t counterLen     = SESSION_CHECKPOINT_COUNTER_LEN;
+    smStatus_t sm_status;
+
+    if (create) {
+        sm_status = Se05x_API_CheckObjectExists(se05xSession, SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID, &exists);
+        ENSURE_OR_GO_EXIT(sm_status == SM_OK);
+        if (exists != kSE05x_Result_SUCCESS) {
+            sm_status = Se05x_API_CreateCounter(
+                se05xSession, NULL, SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID, SESSION_CHECKPOINT_COUNTER_LEN);
+            ENSURE_OR_GO_EXIT(sm_status == SM_OK);
+        }
+    }
+    sm_status = Se05x_API_IncCounter(se05xSession, SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID);
+    ENSURE_OR_GO_EXIT(sm_status == SM_OK);
+    sm_status =
+        Se05x_API_ReadObject(se05xSession, SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID, 0, 0, pCounter, &counterLen);
+    ENSURE_OR_GO_EXIT(sm_status == SM_OK);
+    ENSURE_OR_GO_EXIT(counterLen == SESSION_CHECKPOINT_COUNTER_LEN);
+    retval = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
+static sss_status_t sss_se05x_checkpoint_crypt(
+    sss_object_t *pKey, sss_mode_t mode, const uint8_t *pIv, const uint8_t *pSrc, uint8_t *pDst, size_t dataLen)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+    sss_symmetric_t symm;
+    uint8_t iv[AES_KEY_LEN_nBYTE];
+
+    memcpy(iv, pIv, sizeof(iv));
+    status = sss_host_symmetric_context_init(&symm, pKey->keyStore->session, pKey, kAlgorithm_SSS_AES_CBC, mode);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+    status = sss_host_cipher_one_go(&symm, iv, sizeof(iv), pSrc, pDst, dataLen);
+    sss_host_symmetric_context_free(&symm);
+exit:
+    return status;
+}
+
+static sss_status_t sss_se05x_checkpoint_mac(sss_object_t *pKey, const uint8_t *pData, size_t dataLen, uint8_t *pMac)
+{
+    sss_status_t status = kStatus_SSS_Fail;
+    sss_mac_t macCtx;
+    size_t macLen = AES_KEY_LEN_nBYTE;
+
+    status = sss_host_mac_context_init(&macCtx, pKey->keyStore->session, pKey, kAlgorithm_SSS_CMAC_AES, kMode_SSS_Mac);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+    status = sss_host_mac_one_go(&macCtx, pData, dataLen, pMac, &macLen);
+    sss_host_mac_context_free(&macCtx);
+exit:
+    return status;
+}
+
+/* Compare MACs in constant time, 0 if equal */
+static int sss_se05x_checkpoint_mac_cmp(const uint8_t *a, const uint8_t *b, size_t len)
+{
+    uint8_t diff = 0;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff;
+}
+
+sss_status_t sss_se05x_session_checkpoint(
+    sss_se05x_session_t *session, SE05x_Connect_Ctx_t *pConnectCtx, uint8_t *pBlob, size_t *pBlobLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint8_t state[SESSION_CHECKPOINT_STATE_LEN] = {0};
+    sss_object_t *sessionKeys[3];
+    sss_object_t blobEnc;
+    sss_object_t blobMac;
+    NXSCP03_StaticCtx_t *pStatic_ctx = NULL;
+    NXSCP03_DynCtx_t *pDyn_ctx       = NULL;
+    pSe05xSession_t se05xSession;
+    sss_rng_context_t rngctx;
+    size_t i;
+
+    memset(&blobEnc, 0, sizeof(blobEnc));
+    memset(&blobMac, 0, sizeof(blobMac));
+    ENSURE_OR_GO_EXIT(session != NULL);
+    ENSURE_OR_GO_EXIT(pConnectCtx != NULL);
+    ENSURE_OR_GO_EXIT(pBlob != NULL);
+    ENSURE_OR_GO_EXIT(pBlobLen != NULL);
+    ENSURE_OR_GO_EXIT(*pBlobLen >= SSS_SE05X_SESSION_CHECKPOINT_LEN);
+    se05xSession = &session->s_ctx;
+    pStatic_ctx  = pConnectCtx->auth.ctx.scp03.pStatic_ctx;
+    pDyn_ctx     = se05xSession->pdynScp03Ctx;
+    if ((se05xSession->authType != kSSS_AuthType_SCP03) || (pDyn_ctx == NULL) || (pStatic_ctx == NULL) ||
+        (se05xSession->pChannelCtx != NULL)) {
+        LOG_E("Only a direct Platform SCP03 session can be checkpointed");
+        goto exit;
+    }
+
+    /* Before the state is taken, these APDUs move the SCP03 counter */
+    memcpy(pBlob, gSessionCheckpointMagic, SESSION_CHECKPOINT_MAGIC_LEN);
+    retval = sss_se05x_checkpoint_counter_inc(se05xSession, 1, &pBlob[SESSION_CHECKPOINT_COUNTER_OFFSET]);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = kStatus_SSS_Fail;
+
+    memcpy(&state[0], se05xSession->value, sizeof(se05xSession->value));
+    state[8]  = se05xSession->hasSession;
+    state[9]  = (uint8_t)pDyn_ctx->authType;
+    state[10] = pDyn_ctx->SecurityLevel;
+    state[12] = (uint8_t)(se05xSession->auth_id >> 24);
+    state[13] = (uint8_t)(se05xSession->auth_id >> 16);
+    state[14] = (uint8_t)(se05xSession->auth_id >> 8);
+    state[15] = (uint8_t)(se05xSession->auth_id);
+    memcpy(&state[16], pDyn_ctx->MCV, AES_KEY_LEN_nBYTE);
+    memcpy(&state[32], pDyn_ctx->cCounter, AES_KEY_LEN_nBYTE);
+
+    sessionKeys[0] = &pDyn_ctx->Enc;
+    sessionKeys[1] = &pDyn_ctx->Mac;
+    sessionKeys[2] = &pDyn_ctx->Rmac;
+    for (i = 0; i < ARRAY_SIZE(sessionKeys); i++) {
+        size_t keyLen    = AES_KEY_LEN_nBYTE;
+        size_t keyBitLen = AES_KEY_LEN_nBYTE * 8;
+        retval           = sss_host_key_store_get_key(sessionKeys[i]->keyStore,
+            sessionKeys[i],
+            &state[SESSION_STATE_KEY_OFFSET + (i * AES_KEY_LEN_nBYTE)],
+            &keyLen,
+            &keyBitLen);
+        ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+        ENSURE_OR_GO_EXIT(keyLen == AES_KEY_LEN_nBYTE);
+    }
+
+    retval = sss_se05x_checkpoint_keys(pStatic_ctx, pBlob, &blobEnc, &blobMac);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = sss_host_rng_context_init(&rngctx, pStatic_ctx->Enc.keyStore->session);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = sss_host_rng_get_random(&rngctx, &pBlob[SESSION_CHECKPOINT_IV_OFFSET], AES_KEY_LEN_nBYTE);
+    sss_host_rng_context_free(&rngctx);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+
+    retval = sss_se05x_checkpoint_crypt(&blobEnc,
+        kMode_SSS_Encrypt,
+        &pBlob[SESSION_CHECKPOINT_IV_OFFSET],
+        state,
+        &pBlob[SESSION_CHECKPOINT_STATE_OFFSET],
+        sizeof(state));
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = sss_se05x_checkpoint_mac(
+        &blobMac, pBlob, SESSION_CHECKPOINT_MAC_OFFSET, &pBlob[SESSION_CHECKPOINT_MAC_OFFSET]);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    *pBlobLen = SSS_SE05X_SESSION_CHECKPOINT_LEN;
+
+exit:
+    memset(state, 0, sizeof(state));
+    sss_host_key_object_free(&blobEnc);
+    sss_host_key_object_free(&blobMac);
+    return retval;
+}
+
+sss_status_t sss_se05x_session_resume(
+    sss_se05x_session_t *session, SE05x_Connect_Ctx_t *pConnectCtx, const uint8_t *pBlob, size_t blobLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint8_t state[SESSION_CHECKPOINT_STATE_LEN];
+    uint8_t mac[AES_KEY_LEN_nBYTE];
+    uint8_t counter[SESSION_CHECKPOINT_COUNTER_LEN];
+    uint8_t expected[SESSION_CHECKPOINT_COUNTER_LEN];
+    sss_object_t *sessionKeys[3];
+    sss_object_t blobEnc;
+    sss_object_t blobMac;
+    NXSCP03_StaticCtx_t *pStatic_ctx = NULL;
+    NXSCP03_DynCtx_t *pDyn_ctx       = NULL;
+    pSe05xSession_t se05xSession;
+    int sm_connected = 0;
+    size_t i;
+#if defined(T1oI2C)
+    SmCommState_t CommState = {0};
+    uint8_t atr[100];
+    uint16_t atrLen = ARRAY_SIZE(atr);
+    U16 lReturn;
+#endif
+
+    memset(&blobEnc, 0, sizeof(blobEnc));
+    memset(&blobMac, 0, sizeof(blobMac));
+    ENSURE_OR_GO_EXIT(session != NULL);
+    ENSURE_OR_GO_EXIT(pConnectCtx != NULL);
+    ENSURE_OR_GO_EXIT(pBlob != NULL);
+    ENSURE_OR_GO_EXIT(blobLen == SSS_SE05X_SESSION_CHECKPOINT_LEN);
+    ENSURE_OR_GO_EXIT(pConnectCtx->auth.authType == kSSS_AuthType_SCP03);
+    ENSURE_OR_GO_EXIT(pConnectCtx->connType != kType_SE_Conn_Type_Channel);
+    pStatic_ctx = pConnectCtx->auth.ctx.scp03.pStatic_ctx;
+    pDyn_ctx    = pConnectCtx->auth.ctx.scp03.pDyn_ctx;
+    ENSURE_OR_GO_EXIT(pStatic_ctx != NULL);
+    ENSURE_OR_GO_EXIT(pDyn_ctx != NULL);
+    se05xSession = &session->s_ctx;
+    memset(session, 0, sizeof(*session));
+
+    if (0 != memcmp(pBlob, gSessionCheckpointMagic, SESSION_CHECKPOINT_MAGIC_LEN)) {
+        LOG_E("Not a session checkpoint");
+        goto exit;
+    }
+    retval = sss_se05x_checkpoint_keys(pStatic_ctx, pBlob, &blobEnc, &blobMac);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = sss_se05x_checkpoint_mac(&blobMac, pBlob, SESSION_CHECKPOINT_MAC_OFFSET, mac);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    if (0 != sss_se05x_checkpoint_mac_cmp(mac, &pBlob[SESSION_CHECKPOINT_MAC_OFFSET], sizeof(mac))) {
+        LOG_E("Session checkpoint does not verify");
+        retval = kStatus_SSS_Fail;
+        goto exit;
+    }
+    retval = sss_se05x_checkpoint_crypt(&blobEnc,
+        kMode_SSS_Decrypt,
+        &pBlob[SESSION_CHECKPOINT_IV_OFFSET],
+        &pBlob[SESSION_CHECKPOINT_STATE_OFFSET],
+        state,
+        sizeof(state));
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    retval = kStatus_SSS_Fail;
+
+#if defined(T1oI2C)
+    /* Session is still open on the SE: no ATR, no applet select */
+    CommState.connType      = pConnectCtx->connType;
+    CommState.sessionResume = 1;
+    CommState.select        = SELECT_NONE;
+    lReturn = SM_I2CConnect(&(se05xSession->conn_ctx), &CommState, atr, &atrLen, pConnectCtx->portName);
+    if (lReturn != SW_OK) {
+        LOG_E("SM_I2CConnect Failed. Status %04X", lReturn);
+        goto exit;
+    }
+    sm_connected = 1;
+#else
+    LOG_E("Session resume is only supported over T=1oI2C");
+    goto exit;
+#endif
+
+    sessionKeys[0] = &pDyn_ctx->Enc;
+    sessionKeys[1] = &pDyn_ctx->Mac;
+    sessionKeys[2] = &pDyn_ctx->Rmac;
+    for (i = 0; i < ARRAY_SIZE(sessionKeys); i++) {
+        retval = sss_host_key_store_set_key(sessionKeys[i]->keyStore,
+            sessionKeys[i],
+            &state[SESSION_STATE_KEY_OFFSET + (i * AES_KEY_LEN_nBYTE)],
+            AES_KEY_LEN_nBYTE,
+            AES_KEY_LEN_nBYTE * 8,
+            NULL,
+            0);
+        ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+    }
+    memcpy(pDyn_ctx->MCV, &state[16], AES_KEY_LEN_nBYTE);
+    memcpy(pDyn_ctx->cCounter, &state[32], AES_KEY_LEN_nBYTE);
+    pDyn_ctx->SecurityLevel = state[10];
+    pDyn_ctx->authType      = (SE_AuthType_t)state[9];
+    retval                  = nxScp03_DynCtx_KeyedInit(pDyn_ctx);
+    ENSURE_OR_GO_EXIT(retval == kStatus_SSS_Success);
+
+    memcpy(se05xSession->value, &state[0], sizeof(se05xSession->value));
+    se05xSession->hasSession   = state[8] & 0x01;
+    se05xSession->auth_id      = ((uint32_t)state[12] << 24) | ((uint32_t)state[13] << 16) |
+                            ((uint32_t)state[14] << 8) | ((uint32_t)state[15]);
+    se05xSession->authType     = kSSS_AuthType_SCP03;
+    se05xSession->pdynScp03Ctx = pDyn_ctx;
+    se05xSession->fp_TXn       = &sss_se05x_TXn;
+    se05xSession->fp_RawTXn    = &sss_se05x_channel_txn;
+    se05xSession->fp_Transform = &se05x_Transform_scp;
+    se05xSession->fp_DeCrypt   = &se05x_DeCrypt;
+    session->subsystem         = kType_SSS_SE_SE05x;
+
+    /* Take the blob: the counter must move from its value to the next one */
+    memcpy(expected, &pBlob[SESSION_CHECKPOINT_COUNTER_OFFSET], sizeof(expected));
+    i = sizeof(expected);
+    while (i > 0) {
+        i--;
+        expected[i]++;
+        if (expected[i] != 0) {
+            break;
+        }
+    }
+    retval = sss_se05x_checkpoint_counter_inc(se05xSession, 0, counter);
+    if (retval != kStatus_SSS_Success) {
+        LOG_E("Session checkpoint is outdated or its session is gone");
+        goto exit;
+    }
+    if (0 != memcmp(counter, expected, sizeof(counter))) {
+        LOG_E("Session checkpoint was already used");
+        retval = kStatus_SSS_Fail;
+        goto exit;
+    }
+
+exit:
+    memset(state, 0, sizeof(state));
+    sss_host_key_object_free(&blobEnc);
+    sss_host_key_object_free(&blobMac);
+    if (retval != kStatus_SSS_Success) {
+        if (sm_connected) {
+            sss_se05x_session_detach(session);
+        }
+        else if (session != NULL) {
+            memset(session, 0, sizeof(*session));
+        }
+    }
+    return retval;
+}
+
+void sss_se05x_session_detach(sss_se05x_session_t *session)
+{
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_flush(session);
+#endif
+    if (session->s_ctx.pdynScp03Ctx != NULL) {
+        nxScp03_DynCtx_KeyedFree(session->s_ctx.pdynScp03Ctx);
+    }
+    if (session->s_ctx.pChannelCtx == NULL) {
+#if defined(T1oI2C)
+        SM_Close(session->s_ctx.conn_ctx, ESE_MODE_RESUME);
+#else
+        SM_Close(session->s_ctx.conn_ctx, 0);
+#endif
+    }
+    memset(session, 0, sizeof(*session));
+}
+
+#endif // SSS_HAVE_SCP_SCP03_SSS
+
 /* End: se05x_session */
 
 /* ************************************************************************** */
@@ -966,6 +1396,312 @@ sss_status_t sss_se05x_key_object_allocate_handle(sss_se05x_object_t *keyObject,
     return retval;
 }
 
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+
+/* Host side copy of what sss_se05x_key_object_get_handle() learnt about
+ * an object, so that the next handle for the same keyId needs no APDU.
+ *
+ * Entries are owned by the Se05xSession_t they were read with. An erase /
+ * set / generate through any sss session of this process drops the keyId,
+ * Se05x_API_DeleteAll(_Iterative) drops all entries of its session
+ * (Se05xSession_t.objEpoch), closing the session drops them too.
+ *
+ * The cache assumes the sss layer of this process is the only writer of
+ * the objects it caches. A hit skips CheckIfKeyIdExists, so an object
+ * deleted with Se05x_API_DeleteSecureObject() directly, or by another
+ * process, still gets a handle and only the next operation on it fails.
+ * Call sss_se05x_obj_cache_flush() if that can happen. */
+typedef struct
+{
+    const Se05xSession_t *pOwner;
+    uint32_t epoch;
+    uint32_t keyId;
+    uint32_t objectType;
+    uint32_t cipherType;
+    uint32_t curve_id;
+    uint8_t isPersistant;
+} sss_se05x_obj_cache_entry_t;
+
+static sss_se05x_obj_cache_entry_t gObjCache[SSS_SE05X_OBJ_CACHE_ENTRIES];
+static size_t gObjCacheNext;
+
+#if (__GNUC__ && !AX_EMBEDDED)
+static pthread_mutex_t gObjCacheLock = PTHREAD_MUTEX_INITIALIZER;
+#define OBJ_CACHE_LOCK() pthread_mutex_lock(&gObjCacheLock)
+#define OBJ_CACHE_UNLOCK() pthread_mutex_unlock(&gObjCacheLock)
+#else
+#define OBJ_CACHE_LOCK()
+#define OBJ_CACHE_UNLOCK()
+#endif
+
+/* Call with the lock held. An entry from before a DeleteAll is freed, not returned. */
+static sss_se05x_obj_cache_entry_t *sss_se05x_obj_cache_find(const Se05xSession_t *pOwner, uint32_t keyId)
+{
+    size_t i;
+    for (i = 0; i < SSS_SE05X_OBJ_CACHE_ENTRIES; i++) {
+        if (gObjCache[i].pOwner == pOwner && gObjCache[i].keyId == keyId) {
+            if (pOwner != NULL && gObjCache[i].epoch != pOwner->objEpoch) {
+                memset(&gObjCache[i], 0, sizeof(gObjCache[i]));
+                return NULL;
+            }
+            return &gObjCache[i];
+        }
+    }
+    return NULL;
+}
+
+/* Call with the lock held */
+static void sss_se05x_obj_cache_put(const Se05xSession_t *pOwner,
+    uint32_t keyId,
+    uint32_t objectType,
+    uint32_t cipherType,
+    uint32_t curve_id,
+    uint8_t isPersistant)
+{
+    sss_se05x_obj_cache_entry_t *pEntry = sss_se05x_obj_cache_find(pOwner, keyId);
+    if (pEntry == NULL) {
+        pEntry = sss_se05x_obj_cache_find(NULL, 0);
+    }
+    if (pEntry == NULL) {
+        /* Full, evict round robin */
+        pEntry        = &gObjCache[gObjCacheNext];
+        gObjCacheNext = (gObjCacheNext + 1) % SSS_SE05X_OBJ_CACHE_ENTRIES;
+    }
+    pEntry->pOwner       = pOwner;
+    pEntry->epoch        = pOwner->objEpoch;
+    pEntry->keyId        = keyId;
+    pEntry->objectType   = objectType;
+    pEntry->cipherType   = cipherType;
+    pEntry->curve_id     = curve_id;
+    pEntry->isPersistant = isPersistant;
+}
+
+static int sss_se05x_obj_cache_lookup(sss_se05x_object_t *keyObject, uint32_t keyId)
+{
+    int found = 0;
+    sss_se05x_obj_cache_entry_t *pEntry;
+
+    OBJ_CACHE_LOCK();
+    pEntry = sss_se05x_obj_cache_find(&keyObject->keyStore->session->s_ctx, keyId);
+    if (pEntry != NULL) {
+        keyObject->keyId        = keyId;
+        keyObject->objectType   = pEntry->objectType;
+        keyObject->cipherType   = pEntry->cipherType;
+        keyObject->curve_id     = (SE05x_ECCurve_t)pEntry->curve_id;
+        keyObject->isPersistant = pEntry->isPersistant;
+        found                   = 1;
+    }
+    OBJ_CACHE_UNLOCK();
+    return found;
+}
+
+static void sss_se05x_obj_cache_insert(const sss_se05x_object_t *keyObject)
+{
+    OBJ_CACHE_LOCK();
+    sss_se05x_obj_cache_put(&keyObject->keyStore->session->s_ctx,
+        keyObject->keyId,
+        keyObject->objectType,
+        keyObject->cipherType,
+        keyObject->curve_id,
+        keyObject->isPersistant);
+    OBJ_CACHE_UNLOCK();
+}
+
+/* Drops keyId for all sessions, they may all be talking to the same SE */
+static void sss_se05x_obj_cache_drop(uint32_t keyId)
+{
+    size_t i;
+
+    OBJ_CACHE_LOCK();
+    for (i = 0; i < SSS_SE05X_OBJ_CACHE_ENTRIES; i++) {
+        if (gObjCache[i].pOwner != NULL && gObjCache[i].keyId == keyId) {
+            memset(&gObjCache[i], 0, sizeof(gObjCache[i]));
+        }
+    }
+    OBJ_CACHE_UNLOCK();
+}
+
+void sss_se05x_obj_cache_flush(sss_se05x_session_t *session)
+{
+    size_t i;
+
+    OBJ_CACHE_LOCK();
+    for (i = 0; i < SSS_SE05X_OBJ_CACHE_ENTRIES; i++) {
+        if (gObjCache[i].pOwner == &session->s_ctx) {
+            memset(&gObjCache[i], 0, sizeof(gObjCache[i]));
+        }
+    }
+    OBJ_CACHE_UNLOCK();
+}
+
+#if !AX_EMBEDDED
+
+/* Cache file:
+ *
+ *  magic (4) | fingerprint (8) | count (4) | count * entry (17)
+ *
+ * entry: keyId (4) | objectType (4) | cipherType (4) | curve_id (4) | isPersistant (1)
+ *
+ * All values big endian. The fingerprint is the free persistent memory (2),
+ * RFU (2) and an FNV-1a hash of the first page of ReadIDList (4). Creating or
+ * deleting an object changes both, so a file from before such a change is
+ * not loaded.
+ */
+#define OBJ_CACHE_FILE_MAGIC "SOC\x01"
+#define OBJ_CACHE_FP_LEN 8
+#define OBJ_CACHE_ENTRY_LEN 17
+
+static void obj_cache_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)(v);
+}
+
+static uint32_t obj_cache_get_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static sss_status_t sss_se05x_obj_cache_fingerprint(sss_se05x_session_t *session, uint8_t *pFp)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    smStatus_t status;
+    uint16_t freeMem = 0;
+    uint8_t pmore    = 0;
+    uint8_t idList[1024];
+    size_t idListLen = sizeof(idList);
+    uint32_t hash    = 2166136261u;
+    size_t i;
+
+    status = Se05x_API_GetFreeMemory(&session->s_ctx, kSE05x_MemoryType_PERSISTENT, &freeMem);
+    ENSURE_OR_GO_EXIT(status == SM_OK);
+    status = Se05x_API_ReadIDList(&session->s_ctx, 0, 0xFF, &pmore, idList, &idListLen);
+    ENSURE_OR_GO_EXIT(status == SM_OK);
+
+    for (i = 0; i < idListLen; i++) {
+        hash = (hash ^ idList[i]) * 16777619u;
+    }
+    pFp[0] = (uint8_t)(freeMem >> 8);
+    pFp[1] = (uint8_t)(freeMem);
+    pFp[2] = 0;
+    pFp[3] = pmore;
+    obj_cache_put_u32(&pFp[4], hash);
+    retval = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
+sss_status_t sss_se05x_obj_cache_save(sss_se05x_session_t *session, const char *path)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint8_t header[4 + OBJ_CACHE_FP_LEN + 4];
+    uint8_t entry[OBJ_CACHE_ENTRY_LEN];
+    sss_se05x_obj_cache_entry_t snapshot[SSS_SE05X_OBJ_CACHE_ENTRIES];
+    uint32_t count = 0;
+    size_t i;
+    FILE *fp = NULL;
+
+    ENSURE_OR_GO_EXIT(session != NULL);
+    ENSURE_OR_GO_EXIT(path != NULL);
+    ENSURE_OR_GO_EXIT(
+        kStatus_SSS_Success == sss_se05x_obj_cache_fingerprint(session, &header[sizeof(OBJ_CACHE_FILE_MAGIC) - 1]));
+
+    OBJ_CACHE_LOCK();
+    for (i = 0; i < SSS_SE05X_OBJ_CACHE_ENTRIES; i++) {
+        if (gObjCache[i].pOwner == &session->s_ctx && gObjCache[i].epoch == session->s_ctx.objEpoch) {
+            snapshot[count++] = gObjCache[i];
+        }
+    }
+    OBJ_CACHE_UNLOCK();
+
+    memcpy(header, OBJ_CACHE_FILE_MAGIC, sizeof(OBJ_CACHE_FILE_MAGIC) - 1);
+    obj_cache_put_u32(&header[4 + OBJ_CACHE_FP_LEN], count);
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        LOG_E("Could not open '%s' for writing", path);
+        goto exit;
+    }
+    ENSURE_OR_GO_EXIT(fwrite(header, 1, sizeof(header), fp) == sizeof(header));
+    for (i = 0; i < count; i++) {
+        obj_cache_put_u32(&entry[0], snapshot[i].keyId);
+        obj_cache_put_u32(&entry[4], snapshot[i].objectType);
+        obj_cache_put_u32(&entry[8], snapshot[i].cipherType);
+        obj_cache_put_u32(&entry[12], snapshot[i].curve_id);
+        entry[16] = snapshot[i].isPersistant;
+        ENSURE_OR_GO_EXIT(fwrite(entry, 1, sizeof(entry), fp) == sizeof(entry));
+    }
+    LOG_D("Saved %u cached objects to '%s'", (unsigned int)count, path);
+    retval = kStatus_SSS_Success;
+exit:
+    if (fp != NULL) {
+        if (0 != fclose(fp)) {
+            retval = kStatus_SSS_Fail;
+        }
+    }
+    return retval;
+}
+
+sss_status_t sss_se05x_obj_cache_load(sss_se05x_session_t *session, const char *path)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint8_t header[4 + OBJ_CACHE_FP_LEN + 4];
+    uint8_t fingerprint[OBJ_CACHE_FP_LEN];
+    uint8_t entry[OBJ_CACHE_ENTRY_LEN];
+    uint32_t count;
+    uint32_t i;
+    FILE *fp = NULL;
+
+    ENSURE_OR_GO_EXIT(session != NULL);
+    ENSURE_OR_GO_EXIT(path != NULL);
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        LOG_D("No object cache at '%s'", path);
+        goto exit;
+    }
+    ENSURE_OR_GO_EXIT(fread(header, 1, sizeof(header), fp) == sizeof(header));
+    ENSURE_OR_GO_EXIT(0 == memcmp(header, OBJ_CACHE_FILE_MAGIC, sizeof(OBJ_CACHE_FILE_MAGIC) - 1));
+    ENSURE_OR_GO_EXIT(kStatus_SSS_Success == sss_se05x_obj_cache_fingerprint(session, fingerprint));
+    if (0 != memcmp(fingerprint, &header[4], sizeof(fingerprint))) {
+        LOG_I("Object cache '%s' is stale, not loaded", path);
+        goto exit;
+    }
+    count = obj_cache_get_u32(&header[4 + OBJ_CACHE_FP_LEN]);
+
+    OBJ_CACHE_LOCK();
+    for (i = 0; i < count; i++) {
+        if (fread(entry, 1, sizeof(entry), fp) != sizeof(entry)) {
+            break;
+        }
+        sss_se05x_obj_cache_put(&session->s_ctx,
+            obj_cache_get_u32(&entry[0]),
+            obj_cache_get_u32(&entry[4]),
+            obj_cache_get_u32(&entry[8]),
+            obj_cache_get_u32(&entry[12]),
+            entry[16]);
+    }
+    OBJ_CACHE_UNLOCK();
+    if (i != count) {
+        LOG_E("Object cache '%s' is truncated", path);
+        sss_se05x_obj_cache_flush(session);
+        goto exit;
+    }
+    LOG_D("Loaded %u cached objects from '%s'", (unsigned int)count, path);
+    retval = kStatus_SSS_Success;
+exit:
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    return retval;
+}
+
+#endif /* !AX_EMBEDDED */
+
+#endif /* SSS_SE05X_OBJ_CACHE_ENTRIES > 0 */
+
 //static sss_status_t sss_se05x_key_object_get_handle_binary(
 //    sss_se05x_object_t *keyObject) {
 //    sss_status_t retval = kStatus_SSS_Success;
@@ -983,6 +1719,12 @@ sss_status_t sss_se05x_key_object_get_handle(sss_se05x_object_t *keyObject, uint
     const SE05x_AttestationType_t attestationType = kSE05x_AttestationType_None;
     smStatus_t apiRetval;
 
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    if (sss_se05x_obj_cache_lookup(keyObject, keyId)) {
+        return kStatus_SSS_Success;
+    }
+#endif
+
     if (0 == CheckIfKeyIdExists(keyId, &keyObject->keyStore->session->s_ctx)) {
         /* Object does not exist  */
         LOG_D("keyId does not exist");
@@ -1198,6 +1940,9 @@ sss_status_t sss_se05x_key_object_get_handle(sss_se05x_object_t *keyObject, uint
         return retval;
     }
 
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_insert(keyObject);
+#endif
     retval = kStatus_SSS_Success;
 #endif // SSSFTR_SE05X_KEY_GET
     return retval;
@@ -1627,6 +2372,61 @@ exit:
     return retval;
 }
 
+sss_status_t sss_se05x_derive_key_dh_inline(sss_se05x_derive_key_t *context,
+    const uint8_t *pPeerPoint,
+    size_t peerPointLen,
+    uint8_t *pSharedSecret,
+    size_t *pSharedSecretLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    smStatus_t status   = SM_NOT_OK;
+#if SSS_HAVE_EC_MONT
+    uint8_t peerPoint[64];
+    uint8_t isMont = 0;
+#endif
+
+    ENSURE_OR_GO_EXIT(context);
+    ENSURE_OR_GO_EXIT(context->keyObject);
+    ENSURE_OR_GO_EXIT(pPeerPoint);
+    ENSURE_OR_GO_EXIT(pSharedSecret);
+    ENSURE_OR_GO_EXIT(pSharedSecretLen);
+
+#if SSS_HAVE_EC_MONT
+    // Change Endianness Public Key in case of Montgomery Curve
+    if (context->keyObject->cipherType == kSSS_CipherType_EC_MONTGOMERY) {
+        ENSURE_OR_GO_EXIT(peerPointLen <= sizeof(peerPoint));
+        for (size_t keyValueIdx = 0; keyValueIdx < peerPointLen; keyValueIdx++) {
+            peerPoint[keyValueIdx] = pPeerPoint[peerPointLen - 1 - keyValueIdx];
+        }
+        pPeerPoint = peerPoint;
+        isMont     = 1;
+    }
+#endif
+
+    status = Se05x_API_ECGenSharedSecret(&context->session->s_ctx,
+        context->keyObject->keyId,
+        pPeerPoint,
+        peerPointLen,
+        pSharedSecret,
+        pSharedSecretLen);
+    ENSURE_OR_GO_EXIT(status == SM_OK);
+
+#if SSS_HAVE_EC_MONT
+    // Change Endianness Shared Secret in case of Montgomery Curve
+    if (isMont) {
+        for (size_t keyValueIdx = 0; keyValueIdx < (*pSharedSecretLen >> 1); keyValueIdx++) {
+            uint8_t swapByte                                   = pSharedSecret[keyValueIdx];
+            pSharedSecret[keyValueIdx]                         = pSharedSecret[*pSharedSecretLen - 1 - keyValueIdx];
+            pSharedSecret[*pSharedSecretLen - 1 - keyValueIdx] = swapByte;
+        }
+    }
+#endif
+
+    retval = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
 void sss_se05x_derive_key_context_free(sss_se05x_derive_key_t *context)
 {
     AX_UNUSED_ARG(context);
@@ -2493,19 +3293,52 @@ static sss_status_t getEccPrivPubKeyLen(uint32_t curve_id, size_t *pubKeyLen, si
 
     return retval;
 }
-#endif //SSSFTR_SE05X_ECC && SSSFTR_SE05X_KEY_SET
+#endif //SSSFTR_SE05X_ECC && SSSFTR_SE05X_KEY_SET
+
+#if SSSFTR_SE05X_ECC && SSSFTR_SE05X_KEY_SET
+/* Fill pSession->ecCurveBitmap from the curve list of the SE */
+static smStatus_t sss_se05x_read_curve_bitmap(Se05xSession_t *pSession)
+{
+    smStatus_t status = SM_NOT_OK;
+    uint8_t curveList[kSE05x_ECCurve_Total_Weierstrass_Curves] = {
+        0,
+    };
+    size_t curveListLen = sizeof(curveList);
+    uint32_t bitmap     = SE05X_EC_CURVE_BITMAP_VALID;
+    size_t i;
+
+    status = Se05x_API_ReadECCurveList(pSession, curveList, &curveListLen);
+    if (status != SM_OK) {
+        return status;
+    }
+    for (i = 0; i < curveListLen; i++) {
+        if (curveList[i] == kSE05x_SetIndicator_SET) {
+            bitmap |= SE05X_EC_CURVE_BIT(i + 1);
+        }
+    }
+    /* Edwards / Montgomery curves are not in the list, keep what is known of them */
+    bitmap |= pSession->ecCurveBitmap & (SE05X_EC_CURVE_BIT(0x40) | SE05X_EC_CURVE_BIT(0x41) |
+                                            SE05X_EC_CURVE_BIT(0x42) | SE05X_EC_CURVE_BIT(0x43));
+    pSession->ecCurveBitmap = bitmap;
+    return SM_OK;
+}
+
+sss_status_t sss_se05x_session_prefetch_curves(sss_se05x_session_t *session)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+
+    ENSURE_OR_GO_EXIT(session != NULL);
+    if (sss_se05x_read_curve_bitmap(&session->s_ctx) == SM_OK) {
+        retval = kStatus_SSS_Success;
+    }
+exit:
+    return retval;
+}
 
-#if SSSFTR_SE05X_ECC && SSSFTR_SE05X_KEY_SET
 /* sss_se05x_create_curve_if_needed for internal to this file and for tests */
 smStatus_t sss_se05x_create_curve_if_needed(Se05xSession_t *pSession, uint32_t curve_id)
 {
     smStatus_t status = SM_NOT_OK;
-    //uint32_t existing_curve_id = 0;
-    uint8_t curveList[kSE05x_ECCurve_Total_Weierstrass_Curves] = {
-        0,
-    };
-    size_t curveListLen = sizeof(curveList);
-    //int i = 0;
 
 #if SSS_HAVE_EC_ED
     if (curve_id == kSE05x_ECCurve_RESERVED_ID_ECC_ED_25519) {
@@ -2521,8 +3354,12 @@ smStatus_t sss_se05x_create_curve_if_needed(Se05xSession_t *pSession, uint32_t c
 #endif
     ) {
 #if SSS_HAVE_SE05X_VER_GTE_06_00
+        if (pSession->ecCurveBitmap & SE05X_EC_CURVE_BIT(curve_id)) {
+            return SM_OK;
+        }
         status = Se05x_API_CreateECCurve(pSession, curve_id);
         /* If curve is already created, Se05x_API_CreateECCurve fails. Ignore this error */
+        pSession->ecCurveBitmap |= SE05X_EC_CURVE_BIT(curve_id);
         return SM_OK;
 #else
         return SM_OK;
@@ -2531,20 +3368,17 @@ smStatus_t sss_se05x_create_curve_if_needed(Se05xSession_t *pSession, uint32_t c
     }
 #endif // SSS_HAVE_EC_MONT
 
-    status = Se05x_API_ReadECCurveList(pSession, curveList, &curveListLen);
-    if (status == SM_OK) {
-        if (curve_id == 0) {
-            return SM_NOT_OK;
-        }
-        if ((curve_id - 1) >= curveListLen) {
+    if (curve_id == 0 || curve_id > kSE05x_ECCurve_Total_Weierstrass_Curves) {
+        return SM_NOT_OK;
+    }
+    if (!(pSession->ecCurveBitmap & SE05X_EC_CURVE_BITMAP_VALID)) {
+        /* Read once per session, then kept up to date by Se05x_API_CreateECCurve / Se05x_API_DeleteECCurve */
+        if (sss_se05x_read_curve_bitmap(pSession) != SM_OK) {
             return SM_NOT_OK;
         }
-        if (curveList[curve_id - 1] == kSE05x_SetIndicator_SET) {
-            return SM_OK;
-        }
     }
-    else {
-        return SM_NOT_OK;
+    if (pSession->ecCurveBitmap & SE05X_EC_CURVE_BIT(curve_id)) {
+        return SM_OK;
     }
 
     status = SM_NOT_OK;
@@ -2620,6 +3454,8 @@ smStatus_t sss_se05x_create_curve_if_needed(Se05xSession_t *pSession, uint32_t c
     ENSURE_OR_GO_EXIT(status != SM_NOT_OK);
     if (status == SM_ERR_CONDITIONS_NOT_SATISFIED) {
         LOG_W("Allowing SM_ERR_CONDITIONS_NOT_SATISFIED for CreateCurve");
+        /* State of the curve is not known, read the list again next time */
+        pSession->ecCurveBitmap &= ~SE05X_EC_CURVE_BITMAP_VALID;
     }
 exit:
     return status;
@@ -3186,82 +4022,264 @@ exit:
 
 #endif
 
-#if SSSFTR_SE05X_KEY_SET
-static sss_status_t sss_se05x_key_store_set_cert(sss_se05x_key_store_t *keyStore,
-    sss_se05x_object_t *keyObject,
-    const uint8_t *key,
-    size_t keyLen,
-    size_t keyBitLen,
-    void *policy_buff,
+#if SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET
+static sss_status_t sss_se05x_binary_stream_init(sss_se05x_binary_stream_t *stream,
+    sss_se05x_key_store_t *keyStore,
+    uint32_t keyId,
+    uint16_t size,
+    uint8_t create,
+    const uint8_t *policy_buff,
     size_t policy_buff_len)
 {
-    AX_UNUSED_ARG(keyBitLen);
+    sss_status_t retval = kStatus_SSS_Fail;
+
+    ENSURE_OR_GO_EXIT(policy_buff_len <= sizeof(stream->policy));
+    memset(stream, 0, sizeof(*stream));
+    stream->keyStore = keyStore;
+    stream->keyId    = keyId;
+    stream->size     = size;
+    stream->create   = create;
+    if (policy_buff != NULL && policy_buff_len > 0) {
+        memcpy(stream->policy, policy_buff, policy_buff_len);
+        stream->policyLen = policy_buff_len;
+    }
+    retval = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
+sss_status_t sss_se05x_binary_stream_open(sss_se05x_binary_stream_t *stream,
+    sss_se05x_key_store_t *keyStore,
+    sss_se05x_object_t *keyObject,
+    size_t createSize,
+    sss_policy_t *policies)
+{
     sss_status_t retval = kStatus_SSS_Fail;
     smStatus_t status   = SM_NOT_OK;
-    Se05xPolicy_t se05x_policy;
-#if !SSS_HAVE_SE05X_VER_GTE_06_00
-    Se05xPolicy_t *ppolicy = &se05x_policy;
+    uint16_t size       = 0;
+#if SSSFTR_SE05X_KEY_SET
+    uint8_t policies_buff[MAX_POLICY_BUFFER_SIZE];
+    size_t valid_policy_buff_len = 0;
 #endif
-    uint16_t data_rem;
-    uint16_t offset   = 0;
-    uint16_t fileSize = 0;
-    uint8_t IdExists  = 0;
-#if SSS_HAVE_SE05X_VER_GTE_06_00
-    SE05x_Result_t obj_exists = kSE05x_Result_NA;
+
+    ENSURE_OR_GO_EXIT(stream);
+    ENSURE_OR_GO_EXIT(keyStore);
+    ENSURE_OR_GO_EXIT(keyObject);
+
+    /* Also tells whether the object exists, in one APDU */
+    status = Se05x_API_ReadSize(&keyStore->session->s_ctx, keyObject->keyId, &size);
+    if (status == SM_OK) {
+        retval = sss_se05x_binary_stream_init(stream, keyStore, keyObject->keyId, size, 0, NULL, 0);
+        goto exit;
+    }
+
+    if (createSize == 0) {
+        LOG_E("Object %X does not exist", keyObject->keyId);
+        goto exit;
+    }
+#if SSSFTR_SE05X_KEY_SET
+    ENSURE_OR_GO_EXIT(createSize < 0xFFFFu);
+    if (policies) {
+        if (kStatus_SSS_Success !=
+            sss_se05x_create_object_policy_buffer(policies, &policies_buff[0], &valid_policy_buff_len)) {
+            goto exit;
+        }
+    }
+    retval = sss_se05x_binary_stream_init(
+        stream, keyStore, keyObject->keyId, (uint16_t)createSize, 1, policies_buff, valid_policy_buff_len);
+#else
+    AX_UNUSED_ARG(policies);
+    LOG_E("Object %X does not exist, and writing is not enabled (SSSFTR_SE05X_KEY_SET)", keyObject->keyId);
 #endif
+exit:
+    return retval;
+}
 
-    ENSURE_OR_GO_EXIT(keyLen < 0xFFFFu);
+sss_status_t sss_se05x_binary_stream_seek(sss_se05x_binary_stream_t *stream, size_t offset)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
 
-    IdExists = CheckIfKeyIdExists(keyObject->keyId, &keyStore->session->s_ctx);
-    fileSize = (IdExists == 1) ? 0 : (uint16_t)keyLen;
-    data_rem = (uint16_t)keyLen;
+    ENSURE_OR_GO_EXIT(stream);
+    ENSURE_OR_GO_EXIT(offset <= stream->size);
+    /* The creating write has to come first */
+    ENSURE_OR_GO_EXIT(stream->create == 0 || offset == 0);
+    stream->offset = (uint16_t)offset;
+    retval         = kStatus_SSS_Success;
+exit:
+    return retval;
+}
 
-    se05x_policy.value     = (uint8_t *)policy_buff;
-    se05x_policy.value_len = policy_buff_len;
+sss_status_t sss_se05x_binary_stream_read(sss_se05x_binary_stream_t *stream, uint8_t *data, size_t *dataLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    smStatus_t status   = SM_NOT_OK;
+    size_t total        = 0;
+    size_t max_buffer   = 0;
+
+    ENSURE_OR_GO_EXIT(stream);
+    ENSURE_OR_GO_EXIT(data);
+    ENSURE_OR_GO_EXIT(dataLen);
+    ENSURE_OR_GO_EXIT(stream->create == 0);
+
+    while (total < *dataLen && stream->offset < stream->size) {
+        size_t want    = *dataLen - total;
+        uint16_t chunk = (uint16_t)(stream->size - stream->offset);
+        if (chunk > SSS_SE05X_BINARY_STREAM_CHUNK) {
+            chunk = SSS_SE05X_BINARY_STREAM_CHUNK;
+        }
+        if (chunk > want) {
+            chunk = (uint16_t)want;
+        }
+        max_buffer = chunk;
+        status     = Se05x_API_ReadObject(
+            &stream->keyStore->session->s_ctx, stream->keyId, stream->offset, chunk, (data + total), &max_buffer);
+        ENSURE_OR_GO_EXIT(status == SM_OK);
+        ENSURE_OR_GO_EXIT(max_buffer == chunk);
+        total          = total + chunk;
+        stream->offset = stream->offset + chunk;
+    }
+    *dataLen = total;
+    retval   = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
+sss_status_t sss_se05x_binary_stream_read_cb(
+    sss_se05x_binary_stream_t *stream, fp_sss_se05x_binary_stream_sink_t fpSink, void *pSinkCtx)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    uint8_t buff[SSS_SE05X_BINARY_STREAM_CHUNK];
+    size_t buffLen;
 
-    while (data_rem > 0) {
-        uint16_t chunk = (data_rem > BINARY_WRITE_MAX_LEN) ? BINARY_WRITE_MAX_LEN : data_rem;
-        data_rem       = data_rem - chunk;
+    ENSURE_OR_GO_EXIT(stream);
+    ENSURE_OR_GO_EXIT(fpSink);
 
+    while (stream->offset < stream->size) {
+        buffLen = sizeof(buff);
+        ENSURE_OR_GO_EXIT(kStatus_SSS_Success == sss_se05x_binary_stream_read(stream, buff, &buffLen));
+        ENSURE_OR_GO_EXIT(kStatus_SSS_Success == fpSink(pSinkCtx, buff, buffLen));
+    }
+    retval = kStatus_SSS_Success;
+exit:
+    return retval;
+}
+
+void sss_se05x_binary_stream_close(sss_se05x_binary_stream_t *stream)
+{
+    if (stream != NULL) {
+        memset(stream, 0, sizeof(*stream));
+    }
+}
+
+#endif // SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET
+
+#if SSSFTR_SE05X_KEY_SET
+/* Largest write that fits one APDU, with the policy TLV if it goes along */
+static uint16_t sss_se05x_binary_stream_write_chunk(const sss_se05x_binary_stream_t *stream)
+{
+    size_t chunk = SSS_SE05X_BINARY_STREAM_CHUNK;
+#if SSS_HAVE_SE05X_VER_GTE_06_00
+    const uint8_t withPolicy = 1;
+#else
+    const uint8_t withPolicy = stream->create;
+#endif
+    if (withPolicy && stream->policyLen > 0) {
+        /* Tag + 3 byte length */
+        chunk -= stream->policyLen + 4;
+    }
+    return (uint16_t)chunk;
+}
+
+sss_status_t sss_se05x_binary_stream_write(sss_se05x_binary_stream_t *stream, const uint8_t *data, size_t dataLen)
+{
+    sss_status_t retval = kStatus_SSS_Fail;
+    smStatus_t status   = SM_NOT_OK;
+    Se05xPolicy_t se05x_policy;
+    Se05xPolicy_t *ppolicy;
+    size_t done = 0;
+
+    ENSURE_OR_GO_EXIT(stream);
+    ENSURE_OR_GO_EXIT(data);
+    ENSURE_OR_GO_EXIT(dataLen <= (size_t)(stream->size - stream->offset));
+
+    se05x_policy.value     = (stream->policyLen > 0) ? stream->policy : NULL;
+    se05x_policy.value_len = stream->policyLen;
+
+    while (done < dataLen) {
+        uint16_t chunk = sss_se05x_binary_stream_write_chunk(stream);
+        if (chunk > dataLen - done) {
+            chunk = (uint16_t)(dataLen - done);
+        }
+        ppolicy = &se05x_policy;
 #if SSS_HAVE_SE05X_VER_GTE_06_00
         /* Call APIs For SE051 */
-        obj_exists = (IdExists == 1) ? kSE05x_Result_SUCCESS : kSE05x_Result_FAILURE;
-        if (obj_exists == kSE05x_Result_FAILURE && offset == 0) {
-            status = Se05x_API_WriteBinary_Ver(&keyStore->session->s_ctx,
-                &se05x_policy,
-                keyObject->keyId,
-                offset,
-                (uint16_t)fileSize,
-                (key + offset),
+        if (stream->create) {
+            status = Se05x_API_WriteBinary_Ver(&stream->keyStore->session->s_ctx,
+                ppolicy,
+                stream->keyId,
+                stream->offset,
+                stream->size,
+                (data + done),
                 chunk,
                 0);
         }
         else {
-            status = Se05x_API_UpdateBinary_Ver(&keyStore->session->s_ctx,
-                &se05x_policy,
-                keyObject->keyId,
-                offset,
-                (uint16_t)fileSize,
-                (key + offset),
-                chunk,
-                0);
+            status = Se05x_API_UpdateBinary_Ver(
+                &stream->keyStore->session->s_ctx, ppolicy, stream->keyId, stream->offset, 0, (data + done), chunk, 0);
         }
-
 #else
         /* Call APIs For SE050 */
-        status = Se05x_API_WriteBinary(
-            &keyStore->session->s_ctx, ppolicy, keyObject->keyId, offset, (uint16_t)fileSize, (key + offset), chunk);
-        ppolicy = NULL;
+        if (!stream->create) {
+            ppolicy = NULL;
+        }
+        status = Se05x_API_WriteBinary(&stream->keyStore->session->s_ctx,
+            ppolicy,
+            stream->keyId,
+            stream->offset,
+            (stream->create) ? stream->size : 0,
+            (data + done),
+            chunk);
 #endif
         ENSURE_OR_GO_EXIT(status == SM_OK);
 
-        fileSize = 0;
-        offset   = offset + chunk;
+        stream->create = 0;
+        stream->offset = stream->offset + chunk;
+        done           = done + chunk;
     }
     retval = kStatus_SSS_Success;
 exit:
     return retval;
 }
+
+static sss_status_t sss_se05x_key_store_set_cert(sss_se05x_key_store_t *keyStore,
+    sss_se05x_object_t *keyObject,
+    const uint8_t *key,
+    size_t keyLen,
+    size_t keyBitLen,
+    void *policy_buff,
+    size_t policy_buff_len)
+{
+    AX_UNUSED_ARG(keyBitLen);
+    sss_status_t retval = kStatus_SSS_Fail;
+    sss_se05x_binary_stream_t stream;
+    uint8_t IdExists = 0;
+
+    ENSURE_OR_GO_EXIT(keyLen < 0xFFFFu);
+
+    IdExists = CheckIfKeyIdExists(keyObject->keyId, &keyStore->session->s_ctx);
+
+    ENSURE_OR_GO_EXIT(kStatus_SSS_Success == sss_se05x_binary_stream_init(&stream,
+                                                 keyStore,
+                                                 keyObject->keyId,
+                                                 (uint16_t)keyLen,
+                                                 (IdExists == 1) ? 0 : 1,
+                                                 (const uint8_t *)policy_buff,
+                                                 policy_buff_len));
+    retval = sss_se05x_binary_stream_write(&stream, key, keyLen);
+    sss_se05x_binary_stream_close(&stream);
+exit:
+    return retval;
+}
 #endif // SSSFTR_SE05X_KEY_SET
 
 #if 0
@@ -3347,6 +4365,9 @@ sss_status_t sss_se05x_key_store_set_key(sss_se05x_key_store_t *keyStore,
 
     ENSURE_OR_GO_EXIT(keyStore);
     ENSURE_OR_GO_EXIT(keyObject);
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_drop(keyObject->keyId);
+#endif
 
 #if SSS_HAVE_TPM_BN && SSS_HAVE_ECDAA && SSS_HAVE_SE05X_VER_GTE_07_02
     if ((keyObject->keyId & SSS_SE05X_RESID_ECDAA_RANDOM_KEY_MASK) == SSS_SE05X_RESID_ECDAA_RANDOM_KEY_START) {
@@ -3463,6 +4484,9 @@ sss_status_t sss_se05x_key_store_generate_key(
     uint8_t policies_buff[MAX_POLICY_BUFFER_SIZE];
     ENSURE_OR_GO_EXIT(keyStore);
     ENSURE_OR_GO_EXIT(keyObject);
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_drop(keyObject->keyId);
+#endif
 
 #if SSS_HAVE_TPM_BN && SSS_HAVE_ECDAA && SSS_HAVE_SE05X_VER_GTE_07_02
     if ((keyObject->keyId & SSS_SE05X_RESID_ECDAA_RANDOM_KEY_MASK) == SSS_SE05X_RESID_ECDAA_RANDOM_KEY_START) {
@@ -3925,7 +4949,6 @@ sss_status_t sss_se05x_key_store_get_key(
     sss_status_t retval           = kStatus_SSS_Fail;
     sss_cipher_type_t cipher_type = kSSS_CipherType_NONE;
     smStatus_t status             = SM_NOT_OK;
-    uint16_t size;
     ENSURE_OR_GO_EXIT(keyObject);
     ENSURE_OR_GO_EXIT(key);
     ENSURE_OR_GO_EXIT(keylen);
@@ -4005,31 +5028,24 @@ sss_status_t sss_se05x_key_store_get_key(
         status = Se05x_API_ReadObject(&keyStore->session->s_ctx, keyObject->keyId, 0, 0, key, keylen);
         ENSURE_OR_GO_EXIT(status == SM_OK);
         break;
+#if SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET
     case kSSS_CipherType_Binary:
     case kSSS_CipherType_Certificate: {
-        uint16_t rem_data = 0;
-        uint16_t offset   = 0;
-        size_t max_buffer = 0;
-        status            = Se05x_API_ReadSize(&keyStore->session->s_ctx, keyObject->keyId, &size);
-        ENSURE_OR_GO_EXIT(status == SM_OK);
-        if (*keylen < size) {
+        sss_se05x_binary_stream_t stream;
+        ENSURE_OR_GO_EXIT(
+            kStatus_SSS_Success == sss_se05x_binary_stream_open(&stream, keyStore, keyObject, 0, NULL));
+        if (*keylen < stream.size) {
             LOG_E("Insufficient buffer ");
             goto exit;
         }
 
-        rem_data = size;
-        *keylen  = size;
-        while (rem_data > 0) {
-            uint16_t chunk = (rem_data > BINARY_WRITE_MAX_LEN) ? BINARY_WRITE_MAX_LEN : rem_data;
-            rem_data       = rem_data - chunk;
-            max_buffer     = chunk;
-            status         = Se05x_API_ReadObject(
-                &keyStore->session->s_ctx, keyObject->keyId, offset, chunk, (key + offset), &max_buffer);
-            ENSURE_OR_GO_EXIT(status == SM_OK);
-            offset = offset + chunk;
+        *keylen = stream.size;
+        if (kStatus_SSS_Success != sss_se05x_binary_stream_read(&stream, key, keylen)) {
+            goto exit;
         }
-
+        sss_se05x_binary_stream_close(&stream);
     } break;
+#endif // SSSFTR_SE05X_KEY_SET || SSSFTR_SE05X_KEY_GET
     case kSSS_CipherType_DES:
         status = Se05x_API_ReadObject(&keyStore->session->s_ctx, keyObject->keyId, 0, 0, key, keylen);
         ENSURE_OR_GO_EXIT(status == SM_OK);
@@ -4733,6 +5749,9 @@ sss_status_t sss_se05x_key_store_erase_key(sss_se05x_key_store_t *keyStore, sss_
     smStatus_t status   = SM_NOT_OK;
     ENSURE_OR_GO_EXIT(keyStore);
     ENSURE_OR_GO_EXIT(keyObject);
+#if SSS_SE05X_OBJ_CACHE_ENTRIES > 0
+    sss_se05x_obj_cache_drop(keyObject->keyId);
+#endif
 
     status = Se05x_API_DeleteSecureObject(&keyStore->session->s_ctx, keyObject->keyId);
     if (SM_OK == status) {
@@ -5682,6 +6701,33 @@ exit:
     return retval;
 }
 
+sss_status_t sss_se05x_cipher_one_go_batch(sss_se05x_symmetric_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+    sss_status_t retval = kStatus_SSS_InvalidArgument;
+    sss_se05x_object_t *keyObject;
+    size_t i;
+
+    ENSURE_OR_GO_EXIT(context != NULL);
+    ENSURE_OR_GO_EXIT((items != NULL) || (itemCount == 0));
+
+    /* The key stays in the SE, one CipherOneShot per item */
+    keyObject = context->keyObject;
+    retval    = kStatus_SSS_Success;
+    for (i = 0; i < itemCount; i++) {
+        sss_batch_item_t *item = &items[i];
+
+        context->keyObject = (item->keyObject != NULL) ? (sss_se05x_object_t *)item->keyObject : keyObject;
+        item->status       = sss_se05x_cipher_one_go_v2(
+            context, item->iv, item->ivLen, item->srcData, item->srcLen, item->destData, &item->destLen);
+        if ((item->status != kStatus_SSS_Success) && (retval == kStatus_SSS_Success)) {
+            retval = item->status;
+        }
+    }
+    context->keyObject = keyObject;
+exit:
+    return retval;
+}
+
 sss_status_t sss_se05x_cipher_init(sss_se05x_symmetric_t *context, uint8_t *iv, size_t ivLen)
 {
     sss_status_t retval = kStatus_SSS_Fail;
@@ -6550,6 +7596,163 @@ exit:
     return retval;
 }
 
+typedef struct
+{
+    sss_mode_t mode;
+    /* Item of the first command in the batch */
+    sss_batch_item_t *items;
+} sss_se05x_mac_batch_t;
+
+/* Append the MACOneShot command of item to the batch buffer */
+static int sss_se05x_mac_batch_cmd(sss_se05x_mac_t *context,
+    SE05x_MACAlgo_t macOperation,
+    sss_batch_item_t *item,
+    uint8_t **ppCmdbuf,
+    size_t *pCmdbufLen,
+    Se05xBatchApdu_t *pApdu)
+{
+    int tlvRet                    = 1;
+    size_t startLen               = *pCmdbufLen;
+    sss_se05x_object_t *keyObject = context->keyObject;
+    tlvHeader_t hdr               = {{kSE05x_CLA, kSE05x_INS_CRYPTO, kSE05x_P1_MAC, kSE05x_P2_GENERATE_ONESHOT}};
+
+    if (item->keyObject != NULL) {
+        keyObject = (sss_se05x_object_t *)item->keyObject;
+    }
+    ENSURE_OR_GO_CLEANUP(keyObject != NULL);
+    ENSURE_OR_GO_CLEANUP(item->srcData != NULL);
+    ENSURE_OR_GO_CLEANUP(item->destData != NULL);
+
+    pApdu->cmdBuf = *ppCmdbuf;
+    tlvRet        = TLVSET_U32("objectID", ppCmdbuf, pCmdbufLen, kSE05x_TAG_1, keyObject->keyId);
+    if (0 != tlvRet) {
+        goto cleanup;
+    }
+    tlvRet = TLVSET_U8("macOperation", ppCmdbuf, pCmdbufLen, kSE05x_TAG_2, macOperation);
+    if (0 != tlvRet) {
+        goto cleanup;
+    }
+    tlvRet = TLVSET_u8bufOptional("inputData", ppCmdbuf, pCmdbufLen, kSE05x_TAG_3, item->srcData, item->srcLen);
+    if (0 != tlvRet) {
+        goto cleanup;
+    }
+    if (context->mode == kMode_SSS_Mac_Validate) {
+        hdr.hdr[3] = kSE05x_P2_VALIDATE_ONESHOT;
+        tlvRet     = TLVSET_u8bufOptional("MAC to verify (when P2=P2_VALIDATE_ONESHOT)",
+            ppCmdbuf,
+            pCmdbufLen,
+            kSE05x_TAG_5,
+            item->destData,
+            item->destLen);
+        if (0 != tlvRet) {
+            goto cleanup;
+        }
+    }
+    pApdu->hdr       = hdr;
+    pApdu->cmdBufLen = *pCmdbufLen - startLen;
+    pApdu->hasle     = 0;
+
+cleanup:
+    return tlvRet;
+}
+
+/* DoAPDUTxRx_Batch() callback, takes the MAC / the result of the command out of the shared response buffer */
+static void sss_se05x_mac_batch_done(void *pDoneCtx, size_t index, Se05xBatchApdu_t *pApdu)
+{
+    sss_se05x_mac_batch_t *pBatch = (sss_se05x_mac_batch_t *)pDoneCtx;
+    sss_batch_item_t *item        = &pBatch->items[index];
+    uint8_t result                = kSE05x_Result_FAILURE;
+    uint8_t *pOut                 = item->destData;
+    size_t outLen                 = item->destLen;
+    size_t rspIndex               = 0;
+    int tlvRet;
+
+    item->status = kStatus_SSS_Fail;
+    if (pApdu->status != SM_OK) {
+        return;
+    }
+    if (pBatch->mode == kMode_SSS_Mac_Validate) {
+        pOut   = &result;
+        outLen = sizeof(result);
+    }
+    tlvRet = tlvGet_u8buf(pApdu->rspBuf, &rspIndex, pApdu->rspBufLen, kSE05x_TAG_1, pOut, &outLen);
+    if ((0 != tlvRet) || ((rspIndex + 2) != pApdu->rspBufLen)) {
+        return;
+    }
+    if (((pApdu->rspBuf[rspIndex] << 8) | (pApdu->rspBuf[rspIndex + 1])) != SM_OK) {
+        return;
+    }
+    if (pBatch->mode == kMode_SSS_Mac_Validate) {
+        if (result != kSE05x_Result_SUCCESS) {
+            return;
+        }
+    }
+    else {
+        item->destLen = outLen;
+    }
+    item->status = kStatus_SSS_Success;
+}
+
+sss_status_t sss_se05x_mac_one_go_batch(sss_se05x_mac_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+    sss_status_t retval = kStatus_SSS_InvalidArgument;
+    SE05x_MACAlgo_t macOperation;
+    sss_se05x_mac_batch_t batch;
+    Se05xBatchApdu_t apdus[SSS_SE05X_MAC_BATCH_MAX];
+    uint8_t cmdbuf[SE05X_MAX_BUF_SIZE_CMD];
+    /* Shared by all the commands, each response is handled as soon as it is received */
+    uint8_t rspbuf[SE05X_MAX_BUF_SIZE_RSP + 2];
+    size_t first = 0;
+    size_t i;
+    int tlvRet;
+
+    ENSURE_OR_GO_EXIT(context != NULL);
+    ENSURE_OR_GO_EXIT((items != NULL) || (itemCount == 0));
+    ENSURE_OR_GO_EXIT((context->mode == kMode_SSS_Mac) || (context->mode == kMode_SSS_Mac_Validate));
+    macOperation = se05x_get_mac_algo(context->algorithm);
+    ENSURE_OR_GO_EXIT(macOperation != kSE05x_MACAlgo_NA);
+
+    batch.mode = context->mode;
+    while (first < itemCount) {
+        uint8_t *pCmdbuf = &cmdbuf[0];
+        size_t cmdbufLen = 0;
+        size_t apduCount = 0;
+
+        /* As many commands as fit in cmdbuf */
+        for (i = first; (i < itemCount) && (apduCount < SSS_SE05X_MAC_BATCH_MAX); i++) {
+            tlvRet = sss_se05x_mac_batch_cmd(context, macOperation, &items[i], &pCmdbuf, &cmdbufLen, &apdus[apduCount]);
+            if (0 != tlvRet) {
+                break;
+            }
+            apdus[apduCount].rspBuf    = rspbuf;
+            apdus[apduCount].rspBufLen = sizeof(rspbuf);
+            /* Set by sss_se05x_mac_batch_done() once the command is sent */
+            items[i].status = kStatus_SSS_Fail;
+            apduCount++;
+        }
+        if (apduCount == 0) {
+            /* Invalid, or too long for a single command */
+            items[first].status = kStatus_SSS_Fail;
+            first++;
+            continue;
+        }
+
+        batch.items = &items[first];
+        (void)DoAPDUTxRx_Batch(&context->session->s_ctx, apdus, apduCount, 0, &sss_se05x_mac_batch_done, &batch);
+        first += apduCount;
+    }
+
+    retval = kStatus_SSS_Success;
+    for (i = 0; i < itemCount; i++) {
+        if (items[i].status != kStatus_SSS_Success) {
+            retval = items[i].status;
+            break;
+        }
+    }
+exit:
+    return retval;
+}
+
 sss_status_t sss_se05x_mac_validate_one_go(
     sss_se05x_mac_t *context, const uint8_t *message, size_t messageLen, uint8_t *mac, size_t macLen)
 {
@@ -6769,6 +7972,28 @@ exit:
     return retval;
 }
 
+sss_status_t sss_se05x_digest_one_go_batch(sss_se05x_digest_t *context, sss_batch_item_t *items, size_t itemCount)
+{
+    sss_status_t retval = kStatus_SSS_InvalidArgument;
+    size_t i;
+
+    ENSURE_OR_GO_EXIT(context != NULL);
+    ENSURE_OR_GO_EXIT((items != NULL) || (itemCount == 0));
+
+    retval = kStatus_SSS_Success;
+    for (i = 0; i < itemCount; i++) {
+        sss_batch_item_t *item = &items[i];
+
+        item->status =
+            sss_se05x_digest_one_go(context, item->srcData, item->srcLen, item->destData, &item->destLen);
+        if ((item->status != kStatus_SSS_Success) && (retval == kStatus_SSS_Success)) {
+            retval = item->status;
+        }
+    }
+exit:
+    return retval;
+}
+
 sss_status_t sss_se05x_digest_init(sss_se05x_digest_t *context)
 {
     sss_status_t retval = kStatus_SSS_Fail;
@@ -6990,10 +8215,13 @@ static smStatus_t sss_se05x_TXn(struct Se05xSession *pSession,
         0,
     };
     size_t txBufLen = sizeof(txBuf);
+    SM_METRICS_START(apduStartUs);
+    SM_METRICS_START(phaseStartUs);
 
     if (pSession->fp_Transform) {
         ret = pSession->fp_Transform(pSession, hdr, cmdBuf, cmdBufLen, &outHdr, txBuf, &txBufLen, hasle);
     }
+    SM_METRICS_PHASE(SM_METRICS_PHASE_WRAP, hdr->hdr, phaseStartUs);
     ENSURE_OR_GO_EXIT(ret == SM_OK);
     if (pSession->fp_RawTXn) {
         ret = pSession->fp_RawTXn(pSession->conn_ctx,
@@ -7007,9 +8235,12 @@ static smStatus_t sss_se05x_TXn(struct Se05xSession *pSession,
             hasle);
     }
 
+    SM_METRICS_RESTART(phaseStartUs);
     if (pSession->fp_DeCrypt) {
         ret = pSession->fp_DeCrypt(pSession, cmdBufLen, rsp, rspLen, hasle);
     }
+    SM_METRICS_PHASE(SM_METRICS_PHASE_UNWRAP, hdr->hdr, phaseStartUs);
+    SM_METRICS_APDU(hdr->hdr, apduStartUs, txBufLen, (ret == SM_OK) ? rsp : NULL, *rspLen);
 
     ENSURE_OR_GO_EXIT(ret == SM_OK);
 exit:
@@ -7025,43 +8256,11 @@ static smStatus_t sss_se05x_channel_txnRaw(void *conn_ctx,
     uint8_t hasle)
 {
     uint8_t txBuf[SE05X_MAX_BUF_SIZE_CMD] = {0};
-    size_t i                              = 0;
-    memcpy(&txBuf[i], hdr, sizeof(*hdr));
-    smStatus_t ret = SM_NOT_OK;
-    i += sizeof(*hdr);
-    if (cmdBufLen > 0) {
-        // The Lc field must be extended in case the length does not fit
-        // into a single byte (Note, while the standard would allow to
-        // encode 0x100 as 0x00 in the Lc field, nobody who is sane in his mind
-        // would actually do that).
-        if ((cmdBufLen < 0xFF) && !hasle) {
-            txBuf[i++] = (uint8_t)cmdBufLen;
-        }
-        else {
-            txBuf[i++] = 0x00;
-            txBuf[i++] = 0xFFu & (cmdBufLen >> 8);
-            txBuf[i++] = 0xFFu & (cmdBufLen);
-        }
-        memcpy(&txBuf[i], cmdBuf, cmdBufLen);
-        if ((UINT_MAX - i) < cmdBufLen) {
-            goto exit;
-        }
-        i += cmdBufLen;
-    }
-    else {
-        if (cmdBufLen == 0) {
-            txBuf[i++] = 0x00;
-        }
-    }
-
-    if (hasle) {
-        if (i > SE05X_MAX_BUF_SIZE_CMD - 2) {
-            goto exit;
-        }
-        txBuf[i++] = 0x00;
-        txBuf[i++] = 0x00;
-    }
+    size_t i                              = sizeof(txBuf);
+    smStatus_t ret                        = SM_NOT_OK;
 
+    ret = se05x_FrameApdu(hdr, cmdBuf, cmdBufLen, hasle, txBuf, &i);
+    ENSURE_OR_GO_EXIT(ret == SM_OK);
     uint32_t U32rspLen = (uint32_t)*rspLen;
     ret                = (smStatus_t)smCom_TransceiveRaw(conn_ctx, txBuf, (U16)i, rsp, &U32rspLen);
     *rspLen            = U32rspLen;
@@ -224,6 +224,10 @@ static sss_status_t nxECKey_HostLocal_CalculateSessionKeys(SE05x_AuthCtx_ECKey_t
     status =
         sss_host_key_store_set_key(pDyn_ctx->Rmac.keyStore, &pDyn_ctx->Rmac, sessionRmacKey, 16, (16) * 8, NULL, 0);
     ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+
+    // Expand the session keys once for all the APDUs of this session
+    status = nxScp03_DynCtx_KeyedInit(pDyn_ctx);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
 exit:
     return status;
 }
@@ -372,6 +372,10 @@ static sss_status_t nxScp03_HostLocal_CalculateSessionKeys(
     // Set the Session-RMAC key
     status =
         sss_host_key_store_set_key(pDyn_ctx->Rmac.keyStore, &pDyn_ctx->Rmac, sessionRmacKey, 16, (16) * 8, NULL, 0);
+    ENSURE_OR_GO_EXIT(status == kStatus_SSS_Success);
+
+    // Expand the session keys once for all the APDUs of this session
+    status = nxScp03_DynCtx_KeyedInit(pDyn_ctx);
 exit:
     return status;
 }
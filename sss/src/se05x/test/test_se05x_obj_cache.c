@@ -0,0 +1,222 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * The object cache of the SE05x sss layer (SSS_SE05X_OBJ_CACHE_ENTRIES > 0)
+ * against the SE05x emulator. Every APDU the emulator answers is counted
+ * (se05x_emul_process is wrapped at link time):
+ * - the first handle on a keyId costs APDUs, the next one none and is the
+ *   same object, usable for signing
+ * - set / generate / erase of a cached keyId drop it, the next handle
+ *   reads the SE again (and fails after an erase)
+ * - with more objects than entries the oldest one is evicted, round robin
+ * - sss_se05x_obj_cache_flush() drops everything, sss_se05x_obj_cache_save()
+ *   and sss_se05x_obj_cache_load() restore it while the SE is unchanged
+ */
+
+#include <ex_sss.h>
+#include <ex_sss_boot.h>
+#include <fsl_sss_se05x_apis.h>
+#include <nxLog_App.h>
+#include <se05x_emul.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_KEY_ID(N) (0x7DA18000u + (N))
+#define TEST_ENTRIES SSS_SE05X_OBJ_CACHE_ENTRIES
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return kStatus_SSS_Fail;                        \
+    }
+
+static ex_sss_boot_ctx_t gex_sss_obj_cache_boot_ctx;
+static unsigned int gApdus;
+
+smStatus_t __real_se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs);
+
+/* Every APDU the host sends ends up here */
+smStatus_t __wrap_se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs)
+{
+    gApdus++;
+    return __real_se05x_emul_process(cmd, cmdLen, rsp, rspLen, pLatencyUs);
+}
+
+#define EX_SSS_BOOT_PCONTEXT (&gex_sss_obj_cache_boot_ctx)
+#define EX_SSS_BOOT_DO_ERASE 1
+#define EX_SSS_BOOT_EXPOSE_ARGC_ARGV 0
+
+#include <ex_sss_main_inc.h>
+
+static sss_status_t set_aes_key(ex_sss_boot_ctx_t *pCtx, uint32_t keyId, uint8_t fill)
+{
+    sss_object_t key = {0};
+    uint8_t aesKey[16];
+
+    memset(aesKey, fill, sizeof(aesKey));
+    CHECK(kStatus_SSS_Success == sss_key_object_init(&key, &pCtx->ks));
+    CHECK(kStatus_SSS_Success == sss_key_object_allocate_handle(&key,
+                                     keyId,
+                                     kSSS_KeyPart_Default,
+                                     kSSS_CipherType_AES,
+                                     sizeof(aesKey),
+                                     kKeyObject_Mode_Persistent));
+    CHECK(kStatus_SSS_Success ==
+          sss_key_store_set_key(&pCtx->ks, &key, aesKey, sizeof(aesKey), sizeof(aesKey) * 8, NULL, 0));
+    sss_key_object_free(&key);
+    return kStatus_SSS_Success;
+}
+
+/* get_handle on keyId, *pApdus is what it cost */
+static sss_status_t get_handle(ex_sss_boot_ctx_t *pCtx, sss_object_t *pKey, uint32_t keyId, unsigned int *pApdus)
+{
+    sss_status_t status;
+    unsigned int before = gApdus;
+
+    memset(pKey, 0, sizeof(*pKey));
+    if (kStatus_SSS_Success != sss_key_object_init(pKey, &pCtx->ks)) {
+        return kStatus_SSS_Fail;
+    }
+    status  = sss_key_object_get_handle(pKey, keyId);
+    *pApdus = gApdus - before;
+    return status;
+}
+
+/* Run first: nothing was evicted before, the round robin starts at entry 0 */
+static sss_status_t test_eviction(ex_sss_boot_ctx_t *pCtx)
+{
+    sss_object_t key;
+    unsigned int apdus;
+    uint32_t i;
+
+    for (i = 0; i <= TEST_ENTRIES; i++) {
+        CHECK(kStatus_SSS_Success == set_aes_key(pCtx, TEST_KEY_ID(i), (uint8_t)i));
+    }
+    /* One more object than entries, the last one evicts the first one */
+    for (i = 0; i <= TEST_ENTRIES; i++) {
+        CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, TEST_KEY_ID(i), &apdus));
+        CHECK(apdus > 0);
+    }
+    for (i = 1; i <= TEST_ENTRIES; i++) {
+        CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, TEST_KEY_ID(i), &apdus));
+        CHECK(apdus == 0);
+        CHECK(key.keyId == TEST_KEY_ID(i) && key.cipherType == kSSS_CipherType_AES);
+    }
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, TEST_KEY_ID(0), &apdus));
+    CHECK(apdus > 0);
+    CHECK(key.keyId == TEST_KEY_ID(0) && key.cipherType == kSSS_CipherType_AES);
+    return kStatus_SSS_Success;
+}
+
+static sss_status_t test_hit_and_invalidation(ex_sss_boot_ctx_t *pCtx)
+{
+    sss_object_t key    = {0};
+    sss_object_t cached = {0};
+    sss_asymmetric_t ctx;
+    uint8_t digest[32] = "Hello World";
+    uint8_t signature[128];
+    size_t signatureLen = sizeof(signature);
+    unsigned int apdus;
+    const uint32_t ecKeyId  = TEST_KEY_ID(0x100);
+    const uint32_t aesKeyId = TEST_KEY_ID(0x101);
+
+    CHECK(kStatus_SSS_Success == sss_key_object_init(&key, &pCtx->ks));
+    CHECK(kStatus_SSS_Success == sss_key_object_allocate_handle(
+                                     &key, ecKeyId, kSSS_KeyPart_Pair, kSSS_CipherType_EC_NIST_P, 256, kKeyObject_Mode_Persistent));
+    CHECK(kStatus_SSS_Success == sss_key_store_generate_key(&pCtx->ks, &key, 256, NULL));
+
+    /* Miss, then hit with the same metadata */
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, ecKeyId, &apdus));
+    CHECK(apdus > 0);
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, ecKeyId, &apdus));
+    CHECK(apdus == 0);
+    CHECK(cached.keyId == ecKeyId && cached.objectType == kSSS_KeyPart_Pair);
+    CHECK(cached.cipherType == kSSS_CipherType_EC_NIST_P);
+    CHECK(((sss_se05x_object_t *)&cached)->curve_id == ((sss_se05x_object_t *)&key)->curve_id);
+    CHECK(((sss_se05x_object_t *)&cached)->isPersistant == ((sss_se05x_object_t *)&key)->isPersistant);
+
+    /* The cached handle works */
+    CHECK(kStatus_SSS_Success ==
+          sss_asymmetric_context_init(&ctx, &pCtx->session, &cached, kAlgorithm_SSS_SHA256, kMode_SSS_Sign));
+    CHECK(kStatus_SSS_Success == sss_asymmetric_sign_digest(&ctx, digest, sizeof(digest), signature, &signatureLen));
+    sss_asymmetric_context_free(&ctx);
+
+    /* Generate drops the keyId */
+    CHECK(kStatus_SSS_Success == sss_key_store_generate_key(&pCtx->ks, &key, 256, NULL));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, ecKeyId, &apdus));
+    CHECK(apdus > 0);
+
+    /* Set drops the keyId */
+    CHECK(kStatus_SSS_Success == set_aes_key(pCtx, aesKeyId, 0xA5));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, aesKeyId, &apdus));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, aesKeyId, &apdus));
+    CHECK(apdus == 0);
+    CHECK(kStatus_SSS_Success == set_aes_key(pCtx, aesKeyId, 0x5A));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, aesKeyId, &apdus));
+    CHECK(apdus > 0);
+
+    /* Erase drops the keyId, the SE says it is gone */
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &cached, ecKeyId, &apdus));
+    CHECK(apdus == 0);
+    CHECK(kStatus_SSS_Success == sss_key_store_erase_key(&pCtx->ks, &key));
+    CHECK(kStatus_SSS_Success != get_handle(pCtx, &cached, ecKeyId, &apdus));
+    CHECK(apdus > 0);
+
+    sss_key_object_free(&key);
+    return kStatus_SSS_Success;
+}
+
+static sss_status_t test_flush_save_load(ex_sss_boot_ctx_t *pCtx)
+{
+    sss_se05x_session_t *pSession = (sss_se05x_session_t *)&pCtx->session;
+    sss_object_t key;
+    unsigned int apdus;
+    char path[] = "/tmp/se05x_obj_cache_XXXXXX";
+    const uint32_t keyId = TEST_KEY_ID(0x200);
+    int fd;
+
+    fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+
+    CHECK(kStatus_SSS_Success == set_aes_key(pCtx, keyId, 0x11));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, keyId, &apdus));
+    CHECK(kStatus_SSS_Success == sss_se05x_obj_cache_save(pSession, path));
+
+    sss_se05x_obj_cache_flush(pSession);
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, keyId, &apdus));
+    CHECK(apdus > 0);
+
+    /* Same SE, the file is taken */
+    sss_se05x_obj_cache_flush(pSession);
+    CHECK(kStatus_SSS_Success == sss_se05x_obj_cache_load(pSession, path));
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, keyId, &apdus));
+    CHECK(apdus == 0);
+
+    /* A new object changes the fingerprint, the file is not taken */
+    CHECK(kStatus_SSS_Success == set_aes_key(pCtx, TEST_KEY_ID(0x201), 0x22));
+    sss_se05x_obj_cache_flush(pSession);
+    sss_se05x_obj_cache_load(pSession, path);
+    CHECK(kStatus_SSS_Success == get_handle(pCtx, &key, keyId, &apdus));
+    CHECK(apdus > 0);
+
+    unlink(path);
+    return kStatus_SSS_Success;
+}
+
+sss_status_t ex_sss_entry(ex_sss_boot_ctx_t *pCtx)
+{
+    CHECK(kStatus_SSS_Success == test_eviction(pCtx));
+    CHECK(kStatus_SSS_Success == test_hit_and_invalidation(pCtx));
+    CHECK(kStatus_SSS_Success == test_flush_save_load(pCtx));
+    printf("test_se05x_obj_cache: OK\n");
+    return kStatus_SSS_Success;
+}
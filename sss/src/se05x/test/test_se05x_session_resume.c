@@ -0,0 +1,167 @@
+/*
+ *
+ * Copyright 2026 NXP
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @par Description
+ * Session checkpoint / resume of a Platform SCP03 session over T=1oI2C,
+ * against the SE05x emulator. Every APDU the emulator answers is counted
+ * (se05x_emul_process is wrapped at link time):
+ * - a tampered, truncated or foreign blob is refused before any APDU
+ * - resume costs the two APDUs of the checkpoint counter, no handshake,
+ *   and the counter on the SE is the one of the blob plus one
+ * - the resumed session works, and is checkpointed / resumed again
+ * - a blob that was resumed from already, or an older one, is refused
+ * - after that a full session can be opened as usual
+ */
+
+#include <ex_sss.h>
+#include <ex_sss_boot.h>
+#include <fsl_sss_se05x_apis.h>
+#include <nxLog_App.h>
+#include <se05x_APDU.h>
+#include <se05x_emul.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_BINARY_ID 0x7DA18400u
+#define TEST_COUNTER_OFFSET 4
+#define TEST_COUNTER_LEN 8
+
+#define CHECK(COND)                                     \
+    if (!(COND)) {                                      \
+        printf("FAIL: line %d: %s\n", __LINE__, #COND); \
+        return kStatus_SSS_Fail;                        \
+    }
+
+static ex_sss_boot_ctx_t gex_sss_resume_boot_ctx;
+static unsigned int gApdus;
+
+smStatus_t __real_se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs);
+
+/* Every APDU the host sends ends up here */
+smStatus_t __wrap_se05x_emul_process(
+    const uint8_t *cmd, size_t cmdLen, uint8_t *rsp, size_t *rspLen, uint32_t *pLatencyUs)
+{
+    gApdus++;
+    return __real_se05x_emul_process(cmd, cmdLen, rsp, rspLen, pLatencyUs);
+}
+
+#define EX_SSS_BOOT_PCONTEXT (&gex_sss_resume_boot_ctx)
+#define EX_SSS_BOOT_DO_ERASE 1
+#define EX_SSS_BOOT_EXPOSE_ARGC_ARGV 0
+
+#include <ex_sss_main_inc.h>
+
+/* Write fill to the binary object and read it back */
+static sss_status_t use_session(ex_sss_boot_ctx_t *pCtx, uint8_t fill)
+{
+    sss_object_t obj;
+    uint8_t data[64];
+    uint8_t back[64];
+    size_t backLen  = sizeof(back);
+    size_t backBits = sizeof(back) * 8;
+
+    memset(data, fill, sizeof(data));
+    CHECK(kStatus_SSS_Success == sss_key_object_init(&obj, &pCtx->ks));
+    CHECK(kStatus_SSS_Success == sss_key_object_allocate_handle(&obj,
+                                     TEST_BINARY_ID,
+                                     kSSS_KeyPart_Default,
+                                     kSSS_CipherType_Binary,
+                                     sizeof(data),
+                                     kKeyObject_Mode_Persistent));
+    CHECK(kStatus_SSS_Success == sss_key_store_set_key(&pCtx->ks, &obj, data, sizeof(data), sizeof(data) * 8, NULL, 0));
+    CHECK(kStatus_SSS_Success == sss_key_store_get_key(&pCtx->ks, &obj, back, &backLen, &backBits));
+    CHECK(backLen == sizeof(data) && 0 == memcmp(back, data, sizeof(data)));
+    sss_key_object_free(&obj);
+    return kStatus_SSS_Success;
+}
+
+static sss_status_t checkpoint_and_detach(ex_sss_boot_ctx_t *pCtx, uint8_t *pBlob)
+{
+    sss_se05x_session_t *pSession = (sss_se05x_session_t *)&pCtx->session;
+    size_t blobLen                = SSS_SE05X_SESSION_CHECKPOINT_LEN;
+
+    CHECK(kStatus_SSS_Success == sss_se05x_session_checkpoint(pSession, &pCtx->se05x_open_ctx, pBlob, &blobLen));
+    CHECK(blobLen == SSS_SE05X_SESSION_CHECKPOINT_LEN);
+    sss_se05x_session_detach(pSession);
+    return kStatus_SSS_Success;
+}
+
+/* Resume, *pApdus is what it cost */
+static sss_status_t resume(ex_sss_boot_ctx_t *pCtx, const uint8_t *pBlob, size_t blobLen, unsigned int *pApdus)
+{
+    sss_status_t status;
+    unsigned int before = gApdus;
+
+    status  = sss_se05x_session_resume((sss_se05x_session_t *)&pCtx->session, &pCtx->se05x_open_ctx, pBlob, blobLen);
+    *pApdus = gApdus - before;
+    return status;
+}
+
+static sss_status_t test_refused_blobs(ex_sss_boot_ctx_t *pCtx, const uint8_t *pBlob)
+{
+    uint8_t bad[SSS_SE05X_SESSION_CHECKPOINT_LEN];
+    unsigned int apdus;
+    size_t offsets[] = {0, TEST_COUNTER_OFFSET + TEST_COUNTER_LEN - 1, 40, SSS_SE05X_SESSION_CHECKPOINT_LEN - 1};
+    size_t i;
+
+    for (i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        memcpy(bad, pBlob, sizeof(bad));
+        bad[offsets[i]] ^= 0x01;
+        CHECK(kStatus_SSS_Success != resume(pCtx, bad, sizeof(bad), &apdus));
+        CHECK(apdus == 0);
+    }
+    CHECK(kStatus_SSS_Success != resume(pCtx, pBlob, SSS_SE05X_SESSION_CHECKPOINT_LEN - 1, &apdus));
+    CHECK(apdus == 0);
+    return kStatus_SSS_Success;
+}
+
+sss_status_t ex_sss_entry(ex_sss_boot_ctx_t *pCtx)
+{
+    sss_se05x_session_t *pSession = (sss_se05x_session_t *)&pCtx->session;
+    uint8_t blob1[SSS_SE05X_SESSION_CHECKPOINT_LEN];
+    uint8_t blob2[SSS_SE05X_SESSION_CHECKPOINT_LEN];
+    uint8_t counter[TEST_COUNTER_LEN];
+    size_t counterLen = sizeof(counter);
+    unsigned int apdus;
+
+    CHECK(kStatus_SSS_Success == use_session(pCtx, 0x11));
+    CHECK(kStatus_SSS_Success == checkpoint_and_detach(pCtx, blob1));
+    CHECK(kStatus_SSS_Success == test_refused_blobs(pCtx, blob1));
+
+    /* Only the checkpoint counter is sent */
+    CHECK(kStatus_SSS_Success == resume(pCtx, blob1, sizeof(blob1), &apdus));
+    CHECK(apdus == 2);
+    CHECK(SM_OK == Se05x_API_ReadObject(
+                       &pSession->s_ctx, SSS_SE05X_SESSION_CHECKPOINT_COUNTER_ID, 0, 0, counter, &counterLen));
+    CHECK(counterLen == TEST_COUNTER_LEN);
+    CHECK(0 == memcmp(counter, &blob1[TEST_COUNTER_OFFSET], TEST_COUNTER_LEN - 1));
+    CHECK(counter[TEST_COUNTER_LEN - 1] == (uint8_t)(blob1[TEST_COUNTER_OFFSET + TEST_COUNTER_LEN - 1] + 1));
+    CHECK(kStatus_SSS_Success == use_session(pCtx, 0x22));
+
+    /* Again, from the resumed session */
+    CHECK(kStatus_SSS_Success == checkpoint_and_detach(pCtx, blob2));
+    CHECK(kStatus_SSS_Success == resume(pCtx, blob2, sizeof(blob2), &apdus));
+    CHECK(apdus == 2);
+    CHECK(kStatus_SSS_Success == use_session(pCtx, 0x33));
+    sss_se05x_session_detach(pSession);
+
+    /* Replayed: the session has moved on */
+    CHECK(kStatus_SSS_Success != resume(pCtx, blob2, sizeof(blob2), &apdus));
+    CHECK(kStatus_SSS_Success != resume(pCtx, blob1, sizeof(blob1), &apdus));
+
+    /* A worker whose blob is refused opens a new session */
+    CHECK(kStatus_SSS_Success == sss_session_open(&pCtx->session,
+                                     kType_SSS_SE_SE05x,
+                                     0,
+                                     kSSS_ConnectionType_Encrypted,
+                                     &pCtx->se05x_open_ctx));
+    CHECK(kStatus_SSS_Success == use_session(pCtx, 0x44));
+
+    printf("test_se05x_session_resume: OK\n");
+    return kStatus_SSS_Success;
+}